@@ -1,14 +1,19 @@
 #include "atmosphere_renderer.h"
 #include <QtMath>
+#include <QtConcurrent>
 #include <qapplication.h>
 
 AtmosphereRenderer::AtmosphereRenderer(float earthRadius)
     : Renderer()
+    , earthRadius(earthRadius)
     , radius(earthRadius * 1.05f)
 {
 }
 
-AtmosphereRenderer::~AtmosphereRenderer() = default;
+AtmosphereRenderer::~AtmosphereRenderer() {
+    if (memoryBudget)
+        memoryBudget->unregisterLayer(budgetLayer);
+}
 
 void AtmosphereRenderer::initialize() {
     if (!init()) {
@@ -16,34 +21,96 @@ void AtmosphereRenderer::initialize() {
         return;
     }
     initShaders();
-    initTextures();  // Добавляем вызов initTextures
     initGeometry();
+    if (scatteringEnabled)
+        startScatteringBuild();
 }
 
-void AtmosphereRenderer::initTextures() {
-    QString buildDir = QCoreApplication::applicationDirPath();
-    skyTexture = std::make_unique<TileTextureManager>(
-        buildDir + "/textures/earth_clouds.jpg", RINGS, SEGMENTS);
-    skyTexture->initialize();
-
-    // Устанавливаем параметры текстурирования
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+void AtmosphereRenderer::setScatteringEnabled(bool enabled) {
+    scatteringEnabled = enabled;
+    if (enabled)
+        startScatteringBuild();
 }
 
 void AtmosphereRenderer::initShaders() {
     program.addShaderFromSourceFile(QOpenGLShader::Vertex, ":/shaders/atmosphere_vertex.glsl");
     program.addShaderFromSourceFile(QOpenGLShader::Fragment, ":/shaders/atmosphere_fragment.glsl");
     program.link();
+
+    // Программа рассеяния использует тот же VAO, поэтому атрибут на том же индексе
+    scatteringProgram.addShaderFromSourceFile(QOpenGLShader::Vertex, ":/shaders/atmosphere_scattering_vertex.glsl");
+    scatteringProgram.addShaderFromSourceFile(QOpenGLShader::Fragment, ":/shaders/atmosphere_scattering_fragment.glsl");
+    scatteringProgram.bindAttributeLocation("position", program.attributeLocation("position"));
+    if (!scatteringProgram.link())
+        qDebug() << "Failed to link atmosphere scattering program:" << scatteringProgram.log();
+}
+
+void AtmosphereRenderer::startScatteringBuild() {
+    if (scatteringBuildStarted)
+        return;
+    scatteringBuildStarted = true;
+
+    AtmosphereParameters parameters;
+    parameters.bottomRadius = earthRadius;
+    parameters.topRadius = earthRadius + 100000.0f;
+
+    // Загрузка кэша или расчет таблиц не задерживает кадр
+    scatteringBuild = QtConcurrent::run([parameters]() {
+        auto model = std::make_shared<AtmosphereScatteringModel>(parameters);
+        if (!model->loadOrPrecompute())
+            qDebug() << "Atmosphere LUT cache was not saved";
+        return model;
+    });
+}
+
+void AtmosphereRenderer::uploadScattering() {
+    scatteringModel = scatteringBuild.result();
+
+    transmittanceLut = std::make_unique<QOpenGLTexture>(QOpenGLTexture::Target2D);
+    transmittanceLut->setSize(AtmosphereScatteringModel::TRANSMITTANCE_WIDTH,
+                              AtmosphereScatteringModel::TRANSMITTANCE_HEIGHT);
+    transmittanceLut->setFormat(QOpenGLTexture::RGBA16F);
+    transmittanceLut->allocateStorage(QOpenGLTexture::RGBA, QOpenGLTexture::Float32);
+    transmittanceLut->setData(QOpenGLTexture::RGBA, QOpenGLTexture::Float32,
+                              scatteringModel->transmittance().constData());
+    transmittanceLut->setMinificationFilter(QOpenGLTexture::Linear);
+    transmittanceLut->setMagnificationFilter(QOpenGLTexture::Linear);
+    transmittanceLut->setWrapMode(QOpenGLTexture::ClampToEdge);
+
+    scatteringLut = std::make_unique<QOpenGLTexture>(QOpenGLTexture::Target3D);
+    scatteringLut->setSize(AtmosphereScatteringModel::SCATTERING_MU_S,
+                           AtmosphereScatteringModel::SCATTERING_MU,
+                           AtmosphereScatteringModel::SCATTERING_R);
+    scatteringLut->setFormat(QOpenGLTexture::RGBA16F);
+    scatteringLut->allocateStorage(QOpenGLTexture::RGBA, QOpenGLTexture::Float32);
+    scatteringLut->setData(QOpenGLTexture::RGBA, QOpenGLTexture::Float32,
+                           scatteringModel->scattering().constData());
+    scatteringLut->setMinificationFilter(QOpenGLTexture::Linear);
+    scatteringLut->setMagnificationFilter(QOpenGLTexture::Linear);
+    scatteringLut->setWrapMode(QOpenGLTexture::ClampToEdge);
+
+    if (memoryBudget) {
+        // RGBA16F, без mip; объемная таблица — одним уровнем
+        const qint64 transmittanceBytes = qint64(AtmosphereScatteringModel::TRANSMITTANCE_WIDTH)
+                                          * AtmosphereScatteringModel::TRANSMITTANCE_HEIGHT * 8;
+        const qint64 scatteringBytes = qint64(AtmosphereScatteringModel::SCATTERING_MU_S)
+                                       * AtmosphereScatteringModel::SCATTERING_MU
+                                       * AtmosphereScatteringModel::SCATTERING_R * 8;
+        budgetLayer = memoryBudget->registerLayer("atmosphere", GpuMemoryBudget::Priority::High);
+        memoryBudget->setUsage(budgetLayer, {transmittanceBytes + scatteringBytes});
+    }
 }
 
 void AtmosphereRenderer::render(const QMatrix4x4& projection, const QMatrix4x4& view, const QMatrix4x4& model) {
-    if (!program.bind())
+    if (scatteringEnabled && !scatteringLut && scatteringBuildStarted && scatteringBuild.isFinished())
+        uploadScattering();
+    if (scatteringEnabled && scatteringLut) {
+        renderScattering(projection, view, model);
         return;
+    }
 
-    update(0.016f);
+    if (!program.bind())
+        return;
 
     vao.bind();
 
@@ -53,13 +120,13 @@ void AtmosphereRenderer::render(const QMatrix4x4& projection, const QMatrix4x4&
     program.setUniformValue("viewMatrix", view);
     program.setUniformValue("modelMatrix", model);
     program.setUniformValue("viewPos", cameraPos);
-    program.setUniformValue("lightPos", cameraPos);
-    program.setUniformValue("cloudRotationMatrix", cloudRotationMatrix);
+    program.setUniformValue("sunDirection", sunDirection);
 
-    // Привязываем текстуру облаков
-    glActiveTexture(GL_TEXTURE0);
-    skyTexture->bindTileTexture(0, 0);
-    program.setUniformValue("skyTexture", 0);
+    // Облака из общего слоя
+    if (cloudLayer)
+        cloudLayer->bind(program, 0);
+    else
+        program.setUniformValue("cloudsAvailable", false);
 
     // Сохраняем текущие состояния OpenGL
     GLboolean depthTest, blend, cullFace;
@@ -95,6 +162,68 @@ void AtmosphereRenderer::render(const QMatrix4x4& projection, const QMatrix4x4&
     program.release();
 }
 
+void AtmosphereRenderer::renderScattering(const QMatrix4x4& projection, const QMatrix4x4& view, const QMatrix4x4& model) {
+    if (!scatteringProgram.bind())
+        return;
+
+    vao.bind();
+
+    const AtmosphereParameters& parameters = scatteringModel->parameters();
+    QVector3D cameraPos = view.inverted().column(3).toVector3D();
+
+    scatteringProgram.setUniformValue("projectionMatrix", projection);
+    scatteringProgram.setUniformValue("viewMatrix", view);
+    scatteringProgram.setUniformValue("modelMatrix", model);
+    scatteringProgram.setUniformValue("shellScale", parameters.topRadius / radius);
+    scatteringProgram.setUniformValue("viewPos", cameraPos);
+    scatteringProgram.setUniformValue("sunDirection", sunDirection);
+    scatteringProgram.setUniformValue("bottomRadius", parameters.bottomRadius);
+    scatteringProgram.setUniformValue("topRadius", parameters.topRadius);
+    scatteringProgram.setUniformValue("rayleighScattering", parameters.rayleighScattering);
+    scatteringProgram.setUniformValue("miePhaseG", parameters.miePhaseG);
+
+    glActiveTexture(GL_TEXTURE0);
+    transmittanceLut->bind();
+    scatteringProgram.setUniformValue("transmittanceLut", 0);
+    glActiveTexture(GL_TEXTURE1);
+    scatteringLut->bind();
+    scatteringProgram.setUniformValue("scatteringLut", 1);
+
+    GLboolean depthTest, blend, cullFace;
+    GLint depthFunc;
+    glGetBooleanv(GL_DEPTH_TEST, &depthTest);
+    glGetBooleanv(GL_BLEND, &blend);
+    glGetBooleanv(GL_CULL_FACE, &cullFace);
+    glGetIntegerv(GL_DEPTH_FUNC, &depthFunc);
+
+    glEnable(GL_DEPTH_TEST);
+    glDepthFunc(GL_LEQUAL);
+    glDepthMask(GL_FALSE);
+
+    // Цвет сцены ослабляется пропусканием (alpha), рассеянный свет добавляется
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_ONE, GL_SRC_ALPHA);
+
+    glEnable(GL_CULL_FACE);
+    glCullFace(GL_BACK);
+    glFrontFace(GL_CCW);
+
+    glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, nullptr);
+
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glDepthFunc(depthFunc);
+    glDepthMask(GL_TRUE);
+    if (!depthTest) glDisable(GL_DEPTH_TEST);
+    if (!blend) glDisable(GL_BLEND);
+    if (!cullFace) glDisable(GL_CULL_FACE);
+
+    scatteringLut->release();
+    glActiveTexture(GL_TEXTURE0);
+
+    vao.release();
+    scatteringProgram.release();
+}
+
 void AtmosphereRenderer::initGeometry() {
     createSphere();
 
@@ -141,12 +270,11 @@ void AtmosphereRenderer::createSphere() {
             QVector3D v3 = sphericalToCartesian(radius, phi2, theta2);
             QVector3D v4 = sphericalToCartesian(radius, phi2, theta1);
 
-            // Получаем UV-координаты из атласа текстур
-            QRectF uvCoords = skyTexture->getTileUVCoords(ring, segment);
-            QVector2D uv1(uvCoords.left(), uvCoords.top());
-            QVector2D uv2(uvCoords.right(), uvCoords.top());
-            QVector2D uv3(uvCoords.right(), uvCoords.bottom());
-            QVector2D uv4(uvCoords.left(), uvCoords.bottom());
+            // Облака выбираются по направлению в шейдере, UV — обычная развертка сферы
+            QVector2D uv1(float(segment) / SEGMENTS, float(ring) / RINGS);
+            QVector2D uv2(float(segment + 1) / SEGMENTS, float(ring) / RINGS);
+            QVector2D uv3(float(segment + 1) / SEGMENTS, float(ring + 1) / RINGS);
+            QVector2D uv4(float(segment) / SEGMENTS, float(ring + 1) / RINGS);
 
             // Нормали
             QVector3D n1 = v1.normalized();
@@ -191,14 +319,3 @@ QVector3D AtmosphereRenderer::sphericalToCartesian(float radius, float phi, floa
     float z = radius * sin(phi) * sin(theta);
     return QVector3D(x, y, z);
 }
-
-void AtmosphereRenderer::update(float deltaTime) {
-    // Обновляем угол вращения (настройте скорость по необходимости)
-    float rotationSpeed = 0.02f; // радиан в секунду
-    rotationAngle += rotationSpeed * deltaTime;
-
-    // Создаем матрицу вращения вокруг оси Y
-    cloudRotationMatrix.setToIdentity();
-    cloudRotationMatrix.rotate(QQuaternion::fromAxisAndAngle(QVector3D(0, 1, 0),
-                                                             qRadiansToDegrees(rotationAngle)));
-}
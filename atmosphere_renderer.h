@@ -2,7 +2,12 @@
 #define ATMOSPHERE_RENDERER_H
 
 #include "renderer.h"
-#include "tile_texture_manager.h"
+#include "atmosphere_scattering.h"
+#include "cloud_layer.h"
+#include "gpu_memory_budget.h"
+#include <QOpenGLTexture>
+#include <QFuture>
+#include <memory>
 
 class AtmosphereRenderer : public Renderer {
 public:
@@ -12,25 +17,49 @@ public:
     void initialize() override;
     void render(const QMatrix4x4& projection, const QMatrix4x4& view, const QMatrix4x4& model) override;
 
+    // Слой облаков принадлежит EarthRenderer
+    void setCloudLayer(CloudLayer* layer) { cloudLayer = layer; }
+    // Единичное направление на Солнце в мировой системе; задается каждый кадр
+    void setSunDirection(const QVector3D& direction) { sunDirection = direction; }
+    // Таблицы рассеяния учитываются в бюджете видеопамяти при построении
+    void setMemoryBudget(GpuMemoryBudget* budget) { memoryBudget = budget; }
+
+    // Режим физического рассеяния. Таблицы строятся в пуле потоков при первом
+    // включении; пока они не готовы, рисуется текстурная оболочка
+    void setScatteringEnabled(bool enabled);
+    bool isScatteringEnabled() const { return scatteringEnabled; }
+    // Рассеяние действительно рисуется: таблицы готовы и загружены
+    bool isScatteringActive() const { return scatteringEnabled && scatteringLut; }
 
 protected:
     void initShaders();
     void initGeometry();
-    void initTextures();  // Добавляем метод для инициализации текстур
 
 private:
-    QMatrix4x4 cloudRotationMatrix;
-    float rotationAngle = 0.0f;
     void createSphere();
     QVector3D sphericalToCartesian(float radius, float phi, float theta) const;
-    void update(float deltaTime);
+    void startScatteringBuild();
+    void uploadScattering();
+    void renderScattering(const QMatrix4x4& projection, const QMatrix4x4& view, const QMatrix4x4& model);
 
+    float earthRadius;
     float radius;
 
+    // Рассеяние Рэлея/Ми по предрасчитанным таблицам
+    bool scatteringEnabled = false;
+    QOpenGLShaderProgram scatteringProgram;
+    std::shared_ptr<AtmosphereScatteringModel> scatteringModel;
+    QFuture<std::shared_ptr<AtmosphereScatteringModel>> scatteringBuild;
+    bool scatteringBuildStarted = false;
+    std::unique_ptr<QOpenGLTexture> transmittanceLut;
+    std::unique_ptr<QOpenGLTexture> scatteringLut;
+
     QOpenGLBuffer ibo{QOpenGLBuffer::IndexBuffer};
 
-    // Добавляем текстуру неба
-    std::unique_ptr<TileTextureManager> skyTexture;
+    CloudLayer* cloudLayer = nullptr;
+    GpuMemoryBudget* memoryBudget = nullptr;
+    QVector3D sunDirection{1.0f, 0.0f, 0.0f};
+    int budgetLayer = -1;
 
     struct Vertex {
         QVector3D position;
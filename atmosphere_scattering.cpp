@@ -0,0 +1,276 @@
+// atmosphere_scattering.cpp
+#include "atmosphere_scattering.h"
+#include <QtConcurrent>
+#include <QElapsedTimer>
+#include <QStandardPaths>
+#include <QSaveFile>
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QDataStream>
+#include <QDebug>
+#include <numeric>
+#include <cmath>
+
+namespace {
+
+constexpr quint32 CACHE_MAGIC = 0x45334441; // "E3DA"
+constexpr quint32 CACHE_VERSION = 1;
+constexpr int TRANSMITTANCE_STEPS = 64;
+constexpr int SCATTERING_STEPS = 48;
+constexpr float MU_S_MIN = -0.2f; // солнце ниже этого угла уже не дает рассеяния
+
+// Одинаковые отображения используются в шейдере atmosphere_scattering_fragment.glsl
+float unitFromIndex(int index, int size)
+{
+    return float(index) / float(size - 1);
+}
+
+QVector3D expVector(const QVector3D& v)
+{
+    return QVector3D(std::exp(v.x()), std::exp(v.y()), std::exp(v.z()));
+}
+
+}
+
+quint64 AtmosphereParameters::hash() const
+{
+    const float values[] = {
+        bottomRadius, topRadius,
+        rayleighScattering.x(), rayleighScattering.y(), rayleighScattering.z(),
+        rayleighScaleHeight, mieScattering, mieExtinction, mieScaleHeight, miePhaseG
+    };
+    return qHashBits(values, sizeof(values));
+}
+
+AtmosphereScatteringModel::AtmosphereScatteringModel(const AtmosphereParameters& parameters)
+    : params(parameters)
+    , buildTimeMs(0)
+{
+}
+
+void AtmosphereScatteringModel::precompute()
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    transmittanceTable.resize(TRANSMITTANCE_WIDTH * TRANSMITTANCE_HEIGHT * 4);
+    scatteringTable.resize(SCATTERING_R * SCATTERING_MU * SCATTERING_MU_S * 4);
+
+    // Рассеяние читает таблицу пропускания, поэтому два последовательных этапа
+    QVector<int> rows(TRANSMITTANCE_HEIGHT);
+    std::iota(rows.begin(), rows.end(), 0);
+    QtConcurrent::blockingMap(rows, [this](int row) { computeTransmittanceRow(row); });
+
+    QVector<int> slices(SCATTERING_R);
+    std::iota(slices.begin(), slices.end(), 0);
+    QtConcurrent::blockingMap(slices, [this](int slice) { computeScatteringSlice(slice); });
+
+    buildTimeMs = timer.elapsed();
+}
+
+void AtmosphereScatteringModel::computeTransmittanceRow(int row)
+{
+    float x = unitFromIndex(row, TRANSMITTANCE_HEIGHT);
+    float r = params.bottomRadius + x * x * (params.topRadius - params.bottomRadius);
+
+    float* out = transmittanceTable.data() + row * TRANSMITTANCE_WIDTH * 4;
+    for (int column = 0; column < TRANSMITTANCE_WIDTH; ++column) {
+        float mu = unitFromIndex(column, TRANSMITTANCE_WIDTH) * 2.0f - 1.0f;
+        QVector3D t = computeTransmittance(r, mu);
+        *out++ = t.x();
+        *out++ = t.y();
+        *out++ = t.z();
+        *out++ = 1.0f;
+    }
+}
+
+void AtmosphereScatteringModel::computeScatteringSlice(int slice)
+{
+    float x = unitFromIndex(slice, SCATTERING_R);
+    float r = params.bottomRadius + x * x * (params.topRadius - params.bottomRadius);
+
+    float* out = scatteringTable.data() + slice * SCATTERING_MU * SCATTERING_MU_S * 4;
+    for (int muIndex = 0; muIndex < SCATTERING_MU; ++muIndex) {
+        float mu = unitFromIndex(muIndex, SCATTERING_MU) * 2.0f - 1.0f;
+        for (int muSIndex = 0; muSIndex < SCATTERING_MU_S; ++muSIndex) {
+            float muS = MU_S_MIN + unitFromIndex(muSIndex, SCATTERING_MU_S) * (1.0f - MU_S_MIN);
+            QVector4D s = computeScattering(r, mu, muS);
+            *out++ = s.x();
+            *out++ = s.y();
+            *out++ = s.z();
+            *out++ = s.w();
+        }
+    }
+}
+
+// Геометрия в double: r^2 порядка 4e13 и в float теряет точность у горизонта
+float AtmosphereScatteringModel::distanceToTop(float r, float mu) const
+{
+    double discriminant = double(r) * r * (double(mu) * mu - 1.0) + double(params.topRadius) * params.topRadius;
+    return float(qMax(0.0, -double(r) * mu + std::sqrt(qMax(0.0, discriminant))));
+}
+
+float AtmosphereScatteringModel::distanceToBottom(float r, float mu) const
+{
+    double discriminant = double(r) * r * (double(mu) * mu - 1.0) + double(params.bottomRadius) * params.bottomRadius;
+    return float(qMax(0.0, -double(r) * mu - std::sqrt(qMax(0.0, discriminant))));
+}
+
+bool AtmosphereScatteringModel::intersectsGround(float r, float mu) const
+{
+    return mu < 0.0f &&
+           double(r) * r * (double(mu) * mu - 1.0) + double(params.bottomRadius) * params.bottomRadius >= 0.0;
+}
+
+QVector3D AtmosphereScatteringModel::extinctionAt(float r) const
+{
+    float height = qMax(0.0f, r - params.bottomRadius);
+    float rayleighDensity = std::exp(-height / params.rayleighScaleHeight);
+    float mieDensity = std::exp(-height / params.mieScaleHeight);
+    return params.rayleighScattering * rayleighDensity
+           + QVector3D(1.0f, 1.0f, 1.0f) * params.mieExtinction * mieDensity;
+}
+
+QVector3D AtmosphereScatteringModel::computeTransmittance(float r, float mu) const
+{
+    float distance = intersectsGround(r, mu) ? distanceToBottom(r, mu) : distanceToTop(r, mu);
+    float step = distance / TRANSMITTANCE_STEPS;
+
+    QVector3D opticalDepth;
+    for (int i = 0; i < TRANSMITTANCE_STEPS; ++i) {
+        float t = (i + 0.5f) * step;
+        float rt = std::sqrt(r * r + t * t + 2.0f * r * mu * t);
+        opticalDepth += extinctionAt(rt) * step;
+    }
+    return expVector(-opticalDepth);
+}
+
+QVector3D AtmosphereScatteringModel::lookupTransmittance(float r, float mu) const
+{
+    if (intersectsGround(r, mu))
+        return QVector3D(0.0f, 0.0f, 0.0f);
+
+    float xr = std::sqrt(qBound(0.0f, (r - params.bottomRadius) / (params.topRadius - params.bottomRadius), 1.0f));
+    float xmu = qBound(0.0f, (mu + 1.0f) * 0.5f, 1.0f);
+
+    float fx = xmu * (TRANSMITTANCE_WIDTH - 1);
+    float fy = xr * (TRANSMITTANCE_HEIGHT - 1);
+    int x0 = qMin(int(fx), TRANSMITTANCE_WIDTH - 2);
+    int y0 = qMin(int(fy), TRANSMITTANCE_HEIGHT - 2);
+    float ax = fx - x0;
+    float ay = fy - y0;
+
+    auto texel = [this](int x, int y) {
+        const float* p = transmittanceTable.constData() + (y * TRANSMITTANCE_WIDTH + x) * 4;
+        return QVector3D(p[0], p[1], p[2]);
+    };
+
+    QVector3D top = texel(x0, y0) * (1.0f - ax) + texel(x0 + 1, y0) * ax;
+    QVector3D bottom = texel(x0, y0 + 1) * (1.0f - ax) + texel(x0 + 1, y0 + 1) * ax;
+    return top * (1.0f - ay) + bottom * ay;
+}
+
+QVector4D AtmosphereScatteringModel::computeScattering(float r, float mu, float muS) const
+{
+    float distance = intersectsGround(r, mu) ? distanceToBottom(r, mu) : distanceToTop(r, mu);
+    float step = distance / SCATTERING_STEPS;
+
+    // Солнце в плоскости луча (см. описание класса)
+    float nu = mu * muS + std::sqrt(qMax(0.0f, 1.0f - mu * mu)) * std::sqrt(qMax(0.0f, 1.0f - muS * muS));
+
+    QVector3D opticalDepth;
+    QVector3D rayleigh;
+    QVector3D mie;
+    for (int i = 0; i < SCATTERING_STEPS; ++i) {
+        float t = (i + 0.5f) * step;
+        float rt = std::sqrt(r * r + t * t + 2.0f * r * mu * t);
+        float muSt = qBound(-1.0f, (r * muS + t * nu) / rt, 1.0f);
+
+        float height = qMax(0.0f, rt - params.bottomRadius);
+        float rayleighDensity = std::exp(-height / params.rayleighScaleHeight);
+        float mieDensity = std::exp(-height / params.mieScaleHeight);
+
+        // Оптическая толщина до середины шага
+        QVector3D extinction = params.rayleighScattering * rayleighDensity
+                               + QVector3D(1.0f, 1.0f, 1.0f) * params.mieExtinction * mieDensity;
+        QVector3D viewTransmittance = expVector(-(opticalDepth + extinction * (0.5f * step)));
+        opticalDepth += extinction * step;
+
+        QVector3D light = viewTransmittance * lookupTransmittance(rt, muSt) * step;
+        rayleigh += light * rayleighDensity;
+        mie += light * mieDensity;
+    }
+
+    rayleigh *= params.rayleighScattering;
+    mie *= params.mieScattering;
+    return QVector4D(rayleigh, mie.x());
+}
+
+QString AtmosphereScatteringModel::defaultCachePath() const
+{
+    QString dir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    return QDir(dir).filePath(QString("atmosphere_lut_%1.bin").arg(params.hash(), 16, 16, QChar('0')));
+}
+
+bool AtmosphereScatteringModel::loadOrPrecompute(const QString& cachePath)
+{
+    QString path = cachePath.isEmpty() ? defaultCachePath() : cachePath;
+    if (loadCache(path))
+        return true;
+
+    precompute();
+    return saveCache(path);
+}
+
+bool AtmosphereScatteringModel::loadCache(const QString& path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream stream(&file);
+    quint32 magic = 0, version = 0;
+    quint64 hash = 0;
+    qint32 tw = 0, th = 0, sr = 0, smu = 0, smus = 0;
+    stream >> magic >> version >> hash >> tw >> th >> sr >> smu >> smus;
+    if (magic != CACHE_MAGIC || version != CACHE_VERSION || hash != params.hash() ||
+        tw != TRANSMITTANCE_WIDTH || th != TRANSMITTANCE_HEIGHT ||
+        sr != SCATTERING_R || smu != SCATTERING_MU || smus != SCATTERING_MU_S)
+        return false;
+
+    transmittanceTable.resize(TRANSMITTANCE_WIDTH * TRANSMITTANCE_HEIGHT * 4);
+    scatteringTable.resize(SCATTERING_R * SCATTERING_MU * SCATTERING_MU_S * 4);
+
+    int transmittanceBytes = int(transmittanceTable.size() * sizeof(float));
+    int scatteringBytes = int(scatteringTable.size() * sizeof(float));
+    if (stream.readRawData(reinterpret_cast<char*>(transmittanceTable.data()), transmittanceBytes) != transmittanceBytes ||
+        stream.readRawData(reinterpret_cast<char*>(scatteringTable.data()), scatteringBytes) != scatteringBytes) {
+        transmittanceTable.clear();
+        scatteringTable.clear();
+        return false;
+    }
+    buildTimeMs = 0;
+    return true;
+}
+
+bool AtmosphereScatteringModel::saveCache(const QString& path) const
+{
+    QDir().mkpath(QFileInfo(path).absolutePath());
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Failed to write atmosphere LUT cache:" << path;
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream << CACHE_MAGIC << CACHE_VERSION << params.hash()
+           << qint32(TRANSMITTANCE_WIDTH) << qint32(TRANSMITTANCE_HEIGHT)
+           << qint32(SCATTERING_R) << qint32(SCATTERING_MU) << qint32(SCATTERING_MU_S);
+    stream.writeRawData(reinterpret_cast<const char*>(transmittanceTable.constData()),
+                        int(transmittanceTable.size() * sizeof(float)));
+    stream.writeRawData(reinterpret_cast<const char*>(scatteringTable.constData()),
+                        int(scatteringTable.size() * sizeof(float)));
+    return file.commit();
+}
@@ -0,0 +1,72 @@
+// atmosphere_scattering.h
+#ifndef ATMOSPHERE_SCATTERING_H
+#define ATMOSPHERE_SCATTERING_H
+
+#include <QVector>
+#include <QVector3D>
+#include <QVector4D>
+#include <QString>
+
+// Параметры атмосферы Земли (единицы — метры)
+struct AtmosphereParameters {
+    float bottomRadius = 6371000.0f;
+    float topRadius = 6371000.0f + 100000.0f;
+    QVector3D rayleighScattering{5.802e-6f, 13.558e-6f, 33.1e-6f};
+    float rayleighScaleHeight = 8000.0f;
+    float mieScattering = 3.996e-6f;
+    float mieExtinction = 4.440e-6f;
+    float mieScaleHeight = 1200.0f;
+    float miePhaseG = 0.8f;
+
+    quint64 hash() const;
+};
+
+// Однократное рассеяние Рэлея и Ми, предрасчитанное в таблицы:
+//  - пропускание T(r, mu) — 2D;
+//  - рассеяние S(r, mu, muS) — 3D, rgb = Рэлей, a = Ми (красный канал).
+// Азимут солнца не хранится: солнце считается лежащим в плоскости луча,
+// фазовые функции применяются в шейдере по настоящему углу.
+// Расчет выполняется на CPU в пуле потоков, поэтому работает и с программным GL.
+class AtmosphereScatteringModel {
+public:
+    static constexpr int TRANSMITTANCE_WIDTH = 256;  // mu
+    static constexpr int TRANSMITTANCE_HEIGHT = 64;  // r
+    static constexpr int SCATTERING_R = 32;
+    static constexpr int SCATTERING_MU = 128;
+    static constexpr int SCATTERING_MU_S = 32;
+
+    explicit AtmosphereScatteringModel(const AtmosphereParameters& parameters = AtmosphereParameters());
+
+    void precompute();
+    // Загружает таблицы из кэша на диске либо рассчитывает и сохраняет их
+    bool loadOrPrecompute(const QString& cachePath = QString());
+    bool loadCache(const QString& path);
+    bool saveCache(const QString& path) const;
+    QString defaultCachePath() const;
+
+    const AtmosphereParameters& parameters() const { return params; }
+    const QVector<float>& transmittance() const { return transmittanceTable; } // RGBA
+    const QVector<float>& scattering() const { return scatteringTable; }       // RGBA
+    // Время последней сборки таблиц; 0 — загружены из кэша
+    qint64 lastBuildTimeMs() const { return buildTimeMs; }
+
+private:
+    void computeTransmittanceRow(int row);
+    void computeScatteringSlice(int slice);
+
+    QVector3D computeTransmittance(float r, float mu) const;
+    QVector3D lookupTransmittance(float r, float mu) const;
+    QVector4D computeScattering(float r, float mu, float muS) const;
+
+    float distanceToTop(float r, float mu) const;
+    float distanceToBottom(float r, float mu) const;
+    bool intersectsGround(float r, float mu) const;
+    QVector3D extinctionAt(float r) const;
+
+    AtmosphereParameters params;
+    QVector<float> transmittanceTable;
+    QVector<float> scatteringTable;
+    qint64 buildTimeMs;
+};
+
+#endif // ATMOSPHERE_SCATTERING_H
@@ -0,0 +1,50 @@
+// atmosphere_lut_bench.cpp
+// Время построения таблиц рассеяния при разном числе потоков.
+// Запуск: atmosphere_lut_bench [повторов]
+#include <QCoreApplication>
+#include <QThread>
+#include <QThreadPool>
+#include <QVector>
+#include <QTextStream>
+#include <algorithm>
+#include "atmosphere_scattering.h"
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QTextStream out(stdout);
+
+    const int repeats = argc > 1 ? std::max(1, QString(argv[1]).toInt()) : 3;
+    const int maxThreads = QThread::idealThreadCount();
+
+    QVector<int> threadCounts;
+    for (int threads = 1; threads < maxThreads; threads *= 2)
+        threadCounts.append(threads);
+    threadCounts.append(maxThreads);
+
+    out << "threads  best_ms  median_ms\n";
+    qint64 singleThreadMs = 0;
+    for (int threads : threadCounts) {
+        QThreadPool::globalInstance()->setMaxThreadCount(threads);
+
+        QVector<qint64> times;
+        for (int i = 0; i < repeats; ++i) {
+            AtmosphereScatteringModel model;
+            model.precompute();
+            times.append(model.lastBuildTimeMs());
+        }
+        std::sort(times.begin(), times.end());
+        if (threads == 1)
+            singleThreadMs = times.first();
+
+        out << qSetFieldWidth(7) << threads << qSetFieldWidth(0) << "  "
+            << qSetFieldWidth(7) << times.first() << qSetFieldWidth(0) << "  "
+            << qSetFieldWidth(9) << times.at(times.size() / 2) << qSetFieldWidth(0);
+        if (threads > 1 && times.first() > 0)
+            out << "  x" << QString::number(double(singleThreadMs) / times.first(), 'f', 2);
+        out << "\n";
+        out.flush();
+    }
+
+    return 0;
+}
@@ -0,0 +1,199 @@
+// catalog_feed_bench.cpp
+// Пропускная способность потока изменений каталога: клиент в отдельном потоке
+// пишет записи в локальный сокет, сервер в цикле событий разбирает их, а таймер
+// кадров применяет накопленные пакеты к SatelliteCatalog, как EarthWidget.
+// Результат — обновления в секунду от сокета до каталога и время пакета на кадр.
+//
+// Пример: catalog_feed_bench --updates 1000000 --objects 30000 --output feed.json
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLocalSocket>
+#include <QTextStream>
+#include <QTimer>
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <thread>
+#include "catalog_feed.h"
+#include "catalog_feed_generator.h"
+#include "satellite_catalog.h"
+
+namespace {
+
+constexpr int CHUNK_LINES = 4096;
+
+double percentile(QVector<double> values, double p)
+{
+    if (values.isEmpty())
+        return 0.0;
+    std::sort(values.begin(), values.end());
+    return values[qBound(0, int(p * (values.size() - 1) + 0.5), values.size() - 1)];
+}
+
+// Разбор без сокета: верхняя граница для сравнения
+double parseOnlyRate(const QByteArray& data, qint64 lines)
+{
+    QElapsedTimer timer;
+    timer.start();
+    CatalogUpdate update;
+    qint64 parsed = 0;
+    size_t start = 0;
+    const std::string_view view(data.constData(), size_t(data.size()));
+    for (size_t end = view.find('\n'); end != std::string_view::npos; end = view.find('\n', start)) {
+        parsed += CatalogParser::parseUpdateLine(view.substr(start, end - start), update);
+        start = end + 1;
+    }
+    const double seconds = timer.nsecsElapsed() / 1e9;
+    if (parsed != lines)
+        qWarning() << "Parsed" << parsed << "of" << lines << "lines";
+    return seconds > 0.0 ? lines / seconds : 0.0;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    QCommandLineOption updatesOption("updates", "Total updates to send.", "n", "1000000");
+    QCommandLineOption objectsOption("objects", "Number of distinct objects.", "n", "30000");
+    QCommandLineOption removeOption("remove-fraction", "Fraction of remove records.", "fraction", "0.01");
+    QCommandLineOption stateOption("state-fraction", "Fraction of state vector records.", "fraction", "0.5");
+    QCommandLineOption frameOption("frame-interval", "Milliseconds between applied batches.", "ms", "16");
+    QCommandLineOption seedOption("seed", "Random seed.", "seed", "1");
+    QCommandLineOption outputOption("output", "Write JSON results to a file instead of stdout.", "file");
+    parser.addOption(updatesOption);
+    parser.addOption(objectsOption);
+    parser.addOption(removeOption);
+    parser.addOption(stateOption);
+    parser.addOption(frameOption);
+    parser.addOption(seedOption);
+    parser.addOption(outputOption);
+    parser.process(app);
+
+    const qint64 updates = qMax<qint64>(1, parser.value(updatesOption).toLongLong());
+    const int objects = qMax(1, parser.value(objectsOption).toInt());
+
+    // Поток генерируется заранее, чтобы в замер не попадал snprintf
+    CatalogFeedGenerator generator(objects, parser.value(removeOption).toDouble(),
+                                   parser.value(stateOption).toDouble(), parser.value(seedOption).toUInt());
+    const double epoch = 1.7e9;
+    constexpr qint64 BYTES_PER_UPDATE = 80; // длина строки с запасом
+    if (updates > std::numeric_limits<qsizetype>::max() / BYTES_PER_UPDATE) {
+        qDebug() << "Too many updates for one buffer:" << updates;
+        return 1;
+    }
+    QByteArray data;
+    data.reserve(qsizetype(updates * BYTES_PER_UPDATE));
+    for (qint64 i = 0; i < updates; ++i)
+        generator.appendLine(data, epoch);
+
+    const QString serverName = QString("earth3d-feed-bench-%1").arg(QCoreApplication::applicationPid());
+    CatalogFeedServer server;
+    if (!server.listen(serverName))
+        return 1;
+
+    SatelliteCatalog catalog;
+    QVector<double> batchMs;
+    QVector<double> batchSizes;
+    qint64 applied = 0;
+
+    auto applyBatch = [&]() {
+        if (!server.hasPendingUpdates())
+            return;
+        QElapsedTimer timer;
+        timer.start();
+        const QVector<CatalogUpdate> batch = server.takePendingUpdates();
+        for (const CatalogUpdate& update : batch) {
+            if (update.type == CatalogUpdate::Type::Remove)
+                catalog.remove(update.elements.catalogNumber);
+            else
+                catalog.upsert(update.elements);
+        }
+        batchMs.append(timer.nsecsElapsed() / 1e6);
+        batchSizes.append(batch.size());
+        applied += batch.size();
+    };
+
+    QTimer frameTimer;
+    frameTimer.setTimerType(Qt::PreciseTimer);
+    QObject::connect(&frameTimer, &QTimer::timeout, applyBatch);
+    frameTimer.start(parser.value(frameOption).toInt());
+
+    std::atomic<bool> clientFailed{false};
+    QElapsedTimer wallTimer;
+    wallTimer.start();
+    std::thread client([&]() {
+        QLocalSocket socket;
+        socket.connectToServer(serverName, QIODevice::WriteOnly);
+        if (!socket.waitForConnected(5000)) {
+            clientFailed = true;
+            return;
+        }
+        const int chunkBytes = CHUNK_LINES * 80;
+        for (int offset = 0; offset < data.size(); offset += chunkBytes) {
+            socket.write(data.constData() + offset, qMin(chunkBytes, int(data.size()) - offset));
+            if (!socket.waitForBytesWritten(5000)) {
+                clientFailed = true;
+                return;
+            }
+        }
+        socket.disconnectFromServer();
+        if (socket.state() != QLocalSocket::UnconnectedState)
+            socket.waitForDisconnected(5000);
+    });
+
+    QEventLoop loop;
+    QTimer poll;
+    QObject::connect(&poll, &QTimer::timeout, [&]() {
+        if (clientFailed || server.receivedCount() >= updates)
+            loop.quit();
+    });
+    poll.start(1);
+    loop.exec();
+    applyBatch();
+    const double wallSeconds = wallTimer.nsecsElapsed() / 1e9;
+    client.join();
+
+    if (clientFailed) {
+        qCritical() << "Feed client failed";
+        return 1;
+    }
+
+    QJsonObject result;
+    result["updates"] = double(updates);
+    result["objects"] = objects;
+    result["received"] = double(server.receivedCount());
+    result["rejected"] = double(server.rejectedCount());
+    result["applied_after_coalescing"] = double(applied);
+    result["catalog_size"] = catalog.size();
+    result["wall_s"] = wallSeconds;
+    result["updates_per_s"] = server.receivedCount() / wallSeconds;
+    result["parse_only_updates_per_s"] = parseOnlyRate(data, updates);
+    result["batches"] = batchMs.size();
+    result["batch_size_p50"] = percentile(batchSizes, 0.5);
+    result["batch_size_max"] = percentile(batchSizes, 1.0);
+    result["batch_apply_ms_p50"] = percentile(batchMs, 0.5);
+    result["batch_apply_ms_p99"] = percentile(batchMs, 0.99);
+
+    const QByteArray json = QJsonDocument(result).toJson(QJsonDocument::Indented);
+    if (parser.isSet(outputOption)) {
+        QFile file(parser.value(outputOption));
+        if (!file.open(QIODevice::WriteOnly)) {
+            qCritical() << "Failed to write" << file.fileName();
+            return 1;
+        }
+        file.write(json);
+    } else {
+        QTextStream(stdout) << json;
+    }
+    return 0;
+}
@@ -0,0 +1,61 @@
+// catalog_feed_generator.h
+// Синтетические строки протокола потока изменений (CatalogParser::parseUpdateLine)
+// для тестового издателя и бенчмарка.
+#ifndef CATALOG_FEED_GENERATOR_H
+#define CATALOG_FEED_GENERATOR_H
+
+#include <QByteArray>
+#include <QRandomGenerator>
+#include <cmath>
+#include <cstdio>
+
+class CatalogFeedGenerator {
+public:
+    CatalogFeedGenerator(int objects, double removeFraction, double stateFraction, quint32 seed)
+        : objects(objects), removeFraction(removeFraction), stateFraction(stateFraction), random(seed) {}
+
+    // Случайная запись об одном из objects объектов; строка завершается \n
+    void appendLine(QByteArray& out, double epoch)
+    {
+        const int id = FIRST_ID + int(random.bounded(objects));
+        const double kind = random.generateDouble();
+        char line[256];
+        int length;
+        if (kind < removeFraction) {
+            length = std::snprintf(line, sizeof(line), "R %d\n", id);
+        } else if (kind < removeFraction + stateFraction) {
+            // Круговая орбита высотой 400-2000 км
+            const double radius = EARTH_RADIUS_KM + 400.0 + random.generateDouble() * 1600.0;
+            const double speed = std::sqrt(EARTH_MU_KM / radius);
+            const double inclination = random.generateDouble() * M_PI;
+            const double raan = random.generateDouble() * 2.0 * M_PI;
+            const double u = random.generateDouble() * 2.0 * M_PI;
+            const double px = radius * std::cos(u), py = radius * std::sin(u);
+            const double vx = -speed * std::sin(u), vy = speed * std::cos(u);
+            const double cosI = std::cos(inclination), sinI = std::sin(inclination);
+            const double cosO = std::cos(raan), sinO = std::sin(raan);
+            length = std::snprintf(line, sizeof(line), "S %d %.3f %.3f %.3f %.3f %.6f %.6f %.6f\n", id, epoch,
+                                   px * cosO - py * cosI * sinO, px * sinO + py * cosI * cosO, py * sinI,
+                                   vx * cosO - vy * cosI * sinO, vx * sinO + vy * cosI * cosO, vy * sinI);
+        } else {
+            length = std::snprintf(line, sizeof(line), "E %d %.3f %.4f %.4f %.7f %.4f %.4f %.8f FEED %d\n", id, epoch,
+                                   random.generateDouble() * 180.0, random.generateDouble() * 360.0,
+                                   random.generateDouble() * 0.02, random.generateDouble() * 360.0,
+                                   random.generateDouble() * 360.0, 1.0 + random.generateDouble() * 15.0, id);
+        }
+        out.append(line, length);
+    }
+
+    static constexpr int FIRST_ID = 900000; // вне диапазона реальных номеров NORAD
+
+private:
+    static constexpr double EARTH_RADIUS_KM = 6371.0;
+    static constexpr double EARTH_MU_KM = 398600.4418; // км^3/с^2
+
+    int objects;
+    double removeFraction;
+    double stateFraction;
+    QRandomGenerator random;
+};
+
+#endif // CATALOG_FEED_GENERATOR_H
@@ -0,0 +1,102 @@
+// catalog_feed_publisher.cpp
+// Тестовый издатель потока изменений каталога: подключается к earth3d --feed
+// и отправляет случайные записи E/S/R с заданной частотой.
+//
+// Пример: earth3d --feed earth3d-feed
+//         catalog_feed_publisher --server earth3d-feed --objects 30000 --rate 20000
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDateTime>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QLocalSocket>
+#include <QTextStream>
+#include <QThread>
+#include "catalog_feed_generator.h"
+
+namespace {
+
+constexpr qint64 MAX_CHUNK_LINES = 4096; // строк за одну запись в сокет
+
+}
+
+int main(int argc, char** argv)
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    QCommandLineOption serverOption("server", "Local socket name passed to earth3d --feed.", "name", "earth3d-feed");
+    QCommandLineOption objectsOption("objects", "Number of distinct objects.", "n", "30000");
+    QCommandLineOption rateOption("rate", "Updates per second (0 = as fast as possible).", "n", "10000");
+    QCommandLineOption durationOption("duration", "Seconds to run (0 = until interrupted).", "seconds", "0");
+    QCommandLineOption removeOption("remove-fraction", "Fraction of remove records.", "fraction", "0.01");
+    QCommandLineOption stateOption("state-fraction", "Fraction of state vector records.", "fraction", "0.5");
+    QCommandLineOption seedOption("seed", "Random seed.", "seed", "1");
+    parser.addOption(serverOption);
+    parser.addOption(objectsOption);
+    parser.addOption(rateOption);
+    parser.addOption(durationOption);
+    parser.addOption(removeOption);
+    parser.addOption(stateOption);
+    parser.addOption(seedOption);
+    parser.process(app);
+
+    const double rate = parser.value(rateOption).toDouble();
+    const double duration = parser.value(durationOption).toDouble();
+    CatalogFeedGenerator generator(qMax(1, parser.value(objectsOption).toInt()),
+                                   parser.value(removeOption).toDouble(),
+                                   parser.value(stateOption).toDouble(),
+                                   parser.value(seedOption).toUInt());
+
+    QLocalSocket socket;
+    socket.connectToServer(parser.value(serverOption), QIODevice::WriteOnly);
+    if (!socket.waitForConnected(5000)) {
+        qCritical() << "Failed to connect to" << parser.value(serverOption) << socket.errorString();
+        return 1;
+    }
+
+    QTextStream out(stdout);
+    QElapsedTimer timer;
+    timer.start();
+    qint64 sent = 0;
+    qint64 lastReport = 0;
+    qint64 sentAtLastReport = 0;
+    QByteArray chunk;
+
+    // Блокирующая запись без цикла событий: пакет строк, затем ожидание отправки
+    while (duration <= 0.0 || timer.elapsed() < duration * 1000.0) {
+        const double elapsed = timer.nsecsElapsed() / 1e9;
+        qint64 due = rate > 0.0 ? qint64(rate * elapsed) - sent : MAX_CHUNK_LINES;
+        if (due <= 0) {
+            QThread::msleep(1);
+            continue;
+        }
+        due = qMin<qint64>(due, MAX_CHUNK_LINES);
+
+        const double epoch = QDateTime::currentMSecsSinceEpoch() / 1000.0;
+        chunk.clear();
+        for (qint64 i = 0; i < due; ++i)
+            generator.appendLine(chunk, epoch);
+        socket.write(chunk);
+        if (!socket.waitForBytesWritten(5000) || socket.state() != QLocalSocket::ConnectedState) {
+            qCritical() << "Feed connection lost:" << socket.errorString();
+            return 1;
+        }
+        sent += due;
+
+        if (timer.elapsed() - lastReport >= 1000) {
+            out << "sent " << sent << " updates, "
+                << qRound64((sent - sentAtLastReport) * 1000.0 / (timer.elapsed() - lastReport)) << " updates/s\n";
+            out.flush();
+            lastReport = timer.elapsed();
+            sentAtLastReport = sent;
+        }
+    }
+
+    socket.disconnectFromServer();
+    if (socket.state() != QLocalSocket::UnconnectedState)
+        socket.waitForDisconnected(5000);
+    out << "sent " << sent << " updates in " << timer.elapsed() / 1000.0 << " s\n";
+    return 0;
+}
@@ -0,0 +1,72 @@
+#!/usr/bin/env python3
+# compare_bench.py
+# Сравнение двух прогонов earth3d_microbench (--benchmark_out_format=json).
+#
+# Пример:
+#   earth3d_microbench --benchmark_repetitions=5 --benchmark_out=base.json --benchmark_out_format=json
+#   earth3d_microbench --benchmark_repetitions=5 --benchmark_out=new.json --benchmark_out_format=json
+#   compare_bench.py base.json new.json --fail-above 0.05
+
+import argparse
+import json
+import sys
+
+
+def load(path, metric):
+    with open(path) as f:
+        data = json.load(f)
+
+    # При повторах берем медиану, иначе единственный замер
+    results = {}
+    medians = {}
+    for bench in data.get("benchmarks", []):
+        if bench.get("error_occurred"):
+            continue
+        name = bench.get("run_name", bench["name"])
+        if bench.get("run_type") == "aggregate":
+            if bench.get("aggregate_name") == "median":
+                medians[name] = bench[metric]
+        else:
+            results.setdefault(name, bench[metric])
+    results.update(medians)
+    return results, data.get("context", {})
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Compare two earth3d_microbench JSON results.")
+    parser.add_argument("baseline")
+    parser.add_argument("contender")
+    parser.add_argument("--metric", choices=["real_time", "cpu_time"], default="real_time")
+    parser.add_argument("--fail-above", type=float, default=None, metavar="FRACTION",
+                        help="exit with status 1 if any benchmark is slower by more than FRACTION")
+    args = parser.parse_args()
+
+    base, base_context = load(args.baseline, args.metric)
+    new, new_context = load(args.contender, args.metric)
+    if base_context.get("host_name") != new_context.get("host_name"):
+        print("warning: results come from different hosts", file=sys.stderr)
+
+    names = [name for name in base if name in new]
+    width = max([len(name) for name in names] + [9])
+    print(f"{'benchmark':<{width}}  {'baseline':>12}  {'contender':>12}  {'speedup':>8}")
+
+    regressions = []
+    for name in names:
+        speedup = base[name] / new[name] if new[name] > 0 else float("inf")
+        print(f"{name:<{width}}  {base[name]:>12.3f}  {new[name]:>12.3f}  {speedup:>7.2f}x")
+        if args.fail_above is not None and new[name] > base[name] * (1.0 + args.fail_above):
+            regressions.append(name)
+
+    for name in sorted(set(base) ^ set(new)):
+        print(f"{name:<{width}}  only in {'baseline' if name in base else 'contender'}")
+
+    if regressions:
+        print(f"\n{len(regressions)} regression(s) above {args.fail_above:.0%}:", file=sys.stderr)
+        for name in regressions:
+            print(f"  {name}", file=sys.stderr)
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
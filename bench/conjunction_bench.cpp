@@ -0,0 +1,107 @@
+// conjunction_bench.cpp
+// Поиск сближений по синтетическому каталогу: время, пары в секунду и число
+// найденных сближений. Пары считаются как N(N-1)/2 на каждый шаг по времени —
+// столько проверял бы перебор без пространственного хеша.
+//
+// Пример: conjunction_bench --objects 30000 --hours 24 --threshold 5
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QRandomGenerator>
+#include <QTextStream>
+#include <QThreadPool>
+#include <QVector>
+#include <algorithm>
+#include <cmath>
+#include "conjunction_screener.h"
+
+namespace {
+
+constexpr double EARTH_RADIUS = 6371000.0;
+
+// Как в реальном каталоге, большинство объектов на низких орбитах 400–1500 км,
+// остальные — средние и высокоэллиптические
+QVector<OrbitalElements> makeCatalog(int count, double epoch, quint32 seed)
+{
+    QRandomGenerator random(seed);
+    QVector<OrbitalElements> catalog(count);
+    for (int i = 0; i < count; ++i) {
+        OrbitalElements& elements = catalog[i];
+        elements.catalogNumber = i + 1;
+        elements.epoch = epoch - random.generateDouble() * 3.0 * 86400.0;
+        const double kind = random.generateDouble();
+        double semiMajorAxis = 0.0;
+        if (kind < 0.85) {
+            elements.eccentricity = random.generateDouble() * 0.01;
+            semiMajorAxis = EARTH_RADIUS + 400000.0 + random.generateDouble() * 1100000.0;
+        } else if (kind < 0.95) {
+            elements.eccentricity = random.generateDouble() * 0.05;
+            semiMajorAxis = EARTH_RADIUS + 2000000.0 + random.generateDouble() * 20000000.0;
+        } else {
+            elements.eccentricity = 0.6 + random.generateDouble() * 0.15;
+            semiMajorAxis = (EARTH_RADIUS + 300000.0) / (1.0 - elements.eccentricity);
+        }
+        elements.meanMotion = std::sqrt(OrbitalElements::EARTH_MU / std::pow(semiMajorAxis, 3.0));
+        elements.inclination = random.generateDouble() * M_PI;
+        elements.raan = random.generateDouble() * 2.0 * M_PI;
+        elements.argPerigee = random.generateDouble() * 2.0 * M_PI;
+        elements.meanAnomaly = random.generateDouble() * 2.0 * M_PI;
+    }
+    return catalog;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Conjunction screening over a synthetic catalog.");
+    parser.addHelpOption();
+    QCommandLineOption objectsOption("objects", "Catalog size.", "n", "30000");
+    QCommandLineOption hoursOption("hours", "Screening window.", "hours", "24");
+    QCommandLineOption stepOption("step", "Screening time step.", "s", "60");
+    QCommandLineOption thresholdOption("threshold", "Miss distance threshold.", "km", "5");
+    QCommandLineOption threadsOption("threads", "Worker threads (0 = all cores).", "n", "0");
+    QCommandLineOption seedOption("seed", "Catalog random seed.", "seed", "1");
+    parser.addOptions({objectsOption, hoursOption, stepOption, thresholdOption, threadsOption, seedOption});
+    parser.process(app);
+
+    const int threads = parser.value(threadsOption).toInt();
+    if (threads > 0)
+        QThreadPool::globalInstance()->setMaxThreadCount(threads);
+
+    const double now = 1.7e9;
+    const QVector<OrbitalElements> catalog =
+        makeCatalog(std::max(2, parser.value(objectsOption).toInt()), now, parser.value(seedOption).toUInt());
+
+    ConjunctionScreener::Settings settings;
+    settings.duration = parser.value(hoursOption).toDouble() * 3600.0;
+    settings.timeStep = parser.value(stepOption).toDouble();
+    settings.threshold = parser.value(thresholdOption).toDouble() * 1000.0;
+    const ConjunctionScreeningResult result = ConjunctionScreener::screen(catalog, now, settings);
+
+    QTextStream out(stdout);
+    out << "objects: " << result.objects << ", threads: " << QThreadPool::globalInstance()->maxThreadCount()
+        << ", window: " << settings.duration / 3600.0 << " h, step: " << settings.timeStep
+        << " s, threshold: " << settings.threshold / 1000.0 << " km\n";
+    out << "steps: " << result.steps << "\n";
+    out << "pairs_screened: " << result.pairsScreened << "\n";
+    out << "candidate_pairs: " << result.candidatePairs << "\n";
+    out << "conjunctions: " << result.conjunctions.size() << "\n";
+    out << "elapsed_ms: " << QString::number(result.elapsedMs, 'f', 1) << "\n";
+    out << "pairs_per_second: " << QString::number(result.pairsPerSecond(), 'e', 3) << "\n";
+
+    // Самые близкие сближения
+    QVector<Conjunction> closest = result.conjunctions;
+    std::sort(closest.begin(), closest.end(),
+              [](const Conjunction& a, const Conjunction& b) { return a.missDistance < b.missDistance; });
+    for (int i = 0; i < std::min(5, int(closest.size())); ++i) {
+        const Conjunction& conjunction = closest[i];
+        out << "  " << conjunction.firstId << " - " << conjunction.secondId << "  t+"
+            << QString::number(conjunction.time - now, 'f', 1) << " s  miss "
+            << QString::number(conjunction.missDistance, 'f', 1) << " m  "
+            << QString::number(conjunction.relativeSpeed, 'f', 0) << " m/s\n";
+    }
+    return 0;
+}
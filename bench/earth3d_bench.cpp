@@ -0,0 +1,517 @@
+// earth3d_bench.cpp
+// Воспроизводимый замер полного конвейера рендеринга без окна:
+// QOffscreenSurface + FBO, сценарий камеры и синтетический каталог.
+// Работает и на программном Mesa llvmpipe.
+//
+// Пример: earth3d_bench --satellites 1000,10000,100000 --frames 600 --path tour --output bench.json
+//
+// С --replay вместо синтетического сценария воспроизводится журнал сессии
+// (earth3d --record): каталог, камера и шаги часов пользователя, без пауз.
+#include <QGuiApplication>
+#include <QCommandLineParser>
+#include <QOffscreenSurface>
+#include <QOpenGLContext>
+#include <QOpenGLExtraFunctions>
+#include <QOpenGLFramebufferObject>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QFile>
+#include <QRandomGenerator>
+#include <QTextStream>
+#include <QtMath>
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include "camera.h"
+#include "scene_renderer.h"
+#include "satellite_catalog.h"
+#include "session_replay.h"
+
+#ifdef Q_OS_WIN
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace {
+
+constexpr float EARTH_RADIUS = 6371000.0f;
+constexpr double EARTH_MU = 3.986004418e14; // м^3/с^2
+
+struct BenchConfig {
+    int frames = 600;
+    int warmupFrames = 30;
+    QSize size{1280, 720};
+    int samples = 4;
+    QString path = "tour";
+    double timeStep = 60.0; // секунд симуляции на кадр
+    quint32 seed = 1;
+    bool atmosphereScattering = false;
+    SatelliteDrawMode satelliteMode = SatelliteDrawMode::Auto;
+    int vramBudget = 0; // МБ, 0 — без ограничения
+    bool tileStreaming = false;
+};
+
+// Круговая орбита со случайными наклонением, долготой узла и фазой
+struct SyntheticOrbit {
+    float radius;
+    float inclination;
+    float raan;
+    float phase;
+    float meanMotion; // рад/с
+
+    QVector3D position(double time) const {
+        const double u = phase + meanMotion * time;
+        const double xOrbit = radius * std::cos(u);
+        const double yOrbit = radius * std::sin(u);
+
+        // Поворот на наклонение вокруг X, затем на долготу узла вокруг Z (ECI)
+        const double x1 = xOrbit;
+        const double y1 = yOrbit * std::cos(inclination);
+        const double z1 = yOrbit * std::sin(inclination);
+        const double x = x1 * std::cos(raan) - y1 * std::sin(raan);
+        const double y = x1 * std::sin(raan) + y1 * std::cos(raan);
+
+        // ECI -> сцена: ось Y сцены направлена на полюс
+        return QVector3D(float(x), float(z1), float(-y));
+    }
+};
+
+QVector<SyntheticOrbit> makeCatalog(int count, quint32 seed)
+{
+    QRandomGenerator random(seed);
+    QVector<SyntheticOrbit> catalog;
+    catalog.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        // Высоты от LEO до MEO, как в реальных каталогах большинство на низких орбитах
+        const double altitudeFraction = std::pow(random.generateDouble(), 3.0);
+        const float radius = EARTH_RADIUS * float(1.05 + altitudeFraction * 2.0);
+        catalog.append({
+            radius,
+            float(random.bounded(M_PI)),
+            float(random.bounded(2.0 * M_PI)),
+            float(random.bounded(2.0 * M_PI)),
+            float(std::sqrt(EARTH_MU / (double(radius) * radius * radius)))
+        });
+    }
+    return catalog;
+}
+
+// Сценарии камеры: orbit — облет по экватору, zoom — приближение и отдаление,
+// tour — облет с изменением широты и масштаба
+void applyCameraPath(Camera& camera, const QString& path, int frame, int frameCount)
+{
+    const float t = float(frame) / std::max(1, frameCount);
+    const float step = 2.0f * float(M_PI) / std::max(1, frameCount);
+
+    float targetZoom = EARTH_RADIUS * 3.0f;
+    if (path == "orbit") {
+        camera.rotate(step, 0.0f);
+    } else if (path == "zoom") {
+        targetZoom = EARTH_RADIUS * (1.6f + 4.0f * 0.5f * (1.0f + std::cos(2.0f * float(M_PI) * t)));
+    } else {
+        camera.rotate(step, 0.6f * step * std::cos(4.0f * float(M_PI) * t));
+        targetZoom = EARTH_RADIUS * (2.0f + 2.0f * 0.5f * (1.0f + std::cos(2.0f * float(M_PI) * t)));
+    }
+    camera.zoom(targetZoom / camera.getZoom());
+}
+
+// Пиковый RSS процесса с его запуска: в прогоне это максимум по нему
+// и всем предыдущим прогонам, а не расход самого прогона. Для отдельного
+// замера каждый размер сцены запускается своим процессом
+qint64 peakRssKb()
+{
+#ifdef Q_OS_WIN
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return qint64(counters.PeakWorkingSetSize / 1024);
+    return -1;
+#else
+    rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return -1;
+#ifdef Q_OS_MACOS
+    return usage.ru_maxrss / 1024; // на macOS — байты
+#else
+    return usage.ru_maxrss;
+#endif
+#endif
+}
+
+// Видеопамять текстурных слоев в МБ: всего и по слоям
+QJsonObject gpuMemory(const GpuMemoryBudget& budget)
+{
+    constexpr double MB = 1024.0 * 1024.0;
+    QJsonObject layers;
+    for (const GpuMemoryBudget::LayerUsage& layer : budget.layers())
+        layers[layer.name] = layer.bytes() / MB;
+    return QJsonObject{
+        {"limit_mb", budget.limit() / MB},
+        {"used_mb", budget.used() / MB},
+        {"layers", layers}
+    };
+}
+
+QJsonObject percentiles(QVector<double> values)
+{
+    std::sort(values.begin(), values.end());
+    auto at = [&values](double fraction) {
+        if (values.isEmpty())
+            return 0.0;
+        int index = int(std::ceil(fraction * values.size())) - 1;
+        return values[std::clamp(index, 0, int(values.size()) - 1)];
+    };
+    double sum = 0.0;
+    for (double value : values)
+        sum += value;
+
+    return QJsonObject{
+        {"mean", values.isEmpty() ? 0.0 : sum / values.size()},
+        {"p50", at(0.50)},
+        {"p90", at(0.90)},
+        {"p99", at(0.99)},
+        {"max", values.isEmpty() ? 0.0 : values.last()}
+    };
+}
+
+// processStartupMs — время от старта процесса до первого готового кадра,
+// заполняется при первом прогоне
+QJsonObject runBenchmark(const BenchConfig& config, int satelliteCount, QOpenGLContext& context,
+                         const QElapsedTimer& processTimer, double& processStartupMs)
+{
+    QOpenGLExtraFunctions* f = context.extraFunctions();
+
+    QElapsedTimer setupTimer;
+    setupTimer.start();
+
+    const QVector<SyntheticOrbit> catalog = makeCatalog(satelliteCount, config.seed);
+    SatelliteStore satellites;
+    satellites.reserve(catalog.size());
+    for (int i = 0; i < catalog.size(); ++i)
+        satellites.insert(i, catalog[i].position(0.0));
+
+    QOpenGLFramebufferObjectFormat format;
+    format.setAttachment(QOpenGLFramebufferObject::CombinedDepthStencil);
+    format.setSamples(config.samples);
+    QOpenGLFramebufferObject fbo(config.size, format);
+
+    auto scene = std::make_unique<SceneRenderer>(EARTH_RADIUS);
+    SceneOptions options;
+    options.atmosphereScattering = config.atmosphereScattering;
+    options.satelliteDrawMode = config.satelliteMode;
+    options.gpuMemoryBudget = config.vramBudget;
+    options.tileStreaming = config.tileStreaming;
+    scene->initialize(options);
+
+    Camera camera(EARTH_RADIUS);
+    QMatrix4x4 projection;
+    projection.perspective(45.0f, float(config.size.width()) / config.size.height(),
+                           EARTH_RADIUS * 0.1f, EARTH_RADIUS * 100.0f);
+    const QMatrix4x4 model;
+
+    constexpr int TRAJECTORY_POINTS = 128;
+    QVector<QVector3D> pastTrajectory(TRAJECTORY_POINTS);
+    QVector<QVector3D> futureTrajectory(TRAJECTORY_POINTS);
+    scene->setTrajectoryVisible(true);
+
+    QVector<double> frameTimes;
+    QVector<double> propagationTimes;
+    QVector<double> missingTiles;
+    qint64 satelliteVertices = 0;
+    frameTimes.reserve(config.frames);
+    propagationTimes.reserve(config.frames);
+    missingTiles.reserve(config.frames);
+    double startupMs = 0.0;
+
+    const int totalFrames = config.warmupFrames + config.frames;
+    for (int frame = 0; frame < totalFrames; ++frame) {
+        QElapsedTimer frameTimer;
+        frameTimer.start();
+
+        const double time = frame * config.timeStep;
+        for (int slot = 0; slot < satellites.size(); ++slot)
+            satellites.setPosition(slot, catalog[satellites.id(slot)].position(time));
+        const double propagationMs = frameTimer.nsecsElapsed() / 1.0e6;
+
+        applyCameraPath(camera, config.path, frame, totalFrames);
+
+        fbo.bind();
+        f->glViewport(0, 0, config.size.width(), config.size.height());
+        scene->update(float(config.timeStep));
+        scene->setSatellites(satellites);
+        if (!catalog.isEmpty()) {
+            // Траектория первого спутника: полвитка назад и полвитка вперед
+            const SyntheticOrbit& tracked = catalog.first();
+            const double halfPeriod = M_PI / tracked.meanMotion;
+            for (int i = 0; i < TRAJECTORY_POINTS; ++i) {
+                const double offset = halfPeriod * i / (TRAJECTORY_POINTS - 1);
+                pastTrajectory[i] = tracked.position(time - halfPeriod + offset);
+                futureTrajectory[i] = tracked.position(time + offset);
+            }
+            scene->setTrajectories(pastTrajectory, futureTrajectory);
+        }
+        scene->render(projection, camera.getViewMatrix(), model);
+        satelliteVertices = scene->satelliteVerticesPerFrame();
+        fbo.release();
+        f->glFinish(); // кадр считается готовым, когда GPU его дорисовал
+
+        const double frameMs = frameTimer.nsecsElapsed() / 1.0e6;
+        if (frame == 0) {
+            startupMs = setupTimer.nsecsElapsed() / 1.0e6;
+            if (processStartupMs == 0.0)
+                processStartupMs = processTimer.nsecsElapsed() / 1.0e6;
+        }
+        if (frame >= config.warmupFrames) {
+            frameTimes.append(frameMs);
+            propagationTimes.append(propagationMs);
+            missingTiles.append(scene->missingTileFraction());
+        }
+    }
+
+    const QJsonObject memory = gpuMemory(scene->gpuMemory());
+    scene.reset();
+
+    // Пропускная способность по вершинам спутников: меш против импосторов
+    const QJsonObject frameStats = percentiles(frameTimes);
+    const double meanFrameS = frameStats["mean"].toDouble() / 1000.0;
+
+    return QJsonObject{
+        {"satellites", satelliteCount},
+        {"frames", config.frames},
+        {"startup_ms", startupMs},
+        {"frame_ms", frameStats},
+        {"propagation_ms", percentiles(propagationTimes)},
+        {"tiles_missing", percentiles(missingTiles)},
+        {"gpu_memory", memory},
+        {"satellite_vertices", satelliteVertices},
+        {"satellite_vertices_per_s", meanFrameS > 0.0 ? satelliteVertices / meanFrameS : 0.0},
+        {"process_peak_rss_kb", peakRssKb()}
+    };
+}
+
+
+// Воспроизведение журнала сессии: все записанные кадры подряд, как можно быстрее
+QJsonObject runReplay(const BenchConfig& config, const QString& path, QOpenGLContext& context)
+{
+    QOpenGLExtraFunctions* f = context.extraFunctions();
+
+    SessionReplay replay;
+    if (!replay.open(path))
+        return QJsonObject{{"replay", path}, {"error", replay.errorString()}};
+    replay.setPacing(SessionReplay::Pacing::AsFastAsPossible);
+    const double epoch = replay.header().epoch.toMSecsSinceEpoch() / 1000.0;
+
+    QOpenGLFramebufferObjectFormat format;
+    format.setAttachment(QOpenGLFramebufferObject::CombinedDepthStencil);
+    format.setSamples(config.samples);
+    QOpenGLFramebufferObject fbo(config.size, format);
+
+    auto scene = std::make_unique<SceneRenderer>(EARTH_RADIUS);
+    SceneOptions options;
+    options.atmosphereScattering = config.atmosphereScattering;
+    options.satelliteDrawMode = config.satelliteMode;
+    options.gpuMemoryBudget = config.vramBudget;
+    options.tileStreaming = config.tileStreaming;
+    scene->initialize(options);
+
+    // То же начальное состояние, что у EarthWidget
+    Camera camera(EARTH_RADIUS);
+    QMatrix4x4 projection;
+    projection.perspective(45.0f, float(config.size.width()) / config.size.height(),
+                           EARTH_RADIUS * 0.1f, EARTH_RADIUS * 100.0f);
+    const QMatrix4x4 model;
+
+    SatelliteCatalog catalog;
+    SatelliteStore satellites;
+    int selectedId = -1;
+
+    QObject::connect(&replay, &SessionReplay::cameraRotated,
+                     [&camera](float deltaTheta, float deltaPhi) { camera.rotate(deltaTheta, deltaPhi); });
+    QObject::connect(&replay, &SessionReplay::cameraZoomed, [&camera](float factor) { camera.zoom(factor); });
+    QObject::connect(&replay, &SessionReplay::satelliteSelected, [&](int id) {
+        const int previous = satellites.slotOf(selectedId);
+        if (previous != -1)
+            satellites.setSelected(previous, false);
+        selectedId = id;
+        const int slot = satellites.slotOf(id);
+        if (slot != -1)
+            satellites.setSelected(slot, true);
+    });
+    QObject::connect(&replay, &SessionReplay::catalogUpdates, [&](const QVector<CatalogUpdate>& updates) {
+        for (const CatalogUpdate& update : updates) {
+            const int id = update.elements.catalogNumber;
+            if (update.type == CatalogUpdate::Type::Remove) {
+                catalog.remove(id);
+                satellites.remove(id);
+            } else {
+                catalog.upsert(update.elements);
+                satellites.insert(id, QVector3D());
+            }
+        }
+    });
+
+    QVector<double> frameTimes;
+    QVector<double> propagationTimes;
+    int maxSatellites = 0;
+    double simulationTime = replay.header().simulationTime;
+    double realDelta = 0.0;
+    double previousTime = simulationTime;
+    while (true) {
+        QElapsedTimer frameTimer;
+        frameTimer.start();
+
+        if (!replay.advanceFrame(realDelta, simulationTime))
+            break;
+
+        // Демонстрационные спутники здесь не воспроизводятся, только каталог
+        catalog.propagate(epoch + simulationTime);
+        const QVector<int>& ids = catalog.ids();
+        const QVector<QVector3D>& positions = catalog.positions();
+        for (int i = 0; i < ids.size(); ++i)
+            satellites.setPosition(satellites.slotOf(ids[i]), positions[i]);
+        const double propagationMs = frameTimer.nsecsElapsed() / 1.0e6;
+
+        fbo.bind();
+        f->glViewport(0, 0, config.size.width(), config.size.height());
+        scene->update(float(simulationTime - previousTime));
+        scene->setSatellites(satellites);
+        scene->render(projection, camera.getViewMatrix(), model);
+        fbo.release();
+        f->glFinish();
+        previousTime = simulationTime;
+
+        frameTimes.append(frameTimer.nsecsElapsed() / 1.0e6);
+        propagationTimes.append(propagationMs);
+        maxSatellites = std::max(maxSatellites, int(satellites.size()));
+    }
+
+    scene.reset();
+
+    return QJsonObject{
+        {"replay", path},
+        {"frames", frameTimes.size()},
+        {"max_satellites", maxSatellites},
+        {"frame_ms", percentiles(frameTimes)},
+        {"propagation_ms", percentiles(propagationTimes)},
+        {"process_peak_rss_kb", peakRssKb()}
+    };
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+    QElapsedTimer processTimer;
+    processTimer.start();
+
+    // Без окна: платформа offscreen, если не задана явно
+    if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    QSurfaceFormat surfaceFormat;
+    surfaceFormat.setVersion(3, 3);
+    surfaceFormat.setProfile(QSurfaceFormat::CoreProfile);
+    surfaceFormat.setDepthBufferSize(24);
+    surfaceFormat.setStencilBufferSize(8);
+    QSurfaceFormat::setDefaultFormat(surfaceFormat);
+
+    QGuiApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Offscreen rendering benchmark for earth3d.");
+    parser.addHelpOption();
+    QCommandLineOption satellitesOption("satellites", "Comma-separated catalog sizes.", "counts", "1000");
+    QCommandLineOption framesOption("frames", "Measured frames per run.", "n", "600");
+    QCommandLineOption warmupOption("warmup", "Frames rendered before measuring.", "n", "30");
+    QCommandLineOption sizeOption("size", "Framebuffer size WxH.", "size", "1280x720");
+    QCommandLineOption samplesOption("samples", "MSAA samples.", "n", "4");
+    QCommandLineOption pathOption("path", "Camera path: orbit, zoom or tour.", "path", "tour");
+    QCommandLineOption timeStepOption("time-step", "Simulation seconds per frame.", "seconds", "60");
+    QCommandLineOption seedOption("seed", "Catalog random seed.", "seed", "1");
+    QCommandLineOption scatteringOption("atmosphere-scattering", "Use precomputed atmospheric scattering.");
+    QCommandLineOption outputOption("output", "Write JSON results to a file instead of stdout.", "file");
+    QCommandLineOption satelliteModeOption("satellite-mode", "Satellite drawing: auto, mesh or impostor.", "mode", "auto");
+    QCommandLineOption replayOption("replay", "Replay a session log recorded with earth3d --record.", "file");
+    QCommandLineOption vramBudgetOption("vram-budget", "Video memory budget for texture layers (0 = unlimited).", "MB", "0");
+    QCommandLineOption tileStreamingOption("tile-streaming", "Stream Earth tiles ahead of camera motion.");
+    parser.addOptions({satellitesOption, framesOption, warmupOption, sizeOption, samplesOption,
+                       pathOption, timeStepOption, seedOption, scatteringOption, outputOption,
+                       satelliteModeOption, replayOption, vramBudgetOption, tileStreamingOption});
+    parser.process(app);
+
+    BenchConfig config;
+    config.frames = std::max(1, parser.value(framesOption).toInt());
+    config.warmupFrames = std::max(0, parser.value(warmupOption).toInt());
+    const QStringList size = parser.value(sizeOption).split('x');
+    if (size.size() == 2)
+        config.size = QSize(size[0].toInt(), size[1].toInt());
+    config.samples = parser.value(samplesOption).toInt();
+    config.path = parser.value(pathOption);
+    config.timeStep = parser.value(timeStepOption).toDouble();
+    config.seed = parser.value(seedOption).toUInt();
+    config.atmosphereScattering = parser.isSet(scatteringOption);
+    config.vramBudget = std::max(0, parser.value(vramBudgetOption).toInt());
+    config.tileStreaming = parser.isSet(tileStreamingOption);
+    const QString satelliteMode = parser.value(satelliteModeOption);
+    if (satelliteMode == "mesh")
+        config.satelliteMode = SatelliteDrawMode::Mesh;
+    else if (satelliteMode == "impostor")
+        config.satelliteMode = SatelliteDrawMode::Impostor;
+
+    QOpenGLContext context;
+    if (!context.create()) {
+        qCritical() << "Failed to create OpenGL context";
+        return 1;
+    }
+    QOffscreenSurface surface;
+    surface.setFormat(context.format());
+    surface.create();
+    if (!context.makeCurrent(&surface)) {
+        qCritical() << "Failed to make OpenGL context current";
+        return 1;
+    }
+
+    QJsonArray runs;
+    double processStartupMs = 0.0;
+    if (parser.isSet(replayOption)) {
+        runs.append(runReplay(config, parser.value(replayOption), context));
+    } else {
+        for (const QString& count : parser.value(satellitesOption).split(',', Qt::SkipEmptyParts))
+            runs.append(runBenchmark(config, count.toInt(), context, processTimer, processStartupMs));
+    }
+
+    QOpenGLFunctions* f = context.functions();
+    QJsonObject result{
+        {"gl_renderer", QString::fromLatin1(reinterpret_cast<const char*>(f->glGetString(GL_RENDERER)))},
+        {"gl_version", QString::fromLatin1(reinterpret_cast<const char*>(f->glGetString(GL_VERSION)))},
+        {"size", QString("%1x%2").arg(config.size.width()).arg(config.size.height())},
+        {"samples", config.samples},
+        {"path", config.path},
+        {"warmup_frames", config.warmupFrames},
+        {"time_step_s", config.timeStep},
+        {"atmosphere_scattering", config.atmosphereScattering},
+        {"satellite_mode", parser.value(satelliteModeOption)},
+        {"vram_budget_mb", config.vramBudget},
+        {"tile_streaming", config.tileStreaming},
+        {"process_startup_ms", processStartupMs},
+        {"runs", runs},
+        {"process_peak_rss_kb", peakRssKb()}
+    };
+    context.doneCurrent();
+
+    const QByteArray json = QJsonDocument(result).toJson(QJsonDocument::Indented);
+    if (parser.isSet(outputOption)) {
+        QFile file(parser.value(outputOption));
+        if (!file.open(QIODevice::WriteOnly)) {
+            qCritical() << "Failed to write" << parser.value(outputOption);
+            return 1;
+        }
+        file.write(json);
+    } else {
+        QTextStream(stdout) << json;
+    }
+    return 0;
+}
@@ -0,0 +1,448 @@
+// earth3d_microbench.cpp
+// Микробенчмарки горячих путей на CPU (Google Benchmark) для отслеживания регрессий.
+// Сравнение с базовой версией: bench/compare_bench.py base.json new.json
+//
+// Пример: earth3d_microbench --benchmark_out=new.json --benchmark_out_format=json
+#include <benchmark/benchmark.h>
+#include <QGuiApplication>
+#include <QDebug>
+#include <QHash>
+#include <QImage>
+#include <QOffscreenSurface>
+#include <QOpenGLContext>
+#include <QRandomGenerator>
+#include <QTemporaryDir>
+#include <QtMath>
+#include <memory>
+#include "earth_renderer.h"
+#include "eclipse_model.h"
+#include "ephemeris_cache.h"
+#include "pass_predictor.h"
+#include "satellite_catalog.h"
+#include "satellite_data.h"
+#include "satellite_picking.h"
+#include "satellite_store.h"
+#include "solar_ephemeris.h"
+#include "tile_texture_manager.h"
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+namespace {
+
+constexpr float EARTH_RADIUS = 6371000.0f;
+constexpr float ORBIT_RADIUS = EARTH_RADIUS * 1.5f;
+
+// Синтетические текстуры: генерируются один раз, вне замера
+QString syntheticTexture(int width)
+{
+    static QTemporaryDir directory;
+    static QHash<int, QString> paths;
+
+    auto it = paths.constFind(width);
+    if (it != paths.constEnd())
+        return *it;
+
+    QImage image(width, width / 2, QImage::Format_RGB32);
+    QRandomGenerator random(width);
+    for (int y = 0; y < image.height(); ++y) {
+        QRgb* line = reinterpret_cast<QRgb*>(image.scanLine(y));
+        for (int x = 0; x < image.width(); ++x)
+            line[x] = qRgb(x * 255 / image.width(), y * 255 / image.height(), random.bounded(256));
+    }
+    const QString path = directory.filePath(QString("earth_%1.jpg").arg(width));
+    image.save(path);
+    return *paths.insert(width, path);
+}
+
+// Камера над единичной сферой, как в TileTextureManager::isTileVisible
+const QVector3D UNIT_SPHERE_EYE(0.0f, 1.0f, 3.0f);
+
+QMatrix4x4 unitSphereViewProjection()
+{
+    QMatrix4x4 projection;
+    projection.perspective(45.0f, 16.0f / 9.0f, 0.1f, 100.0f);
+    QMatrix4x4 view;
+    view.lookAt(UNIT_SPHERE_EYE, QVector3D(0.0f, 0.0f, 0.0f), QVector3D(0.0f, 1.0f, 0.0f));
+    return projection * view;
+}
+
+QVector3D randomSatellitePosition(QRandomGenerator& random)
+{
+    QVector3D direction(float(random.generateDouble() * 2.0 - 1.0),
+                        float(random.generateDouble() * 2.0 - 1.0),
+                        float(random.generateDouble() * 2.0 - 1.0));
+    return direction.normalized() * EARTH_RADIUS * float(1.05 + random.generateDouble());
+}
+
+SatelliteStore makeSatellites(int count)
+{
+    QRandomGenerator random(count);
+    SatelliteStore satellites;
+    satellites.reserve(count);
+    for (int id = 0; id < count; ++id)
+        satellites.insert(id, randomSatellitePosition(random));
+    return satellites;
+}
+
+// Прежняя запись спутника в узле QMap — для сравнения расхода памяти
+struct LegacySatellite {
+    int id = -1;
+    QVector3D position;
+    QString info;
+    QVector<QVector3D> trajectory;
+    QVector<QVector3D> futureTrajectory;
+    float angle = 0.0f;
+    float speed = 0.0f;
+    bool isSelected = false;
+};
+
+// Занятая куча процесса; 0, если аллокатор не дает статистики
+qint64 heapBytesInUse()
+{
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    return qint64(mallinfo2().uordblks);
+#else
+    return 0;
+#endif
+}
+
+void BM_TileTextureManagerInitialize(benchmark::State& state)
+{
+    const QString path = syntheticTexture(int(state.range(0)));
+    const int tiles = int(state.range(1));
+
+    for (auto _ : state) {
+        TileTextureManager manager(path, tiles, tiles);
+        manager.initialize();
+        benchmark::DoNotOptimize(manager.getAllTileUVCoords().constData());
+    }
+    state.counters["tiles"] = tiles * tiles;
+}
+BENCHMARK(BM_TileTextureManagerInitialize)
+    ->ArgNames({"width", "tiles"})
+    ->Args({2048, 32})->Args({4096, 32})->Args({4096, 128})
+    ->Unit(benchmark::kMillisecond);
+
+void BM_UpdateVisibleTiles(benchmark::State& state)
+{
+    const int tiles = int(state.range(0));
+    TileTextureManager manager(syntheticTexture(1024), tiles, tiles);
+    manager.initialize();
+
+    // Видимые тайлы вырезаются в фоне пакетами; к замеру загружено все,
+    // что помещается в пул: новых пакетов больше не заказывается
+    const QMatrix4x4 viewProjection = unitSphereViewProjection();
+    for (;;) {
+        manager.updateVisibleTiles(viewProjection, UNIT_SPHERE_EYE);
+        if (!manager.isLoading())
+            break;
+        manager.waitForTiles();
+    }
+
+    for (auto _ : state)
+        manager.updateVisibleTiles(viewProjection, UNIT_SPHERE_EYE);
+    state.SetItemsProcessed(state.iterations() * tiles * tiles);
+}
+BENCHMARK(BM_UpdateVisibleTiles)->ArgName("tiles")->Arg(16)->Arg(32)->Arg(64)->Arg(128)
+    ->Unit(benchmark::kMicrosecond);
+
+void BM_IsTileVisible(benchmark::State& state)
+{
+    const int tiles = int(state.range(0));
+    const QMatrix4x4 viewProjection = unitSphereViewProjection();
+
+    QVector<QRectF> sphereCoords;
+    for (int ring = 0; ring < tiles; ++ring) {
+        for (int segment = 0; segment < tiles; ++segment) {
+            const float phi = M_PI * ring / tiles;
+            const float theta = 2.0f * M_PI * segment / tiles;
+            sphereCoords.append(QRectF(phi, theta, M_PI / tiles, 2.0f * M_PI / tiles));
+        }
+    }
+
+    for (auto _ : state) {
+        int visible = 0;
+        for (const QRectF& coords : sphereCoords)
+            visible += TileTextureManager::isTileVisible(coords, viewProjection, UNIT_SPHERE_EYE);
+        benchmark::DoNotOptimize(visible);
+    }
+    state.SetItemsProcessed(state.iterations() * sphereCoords.size());
+}
+BENCHMARK(BM_IsTileVisible)->ArgName("tiles")->Arg(16)->Arg(32)->Arg(64)->Arg(128)
+    ->Unit(benchmark::kMicrosecond);
+
+// Заявки на тайлы для текущего вида и трех предсказанных при повороте камеры
+void BM_CollectTileRequests(benchmark::State& state)
+{
+    const int tiles = int(state.range(0));
+    TileTextureManager manager(QString(), tiles, tiles);
+
+    QMatrix4x4 projection;
+    projection.perspective(45.0f, 16.0f / 9.0f, 0.1f, 100.0f);
+    QVector<PredictedView> views;
+    for (int step = 0; step <= 3; ++step) {
+        const float theta = 0.1f * step;
+        const QVector3D eye(3.0f * std::sin(theta), 1.0f, 3.0f * std::cos(theta));
+        QMatrix4x4 view;
+        view.lookAt(eye, QVector3D(0.0f, 0.0f, 0.0f), QVector3D(0.0f, 1.0f, 0.0f));
+        views.append(PredictedView{projection * view, eye, 0.1f * step});
+    }
+
+    int requests = 0;
+    for (auto _ : state) {
+        requests = manager.collectRequests(views).size();
+        benchmark::DoNotOptimize(requests);
+    }
+    state.counters["requests"] = requests;
+    state.SetItemsProcessed(state.iterations() * tiles * tiles);
+}
+BENCHMARK(BM_CollectTileRequests)->ArgName("tiles")->Arg(32)->Arg(128)
+    ->Unit(benchmark::kMicrosecond);
+
+void BM_CreateSphere(benchmark::State& state)
+{
+    const int tiles = int(state.range(0));
+    QVector<QRectF> tileUVs;
+    for (int i = 0; i < tiles * tiles; ++i)
+        tileUVs.append(QRectF(float(i % tiles) / tiles, float(i / tiles) / tiles, 1.0f / tiles, 1.0f / tiles));
+
+    QVector<EarthRenderer::Vertex> vertices;
+    QVector<GLuint> indices;
+    for (auto _ : state) {
+        EarthRenderer::buildSphereMesh(EARTH_RADIUS, tiles, tiles, tileUVs, vertices, indices);
+        benchmark::DoNotOptimize(vertices.constData());
+        benchmark::DoNotOptimize(indices.constData());
+    }
+    state.SetItemsProcessed(state.iterations() * tiles * tiles);
+}
+BENCHMARK(BM_CreateSphere)->ArgName("tiles")->Arg(32)->Arg(64)->Arg(128)->Arg(256)
+    ->Unit(benchmark::kMicrosecond);
+
+void BM_PickSatellite(benchmark::State& state)
+{
+    const SatelliteStore satellites = makeSatellites(int(state.range(0)));
+    const QMatrix4x4 model;
+    const QVector3D rayOrigin(0.0f, 0.0f, EARTH_RADIUS * 3.0f);
+    const QVector3D rayDirection(0.0f, 0.0f, -1.0f);
+
+    for (auto _ : state) {
+        int id = pickClosestSatellite(satellites, model, rayOrigin, rayDirection, EARTH_RADIUS * 0.1f);
+        benchmark::DoNotOptimize(id);
+    }
+    state.SetItemsProcessed(state.iterations() * satellites.size());
+}
+BENCHMARK(BM_PickSatellite)->ArgName("satellites")->Arg(5)->Arg(1000)->Arg(10000)->Arg(100000)
+    ->Unit(benchmark::kMicrosecond);
+
+// Шаг кадра из main.cpp: пропагация и пересчет траекторий каждого спутника
+void BM_CalculateTrajectories(benchmark::State& state)
+{
+    const int count = int(state.range(0));
+    QVector<SatelliteData> satelliteData;
+    for (int id = 0; id < count; ++id)
+        satelliteData.append({float(id * 72 % 360), float(1 + id % 5), id});
+
+    double simulationTime = 0.0;
+    for (auto _ : state) {
+        simulationTime += 1.0 / 60.0;
+        for (auto& sat : satelliteData) {
+            sat.propagate(simulationTime, ORBIT_RADIUS);
+            QVector<QVector3D> trajectory, futureTrajectory;
+            sat.calculateTrajectories(ORBIT_RADIUS, trajectory, futureTrajectory);
+            benchmark::DoNotOptimize(trajectory.constData());
+            benchmark::DoNotOptimize(futureTrajectory.constData());
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_CalculateTrajectories)->ArgName("satellites")->Arg(5)->Arg(100)->Arg(1000)->Arg(10000)
+    ->Unit(benchmark::kMicrosecond);
+
+// Полная передача набора в поток рендеринга делит массивы с виджетом,
+// и следующее изменение положения копирует горячие массивы целиком
+void BM_UpdateSatellitesCopy(benchmark::State& state)
+{
+    SatelliteStore widgetSatellites = makeSatellites(int(state.range(0)));
+    SatelliteStore rendererSatellites;
+
+    for (auto _ : state) {
+        rendererSatellites = widgetSatellites;
+        widgetSatellites.setPosition(0, widgetSatellites.position(0) + QVector3D(1.0f, 0.0f, 0.0f));
+        benchmark::DoNotOptimize(rendererSatellites.position(0));
+    }
+    state.SetItemsProcessed(state.iterations() * widgetSatellites.size());
+}
+BENCHMARK(BM_UpdateSatellitesCopy)->ArgName("satellites")->Arg(5)->Arg(1000)->Arg(10000)->Arg(100000)
+    ->Unit(benchmark::kMicrosecond);
+
+// Синтетический каталог низких и средних орбит с эпохой в начале отсчета
+SatelliteCatalog makeCatalog(int count)
+{
+    QRandomGenerator random(count);
+    QVector<OrbitalElements> elements(count);
+    for (int i = 0; i < count; ++i) {
+        OrbitalElements& e = elements[i];
+        e.catalogNumber = i + 1;
+        e.inclination = random.generateDouble() * M_PI;
+        e.raan = random.generateDouble() * 2.0 * M_PI;
+        e.eccentricity = random.generateDouble() * 0.1;
+        e.argPerigee = random.generateDouble() * 2.0 * M_PI;
+        e.meanAnomaly = random.generateDouble() * 2.0 * M_PI;
+        e.meanMotion = 2.0 * M_PI / (5400.0 + random.generateDouble() * 40000.0);
+    }
+    SatelliteCatalog catalog;
+    catalog.setElements(elements);
+    return catalog;
+}
+
+// Положения каталога на кадр: пропагация Кеплера (0) против интерполяции
+// по кэшу эфемерид (1). Кусок строится до замера, время идет внутри него
+void BM_CatalogPositions(benchmark::State& state)
+{
+    SatelliteCatalog catalog = makeCatalog(int(state.range(0)));
+    EphemerisCache ephemeris;
+    const bool cached = state.range(1) != 0;
+    if (cached) {
+        catalog.propagate(0.0, ephemeris);
+        ephemeris.waitForBuilds();
+    }
+
+    double unixTime = 0.0;
+    for (auto _ : state) {
+        unixTime = std::fmod(unixTime + 1.0, ephemeris.chunkDuration());
+        if (cached)
+            catalog.propagate(unixTime, ephemeris);
+        else
+            catalog.propagate(unixTime);
+        benchmark::DoNotOptimize(catalog.positions().constData());
+    }
+    state.SetItemsProcessed(state.iterations() * catalog.size());
+}
+BENCHMARK(BM_CatalogPositions)->ArgNames({"satellites", "cached"})
+    ->Args({30000, 0})->Args({30000, 1})->Args({100000, 0})->Args({100000, 1})
+    ->Unit(benchmark::kMicrosecond);
+
+// Освещенность каталога на кадр для атрибута экземпляров при пропагации на CPU
+void BM_EclipseIlluminate(benchmark::State& state)
+{
+    SatelliteCatalog catalog = makeCatalog(int(state.range(0)));
+    catalog.propagate(0.0);
+    QVector<QVector4D> instances;
+    instances.reserve(catalog.size());
+    for (const QVector3D& position : catalog.positions())
+        instances.append(QVector4D(position, 0.0f));
+    QVector<float> illumination(instances.size());
+    const QVector3D sun = SolarEphemeris::position(1.7e9);
+
+    for (auto _ : state) {
+        EclipseModel::illuminate(instances.constData(), instances.size(), sun, illumination.data());
+        benchmark::DoNotOptimize(illumination.constData());
+    }
+    state.SetItemsProcessed(state.iterations() * instances.size());
+}
+BENCHMARK(BM_EclipseIlluminate)->ArgName("satellites")->Arg(30000)->Arg(100000)
+    ->Unit(benchmark::kMicrosecond);
+
+// Пролеты каталога над тремя станциями за сутки: полный расчет (0) против
+// пересчета после изменения 1% элементов, остальное берется из кэша (1)
+void BM_PassPrediction(benchmark::State& state)
+{
+    QVector<OrbitalElements> elements = makeCatalog(int(state.range(0))).elements();
+    QVector<GroundStation> stations(3);
+    GroundStation::parse("Moscow,55.75,37.62,150", stations[0]);
+    GroundStation::parse("Svalbard,78.23,15.39,500", stations[1]);
+    GroundStation::parse("Quito,-0.18,-78.47,2800", stations[2]);
+    const PassPredictor::Settings settings;
+    const bool cached = state.range(1) != 0;
+    const PassPredictionResult cache =
+        cached ? PassPredictor::predict(elements, stations, 0.0, settings) : PassPredictionResult();
+    for (int i = 0; i < elements.size(); i += 100)
+        elements[i].meanAnomaly += 0.01;
+
+    for (auto _ : state) {
+        const PassPredictionResult result = PassPredictor::predict(elements, stations, 0.0, settings, cache);
+        benchmark::DoNotOptimize(result.passCount);
+    }
+    state.SetItemsProcessed(state.iterations() * elements.size());
+}
+BENCHMARK(BM_PassPrediction)->ArgNames({"satellites", "cached"})
+    ->Args({30000, 0})->Args({30000, 1})
+    ->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// Память на спутник: прежний QMap<int, LegacySatellite> с описанием у каждого
+// спутника против SatelliteStore, где описание загружается для единиц
+void BM_SatelliteMemory(benchmark::State& state)
+{
+    const int count = int(state.range(0));
+    const bool store = state.range(1) != 0;
+    qint64 bytes = 0;
+
+    for (auto _ : state) {
+        QRandomGenerator random(count);
+        const qint64 before = heapBytesInUse();
+        if (store) {
+            SatelliteStore satellites;
+            for (int id = 0; id < count; ++id)
+                satellites.insert(id, randomSatellitePosition(random));
+            bytes = heapBytesInUse() - before;
+            if (bytes <= 0)
+                bytes = satellites.hotBytes() + satellites.coldBytes();
+            benchmark::DoNotOptimize(satellites.positions().constData());
+        } else {
+            QMap<int, LegacySatellite> satellites;
+            for (int id = 0; id < count; ++id) {
+                LegacySatellite& satellite = satellites[id];
+                satellite.id = id;
+                satellite.position = randomSatellitePosition(random);
+                satellite.info = QString("Satellite %1").arg(id);
+            }
+            bytes = heapBytesInUse() - before;
+            benchmark::DoNotOptimize(satellites.constBegin()->position);
+        }
+    }
+    state.counters["bytes_per_satellite"] = double(bytes) / count;
+    state.counters["total_MB"] = double(bytes) / (1024.0 * 1024.0);
+}
+BENCHMARK(BM_SatelliteMemory)->ArgNames({"satellites", "store"})
+    ->Args({100000, 0})->Args({100000, 1})
+    ->Iterations(3)->Unit(benchmark::kMillisecond);
+
+}
+
+int main(int argc, char** argv)
+{
+    // Менеджеру тайлов нужен контекст OpenGL; окно не требуется
+    if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    QSurfaceFormat format;
+    format.setVersion(3, 3);
+    format.setProfile(QSurfaceFormat::CoreProfile);
+    QSurfaceFormat::setDefaultFormat(format);
+
+    QGuiApplication app(argc, argv);
+
+    QOpenGLContext context;
+    QOffscreenSurface surface;
+    if (!context.create()) {
+        qCritical() << "Failed to create OpenGL context";
+        return 1;
+    }
+    surface.setFormat(context.format());
+    surface.create();
+    if (!context.makeCurrent(&surface)) {
+        qCritical() << "Failed to make OpenGL context current";
+        return 1;
+    }
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv))
+        return 1;
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+
+    context.doneCurrent();
+    return 0;
+}
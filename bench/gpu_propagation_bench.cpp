@@ -0,0 +1,230 @@
+// gpu_propagation_bench.cpp
+// Проверка и замер пропагации Кеплера на GPU (transform feedback) против
+// KeplerPropagator на CPU, освещенности — против EclipseModel. Работает без окна, в том числе на Mesa llvmpipe:
+//   QT_QPA_PLATFORM=offscreen LIBGL_ALWAYS_SOFTWARE=1 gpu_propagation_bench
+// Код возврата 1, если расхождение с CPU больше допуска.
+#include <QGuiApplication>
+#include <QCommandLineParser>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QOffscreenSurface>
+#include <QOpenGLContext>
+#include <QOpenGLExtraFunctions>
+#include <QOpenGLBuffer>
+#include <QRandomGenerator>
+#include <QSurfaceFormat>
+#include <QTextStream>
+#include <QVector>
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <type_traits>
+#include "eclipse_model.h"
+#include "gpu_propagator.h"
+#include "kepler_propagator.h"
+#include "solar_ephemeris.h"
+
+namespace {
+
+constexpr double EARTH_RADIUS = 6371000.0;
+constexpr float LIGHT_TOLERANCE = 0.1f; // полутень: пересечение дисков во float и приближенные acos на GPU
+
+// Смесь низких почти круговых, средних и высокоэллиптических орбит
+QVector<OrbitalElements> makeCatalog(int count, double epoch, quint32 seed)
+{
+    QRandomGenerator random(seed);
+    QVector<OrbitalElements> catalog(count);
+    for (int i = 0; i < count; ++i) {
+        OrbitalElements& elements = catalog[i];
+        elements.catalogNumber = i + 1;
+        elements.epoch = epoch - random.generateDouble() * 7.0 * 86400.0;
+        const double kind = random.generateDouble();
+        const double perigee = EARTH_RADIUS + 200000.0 + random.generateDouble() * 1800000.0;
+        if (kind < 0.7) {
+            elements.eccentricity = random.generateDouble() * 0.02;
+        } else if (kind < 0.9) {
+            elements.eccentricity = random.generateDouble() * 0.1;
+        } else {
+            elements.eccentricity = 0.5 + random.generateDouble() * 0.25; // Молния, ГПО
+        }
+        const double semiMajorAxis = (kind < 0.7 || kind >= 0.9 ? perigee : perigee * 4.0) /
+                                     (1.0 - elements.eccentricity);
+        elements.meanMotion = std::sqrt(OrbitalElements::EARTH_MU / std::pow(semiMajorAxis, 3.0));
+        elements.inclination = random.generateDouble() * M_PI;
+        elements.raan = random.generateDouble() * 2.0 * M_PI;
+        elements.argPerigee = random.generateDouble() * 2.0 * M_PI;
+        elements.meanAnomaly = random.generateDouble() * 2.0 * M_PI;
+    }
+    return catalog;
+}
+
+struct ErrorStats {
+    double maxRelative = 0.0;
+    double maxMeters = 0.0;
+    double meanMeters = 0.0;
+};
+
+ErrorStats compare(const QVector<QVector4D>& gpu, const QVector<QVector3D>& cpu)
+{
+    ErrorStats stats;
+    for (int i = 0; i < cpu.size(); ++i) {
+        const double error = (gpu[i].toVector3D() - cpu[i]).length();
+        stats.maxMeters = std::max(stats.maxMeters, error);
+        stats.maxRelative = std::max(stats.maxRelative, error / cpu[i].length());
+        stats.meanMeters += error;
+    }
+    if (!cpu.isEmpty())
+        stats.meanMeters /= cpu.size();
+    return stats;
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+    if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    QSurfaceFormat surfaceFormat;
+    surfaceFormat.setVersion(3, 3);
+    surfaceFormat.setProfile(QSurfaceFormat::CoreProfile);
+    QSurfaceFormat::setDefaultFormat(surfaceFormat);
+
+    QGuiApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("GPU Kepler propagation: accuracy against the CPU propagator and timing.");
+    parser.addHelpOption();
+    QCommandLineOption objectsOption("objects", "Catalog size.", "n", "100000");
+    QCommandLineOption repeatsOption("repeats", "Timed propagations per side.", "n", "20");
+    QCommandLineOption toleranceOption("tolerance", "Allowed error relative to the orbit radius.", "ratio", "2e-5");
+    QCommandLineOption seedOption("seed", "Catalog random seed.", "seed", "1");
+    parser.addOptions({objectsOption, repeatsOption, toleranceOption, seedOption});
+    parser.process(app);
+
+    const int objects = std::max(1, parser.value(objectsOption).toInt());
+    const int repeats = std::max(1, parser.value(repeatsOption).toInt());
+    const double tolerance = parser.value(toleranceOption).toDouble();
+
+    QOpenGLContext context;
+    if (!context.create()) {
+        qCritical() << "Failed to create OpenGL context";
+        return 1;
+    }
+    QOffscreenSurface surface;
+    surface.setFormat(context.format());
+    surface.create();
+    if (!context.makeCurrent(&surface)) {
+        qCritical() << "Failed to make OpenGL context current";
+        return 1;
+    }
+    QOpenGLExtraFunctions* f = context.extraFunctions();
+
+    // Буферы пропагатора удаляются до освобождения контекста
+    auto propagator = std::make_unique<GpuPropagator>();
+    if (!propagator->initialize()) {
+        qCritical() << "Failed to initialize GPU propagator";
+        return 1;
+    }
+
+    const double now = 1.7e9;
+    const QVector<OrbitalElements> catalog = makeCatalog(objects, now, parser.value(seedOption).toUInt());
+    QVector<SatelliteOrbit> orbits(objects);
+    for (int i = 0; i < objects; ++i)
+        orbits[i] = SatelliteOrbit::fromElements(catalog[i]);
+
+    QOpenGLBuffer target(QOpenGLBuffer::VertexBuffer);
+    target.create();
+    target.bind();
+    target.allocate(objects * int(sizeof(QVector4D)));
+    target.release();
+    QOpenGLBuffer illumination(QOpenGLBuffer::VertexBuffer);
+    illumination.create();
+    illumination.bind();
+    illumination.allocate(objects * int(sizeof(float)));
+    illumination.release();
+    propagator->reserve(objects);
+
+    QVector<GpuPropagator::Record> records(objects);
+    auto writeRecords = [&](double referenceTime) {
+        for (int i = 0; i < objects; ++i)
+            records[i] = GpuPropagator::makeRecord(orbits[i], QVector4D(), referenceTime);
+        propagator->writeRecords(0, records.constData(), objects);
+    };
+    auto readBack = [&](GLuint buffer, auto* values) {
+        using Value = std::remove_pointer_t<decltype(values)>;
+        f->glBindBuffer(GL_ARRAY_BUFFER, buffer);
+        const void* data = f->glMapBufferRange(GL_ARRAY_BUFFER, 0, objects * sizeof(Value), GL_MAP_READ_BIT);
+        if (data) {
+            std::copy_n(static_cast<const Value*>(data), objects, values);
+            f->glUnmapBuffer(GL_ARRAY_BUFFER);
+        }
+        f->glBindBuffer(GL_ARRAY_BUFFER, 0);
+    };
+
+    QTextStream out(stdout);
+    out << "renderer: " << reinterpret_cast<const char*>(f->glGetString(GL_RENDERER)) << "\n";
+    out << "objects: " << objects << ", tolerance: " << tolerance << " of |r|\n\n";
+    out << "reference_offset_s  dt_s  max_rel  max_m  mean_m  max_light\n";
+
+    // Моменты внутри интервала опорного момента и после его сдвига
+    bool ok = true;
+    const QVector<double> references = {now, now + 5.0 * 86400.0};
+    const QVector<double> offsets = {0.0, 60.0, 1800.0, GpuPropagator::REBASE_INTERVAL};
+    QVector<QVector3D> expected;
+    QVector<QVector4D> positions(objects);
+    QVector<float> light(objects);
+    QVector<float> expectedLight(objects);
+    for (double reference : references) {
+        writeRecords(reference);
+        for (double offset : offsets) {
+            const QVector3D sun = SolarEphemeris::position(reference + offset);
+            propagator->propagate(target.bufferId(), illumination.bufferId(), objects, float(offset), sun);
+            KeplerPropagator::propagate(catalog, reference + offset, expected);
+            readBack(target.bufferId(), positions.data());
+            readBack(illumination.bufferId(), light.data());
+            const ErrorStats stats = compare(positions, expected);
+
+            // Освещенность сверяется по тем же положениям, что получил шейдер
+            EclipseModel::illuminate(positions.constData(), objects, sun, expectedLight.data());
+            float maxLight = 0.0f;
+            for (int i = 0; i < objects; ++i)
+                maxLight = std::max(maxLight, std::abs(light[i] - expectedLight[i]));
+
+            ok = ok && stats.maxRelative <= tolerance && maxLight <= LIGHT_TOLERANCE;
+            out << qSetFieldWidth(18) << reference - now << qSetFieldWidth(0) << "  "
+                << qSetFieldWidth(4) << offset << qSetFieldWidth(0) << "  "
+                << QString::number(stats.maxRelative, 'e', 2) << "  "
+                << QString::number(stats.maxMeters, 'f', 1) << "  "
+                << QString::number(stats.meanMeters, 'f', 2) << "  "
+                << QString::number(maxLight, 'e', 2) << "\n";
+        }
+    }
+
+    // Время: CPU пропагирует в массив, GPU пишет в буфер; glFinish ждет результат
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < repeats; ++i)
+        KeplerPropagator::propagate(catalog, now + i, expected);
+    const double cpuMs = timer.nsecsElapsed() / 1.0e6 / repeats;
+
+    writeRecords(now);
+    const QVector3D sun = SolarEphemeris::position(now);
+    propagator->propagate(target.bufferId(), illumination.bufferId(), objects, 0.0f, sun);
+    f->glFinish();
+    timer.restart();
+    for (int i = 0; i < repeats; ++i)
+        propagator->propagate(target.bufferId(), illumination.bufferId(), objects, float(i), sun);
+    f->glFinish();
+    const double gpuMs = timer.nsecsElapsed() / 1.0e6 / repeats;
+
+    out << "\ncpu_ms: " << QString::number(cpuMs, 'f', 3) << "\ngpu_ms: " << QString::number(gpuMs, 'f', 3)
+        << "\nresult: " << (ok ? "PASS" : "FAIL") << "\n";
+    out.flush();
+
+    target.destroy();
+    illumination.destroy();
+    propagator.reset();
+    context.doneCurrent();
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,79 @@
+// camera_motion_predictor.cpp
+#include "camera_motion_predictor.h"
+#include <QtMath>
+#include <cmath>
+
+CameraMotionPredictor::CameraMotionPredictor()
+{
+    reset();
+}
+
+void CameraMotionPredictor::reset()
+{
+    hasSample = false;
+    lastTime = 0.0;
+    theta = 0.0f;
+    phi = float(M_PI_2);
+    distance = 1.0f;
+    thetaSpeed = 0.0f;
+    phiSpeed = 0.0f;
+    zoomRate = 0.0f;
+}
+
+void CameraMotionPredictor::observe(const QMatrix4x4& view, double seconds)
+{
+    const QVector3D eye = view.inverted().column(3).toVector3D();
+    const float newDistance = eye.length();
+    if (newDistance <= 0.0f)
+        return;
+
+    const float newTheta = std::atan2(eye.z(), eye.x());
+    const float newPhi = std::acos(qBound(-1.0f, eye.y() / newDistance, 1.0f));
+
+    const double dt = seconds - lastTime;
+    if (hasSample && dt > 0.0 && dt <= MAX_GAP) {
+        // Долгота переходит через ±π: берем кратчайшую разность
+        float dTheta = newTheta - theta;
+        if (dTheta > float(M_PI))
+            dTheta -= 2.0f * float(M_PI);
+        else if (dTheta < -float(M_PI))
+            dTheta += 2.0f * float(M_PI);
+
+        const float invDt = float(1.0 / dt);
+        thetaSpeed += SMOOTHING * (dTheta * invDt - thetaSpeed);
+        phiSpeed += SMOOTHING * ((newPhi - phi) * invDt - phiSpeed);
+        zoomRate += SMOOTHING * (std::log(newDistance / distance) * invDt - zoomRate);
+    } else if (!hasSample || dt > MAX_GAP) {
+        thetaSpeed = 0.0f;
+        phiSpeed = 0.0f;
+        zoomRate = 0.0f;
+    } else {
+        return; // тот же момент времени
+    }
+
+    hasSample = true;
+    lastTime = seconds;
+    theta = newTheta;
+    phi = newPhi;
+    distance = newDistance;
+}
+
+bool CameraMotionPredictor::isMoving() const
+{
+    return std::abs(thetaSpeed) > MIN_ANGULAR_SPEED || std::abs(phiSpeed) > MIN_ANGULAR_SPEED
+           || std::abs(zoomRate) > MIN_ZOOM_RATE;
+}
+
+QMatrix4x4 CameraMotionPredictor::predictView(float secondsAhead) const
+{
+    const float predictedTheta = theta + thetaSpeed * secondsAhead;
+    const float predictedPhi = qBound(MIN_PHI, phi + phiSpeed * secondsAhead, float(M_PI) - MIN_PHI);
+    const float predictedDistance = distance * std::exp(zoomRate * secondsAhead);
+
+    const QVector3D eye(predictedDistance * std::sin(predictedPhi) * std::cos(predictedTheta),
+                        predictedDistance * std::cos(predictedPhi),
+                        predictedDistance * std::sin(predictedPhi) * std::sin(predictedTheta));
+    QMatrix4x4 view;
+    view.lookAt(eye, QVector3D(0, 0, 0), QVector3D(0, 1, 0));
+    return view;
+}
@@ -0,0 +1,40 @@
+// camera_motion_predictor.h
+#ifndef CAMERA_MOTION_PREDICTOR_H
+#define CAMERA_MOTION_PREDICTOR_H
+
+#include <QMatrix4x4>
+
+// Экстраполяция движения орбитальной камеры (Camera) на доли секунды вперед.
+// По видовым матрицам последовательных кадров оцениваются угловые скорости
+// по долготе и широте и скорость зума (логарифм расстояния в секунду);
+// оценки сглаживаются экспоненциально. Камера всегда смотрит в центр Земли,
+// поэтому предсказанный вид строится так же, как Camera::getViewMatrix.
+class CameraMotionPredictor {
+public:
+    CameraMotionPredictor();
+
+    // Вид кадра в момент seconds по монотонным часам (не часам симуляции)
+    void observe(const QMatrix4x4& view, double seconds);
+    void reset();
+
+    bool isMoving() const;
+    QMatrix4x4 predictView(float secondsAhead) const;
+
+private:
+    static constexpr float SMOOTHING = 0.5f;          // вес нового замера
+    static constexpr double MAX_GAP = 0.25;           // с, после паузы скорости обнуляются
+    static constexpr float MIN_ANGULAR_SPEED = 1e-3f; // рад/с, медленнее — камера стоит
+    static constexpr float MIN_ZOOM_RATE = 1e-3f;     // 1/с
+    static constexpr float MIN_PHI = 0.1f;            // пределы широты, как в Camera::rotate
+
+    bool hasSample;
+    double lastTime;
+    float theta;    // долгота камеры
+    float phi;      // полярный угол от оси Y
+    float distance; // до центра
+    float thetaSpeed;
+    float phiSpeed;
+    float zoomRate; // d(ln distance)/dt
+};
+
+#endif // CAMERA_MOTION_PREDICTOR_H
@@ -0,0 +1,98 @@
+// catalog_feed.cpp
+#include "catalog_feed.h"
+#include <QLocalSocket>
+#include <QDebug>
+#include <string_view>
+#include <utility>
+
+CatalogFeedServer::CatalogFeedServer(QObject* parent)
+    : QObject(parent)
+{
+    connect(&server, &QLocalServer::newConnection, this, &CatalogFeedServer::acceptConnections);
+}
+
+CatalogFeedServer::~CatalogFeedServer()
+{
+    server.close();
+}
+
+bool CatalogFeedServer::listen(const QString& name)
+{
+    // Сокет, оставшийся от аварийно завершенного процесса, мешает listen()
+    QLocalServer::removeServer(name);
+    if (!server.listen(name)) {
+        qWarning() << "Catalog feed: failed to listen on" << name << server.errorString();
+        return false;
+    }
+    qDebug() << "Catalog feed listening on" << server.fullServerName();
+    return true;
+}
+
+void CatalogFeedServer::acceptConnections()
+{
+    while (QLocalSocket* socket = server.nextPendingConnection()) {
+        partialLines.insert(socket, QByteArray());
+        connect(socket, &QLocalSocket::readyRead, this, [this, socket]() { readSocket(socket); });
+        connect(socket, &QLocalSocket::disconnected, this, [this, socket]() {
+            readSocket(socket);
+            partialLines.remove(socket);
+            socket->deleteLater();
+        });
+    }
+}
+
+void CatalogFeedServer::readSocket(QLocalSocket* socket)
+{
+    auto it = partialLines.find(socket);
+    if (it == partialLines.end() || socket->bytesAvailable() == 0)
+        return;
+
+    QByteArray& buffer = *it;
+    buffer.append(socket->readAll());
+
+    const std::string_view data(buffer.constData(), size_t(buffer.size()));
+    size_t start = 0;
+    CatalogUpdate update;
+    for (size_t end = data.find('\n'); end != std::string_view::npos; end = data.find('\n', start)) {
+        std::string_view line = data.substr(start, end - start);
+        start = end + 1;
+        if (!line.empty() && line.back() == '\r')
+            line.remove_suffix(1);
+        if (line.empty() || line.front() == '#')
+            continue;
+
+        ++received;
+        if (CatalogParser::parseUpdateLine(line, update))
+            appendUpdate(update);
+        else
+            ++rejected;
+    }
+    buffer.remove(0, qsizetype(start));
+
+    if (buffer.size() > MAX_LINE_LENGTH) {
+        qWarning() << "Catalog feed: line too long, dropping connection";
+        socket->abort();
+    }
+}
+
+void CatalogFeedServer::appendUpdate(const CatalogUpdate& update)
+{
+    if (pending.isEmpty())
+        emit updatesAvailable();
+
+    // Каждая запись полностью описывает объект, поэтому достаточно последней
+    const int id = update.elements.catalogNumber;
+    auto it = pendingIndexById.constFind(id);
+    if (it != pendingIndexById.constEnd()) {
+        pending[*it] = update;
+        return;
+    }
+    pendingIndexById.insert(id, pending.size());
+    pending.append(update);
+}
+
+QVector<CatalogUpdate> CatalogFeedServer::takePendingUpdates()
+{
+    pendingIndexById.clear();
+    return std::exchange(pending, {});
+}
@@ -0,0 +1,57 @@
+// catalog_feed.h
+#ifndef CATALOG_FEED_H
+#define CATALOG_FEED_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QHash>
+#include <QLocalServer>
+#include <QVector>
+#include "catalog_loader.h"
+
+class QLocalSocket;
+
+// Поток изменений каталога через локальный сокет (сокет Unix или именованный
+// канал Windows). Строки протокола описаны у CatalogParser::parseUpdateLine.
+// Изменения копятся до takePendingUpdates(); повторные записи одного объекта
+// между вызовами схлопываются в последнюю, поэтому объем пакета ограничен
+// числом разных объектов, а не скоростью потока.
+class CatalogFeedServer : public QObject {
+    Q_OBJECT
+
+public:
+    explicit CatalogFeedServer(QObject* parent = nullptr);
+    ~CatalogFeedServer() override;
+
+    bool listen(const QString& name);
+    QString serverName() const { return server.serverName(); }
+    QString errorString() const { return server.errorString(); }
+
+    // Забирает накопленный пакет; вызывается раз в кадр
+    QVector<CatalogUpdate> takePendingUpdates();
+    bool hasPendingUpdates() const { return !pending.isEmpty(); }
+
+    qint64 receivedCount() const { return received; }
+    qint64 rejectedCount() const { return rejected; }
+    int connectionCount() const { return partialLines.size(); }
+
+signals:
+    // Первая запись после takePendingUpdates(): пора запросить кадр
+    void updatesAvailable();
+
+private:
+    void acceptConnections();
+    void readSocket(QLocalSocket* socket);
+    void appendUpdate(const CatalogUpdate& update);
+
+    static constexpr int MAX_LINE_LENGTH = 4096; // защита от потока без переводов строк
+
+    QLocalServer server;
+    QHash<QLocalSocket*, QByteArray> partialLines; // незавершенная строка каждого клиента
+    QVector<CatalogUpdate> pending;
+    QHash<int, int> pendingIndexById;
+    qint64 received = 0;
+    qint64 rejected = 0;
+};
+
+#endif // CATALOG_FEED_H
@@ -0,0 +1,638 @@
+// catalog_loader.cpp
+#include "catalog_loader.h"
+#include "kepler_propagator.h"
+#include <QElapsedTimer>
+#include <QFile>
+#include <QtConcurrent/QtConcurrent>
+#include <QDebug>
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+
+namespace {
+
+constexpr double DEG_TO_RAD = M_PI / 180.0;
+constexpr double REV_PER_DAY_TO_RAD_PER_SEC = 2.0 * M_PI / 86400.0;
+
+// Обязательные поля OMM
+enum OmmField : unsigned {
+    NoradId = 1 << 0,
+    Epoch = 1 << 1,
+    MeanMotion = 1 << 2,
+    Eccentricity = 1 << 3,
+    Inclination = 1 << 4,
+    Raan = 1 << 5,
+    ArgPerigee = 1 << 6,
+    MeanAnomaly = 1 << 7,
+    AllRequired = (1 << 8) - 1
+};
+
+std::string_view trim(std::string_view text)
+{
+    while (!text.empty() && (text.front() == ' ' || text.front() == '\t' || text.front() == '\r'))
+        text.remove_prefix(1);
+    while (!text.empty() && (text.back() == ' ' || text.back() == '\t' || text.back() == '\r'))
+        text.remove_suffix(1);
+    return text;
+}
+
+bool parseDouble(std::string_view text, double& value)
+{
+    text = trim(text);
+    if (!text.empty() && text.front() == '+')
+        text.remove_prefix(1);
+    if (text.empty())
+        return false;
+    auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+    return error == std::errc() && end == text.data() + text.size();
+}
+
+bool parseInt(std::string_view text, int& value)
+{
+    text = trim(text);
+    if (text.empty())
+        return false;
+    auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+    return error == std::errc() && end == text.data() + text.size();
+}
+
+// Дни от 1970-01-01 по григорианскому календарю (H. Hinnant)
+qint64 daysFromCivil(int year, int month, int day)
+{
+    year -= month <= 2;
+    const qint64 era = (year >= 0 ? year : year - 399) / 400;
+    const unsigned yearOfEra = unsigned(year - era * 400);
+    const unsigned dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    const unsigned dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return era * 146097 + qint64(dayOfEra) - 719468;
+}
+
+// "2024-03-05T12:34:56.789012", разделитель T или пробел, Z необязателен
+bool parseIsoEpoch(std::string_view text, double& unixTime)
+{
+    text = trim(text);
+    if (!text.empty() && text.back() == 'Z')
+        text.remove_suffix(1);
+    if (text.size() < 19 || text[4] != '-' || text[7] != '-' || text[13] != ':' || text[16] != ':')
+        return false;
+
+    int year, month, day, hour, minute;
+    double second;
+    if (!parseInt(text.substr(0, 4), year) || !parseInt(text.substr(5, 2), month) ||
+        !parseInt(text.substr(8, 2), day) || !parseInt(text.substr(11, 2), hour) ||
+        !parseInt(text.substr(14, 2), minute) || !parseDouble(text.substr(17), second))
+        return false;
+
+    unixTime = daysFromCivil(year, month, day) * 86400.0 + hour * 3600.0 + minute * 60.0 + second;
+    return true;
+}
+
+// Поле TLE с подразумеваемой точкой и порядком: " 34123-4" = 0.34123e-4
+bool parseTleExponent(std::string_view text, double& value)
+{
+    text = trim(text);
+    if (text.size() < 3)
+        return false;
+
+    double sign = 1.0;
+    if (text.front() == '-' || text.front() == '+') {
+        sign = text.front() == '-' ? -1.0 : 1.0;
+        text.remove_prefix(1);
+    }
+    const std::string_view mantissaDigits = text.substr(0, text.size() - 2);
+    const char exponentSign = text[text.size() - 2];
+    const char exponentDigit = text.back();
+    int mantissa;
+    if (!parseInt(mantissaDigits, mantissa) || (exponentSign != '-' && exponentSign != '+') ||
+        exponentDigit < '0' || exponentDigit > '9')
+        return false;
+    const int exponent = (exponentSign == '-' ? -1 : 1) * (exponentDigit - '0');
+
+    value = sign * mantissa * std::pow(10.0, exponent - int(mantissaDigits.size()));
+    return true;
+}
+
+// Номер по каталогу, включая формат Alpha-5 (A0001 = 100001, без I и O)
+bool parseCatalogNumber(std::string_view text, int& number)
+{
+    text = trim(text);
+    if (text.empty())
+        return false;
+
+    const char first = text.front();
+    if (first >= 'A' && first <= 'Z' && first != 'I' && first != 'O') {
+        int rest;
+        if (!parseInt(text.substr(1), rest))
+            return false;
+        int prefix = first - 'A' + 10;
+        if (first > 'I') --prefix;
+        if (first > 'O') --prefix;
+        number = prefix * 10000 + rest;
+        return true;
+    }
+    return parseInt(text, number);
+}
+
+// Строки без завершающего \r; последняя строка может не иметь \n
+template <typename Function>
+void forEachLine(std::string_view data, Function&& function)
+{
+    size_t start = 0;
+    while (start < data.size()) {
+        size_t end = data.find('\n', start);
+        if (end == std::string_view::npos)
+            end = data.size();
+        std::string_view line = data.substr(start, end - start);
+        if (!line.empty() && line.back() == '\r')
+            line.remove_suffix(1);
+        function(line);
+        start = end + 1;
+    }
+}
+
+bool parseTleRecord(std::string_view name, std::string_view line1, std::string_view line2,
+                    OrbitalElements& elements)
+{
+    if (line1.size() < 69 || line2.size() < 69 || line2[0] != '2')
+        return false;
+    if (!CatalogParser::tleChecksumValid(line1) || !CatalogParser::tleChecksumValid(line2))
+        return false;
+
+    int number1, number2;
+    if (!parseCatalogNumber(line1.substr(2, 5), number1) || !parseCatalogNumber(line2.substr(2, 5), number2) ||
+        number1 != number2)
+        return false;
+
+    // Эксцентриситет записан без "0."
+    int epochYear, eccentricityDigits;
+    double epochDay, inclination, raan, argPerigee, meanAnomaly, meanMotion, bstar;
+    if (!parseInt(line1.substr(18, 2), epochYear) || !parseDouble(line1.substr(20, 12), epochDay) ||
+        !parseTleExponent(line1.substr(53, 8), bstar) ||
+        !parseDouble(line2.substr(8, 8), inclination) || !parseDouble(line2.substr(17, 8), raan) ||
+        !parseInt(line2.substr(26, 7), eccentricityDigits) ||
+        !parseDouble(line2.substr(34, 8), argPerigee) || !parseDouble(line2.substr(43, 8), meanAnomaly) ||
+        !parseDouble(line2.substr(52, 11), meanMotion))
+        return false;
+
+    epochYear += epochYear < 57 ? 2000 : 1900;
+
+    if (name.size() > 2 && name[0] == '0' && name[1] == ' ')
+        name.remove_prefix(2); // формат 3LE
+    name = trim(name);
+
+    const std::string_view designator = trim(line1.substr(9, 8));
+
+    elements.catalogNumber = number1;
+    elements.name = QString::fromUtf8(name.data(), int(name.size()));
+    elements.internationalDesignator = QString::fromLatin1(designator.data(), int(designator.size()));
+    elements.epoch = daysFromCivil(epochYear, 1, 1) * 86400.0 + (epochDay - 1.0) * 86400.0;
+    elements.inclination = inclination * DEG_TO_RAD;
+    elements.raan = raan * DEG_TO_RAD;
+    elements.eccentricity = eccentricityDigits * 1e-7;
+    elements.argPerigee = argPerigee * DEG_TO_RAD;
+    elements.meanAnomaly = meanAnomaly * DEG_TO_RAD;
+    elements.meanMotion = meanMotion * REV_PER_DAY_TO_RAD_PER_SEC;
+    elements.bstar = bstar;
+    return meanMotion > 0.0;
+}
+
+// Очередное поле строки, разделенное пробелами; line сдвигается за него
+std::string_view nextToken(std::string_view& line)
+{
+    line = trim(line);
+    const size_t end = std::min(line.find(' '), line.size());
+    const std::string_view token = line.substr(0, end);
+    line.remove_prefix(end);
+    return token;
+}
+
+// Эпоха потока: ISO 8601 или секунды Unix
+bool parseFeedEpoch(std::string_view text, double& unixTime)
+{
+    return text.find('T') != std::string_view::npos ? parseIsoEpoch(text, unixTime) : parseDouble(text, unixTime);
+}
+
+// Поле OMM по имени ключевого слова CCSDS; неизвестные ключи пропускаются
+void assignOmmField(OrbitalElements& elements, std::string_view key, std::string_view value, unsigned& present)
+{
+    double number;
+    if (key == "OBJECT_NAME") {
+        value = trim(value);
+        elements.name = QString::fromUtf8(value.data(), int(value.size()));
+    } else if (key == "OBJECT_ID") {
+        value = trim(value);
+        elements.internationalDesignator = QString::fromLatin1(value.data(), int(value.size()));
+    } else if (key == "NORAD_CAT_ID") {
+        if (parseCatalogNumber(value, elements.catalogNumber))
+            present |= NoradId;
+    } else if (key == "EPOCH") {
+        if (parseIsoEpoch(value, elements.epoch))
+            present |= Epoch;
+    } else if (key == "MEAN_MOTION") {
+        if (parseDouble(value, number) && number > 0.0) {
+            elements.meanMotion = number * REV_PER_DAY_TO_RAD_PER_SEC;
+            present |= MeanMotion;
+        }
+    } else if (key == "ECCENTRICITY") {
+        if (parseDouble(value, number) && number >= 0.0 && number < 1.0) {
+            elements.eccentricity = number;
+            present |= Eccentricity;
+        }
+    } else if (key == "INCLINATION") {
+        if (parseDouble(value, number)) {
+            elements.inclination = number * DEG_TO_RAD;
+            present |= Inclination;
+        }
+    } else if (key == "RA_OF_ASC_NODE") {
+        if (parseDouble(value, number)) {
+            elements.raan = number * DEG_TO_RAD;
+            present |= Raan;
+        }
+    } else if (key == "ARG_OF_PERICENTER") {
+        if (parseDouble(value, number)) {
+            elements.argPerigee = number * DEG_TO_RAD;
+            present |= ArgPerigee;
+        }
+    } else if (key == "MEAN_ANOMALY") {
+        if (parseDouble(value, number)) {
+            elements.meanAnomaly = number * DEG_TO_RAD;
+            present |= MeanAnomaly;
+        }
+    } else if (key == "BSTAR") {
+        parseDouble(value, elements.bstar);
+    }
+}
+
+// Строка JSON от открывающей кавычки; escape-последовательности остаются как есть
+std::string_view readJsonString(std::string_view data, size_t& i)
+{
+    const size_t start = ++i;
+    while (i < data.size() && data[i] != '"')
+        i += data[i] == '\\' ? 2 : 1;
+    std::string_view text = data.substr(start, std::min(i, data.size()) - start);
+    ++i;
+    return text;
+}
+
+void skipJsonWhitespace(std::string_view data, size_t& i)
+{
+    while (i < data.size() && (data[i] == ' ' || data[i] == '\n' || data[i] == '\r' || data[i] == '\t'))
+        ++i;
+}
+
+// Пропускает вложенный объект или массив, учитывая строки
+void skipJsonContainer(std::string_view data, size_t& i)
+{
+    int depth = 0;
+    while (i < data.size()) {
+        const char c = data[i];
+        if (c == '"') {
+            readJsonString(data, i);
+            continue;
+        }
+        if (c == '{' || c == '[')
+            ++depth;
+        else if ((c == '}' || c == ']') && --depth == 0) {
+            ++i;
+            return;
+        }
+        ++i;
+    }
+}
+
+}
+
+bool CatalogParser::tleChecksumValid(std::string_view line)
+{
+    if (line.size() < 69 || line[68] < '0' || line[68] > '9')
+        return false;
+    int sum = 0;
+    for (size_t i = 0; i < 68; ++i) {
+        const char c = line[i];
+        if (c >= '0' && c <= '9')
+            sum += c - '0';
+        else if (c == '-')
+            sum += 1;
+    }
+    return sum % 10 == line[68] - '0';
+}
+
+bool CatalogParser::parseUpdateLine(std::string_view line, CatalogUpdate& update)
+{
+    const std::string_view type = nextToken(line);
+    int id;
+    if (type.size() != 1 || !parseInt(nextToken(line), id) || id < 0)
+        return false;
+
+    update.elements = OrbitalElements();
+    update.elements.catalogNumber = id;
+    if (type[0] == 'R') {
+        update.type = CatalogUpdate::Type::Remove;
+        return trim(line).empty();
+    }
+    if (type[0] != 'E' && type[0] != 'S')
+        return false;
+
+    // Оба вида записи: эпоха и шесть чисел
+    double values[6];
+    if (!parseFeedEpoch(nextToken(line), update.elements.epoch))
+        return false;
+    for (double& value : values) {
+        if (!parseDouble(nextToken(line), value))
+            return false;
+    }
+
+    OrbitalElements& elements = update.elements;
+    update.type = CatalogUpdate::Type::Upsert;
+    if (type[0] == 'E') {
+        if (values[2] < 0.0 || values[2] >= 1.0 || values[5] <= 0.0)
+            return false;
+        elements.inclination = values[0] * DEG_TO_RAD;
+        elements.raan = values[1] * DEG_TO_RAD;
+        elements.eccentricity = values[2];
+        elements.argPerigee = values[3] * DEG_TO_RAD;
+        elements.meanAnomaly = values[4] * DEG_TO_RAD;
+        elements.meanMotion = values[5] * REV_PER_DAY_TO_RAD_PER_SEC;
+    } else {
+        const double position[3] = {values[0] * 1000.0, values[1] * 1000.0, values[2] * 1000.0};
+        const double velocity[3] = {values[3] * 1000.0, values[4] * 1000.0, values[5] * 1000.0};
+        if (!KeplerPropagator::elementsFromState(position, velocity, elements))
+            return false;
+    }
+
+    const std::string_view name = trim(line);
+    elements.name = QString::fromUtf8(name.data(), int(name.size()));
+    return true;
+}
+
+CatalogFormat CatalogParser::detectFormat(std::string_view data)
+{
+    if (data.substr(0, 3) == "\xEF\xBB\xBF")
+        data.remove_prefix(3); // BOM
+    size_t i = 0;
+    skipJsonWhitespace(data, i);
+    if (i >= data.size())
+        return CatalogFormat::Unknown;
+
+    if (data[i] == '<')
+        return CatalogFormat::OmmXml;
+    if (data[i] == '[' || data[i] == '{')
+        return CatalogFormat::OmmJson;
+
+    const std::string_view firstLine = data.substr(i, data.find('\n', i) - i);
+    if (firstLine.find(',') != std::string_view::npos &&
+        (firstLine.find("NORAD_CAT_ID") != std::string_view::npos ||
+         firstLine.find("MEAN_MOTION") != std::string_view::npos))
+        return CatalogFormat::OmmCsv;
+    return CatalogFormat::Tle;
+}
+
+int CatalogParser::parse(std::string_view data, CatalogFormat format, QVector<OrbitalElements>& elements)
+{
+    switch (format) {
+    case CatalogFormat::Tle: return parseTle(data, elements);
+    case CatalogFormat::OmmXml: return parseOmmXml(data, elements);
+    case CatalogFormat::OmmJson: return parseOmmJson(data, elements);
+    case CatalogFormat::OmmCsv: return parseOmmCsv(data, elements);
+    case CatalogFormat::Unknown: break;
+    }
+    return 0;
+}
+
+int CatalogParser::parseTle(std::string_view data, QVector<OrbitalElements>& elements)
+{
+    int rejected = 0;
+    std::string_view name;
+    std::string_view line1;
+
+    forEachLine(data, [&](std::string_view line) {
+        if (!line1.empty()) {
+            OrbitalElements record;
+            if (parseTleRecord(name, line1, line, record))
+                elements.append(std::move(record));
+            else
+                ++rejected;
+            name = std::string_view();
+            line1 = std::string_view();
+            if (!line.empty() && line[0] == '2')
+                return;
+        }
+
+        if (line.size() >= 69 && line[0] == '1' && line[1] == ' ')
+            line1 = line;
+        else if (!trim(line).empty())
+            name = line;
+    });
+
+    if (!line1.empty())
+        ++rejected; // файл оборвался после первой строки
+    return rejected;
+}
+
+int CatalogParser::parseOmmXml(std::string_view data, QVector<OrbitalElements>& elements)
+{
+    int rejected = 0;
+    size_t position = 0;
+    while ((position = data.find("<omm", position)) != std::string_view::npos) {
+        size_t end = data.find("</omm>", position);
+        if (end == std::string_view::npos)
+            end = data.size();
+        const std::string_view record = data.substr(position, end - position);
+        position = end;
+
+        OrbitalElements parsed;
+        unsigned present = 0;
+
+        // Листовые элементы вида <KEY>value</KEY>; метаданные и данные лежат вперемешку
+        size_t i = 0;
+        while ((i = record.find('<', i)) != std::string_view::npos) {
+            ++i;
+            if (i >= record.size() || record[i] == '/' || record[i] == '?' || record[i] == '!')
+                continue;
+            const size_t nameEnd = record.find_first_of(" \t\r\n/>", i);
+            const size_t close = record.find('>', i);
+            if (nameEnd == std::string_view::npos || close == std::string_view::npos)
+                break;
+            if (record[close - 1] == '/')
+                continue;
+            const size_t valueEnd = record.find('<', close + 1);
+            if (valueEnd == std::string_view::npos)
+                break;
+            if (valueEnd + 1 < record.size() && record[valueEnd + 1] == '/') {
+                assignOmmField(parsed, record.substr(i, nameEnd - i),
+                               record.substr(close + 1, valueEnd - close - 1), present);
+            }
+            i = valueEnd;
+        }
+
+        if (present == AllRequired)
+            elements.append(std::move(parsed));
+        else
+            ++rejected;
+    }
+    return rejected;
+}
+
+int CatalogParser::parseOmmJson(std::string_view data, QVector<OrbitalElements>& elements)
+{
+    int rejected = 0;
+    size_t i = 0;
+    while ((i = data.find('{', i)) != std::string_view::npos) {
+        ++i;
+        OrbitalElements record;
+        unsigned present = 0;
+        bool closed = false;
+
+        while (i < data.size()) {
+            skipJsonWhitespace(data, i);
+            if (i >= data.size())
+                break;
+            if (data[i] == '}') {
+                ++i;
+                closed = true;
+                break;
+            }
+            if (data[i] == ',') {
+                ++i;
+                continue;
+            }
+            if (data[i] != '"')
+                break; // не объект OMM
+
+            const std::string_view key = readJsonString(data, i);
+            skipJsonWhitespace(data, i);
+            if (i >= data.size() || data[i] != ':')
+                break;
+            ++i;
+            skipJsonWhitespace(data, i);
+            if (i >= data.size())
+                break;
+
+            std::string_view value;
+            if (data[i] == '"') {
+                value = readJsonString(data, i);
+            } else if (data[i] == '{' || data[i] == '[') {
+                skipJsonContainer(data, i);
+                continue;
+            } else {
+                const size_t start = i;
+                while (i < data.size() && data[i] != ',' && data[i] != '}' && data[i] != ']')
+                    ++i;
+                value = trim(data.substr(start, i - start));
+                if (value == "null")
+                    continue;
+            }
+            assignOmmField(record, key, value, present);
+        }
+
+        if (closed && present == AllRequired)
+            elements.append(std::move(record));
+        else
+            ++rejected;
+    }
+    return rejected;
+}
+
+int CatalogParser::parseOmmCsv(std::string_view data, QVector<OrbitalElements>& elements)
+{
+    int rejected = 0;
+    QVector<std::string_view> header;
+    QVector<std::string_view> fields;
+
+    auto split = [](std::string_view line, QVector<std::string_view>& out) {
+        out.clear();
+        size_t start = 0;
+        bool quoted = false;
+        for (size_t i = 0; i <= line.size(); ++i) {
+            if (i < line.size() && line[i] == '"') {
+                quoted = !quoted;
+            } else if (i == line.size() || (line[i] == ',' && !quoted)) {
+                std::string_view field = trim(line.substr(start, i - start));
+                if (field.size() >= 2 && field.front() == '"' && field.back() == '"')
+                    field = field.substr(1, field.size() - 2);
+                out.append(field);
+                start = i + 1;
+            }
+        }
+    };
+
+    forEachLine(data, [&](std::string_view line) {
+        if (trim(line).empty())
+            return;
+        if (header.isEmpty()) {
+            split(line, header);
+            return;
+        }
+
+        split(line, fields);
+        OrbitalElements record;
+        unsigned present = 0;
+        const int count = std::min(header.size(), fields.size());
+        for (int column = 0; column < count; ++column)
+            assignOmmField(record, header[column], fields[column], present);
+
+        if (present == AllRequired)
+            elements.append(std::move(record));
+        else
+            ++rejected;
+    });
+    return rejected;
+}
+
+CatalogLoadResult CatalogParser::parseFile(const QString& path)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    CatalogLoadResult result;
+    result.path = path;
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        result.error = file.errorString();
+        return result;
+    }
+    result.bytes = file.size();
+
+    // Отображение в память; если недоступно (например, для ресурсов Qt) — обычное чтение
+    QByteArray contents;
+    std::string_view data;
+    if (uchar* mapped = result.bytes > 0 ? file.map(0, result.bytes) : nullptr) {
+        data = std::string_view(reinterpret_cast<const char*>(mapped), size_t(result.bytes));
+    } else {
+        contents = file.readAll();
+        data = std::string_view(contents.constData(), size_t(contents.size()));
+    }
+
+    result.format = detectFormat(data);
+    if (result.format == CatalogFormat::Tle)
+        result.elements.reserve(int(result.bytes / 140)); // ~165 байт на трехстрочную запись
+    result.rejected = parse(data, result.format, result.elements);
+
+    result.elapsedMs = timer.nsecsElapsed() / 1.0e6;
+    if (result.elements.isEmpty())
+        result.error = QString("No valid orbital elements in %1").arg(path);
+    return result;
+}
+
+CatalogLoader::CatalogLoader(QObject* parent)
+    : QObject(parent)
+{
+    connect(&watcher, &QFutureWatcher<CatalogLoadResult>::finished, this, [this]() {
+        emit loaded(watcher.result());
+    });
+}
+
+CatalogLoader::~CatalogLoader()
+{
+    watcher.waitForFinished();
+}
+
+void CatalogLoader::load(const QString& path)
+{
+    if (watcher.isRunning()) {
+        qDebug() << "Catalog is already loading, ignoring" << path;
+        return;
+    }
+    watcher.setFuture(QtConcurrent::run(&CatalogParser::parseFile, path));
+}
@@ -0,0 +1,87 @@
+// catalog_loader.h
+#ifndef CATALOG_LOADER_H
+#define CATALOG_LOADER_H
+
+#include <QObject>
+#include <QFutureWatcher>
+#include <QString>
+#include <QVector>
+#include <string_view>
+#include "orbital_elements.h"
+
+enum class CatalogFormat {
+    Unknown,
+    Tle,      // двух- или трехстрочные элементы
+    OmmXml,   // CCSDS OMM в XML (NDM)
+    OmmJson,  // OMM в JSON, как у CelesTrak
+    OmmCsv    // OMM в CSV с заголовком
+};
+
+struct CatalogLoadResult {
+    QString path;
+    CatalogFormat format = CatalogFormat::Unknown;
+    QVector<OrbitalElements> elements;
+    int rejected = 0;      // неверная контрольная сумма или неполная запись
+    qint64 bytes = 0;
+    double elapsedMs = 0.0;
+    QString error;
+
+    bool ok() const { return error.isEmpty(); }
+    double objectsPerSecond() const { return elapsedMs > 0.0 ? elements.size() * 1000.0 / elapsedMs : 0.0; }
+};
+
+// Одна запись потока изменений каталога (CatalogFeedServer)
+struct CatalogUpdate {
+    enum class Type {
+        Upsert,  // новый объект или новые элементы существующего
+        Remove
+    };
+
+    Type type = Type::Upsert;
+    OrbitalElements elements; // для Remove заполнен только catalogNumber
+};
+
+// Разбор каталогов без копирования: файл отображается в память,
+// поля читаются через std::string_view прямо из отображения.
+class CatalogParser {
+public:
+    static CatalogLoadResult parseFile(const QString& path);
+    static CatalogFormat detectFormat(std::string_view data);
+    // Добавляет разобранные записи в elements, возвращает число отброшенных
+    static int parse(std::string_view data, CatalogFormat format, QVector<OrbitalElements>& elements);
+
+    // Строка протокола потока изменений (поля через пробел, эпоха ISO 8601 или секунды Unix):
+    //   E <id> <epoch> <inc> <raan> <ecc> <argp> <M> <n> [name]   элементы, градусы и об/сут
+    //   S <id> <epoch> <x> <y> <z> <vx> <vy> <vz> [name]          вектор состояния ECI, км и км/с
+    //   R <id>                                                     удаление
+    static bool parseUpdateLine(std::string_view line, CatalogUpdate& update);
+
+    // Контрольная сумма строки TLE: цифры плюс 1 за каждый минус, по модулю 10
+    static bool tleChecksumValid(std::string_view line);
+
+private:
+    static int parseTle(std::string_view data, QVector<OrbitalElements>& elements);
+    static int parseOmmXml(std::string_view data, QVector<OrbitalElements>& elements);
+    static int parseOmmJson(std::string_view data, QVector<OrbitalElements>& elements);
+    static int parseOmmCsv(std::string_view data, QVector<OrbitalElements>& elements);
+};
+
+// Загрузка каталога в пуле потоков; результат приходит одним пакетом в GUI-поток
+class CatalogLoader : public QObject {
+    Q_OBJECT
+
+public:
+    explicit CatalogLoader(QObject* parent = nullptr);
+    ~CatalogLoader() override;
+
+    void load(const QString& path);
+    bool isLoading() const { return watcher.isRunning(); }
+
+signals:
+    void loaded(const CatalogLoadResult& result);
+
+private:
+    QFutureWatcher<CatalogLoadResult> watcher;
+};
+
+#endif // CATALOG_LOADER_H
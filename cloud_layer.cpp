@@ -0,0 +1,346 @@
+// cloud_layer.cpp
+#include "cloud_layer.h"
+#include <QtConcurrent>
+#include <QCoreApplication>
+#include <QDir>
+#include <QImageReader>
+#include <QDebug>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+CloudLayer::CloudLayer()
+    : maxTextureSize(0)
+    , time(0.0)
+    , direction(1.0f)
+    , drift(0.0f)
+    , initialized(false)
+    , memoryBudget(nullptr)
+    , budgetLayer(-1)
+{
+}
+
+CloudLayer::~CloudLayer()
+{
+    if (memoryBudget)
+        memoryBudget->unregisterLayer(budgetLayer);
+    if (!initialized)
+        return;
+
+    for (Slot& slot : frameSlots) {
+        if (slot.fence)
+            glDeleteSync(slot.fence);
+        glDeleteBuffers(1, &slot.pbo);
+        glDeleteTextures(1, &slot.texture);
+    }
+}
+
+void CloudLayer::initialize()
+{
+    initializeOpenGLFunctions();
+
+    if (frames.isEmpty())
+        frames.append({0.0, QCoreApplication::applicationDirPath() + "/textures/earth_clouds.jpg"});
+
+    // Первый кадр грузится синхронно: он же задает размер всех текстур слоя
+    const int current = frameAt(time);
+    QImage image(frames[current].path);
+    if (image.isNull()) {
+        qWarning() << "Failed to load cloud frame:" << frames[current].path;
+        return;
+    }
+
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTextureSize);
+    retryClock.start();
+    image = image.convertToFormat(QImage::Format_RGBA8888);
+
+    for (Slot& slot : frameSlots) {
+        glGenTextures(1, &slot.texture);
+        glBindTexture(GL_TEXTURE_2D, slot.texture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);       // шов по долготе
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+        glGenBuffers(1, &slot.pbo);
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+    if (memoryBudget)
+        budgetLayer = memoryBudget->registerLayer("clouds", GpuMemoryBudget::Priority::High);
+    allocateSlots(image.size());
+    initialized = true;
+
+    if (image.size() != frameSize)
+        image = image.scaled(frameSize, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+
+    Slot& slot = frameSlots[0];
+    slot.frame = current;
+    upload(slot, image);
+    glDeleteSync(slot.fence);
+    slot.fence = nullptr;
+    slot.ready = true;
+}
+
+void CloudLayer::setFrames(const QVector<CloudFrame>& newFrames)
+{
+    QVector<CloudFrame> series = newFrames;
+    if (series.isEmpty())
+        series.append({0.0, QCoreApplication::applicationDirPath() + "/textures/earth_clouds.jpg"});
+    std::stable_sort(series.begin(), series.end(), [](const CloudFrame& a, const CloudFrame& b) {
+        return a.time < b.time;
+    });
+
+    if (series == frames)
+        return;
+
+    frames = series;
+    retryAt.clear();
+
+    // Старые кадры больше не соответствуют индексам; незавершенное
+    // декодирование будет отброшено в pollSlots
+    for (Slot& slot : frameSlots) {
+        slot.frame = -1;
+        slot.ready = false;
+    }
+
+    // Новая серия может быть другого разрешения: без перевыделения
+    // ее кадры масштабировались бы к размеру первой
+    if (initialized) {
+        // Читается только заголовок файла
+        const QSize size = QImageReader(frames[frameAt(time)].path).size();
+        if (size.isValid() && size.boundedTo(QSize(maxTextureSize, maxTextureSize)) != frameSize)
+            allocateSlots(size);
+    }
+}
+
+void CloudLayer::allocateSlots(const QSize& size)
+{
+    frameSize = size.boundedTo(QSize(maxTextureSize, maxTextureSize));
+
+    for (Slot& slot : frameSlots) {
+        // Копирование из PBO в старую текстуру должно завершиться
+        if (slot.fence) {
+            glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+            glDeleteSync(slot.fence);
+            slot.fence = nullptr;
+        }
+        glBindTexture(GL_TEXTURE_2D, slot.texture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, frameSize.width(), frameSize.height(), 0,
+                     GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    if (memoryBudget) {
+        // Все слоты заняты постоянно
+        QVector<qint64> bytesPerMip = GpuMemoryBudget::textureBytes(frameSize.width(), frameSize.height(), 4, true);
+        for (qint64& bytes : bytesPerMip)
+            bytes *= SLOT_COUNT;
+        memoryBudget->setUsage(budgetLayer, bytesPerMip);
+    }
+}
+
+void CloudLayer::update(float deltaTime)
+{
+    time += deltaTime;
+    if (deltaTime != 0.0f)
+        direction = deltaTime > 0.0f ? 1.0f : -1.0f;
+    drift = std::fmod(drift + DRIFT_SPEED * deltaTime, 1.0f);
+
+    if (!initialized)
+        return;
+
+    pollSlots();
+
+    const int current = frameAt(time);
+    const int next = std::min(current + 1, int(frames.size()) - 1);
+    const int prefetch = direction > 0.0f ? current + 2 : current - 1;
+
+    requestFrame(current, current, next);
+    requestFrame(next, current, next);
+    if (prefetch >= 0 && prefetch < frames.size())
+        requestFrame(prefetch, current, next);
+}
+
+void CloudLayer::bind(QOpenGLShaderProgram& program, int firstUnit)
+{
+    Slot* previous = nullptr;
+    Slot* next = nullptr;
+    float blend = 0.0f;
+
+    if (initialized) {
+        const int current = frameAt(time);
+        previous = findReadySlot(current);
+        if (current + 1 < frames.size()) {
+            next = findReadySlot(current + 1);
+            const double span = frames[current + 1].time - frames[current].time;
+            if (span > 0.0)
+                blend = float(qBound(0.0, (time - frames[current].time) / span, 1.0));
+        }
+
+        // Пока нужный кадр грузится, показываем ближайший из готовых
+        if (!previous) {
+            previous = next;
+            blend = 0.0f;
+        }
+        for (int i = 0; i < SLOT_COUNT && !previous; ++i) {
+            if (frameSlots[i].ready)
+                previous = &frameSlots[i];
+        }
+        if (!next) {
+            next = previous;
+            blend = 0.0f;
+        }
+    }
+
+    program.setUniformValue("cloudsAvailable", previous != nullptr);
+    if (!previous)
+        return;
+
+    glActiveTexture(GL_TEXTURE0 + firstUnit);
+    glBindTexture(GL_TEXTURE_2D, previous->texture);
+    program.setUniformValue("cloudPrevious", firstUnit);
+
+    glActiveTexture(GL_TEXTURE0 + firstUnit + 1);
+    glBindTexture(GL_TEXTURE_2D, next->texture);
+    program.setUniformValue("cloudNext", firstUnit + 1);
+
+    program.setUniformValue("cloudBlend", blend);
+    // Дрейф имитирует движение облаков только для статичного снимка
+    program.setUniformValue("cloudDrift", frames.size() > 1 ? 0.0f : drift);
+
+    glActiveTexture(GL_TEXTURE0);
+}
+
+QVector<CloudFrame> CloudLayer::framesFromDirectory(const QString& directory, double intervalSeconds)
+{
+    QVector<CloudFrame> result;
+    QDir dir(directory);
+    const QStringList files = dir.entryList({"*.jpg", "*.jpeg", "*.png"}, QDir::Files, QDir::Name);
+    for (int i = 0; i < files.size(); ++i)
+        result.append({i * intervalSeconds, dir.filePath(files[i])});
+
+    if (result.isEmpty())
+        qWarning() << "No cloud frames found in" << directory;
+    return result;
+}
+
+QImage CloudLayer::decodeFrame(const QString& path, const QSize& size)
+{
+    QImage image(path);
+    if (image.isNull())
+        return image;
+
+    image = image.convertToFormat(QImage::Format_RGBA8888);
+    if (image.size() != size)
+        image = image.scaled(size, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+    return image;
+}
+
+void CloudLayer::requestFrame(int frame, int keepA, int keepB)
+{
+    if (findSlot(frame))
+        return;
+    // После ошибки декодирования кадр запрашивается снова не сразу
+    const auto retry = retryAt.constFind(frame);
+    if (retry != retryAt.constEnd() && retryClock.elapsed() < retry.value())
+        return;
+
+    // Свободный слот: не занят декодированием и не хранит нужные сейчас кадры
+    for (Slot& slot : frameSlots) {
+        if (slot.pending.isValid() || slot.fence)
+            continue;
+        if (slot.frame >= 0 && (slot.frame == keepA || slot.frame == keepB))
+            continue;
+
+        slot.frame = frame;
+        slot.ready = false;
+        slot.pending = QtConcurrent::run(&CloudLayer::decodeFrame, frames[frame].path, frameSize);
+        return;
+    }
+}
+
+void CloudLayer::pollSlots()
+{
+    for (Slot& slot : frameSlots) {
+        if (slot.pending.isValid() && slot.pending.isFinished()) {
+            QImage image = slot.pending.result();
+            slot.pending = QFuture<QImage>();
+
+            if (slot.frame < 0)
+                continue; // кадры заменены, пока шло декодирование
+            if (image.isNull()) {
+                // Слот освобождается, кадр будет запрошен снова через RETRY_INTERVAL_MS;
+                // предупреждение — только при первой ошибке
+                if (!retryAt.contains(slot.frame))
+                    qWarning() << "Failed to load cloud frame:" << frames[slot.frame].path;
+                retryAt.insert(slot.frame, retryClock.elapsed() + RETRY_INTERVAL_MS);
+                slot.frame = -1;
+                continue;
+            }
+            retryAt.remove(slot.frame);
+            upload(slot, image);
+        }
+
+        if (slot.fence) {
+            GLenum status = glClientWaitSync(slot.fence, 0, 0);
+            if (status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED) {
+                glDeleteSync(slot.fence);
+                slot.fence = nullptr;
+                slot.ready = slot.frame >= 0;
+            }
+        }
+    }
+}
+
+void CloudLayer::upload(Slot& slot, const QImage& image)
+{
+    const int byteCount = frameSize.width() * frameSize.height() * 4;
+
+    // Копируем кадр в PBO; сама передача в текстуру идет асинхронно
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, slot.pbo);
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, byteCount, nullptr, GL_STREAM_DRAW);
+    void* data = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, byteCount,
+                                  GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    if (!data) {
+        qWarning() << "Failed to map cloud upload buffer";
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        return;
+    }
+    for (int y = 0; y < frameSize.height(); ++y) {
+        std::memcpy(static_cast<uchar*>(data) + y * frameSize.width() * 4,
+                    image.constScanLine(y), frameSize.width() * 4);
+    }
+    glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+    glBindTexture(GL_TEXTURE_2D, slot.texture);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, frameSize.width(), frameSize.height(),
+                    GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glGenerateMipmap(GL_TEXTURE_2D);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+CloudLayer::Slot* CloudLayer::findSlot(int frame)
+{
+    for (Slot& slot : frameSlots) {
+        if (slot.frame == frame)
+            return &slot;
+    }
+    return nullptr;
+}
+
+CloudLayer::Slot* CloudLayer::findReadySlot(int frame)
+{
+    Slot* slot = findSlot(frame);
+    return slot && slot->ready ? slot : nullptr;
+}
+
+int CloudLayer::frameAt(double simulationTime) const
+{
+    // Последний кадр, начавшийся не позже simulationTime
+    auto it = std::upper_bound(frames.begin(), frames.end(), simulationTime,
+                               [](double t, const CloudFrame& frame) { return t < frame.time; });
+    return std::max(0, int(it - frames.begin()) - 1);
+}
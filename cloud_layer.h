@@ -0,0 +1,79 @@
+// cloud_layer.h
+#ifndef CLOUD_LAYER_H
+#define CLOUD_LAYER_H
+
+#include <QOpenGLExtraFunctions>
+#include <QOpenGLShaderProgram>
+#include <QFuture>
+#include <QImage>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QVector>
+#include "scene_options.h"
+#include "gpu_memory_budget.h"
+
+// Единый слой облаков для проходов Земли и атмосферы.
+// Кадры хранятся в равнопромежуточной проекции, два соседних по времени кадра
+// смешиваются в шейдере. Следующие кадры декодируются в пуле потоков и
+// загружаются через PBO, поэтому смена кадра не блокирует рендеринг.
+class CloudLayer : protected QOpenGLExtraFunctions
+{
+public:
+    CloudLayer();
+    ~CloudLayer();
+
+    // До initialize: текстуры слоя учитываются в бюджете видеопамяти
+    void setMemoryBudget(GpuMemoryBudget* budget) { memoryBudget = budget; }
+    // Требует активного OpenGL контекста
+    void initialize();
+    // Размер текстур задает кадр текущего момента; если он отличается,
+    // текстуры слотов перевыделяются (нужен активный контекст)
+    void setFrames(const QVector<CloudFrame>& frames);
+    void update(float deltaTime);
+
+    // Привязывает кадры к блокам firstUnit и firstUnit + 1 и задает uniform-ы
+    // cloudPrevious, cloudNext, cloudBlend, cloudDrift и cloudsAvailable
+    void bind(QOpenGLShaderProgram& program, int firstUnit);
+
+    // Изображения каталога по порядку имен, через равные интервалы
+    static QVector<CloudFrame> framesFromDirectory(const QString& directory, double intervalSeconds);
+
+private:
+    struct Slot {
+        GLuint texture = 0;
+        GLuint pbo = 0;
+        int frame = -1;          // индекс в frames, -1 — слот свободен
+        bool ready = false;      // текстура содержит кадр
+        GLsync fence = nullptr;  // копирование из PBO еще выполняется
+        QFuture<QImage> pending; // декодирование в пуле потоков
+    };
+
+    static QImage decodeFrame(const QString& path, const QSize& size);
+
+    void requestFrame(int frame, int keepA, int keepB);
+    void pollSlots();
+    void upload(Slot& slot, const QImage& image);
+    void allocateSlots(const QSize& size);
+    Slot* findSlot(int frame);
+    Slot* findReadySlot(int frame);
+    int frameAt(double simulationTime) const;
+
+    static constexpr int SLOT_COUNT = 3;          // текущий, следующий и предзагрузка
+    static constexpr float DRIFT_SPEED = 0.0032f; // доля оборота в секунду для статичного кадра
+    static constexpr qint64 RETRY_INTERVAL_MS = 5000; // повтор кадра, который не удалось декодировать
+
+    QVector<CloudFrame> frames;
+    Slot frameSlots[SLOT_COUNT];
+    QSize frameSize;
+    int maxTextureSize;
+    QHash<int, qint64> retryAt;  // кадр -> момент повтора по retryClock после ошибки
+    QElapsedTimer retryClock;
+    double time;      // секунды симуляции
+    float direction;  // знак последнего шага, определяет кадр предзагрузки
+    float drift;
+    bool initialized;
+    GpuMemoryBudget* memoryBudget;
+    int budgetLayer;
+};
+
+#endif // CLOUD_LAYER_H
@@ -0,0 +1,274 @@
+// conjunction_screener.cpp
+#include "conjunction_screener.h"
+#include "kepler_propagator.h"
+#include <QElapsedTimer>
+#include <QHash>
+#include <QThread>
+#include <QtConcurrent/QtConcurrent>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+namespace {
+
+// Ячейка хеша: три координаты по 21 биту
+constexpr int CELL_BITS = 21;
+constexpr int CELL_OFFSET = 1 << (CELL_BITS - 1);
+constexpr quint64 CELL_MASK = (quint64(1) << CELL_BITS) - 1;
+
+quint64 cellKey(int x, int y, int z)
+{
+    return (quint64(x + CELL_OFFSET) & CELL_MASK) << (2 * CELL_BITS) |
+           (quint64(y + CELL_OFFSET) & CELL_MASK) << CELL_BITS |
+           (quint64(z + CELL_OFFSET) & CELL_MASK);
+}
+
+int cellCoordinate(double value, double cellSize)
+{
+    const double cell = std::floor(value / cellSize);
+    return int(std::clamp(cell, double(1 - CELL_OFFSET), double(CELL_OFFSET - 2)));
+}
+
+struct CellEntry {
+    quint64 key;
+    int index;
+    int x, y, z;
+
+    bool operator<(const CellEntry& other) const { return key < other.key; }
+};
+
+struct Vector {
+    double x, y, z;
+
+    Vector(const QVector3D& v) : x(v.x()), y(v.y()), z(v.z()) {}
+    Vector(double x, double y, double z) : x(x), y(y), z(z) {}
+    Vector operator-(const Vector& o) const { return {x - o.x, y - o.y, z - o.z}; }
+    Vector operator+(const Vector& o) const { return {x + o.x, y + o.y, z + o.z}; }
+    Vector operator*(double s) const { return {x * s, y * s, z * s}; }
+    double dot(const Vector& o) const { return x * o.x + y * o.y + z * o.z; }
+    double length() const { return std::sqrt(dot(*this)); }
+};
+
+struct BlockResult {
+    QVector<Conjunction> conjunctions;
+    qint64 tested = 0;
+    qint64 candidates = 0;
+};
+
+}
+
+ConjunctionScreener::ConjunctionScreener(QObject* parent)
+    : QObject(parent)
+{
+    // Одно ядро остается кадру и глобальному пулу
+    pool.setMaxThreadCount(std::max(1, QThread::idealThreadCount() - 1));
+
+    restartTimer.setSingleShot(true);
+    connect(&restartTimer, &QTimer::timeout, this, &ConjunctionScreener::launchPending);
+    connect(&watcher, &QFutureWatcher<ConjunctionScreeningResult>::finished, this, [this]() {
+        result = watcher.result();
+        emit finished(result);
+        launchPending();
+    });
+}
+
+ConjunctionScreener::~ConjunctionScreener()
+{
+    watcher.waitForFinished();
+}
+
+void ConjunctionScreener::start(const QVector<OrbitalElements>& catalog, double startTime)
+{
+    restartPending = true;
+    pendingCatalog = catalog;
+    pendingStartTime = startTime;
+    launchPending();
+}
+
+void ConjunctionScreener::launchPending()
+{
+    // Во время поиска запрос ждет его завершения (finished вызовет снова)
+    if (!restartPending || watcher.isRunning())
+        return;
+    const qint64 wait = sinceStart.isValid() ? MIN_RESTART_INTERVAL_MS - sinceStart.elapsed() : 0;
+    if (wait > 0) {
+        if (!restartTimer.isActive())
+            restartTimer.start(int(wait));
+        return;
+    }
+
+    restartPending = false;
+    sinceStart.start();
+    const QVector<OrbitalElements> catalog = std::exchange(pendingCatalog, {});
+    const double startTime = pendingStartTime;
+    const Settings screeningSettings = settings;
+    QThreadPool* screeningPool = &pool;
+    watcher.setFuture(QtConcurrent::run(screeningPool, [catalog, startTime, screeningSettings, screeningPool]() {
+        return screen(catalog, startTime, screeningSettings, screeningPool);
+    }));
+}
+
+ConjunctionScreeningResult ConjunctionScreener::screen(const QVector<OrbitalElements>& catalog, double startTime,
+                                                       const Settings& settings, QThreadPool* pool)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    ConjunctionScreeningResult screening;
+    screening.startTime = startTime;
+    screening.duration = settings.duration;
+
+    QVector<int> objects;
+    objects.reserve(catalog.size());
+    for (int i = 0; i < catalog.size(); ++i) {
+        if (catalog[i].meanMotion > 0.0)
+            objects.append(i);
+    }
+    const int count = objects.size();
+    screening.objects = count;
+    if (count < 2 || settings.timeStep <= 0.0 || settings.duration < 0.0)
+        return screening;
+
+    const double step = settings.timeStep;
+    const double halfStep = step / 2.0;
+    const double endTime = startTime + settings.duration;
+    const int steps = int(std::ceil(settings.duration / step)) + 1;
+    screening.steps = steps;
+
+    QVector<int> blocks;
+    for (int begin = 0; begin < steps; begin += STEPS_PER_BLOCK)
+        blocks.append(begin);
+    QVector<BlockResult> blockResults(blocks.size());
+
+    QtConcurrent::blockingMap(pool, blocks, [&](int begin) {
+        BlockResult& out = blockResults[begin / STEPS_PER_BLOCK];
+        QVector<QVector3D> positions(count), velocities(count);
+        QVector<CellEntry> cells(count);
+        QHash<quint64, int> cellStart;
+
+        // Уточнение TCA: t -= (r·v) / (v·v) по точным состояниям пары
+        auto refine = [&](int first, int second, double t, double stepTime) {
+            const OrbitalElements& a = catalog[objects[first]];
+            const OrbitalElements& b = catalog[objects[second]];
+            QVector3D positionA, velocityA, positionB, velocityB;
+            double distance = 0.0, speed = 0.0;
+            for (int iteration = 0; iteration < REFINE_ITERATIONS; ++iteration) {
+                KeplerPropagator::state(a, t, positionA, velocityA);
+                KeplerPropagator::state(b, t, positionB, velocityB);
+                const Vector r = Vector(positionB) - Vector(positionA);
+                const Vector v = Vector(velocityB) - Vector(velocityA);
+                distance = r.length();
+                speed = v.length();
+                if (speed <= 0.0)
+                    break;
+                const double correction = -r.dot(v) / (speed * speed);
+                if (std::abs(correction) < 1e-3)
+                    break;
+                t += correction;
+            }
+
+            // Сближение вне окна шага найдет соседний шаг
+            if (t < stepTime - halfStep || t >= stepTime + halfStep || t < startTime || t > endTime)
+                return;
+            if (distance > settings.threshold)
+                return;
+            Conjunction conjunction;
+            conjunction.firstId = std::min(a.catalogNumber, b.catalogNumber);
+            conjunction.secondId = std::max(a.catalogNumber, b.catalogNumber);
+            conjunction.time = t;
+            conjunction.missDistance = distance;
+            conjunction.relativeSpeed = speed;
+            out.conjunctions.append(conjunction);
+        };
+
+        for (int k = begin; k < std::min(begin + STEPS_PER_BLOCK, steps); ++k) {
+            const double t = startTime + k * step;
+            double maxSpeed = 0.0;
+            double minRadius = std::numeric_limits<double>::max();
+            for (int i = 0; i < count; ++i) {
+                KeplerPropagator::state(catalog[objects[i]], t, positions[i], velocities[i]);
+                maxSpeed = std::max(maxSpeed, double(velocities[i].length()));
+                minRadius = std::min(minRadius, double(positions[i].length()));
+            }
+
+            // Ускорения объектов на расстоянии d различаются не больше чем на
+            // 3μd/r³, поэтому за полшага пара отклоняется от прямой не дальше
+            // 0.5·tidal·d·(шаг/2)²; сближаются объекты не быстрее 2·vmax
+            const double tidal = 3.0 * OrbitalElements::EARTH_MU / (minRadius * minRadius * minRadius);
+            const double curvature = 0.5 * tidal * halfStep * halfStep;
+            const double reach = settings.threshold + 2.0 * maxSpeed * halfStep;
+            const double cellSize = reach / std::max(1.0 - curvature, 0.1);
+
+            for (int i = 0; i < count; ++i) {
+                CellEntry& cell = cells[i];
+                cell.index = i;
+                cell.x = cellCoordinate(positions[i].x(), cellSize);
+                cell.y = cellCoordinate(positions[i].y(), cellSize);
+                cell.z = cellCoordinate(positions[i].z(), cellSize);
+                cell.key = cellKey(cell.x, cell.y, cell.z);
+            }
+            std::sort(cells.begin(), cells.end());
+            cellStart.clear();
+            for (int i = 0; i < count; ++i) {
+                if (i == 0 || cells[i].key != cells[i - 1].key)
+                    cellStart.insert(cells[i].key, i);
+            }
+
+            // Грубый фильтр: минимум линейного относительного движения в окне шага
+            auto test = [&](int first, int second) {
+                ++out.tested;
+                const Vector r = Vector(positions[second]) - Vector(positions[first]);
+                const Vector v = Vector(velocities[second]) - Vector(velocities[first]);
+                const double vv = v.dot(v);
+                const double tau = vv > 0.0 ? std::clamp(-r.dot(v) / vv, -halfStep, halfStep) : 0.0;
+                const double margin = curvature * r.length();
+                if ((r + v * tau).length() > settings.threshold + margin)
+                    return;
+                ++out.candidates;
+                refine(first, second, t + tau, t);
+            };
+
+            for (int runBegin = 0; runBegin < count;) {
+                int runEnd = runBegin + 1;
+                while (runEnd < count && cells[runEnd].key == cells[runBegin].key)
+                    ++runEnd;
+
+                for (int i = runBegin; i < runEnd; ++i) {
+                    for (int j = i + 1; j < runEnd; ++j)
+                        test(cells[i].index, cells[j].index);
+                }
+
+                // Половина соседей: каждая пара ячеек проверяется один раз
+                const CellEntry& cell = cells[runBegin];
+                for (int dx = -1; dx <= 1; ++dx) {
+                    for (int dy = -1; dy <= 1; ++dy) {
+                        for (int dz = -1; dz <= 1; ++dz) {
+                            if (dx < 0 || (dx == 0 && (dy < 0 || (dy == 0 && dz <= 0))))
+                                continue;
+                            auto neighbor = cellStart.constFind(cellKey(cell.x + dx, cell.y + dy, cell.z + dz));
+                            if (neighbor == cellStart.constEnd())
+                                continue;
+                            const quint64 neighborKey = neighbor.key();
+                            for (int j = *neighbor; j < count && cells[j].key == neighborKey; ++j) {
+                                for (int i = runBegin; i < runEnd; ++i)
+                                    test(cells[i].index, cells[j].index);
+                            }
+                        }
+                    }
+                }
+                runBegin = runEnd;
+            }
+        }
+    });
+
+    for (const BlockResult& block : blockResults) {
+        screening.conjunctions += block.conjunctions;
+        screening.pairsScreened += block.tested;
+        screening.candidatePairs += block.candidates;
+    }
+    std::sort(screening.conjunctions.begin(), screening.conjunctions.end(),
+              [](const Conjunction& a, const Conjunction& b) { return a.time < b.time; });
+    screening.elapsedMs = timer.nsecsElapsed() / 1.0e6;
+    return screening;
+}
@@ -0,0 +1,95 @@
+// conjunction_screener.h
+#ifndef CONJUNCTION_SCREENER_H
+#define CONJUNCTION_SCREENER_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QFutureWatcher>
+#include <QThreadPool>
+#include <QTimer>
+#include <QVector>
+#include "orbital_elements.h"
+
+// Сближение пары объектов: момент наибольшего сближения (TCA) и промах
+struct Conjunction {
+    int firstId = -1;
+    int secondId = -1;
+    double time = 0.0;          // TCA, секунды Unix
+    double missDistance = 0.0;  // м
+    double relativeSpeed = 0.0; // м/с
+};
+
+struct ConjunctionScreeningResult {
+    QVector<Conjunction> conjunctions; // по времени сближения
+    double startTime = 0.0;
+    double duration = 0.0;
+    int objects = 0;
+    int steps = 0;
+    qint64 pairsScreened = 0;   // пар из соседних ячеек, прошедших грубый фильтр за все шаги
+    qint64 candidatePairs = 0;  // прошли грубый фильтр и уточнялись
+    double elapsedMs = 0.0;
+
+    double pairsPerSecond() const { return elapsedMs > 0.0 ? pairsScreened * 1000.0 / elapsedMs : 0.0; }
+};
+
+// Поиск сближений по каталогу на интервале времени.
+//
+// Интервал делится на шаги; на каждом шаге объекты пропагируются и
+// раскладываются по пространственному хешу с ячейкой не меньше расстояния,
+// которое пара может пройти навстречу за полшага. Пары из соседних ячеек
+// проходят грубый фильтр по линейному относительному движению, кандидаты
+// уточняются итерациями по точным состояниям до момента, где r·v = 0.
+// Каждый шаг отвечает за свое окно [t - шаг/2, t + шаг/2), поэтому одно
+// сближение находится ровно один раз. Шаги обрабатываются в пуле потоков;
+// фоновый поиск идет в собственном пуле и не занимает глобальный, где
+// декодируются текстуры и строятся куски эфемерид.
+class ConjunctionScreener : public QObject {
+    Q_OBJECT
+
+public:
+    struct Settings {
+        double duration = 86400.0; // с
+        double timeStep = 60.0;    // с
+        double threshold = 5000.0; // м, порог промаха
+    };
+
+    explicit ConjunctionScreener(QObject* parent = nullptr);
+    ~ConjunctionScreener() override;
+
+    // Синхронный поиск в пуле потоков pool
+    static ConjunctionScreeningResult screen(const QVector<OrbitalElements>& catalog, double startTime,
+                                             const Settings& settings,
+                                             QThreadPool* pool = QThreadPool::globalInstance());
+
+    void setSettings(const Settings& newSettings) { settings = newSettings; }
+    const Settings& currentSettings() const { return settings; }
+
+    // Поиск в фоне, не чаще раза в MIN_RESTART_INTERVAL_MS: запросы, пришедшие
+    // во время поиска или раньше срока, сливаются в один с последним каталогом
+    void start(const QVector<OrbitalElements>& catalog, double startTime);
+    bool isRunning() const { return watcher.isRunning(); }
+    const ConjunctionScreeningResult& lastResult() const { return result; }
+
+signals:
+    void finished(const ConjunctionScreeningResult& result);
+
+private:
+    static constexpr int STEPS_PER_BLOCK = 8;   // шагов на задачу пула
+    static constexpr int REFINE_ITERATIONS = 6;
+    static constexpr int MIN_RESTART_INTERVAL_MS = 10000; // поток изменений каталога не держит поиск непрерывно
+
+    void launchPending();
+
+    Settings settings;
+    QThreadPool pool;
+    QFutureWatcher<ConjunctionScreeningResult> watcher;
+    QTimer restartTimer;
+    QElapsedTimer sinceStart;
+    ConjunctionScreeningResult result;
+
+    bool restartPending = false;
+    QVector<OrbitalElements> pendingCatalog;
+    double pendingStartTime = 0.0;
+};
+
+#endif // CONJUNCTION_SCREENER_H
@@ -0,0 +1,162 @@
+// coverage_layer.cpp
+#include "coverage_layer.h"
+#include <QDebug>
+#include <QVector2D>
+#include <QVector4D>
+#include <cmath>
+
+CoverageLayer::CoverageLayer()
+    : texture(0)
+    , framebuffer(0)
+    , halfAngle(0.0f)
+    , totalTime(0.0)
+    , cleared(false)
+    , valid(false)
+    , memoryBudget(nullptr)
+    , budgetLayer(-1)
+{
+}
+
+CoverageLayer::~CoverageLayer()
+{
+    if (memoryBudget)
+        memoryBudget->unregisterLayer(budgetLayer);
+    if (!valid)
+        return;
+
+    glDeleteFramebuffers(1, &framebuffer);
+    glDeleteTextures(1, &texture);
+    vao.destroy();
+}
+
+bool CoverageLayer::initialize()
+{
+    initializeOpenGLFunctions();
+
+    if (!program.addShaderFromSourceFile(QOpenGLShader::Vertex, ":/shaders/coverage_vertex.glsl") ||
+        !program.addShaderFromSourceFile(QOpenGLShader::Fragment, ":/shaders/coverage_fragment.glsl") ||
+        !program.link()) {
+        qDebug() << "Failed to build coverage shaders";
+        return false;
+    }
+
+    // Одноканальная float-текстура: сумма секунд без насыщения
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R32F, WIDTH, HEIGHT, 0, GL_RED, GL_FLOAT, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);       // шов по долготе
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    GLint previousFramebuffer = 0;
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previousFramebuffer);
+    glGenFramebuffers(1, &framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, 0);
+    const GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    glBindFramebuffer(GL_FRAMEBUFFER, previousFramebuffer);
+    if (status != GL_FRAMEBUFFER_COMPLETE) {
+        qDebug() << "Coverage framebuffer is incomplete:" << Qt::hex << status;
+        glDeleteFramebuffers(1, &framebuffer);
+        glDeleteTextures(1, &texture);
+        return false;
+    }
+
+    // Атрибут экземпляров задается при каждом накоплении: буфер
+    // SatelliteRenderer перевыделяется при росте набора
+    vao.create();
+    valid = true;
+
+    if (memoryBudget) {
+        budgetLayer = memoryBudget->registerLayer("coverage", GpuMemoryBudget::Priority::Normal);
+        memoryBudget->setUsage(budgetLayer, GpuMemoryBudget::textureBytes(WIDTH, HEIGHT, 4, false));
+    }
+    return true;
+}
+
+void CoverageLayer::setHalfAngle(float radians)
+{
+    if (radians == halfAngle)
+        return;
+    halfAngle = radians;
+    clear();
+}
+
+void CoverageLayer::clear()
+{
+    totalTime = 0.0;
+    cleared = false;
+}
+
+void CoverageLayer::accumulate(GLuint instanceBuffer, int count, float earthRadius, float seconds,
+                               const QMatrix3x3& inertialToFixed)
+{
+    if (!isActive())
+        return;
+
+    // Обратный ход времени тоже проходит эти положения
+    seconds = std::abs(seconds);
+    if (seconds <= 0.0f && cleared)
+        return;
+
+    GLint previousFramebuffer = 0;
+    GLint viewport[4];
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previousFramebuffer);
+    glGetIntegerv(GL_VIEWPORT, viewport);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glViewport(0, 0, WIDTH, HEIGHT);
+    if (!cleared) {
+        const GLfloat zero[] = {0.0f, 0.0f, 0.0f, 0.0f};
+        glClearBufferfv(GL_COLOR, 0, zero);
+        cleared = true;
+    }
+
+    if (count > 0 && seconds > 0.0f && program.bind()) {
+        glDisable(GL_DEPTH_TEST);
+        glDisable(GL_CULL_FACE);
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_ONE, GL_ONE);
+
+        program.setUniformValue("earthRadius", earthRadius);
+        program.setUniformValue("halfAngle", halfAngle);
+        program.setUniformValue("targetSize", QVector2D(WIDTH, HEIGHT));
+        program.setUniformValue("weight", seconds);
+        program.setUniformValue("inertialToFixed", inertialToFixed);
+
+        vao.bind();
+        glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(QVector4D), nullptr);
+        glVertexAttribDivisor(0, 2);
+        glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, 2 * count);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        vao.release();
+        program.release();
+
+        // Состояние сцены, заданное в SceneRenderer::initialize
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        glEnable(GL_CULL_FACE);
+        glEnable(GL_DEPTH_TEST);
+        totalTime += seconds;
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, previousFramebuffer);
+    glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+}
+
+void CoverageLayer::bind(QOpenGLShaderProgram& target, int unit)
+{
+    const bool available = isActive() && totalTime > 0.0;
+    target.setUniformValue("coverageAvailable", available);
+    if (!available)
+        return;
+
+    glActiveTexture(GL_TEXTURE0 + unit);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    target.setUniformValue("coverageMap", unit);
+    target.setUniformValue("coverageScale", float(1.0 / totalTime));
+    glActiveTexture(GL_TEXTURE0);
+}
@@ -0,0 +1,62 @@
+// coverage_layer.h
+#ifndef COVERAGE_LAYER_H
+#define COVERAGE_LAYER_H
+
+#include <QOpenGLExtraFunctions>
+#include <QOpenGLShaderProgram>
+#include <QOpenGLVertexArrayObject>
+#include <QGenericMatrix>
+#include "gpu_memory_budget.h"
+
+// Накопленное покрытие поверхности зонами обзора спутников.
+// Текстура в равнопромежуточной проекции с той же разверткой, что у сетки
+// Земли (u = θ/2π, v = φ/π); каждый шаг симуляции зоны всех спутников
+// добавляются в нее аддитивным смешиванием, без пересчета с начала.
+// Тексель хранит сумму секунд, проведенных точкой в зонах обзора; деленная
+// на накопленное время, она дает среднее число спутников над точкой.
+class CoverageLayer : protected QOpenGLExtraFunctions
+{
+public:
+    CoverageLayer();
+    ~CoverageLayer();
+
+    // До initialize: текстура учитывается в бюджете видеопамяти
+    void setMemoryBudget(GpuMemoryBudget* budget) { memoryBudget = budget; }
+    // Требует активного OpenGL контекста
+    bool initialize();
+    bool isValid() const { return valid; }
+    bool isActive() const { return valid && halfAngle > 0.0f; }
+
+    // Полуугол конуса сенсора в радианах; смена обнуляет накопление
+    void setHalfAngle(float radians);
+    void clear();
+
+    // Добавляет зоны count экземпляров буфера instanceBuffer (vec4, xyz —
+    // положение в инерциальной системе сцены) с весом seconds; inertialToFixed
+    // поворачивает их в земную систему сетки на текущий момент
+    void accumulate(GLuint instanceBuffer, int count, float earthRadius, float seconds,
+                    const QMatrix3x3& inertialToFixed);
+
+    // Привязывает текстуру к блоку unit и задает uniform-ы coverageMap,
+    // coverageScale и coverageAvailable
+    void bind(QOpenGLShaderProgram& program, int unit);
+
+    double accumulatedTime() const { return totalTime; }
+
+private:
+    static constexpr int WIDTH = 1024;
+    static constexpr int HEIGHT = 512;
+
+    QOpenGLShaderProgram program;
+    QOpenGLVertexArrayObject vao;
+    GLuint texture;
+    GLuint framebuffer;
+    float halfAngle;
+    double totalTime;  // секунды симуляции с последнего сброса
+    bool cleared;      // текстура обнулена на GPU
+    bool valid;
+    GpuMemoryBudget* memoryBudget;
+    int budgetLayer;
+};
+
+#endif // COVERAGE_LAYER_H
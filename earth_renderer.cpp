@@ -1,11 +1,14 @@
 // earth_renderer.cpp
 #include "earth_renderer.h"
+#include "solar_ephemeris.h"
 #include <QDebug>
 #include <QtMath>
 #include <QCoreApplication>
 
 EarthRenderer::EarthRenderer(float earthRadius)
-    : radius(earthRadius)
+    : cloudLayer(std::make_unique<CloudLayer>())
+    , coverageLayer(std::make_unique<CoverageLayer>())
+    , radius(earthRadius)
 {
 }
 
@@ -28,10 +31,45 @@ void EarthRenderer::initialize() {
     initShaders();
     initTextures();
     initGeometry();
+    cloudLayer->setMemoryBudget(memoryBudget);
+    coverageLayer->setMemoryBudget(memoryBudget);
+    cloudLayer->initialize();
+    if (!coverageLayer->initialize())
+        qWarning() << "Coverage heatmap is unavailable";
 
     // Инициализируем атмосферу с тем же радиусом
     atmosphereRenderer = std::make_unique<AtmosphereRenderer>(radius);
+    atmosphereRenderer->setCloudLayer(cloudLayer.get());
+    atmosphereRenderer->setMemoryBudget(memoryBudget);
     atmosphereRenderer->initialize();
+    atmosphereRenderer->setScatteringEnabled(atmosphereScattering);
+}
+
+void EarthRenderer::setAtmosphereScattering(bool enabled) {
+    atmosphereScattering = enabled;
+    if (atmosphereRenderer)
+        atmosphereRenderer->setScatteringEnabled(enabled);
+}
+
+void EarthRenderer::setCloudFrames(const QVector<CloudFrame>& frames) {
+    cloudLayer->setFrames(frames);
+}
+
+void EarthRenderer::setCoverageHalfAngle(float degrees) {
+    coverageLayer->setHalfAngle(qDegreesToRadians(degrees));
+}
+
+void EarthRenderer::accumulateCoverage(GLuint instanceBuffer, int count, float seconds) {
+    // Спутники в инерциальной системе сцены, карта — в земной: подспутниковые
+    // точки поворачиваются обратно на звездное время, и каждый виток ложится
+    // на новые долготы
+    QMatrix4x4 inertialToFixed;
+    inertialToFixed.rotate(-rotationDegrees(), 0.0f, 1.0f, 0.0f);
+    coverageLayer->accumulate(instanceBuffer, count, radius, seconds, inertialToFixed.toGenericMatrix<3, 3>());
+}
+
+float EarthRenderer::rotationDegrees() const {
+    return float(qRadiansToDegrees(SolarEphemeris::siderealAngle(unixTime)));
 }
 
 void EarthRenderer::initShaders() {
@@ -61,6 +99,11 @@ void EarthRenderer::initTextures() {
     normalMapTiles = std::make_unique<TileTextureManager>(
         buildDir + "/textures/earth_normal.png", RINGS, SEGMENTS);
 
+    // Под давлением бюджета первыми уменьшаются вспомогательные карты
+    earthTextureTiles->setMemoryBudget(memoryBudget, GpuMemoryBudget::Priority::High);
+    heightMapTiles->setMemoryBudget(memoryBudget, GpuMemoryBudget::Priority::Normal);
+    normalMapTiles->setMemoryBudget(memoryBudget, GpuMemoryBudget::Priority::Normal);
+
     earthTextureTiles->initialize();
     heightMapTiles->initialize();
     normalMapTiles->initialize();
@@ -68,8 +111,6 @@ void EarthRenderer::initTextures() {
     // Новые текстуры
     nightLightsTiles = std::make_unique<TileTextureManager>(
         buildDir + "/textures/earth_night.jpg", RINGS, SEGMENTS);
-    cloudTiles = std::make_unique<TileTextureManager>(
-        buildDir + "/textures/earth_clouds.jpg", RINGS, SEGMENTS);
     specularTiles = std::make_unique<TileTextureManager>(
         buildDir + "/textures/earth_specular.jpg", RINGS, SEGMENTS);
     temperatureTiles = std::make_unique<TileTextureManager>(
@@ -77,11 +118,18 @@ void EarthRenderer::initTextures() {
     snowTiles = std::make_unique<TileTextureManager>(
         buildDir + "/textures/earth_snow.jpg", RINGS, SEGMENTS);
 
+    nightLightsTiles->setMemoryBudget(memoryBudget, GpuMemoryBudget::Priority::Normal);
+    specularTiles->setMemoryBudget(memoryBudget, GpuMemoryBudget::Priority::Low);
+    temperatureTiles->setMemoryBudget(memoryBudget, GpuMemoryBudget::Priority::Low);
+    snowTiles->setMemoryBudget(memoryBudget, GpuMemoryBudget::Priority::Low);
+
     nightLightsTiles->initialize();
-    cloudTiles->initialize();
     specularTiles->initialize();
     temperatureTiles->initialize();
     snowTiles->initialize();
+
+    earthTextureTiles->setLoadBudget(TILE_LOADS_PER_FRAME);
+    motionClock.start();
 }
 
 void EarthRenderer::initGeometry() {
@@ -96,7 +144,22 @@ void EarthRenderer::initGeometry() {
     vao.release();
 }
 
-void EarthRenderer::render(const QMatrix4x4& projection, const QMatrix4x4& view, const QMatrix4x4& model) {
+void EarthRenderer::render(const QMatrix4x4& projection, const QMatrix4x4& view, const QMatrix4x4& sceneModel) {
+    // Сетка, облака и покрытие заданы в земной системе; в инерциальную
+    // сцену, где летают спутники, их переводит поворот вокруг полюса
+    QMatrix4x4 model = sceneModel;
+    model.rotate(rotationDegrees(), 0.0f, 1.0f, 0.0f);
+    // Солнце — в инерциальной системе, как для освещенности спутников
+    const QVector3D sunDirection = sceneModel.mapVector(SolarEphemeris::position(unixTime)).normalized();
+
+    // Атласы, уменьшенные бюджетом, растут обратно, когда место освободилось;
+    // порядок — от основного цвета к вспомогательным картам
+    for (TileTextureManager* tiles : {earthTextureTiles.get(), heightMapTiles.get(), normalMapTiles.get(),
+                                      nightLightsTiles.get(), specularTiles.get(), temperatureTiles.get(),
+                                      snowTiles.get()})
+        tiles->restoreAtlas();
+    updateVisibleTiles(projection, view, model);
+
     if (!program.bind())
         return;
 
@@ -117,7 +180,7 @@ void EarthRenderer::render(const QMatrix4x4& projection, const QMatrix4x4& view,
     // Установка параметров освещения
     QVector3D cameraPos = view.inverted().column(3).toVector3D();
     program.setUniformValue("viewPos", cameraPos);
-    program.setUniformValue("lightPos", cameraPos); // или другая позиция источника света
+    program.setUniformValue("sunDirection", sunDirection);
 
     // Важно! Установка масштаба высоты
     program.setUniformValue("heightScale", 0.05f);
@@ -140,9 +203,17 @@ void EarthRenderer::render(const QMatrix4x4& projection, const QMatrix4x4& view,
     nightLightsTiles->bindTileTexture(0, 0);
     program.setUniformValue("nightLightMap", 3);
 
-    // glActiveTexture(GL_TEXTURE4);
-    // cloudTiles->bindTileTexture(0, 0);
-    // program.setUniformValue("cloudMap", 4);
+    // Облака занимают блоки 8 и 9; в классическом режиме их рисует оболочка атмосферы
+    cloudLayer->bind(program, 8);
+    // Пока таблицы рассеяния строятся, облака рисует текстурная оболочка
+    const bool scatteringActive = atmosphereRenderer && atmosphereRenderer->isScatteringActive();
+    program.setUniformValue("cloudOpacity", scatteringActive ? 0.5f : 0.0f);
+
+    // Тепловая карта покрытия — блок 10
+    coverageLayer->bind(program, 10);
+
+    // Загруженные тайлы цветовой карты — блоки 11 и 12, поверх атласа
+    earthTextureTiles->bindTiles(program, 11, 12);
 
     glActiveTexture(GL_TEXTURE5);
     specularTiles->bindTileTexture(0, 0);
@@ -163,21 +234,51 @@ void EarthRenderer::render(const QMatrix4x4& projection, const QMatrix4x4& view,
     program.release();
 
     // if (atmosphereRenderer) {
+        atmosphereRenderer->setSunDirection(sunDirection);
         atmosphereRenderer->render(projection, view, model);
     // }
 }
 
+void EarthRenderer::update(float deltaTime) {
+    cloudLayer->update(deltaTime);
+}
+
 void EarthRenderer::createSphere() {
+    buildSphereMesh(radius, RINGS, SEGMENTS, earthTextureTiles->getAllTileUVCoords(), vertices, indices);
+
+    vbo.bind();
+    vbo.allocate(vertices.constData(), vertices.size() * sizeof(Vertex));
+
+    ibo.bind();
+    ibo.allocate(indices.constData(), indices.size() * sizeof(GLuint));
+
+    program.enableAttributeArray("position");
+    program.setAttributeBuffer("position", GL_FLOAT, offsetof(Vertex, position), 3, sizeof(Vertex));
+
+    program.enableAttributeArray("texCoord");
+    program.setAttributeBuffer("texCoord", GL_FLOAT, offsetof(Vertex, texCoord), 2, sizeof(Vertex));
+
+    program.enableAttributeArray("normal");
+    program.setAttributeBuffer("normal", GL_FLOAT, offsetof(Vertex, normal), 3, sizeof(Vertex));
+
+    program.enableAttributeArray("tileCoord");
+    program.setAttributeBuffer("tileCoord", GL_FLOAT, offsetof(Vertex, tileCoord), 2, sizeof(Vertex));
+}
+
+void EarthRenderer::buildSphereMesh(float radius, int rings, int segments, const QVector<QRectF>& tileUVs,
+                                    QVector<Vertex>& vertices, QVector<GLuint>& indices) {
     vertices.clear();
     indices.clear();
 
-    for (int ring = 0; ring < RINGS; ++ring) {
-        float phi1 = M_PI * float(ring) / RINGS;
-        float phi2 = M_PI * float(ring + 1) / RINGS;
+    const bool hasAtlas = tileUVs.size() >= rings * segments;
+
+    for (int ring = 0; ring < rings; ++ring) {
+        float phi1 = M_PI * float(ring) / rings;
+        float phi2 = M_PI * float(ring + 1) / rings;
 
-        for (int segment = 0; segment < SEGMENTS; ++segment) {
-            float theta1 = 2.0f * M_PI * float(segment) / SEGMENTS;
-            float theta2 = 2.0f * M_PI * float(segment + 1) / SEGMENTS;
+        for (int segment = 0; segment < segments; ++segment) {
+            float theta1 = 2.0f * M_PI * float(segment) / segments;
+            float theta2 = 2.0f * M_PI * float(segment + 1) / segments;
 
             QVector3D v1 = sphericalToCartesian(radius, phi1, theta1);
             QVector3D v2 = sphericalToCartesian(radius, phi1, theta2);
@@ -185,7 +286,9 @@ void EarthRenderer::createSphere() {
             QVector3D v4 = sphericalToCartesian(radius, phi2, theta1);
 
             // Получаем UV-координаты из атласа текстур
-            QRectF uvCoords = earthTextureTiles->getTileUVCoords(ring, segment);
+            QRectF uvCoords = hasAtlas
+                ? tileUVs[ring * segments + segment]
+                : QRectF(float(segment) / segments, float(ring) / rings, 1.0f / segments, 1.0f / rings);
             QVector2D uv1(uvCoords.left(), uvCoords.top());
             QVector2D uv2(uvCoords.right(), uvCoords.top());
             QVector2D uv3(uvCoords.right(), uvCoords.bottom());
@@ -211,33 +314,52 @@ void EarthRenderer::createSphere() {
             indices.append(baseIndex + 3);
         }
     }
+}
 
-    vbo.bind();
-    vbo.allocate(vertices.constData(), vertices.size() * sizeof(Vertex));
-
-    ibo.bind();
-    ibo.allocate(indices.constData(), indices.size() * sizeof(GLuint));
-
-    program.enableAttributeArray("position");
-    program.setAttributeBuffer("position", GL_FLOAT, offsetof(Vertex, position), 3, sizeof(Vertex));
-
-    program.enableAttributeArray("texCoord");
-    program.setAttributeBuffer("texCoord", GL_FLOAT, offsetof(Vertex, texCoord), 2, sizeof(Vertex));
-
-    program.enableAttributeArray("normal");
-    program.setAttributeBuffer("normal", GL_FLOAT, offsetof(Vertex, normal), 3, sizeof(Vertex));
+void EarthRenderer::updateVisibleTiles(const QMatrix4x4& projection, const QMatrix4x4& view, const QMatrix4x4& model) {
+    if (!tileStreaming) {
+        // Выключили — пул тайлов освобождается целиком
+        if (!tileRequests.isEmpty()) {
+            tileRequests.clear();
+            earthTextureTiles->releaseTiles();
+        }
+        missingTiles = 0.0f;
+        return;
+    }
 
-    program.enableAttributeArray("tileCoord");
-    program.setAttributeBuffer("tileCoord", GL_FLOAT, offsetof(Vertex, tileCoord), 2, sizeof(Vertex));
-}
+    cameraMotion.observe(view, motionClock.nsecsElapsed() / 1.0e9);
+
+    // Тайлы проверяются на единичной сфере; камера в ее координатах нужна
+    // для отсечения за горизонтом
+    QMatrix4x4 unitSphere = model;
+    unitSphere.scale(radius);
+    const QMatrix4x4 viewProjection = projection * view * unitSphere;
+    auto eyeOf = [&unitSphere](const QMatrix4x4& viewMatrix) {
+        return (viewMatrix * unitSphere).inverted().column(3).toVector3D();
+    };
+
+    // Заявки пересчитываются, только когда камера сдвинулась или движется:
+    // у неподвижной камеры набор тот же, кадр лишь догружает очередь
+    const bool moving = cameraMotion.isMoving();
+    if (moving || viewProjection != lastTileViewProjection || tileRequests.isEmpty()) {
+        QVector<PredictedView> views{PredictedView{viewProjection, eyeOf(view), 0.0f}};
+        if (moving) {
+            for (int step = 1; step <= PREFETCH_STEPS; ++step) {
+                const float ahead = PREFETCH_HORIZON * step / PREFETCH_STEPS;
+                const QMatrix4x4 predicted = cameraMotion.predictView(ahead);
+                views.append(PredictedView{projection * predicted * unitSphere, eyeOf(predicted), ahead});
+            }
+        }
+        tileRequests = earthTextureTiles->collectRequests(views);
+        lastTileViewProjection = viewProjection;
+    }
 
-void EarthRenderer::updateVisibleTiles(const QMatrix4x4& viewProjection) {
-    earthTextureTiles->updateVisibleTiles(viewProjection);
-    heightMapTiles->updateVisibleTiles(viewProjection);
-    normalMapTiles->updateVisibleTiles(viewProjection);
+    earthTextureTiles->requestTiles(tileRequests);
+    const int visible = earthTextureTiles->visibleTileCount();
+    missingTiles = visible > 0 ? float(earthTextureTiles->missingTileCount()) / visible : 0.0f;
 }
 
-QVector3D EarthRenderer::sphericalToCartesian(float radius, float phi, float theta) const {
+QVector3D EarthRenderer::sphericalToCartesian(float radius, float phi, float theta) {
     float x = radius * sin(phi) * cos(theta);
     float y = radius * cos(phi);
     float z = radius * sin(phi) * sin(theta);
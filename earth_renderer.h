@@ -5,46 +5,91 @@
 #include "renderer.h"
 #include "tile_texture_manager.h"
 #include "atmosphere_renderer.h"
+#include "cloud_layer.h"
+#include "coverage_layer.h"
+#include "camera_motion_predictor.h"
+#include "gpu_memory_budget.h"
 #include <QOpenGLBuffer>
 #include <QMatrix4x4>
+#include <QElapsedTimer>
 
 class EarthRenderer : public Renderer {
 public:
+    struct Vertex {
+        QVector3D position;
+        QVector2D texCoord;
+        QVector3D normal;
+        QVector2D tileCoord;  // Координаты тайла (ring, segment)
+    };
+
     explicit EarthRenderer(float radius);
     ~EarthRenderer() override;
 
+    // До initialize: все текстурные слои регистрируются в бюджете видеопамяти
+    void setMemoryBudget(GpuMemoryBudget* budget) { memoryBudget = budget; }
     void initialize() override;
     void render(const QMatrix4x4& projection, const QMatrix4x4& view, const QMatrix4x4& model) override;
+    void update(float deltaTime) override;
+    // Момент симуляции в секундах Unix: сетка Земли повернута на звездное время
+    void setUnixTime(double time) { unixTime = time; }
+    void setAtmosphereScattering(bool enabled);
+    void setCloudFrames(const QVector<CloudFrame>& frames);
+    // Подгрузка тайлов цветовой карты полного разрешения по движению камеры:
+    // шейдер берет загруженный тайл вместо ячейки атласа. Остальные карты
+    // остаются атласами
+    void setTileStreaming(bool enabled) { tileStreaming = enabled; }
+    // Полуугол сенсора в градусах; 0 выключает тепловую карту покрытия
+    void setCoverageHalfAngle(float degrees);
+    // Добавляет зоны обзора спутников из буфера экземпляров за seconds секунд симуляции
+    void accumulateCoverage(GLuint instanceBuffer, int count, float seconds);
+    bool coverageActive() const { return coverageLayer->isActive(); }
+    // Доля видимых в последнем кадре тайлов, которых не было в пуле цветовой карты
+    float missingTileFraction() const { return missingTiles; }
+
+    // Сетка сферы по тайлам; tileUVs — прямоугольники тайлов в атласе (ring * segments + segment).
+    // Без атласа UV покрывают текстуру целиком
+    static void buildSphereMesh(float radius, int rings, int segments, const QVector<QRectF>& tileUVs,
+                                QVector<Vertex>& vertices, QVector<GLuint>& indices);
 
 private:
     void initShaders();
     void initTextures();
     void initGeometry();
     void createSphere();
-    void updateVisibleTiles(const QMatrix4x4& viewProjection);
+    void updateVisibleTiles(const QMatrix4x4& projection, const QMatrix4x4& view, const QMatrix4x4& model);
+    // Поворот земной системы в инерциальную на звездное время, градусы
+    float rotationDegrees() const;
 
     static constexpr int RINGS = 128;     // Увеличено для лучшей детализации
     static constexpr int SEGMENTS = 128;   // Увеличено для лучшей детализации
+    static constexpr float PREFETCH_HORIZON = 0.3f; // с, насколько вперед предсказывается камера
+    static constexpr int PREFETCH_STEPS = 3;        // предсказанных видов на горизонте
+    static constexpr int TILE_LOADS_PER_FRAME = 32; // загрузок в видеопамять на слой
 
     std::unique_ptr<TileTextureManager> earthTextureTiles;
     std::unique_ptr<TileTextureManager> heightMapTiles;
     std::unique_ptr<TileTextureManager> normalMapTiles;
 
     std::unique_ptr<TileTextureManager> nightLightsTiles;
-    std::unique_ptr<TileTextureManager> cloudTiles;
     std::unique_ptr<TileTextureManager> specularTiles;
     std::unique_ptr<TileTextureManager> temperatureTiles;
     std::unique_ptr<TileTextureManager> snowTiles;
+    std::unique_ptr<CloudLayer> cloudLayer;  // общий для Земли и атмосферы
+    std::unique_ptr<CoverageLayer> coverageLayer;
     std::unique_ptr<AtmosphereRenderer> atmosphereRenderer;
 
     float radius;
+    double unixTime = 0.0;
+    bool atmosphereScattering = false;
+    GpuMemoryBudget* memoryBudget = nullptr; // принадлежит SceneRenderer
 
-    struct Vertex {
-        QVector3D position;
-        QVector2D texCoord;
-        QVector3D normal;
-        QVector2D tileCoord;  // Координаты тайла (ring, segment)
-    };
+    // Подгрузка тайлов на опережение по движению камеры
+    bool tileStreaming = false;
+    CameraMotionPredictor cameraMotion;
+    QElapsedTimer motionClock;
+    QMatrix4x4 lastTileViewProjection;
+    QVector<TileRequest> tileRequests;
+    float missingTiles = 0.0f;
 
     QOpenGLVertexArrayObject vao;
     QOpenGLBuffer vbo{QOpenGLBuffer::VertexBuffer};
@@ -53,7 +98,7 @@ private:
     QVector<Vertex> vertices;
     QVector<GLuint> indices;
 
-    QVector3D sphericalToCartesian(float radius, float phi, float theta) const;
+    static QVector3D sphericalToCartesian(float radius, float phi, float theta);
 };
 
 #endif // EARTH_RENDERER_H
@@ -1,46 +1,64 @@
 // earthwidget.cpp
 #include "earthwidget.h"
+#include "satellite_picking.h"
+#include "session_log.h"
+#include "session_replay.h"
 #include <QMouseEvent>
 #include <QTimer>
-#include <QPainter>
+#include <QOpenGLContext>
+#include <QOpenGLExtraFunctions>
 #include <QtMath>
+#include <cmath>
+#include <algorithm>
 #include <qimagereader.h>
 
 EarthWidget::EarthWidget(QWidget *parent)
     : QOpenGLWidget(parent)
     , camera(EARTH_RADIUS)
+    , sceneRenderer(nullptr)
+    , renderThread(nullptr)
+    , threadedRendering(false)
+    , textRenderer(nullptr)
+    , labelPlacer(EARTH_RADIUS)
+    , satelliteLabelsVisible(false)
+    , gpuProfiler(nullptr)
+    , profilerVisible(false)
     , isMousePressed(false)
     , isAnimating(true)
     , selectedSatelliteId(-1)
-    , rotationAngle(0.0f)
+    , optionsDirty(true)
+    , satellitesDirty(true)
+    , trajectoriesDirty(false)
+    , sceneDirty(true)
+    , pendingDeltaTime(0.0f)
+    , simulationStarted(false)
+    , sessionRecorder(nullptr)
+    , sessionReplay(nullptr)
 {
     QImageReader::setAllocationLimit(0);
     setupSurfaceFormat();
     setFocusPolicy(Qt::StrongFocus);
     setUpdateBehavior(QOpenGLWidget::NoPartialUpdate);
 
-    earthRenderer = new EarthRenderer(EARTH_RADIUS);
-    satelliteRenderer = new SatelliteRenderer();
-    trajectoryRenderer = new TrajectoryRenderer();
     fpsRenderer = new FPSRenderer();
     satelliteInfoRenderer = new SatelliteInfoRenderer();
 
-    animationTimer = new QTimer(this);
-    connect(animationTimer, &QTimer::timeout, [this]() {
-        if (isAnimating) {
-            rotationAngle += 1.0f;
-            update();
-        }
-    });
-    animationTimer->start(16);
+    scheduler = new FrameScheduler(this);
+    scheduler->setAnimating(!clock.isPaused());
 }
 
 EarthWidget::~EarthWidget()
 {
+    // Поток рендеринга останавливаем до разрушения разделяемого контекста
+    delete renderThread;
+
     makeCurrent();
-    delete earthRenderer;
-    delete satelliteRenderer;
-    delete trajectoryRenderer;
+    delete sceneRenderer;
+    delete textRenderer;
+    delete gpuProfiler;
+    if (compositeVao.isCreated())
+        compositeVao.destroy();
+    compositeProgram.removeAllShaders();
     delete fpsRenderer;
     delete satelliteInfoRenderer;
     doneCurrent();
@@ -59,40 +77,65 @@ void EarthWidget::setupSurfaceFormat()
     QSurfaceFormat::setDefaultFormat(format);
 }
 
+void EarthWidget::setSceneOptions(const SceneOptions& newOptions)
+{
+    if (newOptions.proceduralOrbits != options.proceduralOrbits)
+        trajectoriesDirty = true;
+    options = newOptions;
+    optionsDirty = true;
+    invalidateScene();
+}
+
+void EarthWidget::setThreadedRendering(bool enabled)
+{
+    if (renderThread || sceneRenderer) {
+        qDebug() << "Threaded rendering must be configured before the widget is shown";
+        return;
+    }
+    threadedRendering = enabled;
+}
+
 void EarthWidget::initializeGL()
 {
     // Убедитесь, что контекст OpenGL активен
     makeCurrent();
 
-    // Инициализируем базовые функции OpenGL для каждого рендерера
-    if (!earthRenderer->init() ||
-        !satelliteRenderer->init() ||
-        !trajectoryRenderer->init()) {
-        qDebug() << "Failed to initialize OpenGL functions for renderers";
-        return;
-    }
+    if (threadedRendering) {
+        initCompositor();
 
-    // Теперь можно инициализировать рендереры
-    earthRenderer->initialize();
-    satelliteRenderer->initialize();
-    trajectoryRenderer->initialize();
+        renderThread = new RenderThread(context(), EARTH_RADIUS, options);
+        // Готовый кадр нужно только вывести на экран, сцена не изменилась
+        connect(renderThread, &RenderThread::frameReady, this, [this]() { scheduler->invalidate(); });
+        renderThread->start();
+    } else {
+        sceneRenderer = new SceneRenderer(EARTH_RADIUS);
+        sceneRenderer->initialize(options);
+    }
 
-    // Настройка параметров рендеринга
-    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    textRenderer = new TextRenderer();
+    textRenderer->init();
+    textRenderer->initialize();
 
-    // Включаем и настраиваем тест глубины
-    glEnable(GL_DEPTH_TEST);
-    glDepthFunc(GL_LESS);  // Добавлено: стандартная функция теста глубины
-    glDepthMask(GL_TRUE);  // Добавлено: разрешаем запись в буфер глубины
+    gpuProfiler = new GpuProfiler();
+    gpuProfiler->initialize();
 
-    // Включаем отсечение задних граней
-    glEnable(GL_CULL_FACE);
-    glCullFace(GL_BACK);   // Добавлено: отсекаем задние грани
-    glFrontFace(GL_CCW);   // Добавлено: определяем порядок вершин для передней грани
+    optionsDirty = true;
+    satellitesDirty = true;
+    trajectoriesDirty = true;
+    sceneDirty = true;
+}
 
-    glEnable(GL_MULTISAMPLE);
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+void EarthWidget::initCompositor()
+{
+    if (!compositeProgram.addShaderFromSourceFile(QOpenGLShader::Vertex, ":/shaders/composite_vertex.glsl"))
+        qDebug() << "Failed to compile composite vertex shader";
+    if (!compositeProgram.addShaderFromSourceFile(QOpenGLShader::Fragment, ":/shaders/composite_fragment.glsl"))
+        qDebug() << "Failed to compile composite fragment shader";
+    if (!compositeProgram.link())
+        qDebug() << "Failed to link composite shader program";
+
+    // Core profile требует VAO даже для отрисовки без атрибутов
+    compositeVao.create();
 }
 
 void EarthWidget::resizeGL(int w, int h)
@@ -100,37 +143,261 @@ void EarthWidget::resizeGL(int w, int h)
     float aspect = float(w) / float(h ? h : 1);
     projection.setToIdentity();
     projection.perspective(45.0f, aspect, EARTH_RADIUS * 0.1f, EARTH_RADIUS * 100.0f);
+
+    if (renderThread) {
+        RenderCommand command;
+        command.type = RenderCommand::Type::Resize;
+        command.size = QSize(w, h) * devicePixelRatio();
+        renderThread->post(std::move(command));
+    }
+    invalidateScene();
+}
+
+void EarthWidget::invalidateScene()
+{
+    sceneDirty = true;
+    scheduler->invalidate();
+}
+
+void EarthWidget::advanceSimulation()
+{
+    if (sessionReplay) {
+        // События записи применяются до шага часов, как при записи; пока
+        // кадр не наступил, часы стоят
+        double realDelta = 0.0, simulationTime = clock.simulationTime();
+        sessionReplay->advanceFrame(realDelta, simulationTime);
+        clock.tick(realDelta, simulationTime);
+    } else {
+        clock.tick();
+    }
+    if (sessionRecorder)
+        sessionRecorder->frame(clock.realDeltaTime(), clock.simulationTime());
+    float deltaTime = clock.deltaTime();
+
+    pendingDeltaTime += deltaTime;
+
+    // На паузе время стоит — пропагатор пересчитывать нечего
+    if (deltaTime != 0.0f || !simulationStarted) {
+        simulationStarted = true;
+        sceneDirty = true;
+        ProfileScope scope("propagation");
+        emit simulationAdvanced(clock.simulationTime());
+    }
+}
+
+void EarthWidget::syncScene(const QMatrix4x4& viewMatrix)
+{
+    bool trajectoryVisible = selectedSatelliteId != -1;
+
+    // Траектории лежат в холодной таблице; контейнеры разделяются без копирования
+    QVector<QVector3D> trajectory, futureTrajectory;
+    if (const SatelliteStore::ColdRecord* record = satellites.coldRecord(selectedSatelliteId)) {
+        trajectory = record->trajectory;
+        futureTrajectory = record->futureTrajectory;
+    }
+
+    // Дуги орбиты вместо ломаных: виток вокруг текущего положения и четверть витка вперед
+    QVector<OrbitLine> orbitLines;
+    const int selectedSlot = satellites.slotOf(selectedSatelliteId);
+    if (options.proceduralOrbits && selectedSlot != -1 && !satellites.orbits().isEmpty() &&
+        satellites.orbits()[selectedSlot].isValid()) {
+        const SatelliteOrbit& orbit = satellites.orbits()[selectedSlot];
+        const float period = float(orbit.period());
+        orbitLines.append({orbit, -0.5f * period, period, QVector4D(1.0f, 1.0f, 1.0f, 1.0f)});
+        orbitLines.append({orbit, 0.0f, 0.25f * period, QVector4D(0.0f, 1.0f, 1.0f, 1.0f)});
+        trajectory.clear();
+        futureTrajectory.clear();
+    }
+
+    const double unixTime = clock.epoch().toMSecsSinceEpoch() / 1000.0 + clock.simulationTime();
+    // post не ждет места в очереди: не принятые изменения остаются здесь
+    // и уходят следующим кадром
+    bool advancePosted = true;
+    bool satellitesPosted = true;
+
+    if (sceneRenderer) {
+        if (optionsDirty)
+            sceneRenderer->setOptions(options);
+        sceneRenderer->update(pendingDeltaTime);
+        sceneRenderer->setUnixTime(unixTime);
+        if (satellitesDirty)
+            sceneRenderer->setSatellites(satellites);
+        else if (!pendingSatelliteChanges.isEmpty())
+            sceneRenderer->applySatelliteChanges(pendingSatelliteChanges);
+        if (trajectoriesDirty) {
+            sceneRenderer->setTrajectories(trajectory, futureTrajectory);
+            sceneRenderer->setOrbitLines(orbitLines);
+        }
+        sceneRenderer->setTrajectoryVisible(trajectoryVisible);
+    } else {
+        if (optionsDirty) {
+            RenderCommand command;
+            command.type = RenderCommand::Type::SetOptions;
+            command.options = options;
+            renderThread->post(std::move(command));
+        }
+        {
+            // Момент симуляции нужен и без шага часов: пропагация на GPU идет от него
+            RenderCommand command;
+            command.type = RenderCommand::Type::Advance;
+            command.deltaTime = pendingDeltaTime;
+            command.unixTime = unixTime;
+            advancePosted = renderThread->post(std::move(command));
+        }
+        if (satellitesDirty) {
+            RenderCommand command;
+            command.type = RenderCommand::Type::UpdateSatellites;
+            command.satellites = satellites;
+            satellitesPosted = renderThread->post(std::move(command));
+        } else if (!pendingSatelliteChanges.isEmpty()) {
+            RenderCommand command;
+            command.type = RenderCommand::Type::ApplySatelliteChanges;
+            command.satelliteChanges = pendingSatelliteChanges;
+            satellitesPosted = renderThread->post(std::move(command));
+        }
+        // Видимость траектории меняется вместе с выбором спутника
+        RenderCommand trajectories;
+        trajectories.type = RenderCommand::Type::SetTrajectories;
+        trajectories.trajectory = trajectory;
+        trajectories.futureTrajectory = futureTrajectory;
+        trajectories.orbitLines = orbitLines;
+        trajectories.trajectoryVisible = trajectoryVisible;
+        renderThread->post(std::move(trajectories));
+
+        RenderCommand cameraCommand;
+        cameraCommand.type = RenderCommand::Type::SetCamera;
+        cameraCommand.projection = projection;
+        cameraCommand.view = viewMatrix;
+        cameraCommand.model = model;
+        renderThread->post(std::move(cameraCommand));
+    }
+
+    if (advancePosted)
+        pendingDeltaTime = 0.0f;
+    optionsDirty = false;
+    // Изменения копятся до следующего кадра; набор, переросший каталог,
+    // заменяется полным снимком — он покрывает и изменения
+    if (!satellitesPosted && !satellitesDirty
+        && pendingSatelliteChanges.removed.size() + pendingSatelliteChanges.orbits.size() > satellites.size())
+        satellitesDirty = true;
+    if (satellitesPosted || satellitesDirty) {
+        pendingSatelliteChanges.clear();
+        pendingUpdateIndex.clear();
+    }
+    if (satellitesPosted)
+        satellitesDirty = false;
+    trajectoriesDirty = false;
+    if (!advancePosted || !satellitesPosted)
+        invalidateScene();
+}
+
+void EarthWidget::compositeFrame()
+{
+    QOpenGLExtraFunctions* f = context()->extraFunctions();
+    f->glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    f->glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    RenderThread::Frame frame = renderThread->acquireFrame();
+    if (!frame.texture)
+        return;
+
+    // Ждем на GPU завершения рендера кадра, CPU не блокируется
+    if (frame.fence)
+        f->glWaitSync(frame.fence, 0, GL_TIMEOUT_IGNORED);
+
+    f->glDisable(GL_DEPTH_TEST);
+    f->glDisable(GL_CULL_FACE);
+    f->glDisable(GL_BLEND);
+
+    compositeProgram.bind();
+    compositeVao.bind();
+    f->glActiveTexture(GL_TEXTURE0);
+    f->glBindTexture(GL_TEXTURE_2D, frame.texture);
+    compositeProgram.setUniformValue("frameTexture", 0);
+    f->glDrawArrays(GL_TRIANGLES, 0, 3);
+    compositeVao.release();
+    compositeProgram.release();
+
+    GLsync previous = renderThread->releaseFrame(f->glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+    if (previous)
+        f->glDeleteSync(previous);
 }
 
 void EarthWidget::paintGL()
 {
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    scheduler->beginFrame();
+    gpuProfiler->collect();
+    ProfileScope frameScope("frame");
+    emit frameStarted();
+    advanceSimulation();
 
     QMatrix4x4 viewMatrix = camera.getViewMatrix();
 
-    // Отрисовка 3D объектов
-    earthRenderer->render(projection, viewMatrix, model);
-    satelliteRenderer->render(projection, viewMatrix, model);
+    if (sceneRenderer) {
+        syncScene(viewMatrix);
+        // Отрисовка 3D объектов
+        sceneRenderer->render(projection, viewMatrix, model);
+    } else if (renderThread) {
+        // Новый кадр заказываем только при изменении сцены
+        if (sceneDirty) {
+            sceneDirty = false; // syncScene снова поднимет флаг, если не все передано
+            syncScene(viewMatrix);
+            renderThread->requestFrame();
+        }
+        ProfileScope scope("composite", gpuProfiler);
+        compositeFrame();
+    }
 
-    if (selectedSatelliteId != -1) {
-        trajectoryRenderer->render(projection, viewMatrix, model);
+    {
+        ProfileScope scope("overlay", gpuProfiler);
+        drawOverlay(viewMatrix);
     }
 
-    // Отрисовка 2D информации поверх 3D сцены
-    QPainter painter(this);
-    painter.setRenderHint(QPainter::Antialiasing);
+    fpsRenderer->update();
+    scheduler->endFrame();
+}
+
+void EarthWidget::drawOverlay(const QMatrix4x4& viewMatrix)
+{
+    // Отрисовка 2D информации поверх 3D сцены одним draw call
+    textRenderer->begin(size());
+
+    const int selectedSlot = satellites.slotOf(selectedSatelliteId);
+    const QString selectedInfo = selectedSlot != -1 ? satellites.info(selectedSatelliteId) : QString();
+
+    if (satelliteLabelsVisible) {
+        if (options.gpuPropagation)
+            emit satellitePositionsRequested();
+        QRectF reserved;
+        if (selectedSlot != -1)
+            reserved = satelliteInfoRenderer->boxRect(*textRenderer, selectedSatelliteId, selectedInfo);
+
+        // Спутники заданы в системе модели, туда же переводим камеру
+        QVector3D cameraPos = model.inverted() * camera.getPosition();
+        const auto& placements = labelPlacer.place(
+            satellites, projection * viewMatrix * model, cameraPos, size(), selectedSatelliteId, reserved,
+            [this](const QString& text) { return textRenderer->measure(text, LABEL_FONT_SIZE); });
+
+        for (const LabelPlacer::Placement& placement : placements) {
+            const int slot = satellites.slotOf(placement.id);
+            if (slot != -1) {
+                textRenderer->addLabel(satellites.position(slot), placement.offset, placement.text,
+                                       LABEL_FONT_SIZE, QColor(255, 255, 255, 200));
+            }
+        }
+    }
 
     // Отрисовка информации о выбранном спутнике
-    if (selectedSatelliteId != -1 && satellites.contains(selectedSatelliteId)) {
-        satelliteInfoRenderer->render(&painter, projection, viewMatrix, model,
-                                      satellites[selectedSatelliteId], size());
+    if (selectedSlot != -1) {
+        satelliteInfoRenderer->render(*textRenderer, selectedSatelliteId, satellites.position(selectedSlot),
+                                      selectedInfo);
     }
 
     // Отрисовка FPS
-    fpsRenderer->render(painter, size());
-    painter.end();
-
-    fpsRenderer->update();
+    fpsRenderer->render(*textRenderer);
+    if (profilerVisible)
+        profilerOverlay.render(*textRenderer, QPointF(10.0, 44.0));
+    textRenderer->render(projection, viewMatrix, model);
 }
 
 void EarthWidget::mousePressEvent(QMouseEvent *event)
@@ -138,9 +405,9 @@ void EarthWidget::mousePressEvent(QMouseEvent *event)
     if (event->button() == Qt::LeftButton) {
         isMousePressed = true;
         lastMousePos = event->pos();
+        if (options.gpuPropagation)
+            emit satellitePositionsRequested();
         pickSatellite(event->pos());
-        satelliteRenderer->updateSatellites(satellites);
-        update();
     }
 }
 
@@ -148,56 +415,191 @@ void EarthWidget::mouseMoveEvent(QMouseEvent *event)
 {
     if (isMousePressed) {
         QPoint delta = event->pos() - lastMousePos;
-        camera.rotate(delta.x() * 0.01f, delta.y() * 0.01f);
+        rotateCamera(delta.x() * 0.01f, delta.y() * 0.01f);
         lastMousePos = event->pos();
-        update();
     }
 }
 
 void EarthWidget::wheelEvent(QWheelEvent *event)
 {
     float zoomFactor = event->angleDelta().y() > 0 ? 0.9f : 1.1f;
-    camera.zoom(zoomFactor);
-    update();
+    zoomCamera(zoomFactor);
+}
+
+void EarthWidget::rotateCamera(float deltaTheta, float deltaPhi)
+{
+    camera.rotate(deltaTheta, deltaPhi);
+    if (sessionRecorder)
+        sessionRecorder->cameraRotate(deltaTheta, deltaPhi);
+    invalidateScene();
+}
+
+void EarthWidget::zoomCamera(float factor)
+{
+    camera.zoom(factor);
+    if (sessionRecorder)
+        sessionRecorder->cameraZoom(factor);
+    invalidateScene();
 }
 
 void EarthWidget::addSatellite(int id, const QVector3D& position, const QString& info)
 {
-    Satellite satellite(id, position, info);
-    satellites[id] = satellite;
-    satelliteRenderer->updateSatellites(satellites);
+    const int slot = satellites.insert(id, position);
+    satellites.setInfo(id, info);
+    queueSatelliteUpdate(slot);
+    labelPlacer.invalidate();
+    invalidateScene();
+}
 
+void EarthWidget::addSatellites(const QVector<int>& ids, const QVector<QVector3D>& positions)
+{
+    const int count = int(std::min(ids.size(), positions.size()));
+    if (satellites.isEmpty())
+        satellites.reserve(count); // первый пакет каталога
+    for (int i = 0; i < count; ++i)
+        queueSatelliteUpdate(satellites.insert(ids[i], positions[i]));
+    labelPlacer.invalidate();
+    invalidateScene();
+}
 
-    update();
+void EarthWidget::setSatelliteInfoLoader(SatelliteStore::InfoLoader loader)
+{
+    satellites.setInfoLoader(std::move(loader));
+}
+
+void EarthWidget::removeSatellite(int id)
+{
+    if (!satellites.remove(id))
+        return;
+
+    // Добавление раньше удаления в том же кадре не должно воскресить спутник
+    auto pending = pendingUpdateIndex.find(id);
+    if (pending != pendingUpdateIndex.end()) {
+        auto& updated = pendingSatelliteChanges.updated;
+        const int index = *pending;
+        pendingUpdateIndex.erase(pending);
+        if (index != updated.size() - 1) {
+            updated[index] = updated.last();
+            pendingUpdateIndex[updated[index].id] = index;
+        }
+        updated.removeLast();
+    }
+    pendingSatelliteChanges.removed.append(id);
+
+    if (id == selectedSatelliteId) {
+        selectedSatelliteId = -1;
+        emit satelliteSelected(-1);
+    }
+    labelPlacer.invalidate();
+    invalidateScene();
+}
+
+void EarthWidget::queueSatelliteUpdate(int slot)
+{
+    // Повторные изменения за кадр заменяют предыдущие
+    const SatelliteChangeSet::Update update{satellites.id(slot), satellites.position(slot),
+                                            satellites.flags()[slot]};
+    auto& updated = pendingSatelliteChanges.updated;
+    auto it = pendingUpdateIndex.constFind(update.id);
+    if (it != pendingUpdateIndex.constEnd()) {
+        updated[*it] = update;
+        return;
+    }
+    pendingUpdateIndex.insert(update.id, updated.size());
+    updated.append(update);
+}
+
+void EarthWidget::updateSatellitePositions(const QVector<int>& ids, const QVector<QVector3D>& positions)
+{
+    const int count = int(std::min(ids.size(), positions.size()));
+    for (int i = 0; i < count; ++i) {
+        const int slot = satellites.slotOf(ids[i]);
+        if (slot != -1) {
+            satellites.setPosition(slot, positions[i]);
+            queueSatelliteUpdate(slot);
+        }
+    }
+    labelPlacer.markSatellitesMoved();
+    invalidateScene();
+}
+
+void EarthWidget::setSatelliteOrbits(const QVector<int>& ids, const QVector<SatelliteOrbit>& orbits)
+{
+    const int count = int(std::min(ids.size(), orbits.size()));
+    for (int i = 0; i < count; ++i) {
+        const int slot = satellites.slotOf(ids[i]);
+        if (slot == -1)
+            continue;
+        satellites.setOrbit(slot, orbits[i]);
+        pendingSatelliteChanges.orbits.append({ids[i], orbits[i]});
+        if (ids[i] == selectedSatelliteId)
+            trajectoriesDirty = true;
+    }
+    invalidateScene();
+}
+
+void EarthWidget::setConjunctionHighlights(const QVector<int>& ids)
+{
+    const QVector<int>& previous = conjunctionIds;
+    for (int id : previous) {
+        const int slot = satellites.slotOf(id);
+        if (slot != -1 && satellites.hasConjunction(slot)) {
+            satellites.setConjunction(slot, false);
+            queueSatelliteUpdate(slot);
+        }
+    }
+    conjunctionIds = ids;
+    for (int id : ids) {
+        const int slot = satellites.slotOf(id);
+        if (slot != -1 && !satellites.hasConjunction(slot)) {
+            satellites.setConjunction(slot, true);
+            queueSatelliteUpdate(slot);
+        }
+    }
+    invalidateScene();
 }
 
 void EarthWidget::updateSatellitePosition(int id, const QVector3D& newPosition,
                                           const QVector<QVector3D>& trajectory,
-                                          const QVector<QVector3D>& futureTrajectory,
-                                          float angle)
+                                          const QVector<QVector3D>& futureTrajectory)
 {
     static QTimer updateTimer;
     static bool timerActive = false;
 
-    auto it = satellites.find(id);
-    if (it != satellites.end()) {
-        it->position = newPosition;
-        it->angle = angle;
+    const int slot = satellites.slotOf(id);
+    if (slot != -1) {
+        satellites.setPosition(slot, newPosition);
+        satellites.setTrajectories(id, trajectory, futureTrajectory);
+        labelPlacer.markSatellitesMoved();
 
+        // Траектория выбранного спутника передается в сцену не чаще раза в 100 мс
         if (id == selectedSatelliteId) {
             if (!timerActive) {
                 timerActive = true;
-                updateTimer.singleShot(100, this, [this, trajectory, futureTrajectory]() {
-                    trajectoryRenderer->setTrajectories(trajectory, futureTrajectory);
+                updateTimer.singleShot(100, this, [this]() {
+                    trajectoriesDirty = true;
                     timerActive = false;
-                    update();
+                    invalidateScene();
                 });
             }
         }
 
-        satelliteRenderer->updateSatellites(satellites);
+        queueSatelliteUpdate(slot);
+        invalidateScene();
     }
-    update();
+}
+
+void EarthWidget::setSatelliteLabelsVisible(bool visible)
+{
+    satelliteLabelsVisible = visible;
+    scheduler->invalidate();
+}
+
+void EarthWidget::setProfilerVisible(bool visible)
+{
+    profilerVisible = visible;
+    FrameProfiler::instance().setEnabled(visible);
+    scheduler->invalidate();
 }
 
 bool EarthWidget::toggleEarthAnimation()
@@ -206,6 +608,54 @@ bool EarthWidget::toggleEarthAnimation()
     return isAnimating;
 }
 
+void EarthWidget::setTimeWarp(double warp)
+{
+    clock.setTimeWarp(warp);
+    if (sessionRecorder)
+        sessionRecorder->timeWarp(warp);
+    invalidateScene();
+}
+
+void EarthWidget::setSimulationPaused(bool paused)
+{
+    clock.setPaused(paused);
+    if (sessionRecorder)
+        sessionRecorder->pause(paused);
+    // При воспроизведении кадры нужны и на паузе: в записи идут события ввода
+    scheduler->setAnimating(!paused || sessionReplay);
+    invalidateScene();
+}
+
+bool EarthWidget::toggleSimulationPause()
+{
+    setSimulationPaused(!clock.isPaused());
+    return clock.isPaused();
+}
+
+void EarthWidget::setSessionRecorder(SessionRecorder* recorder)
+{
+    sessionRecorder = recorder;
+}
+
+void EarthWidget::setSessionReplay(SessionReplay* replay)
+{
+    sessionReplay = replay;
+    if (!sessionReplay)
+        return;
+
+    const SessionHeader& header = sessionReplay->header();
+    clock.setEpoch(header.epoch);
+    clock.reset(header.simulationTime);
+    clock.setTimeWarp(header.timeWarp);
+    clock.setPaused(header.paused);
+    scheduler->setAnimating(true);
+    // После записи часы снова идут сами
+    connect(sessionReplay, &SessionReplay::finished, this, [this]() {
+        sessionReplay = nullptr;
+        scheduler->setAnimating(!clock.isPaused());
+    });
+}
+
 int EarthWidget::pickSatellite(const QPoint& mousePos)
 {
     float x = (2.0f * mousePos.x()) / width() - 1.0f;
@@ -220,34 +670,28 @@ int EarthWidget::pickSatellite(const QPoint& mousePos)
     QVector3D rayWorld(rayWorld4.x(), rayWorld4.y(), rayWorld4.z());
     rayWorld.normalize();
 
-    QVector3D rayOrigin = camera.getPosition();
-    float minDistance = std::numeric_limits<float>::max();
-    int closestSatelliteId = -1;
-    float pickRadius = EARTH_RADIUS * 0.1f;
-
-    for (const auto& satellite : satellites) {
-        QVector3D satPos = model * satellite.position;
-        QVector3D toSatellite = satPos - rayOrigin;
-        float projection = QVector3D::dotProduct(toSatellite, rayWorld);
-
-        if (projection < 0) continue;
-
-        QVector3D projectionPoint = rayOrigin + rayWorld * projection;
-        float distance = (satPos - projectionPoint).length();
+    int closestSatelliteId = pickClosestSatellite(satellites, model, camera.getPosition(),
+                                                  rayWorld, EARTH_RADIUS * 0.1f);
+    selectSatellite(closestSatelliteId);
+    return closestSatelliteId;
+}
 
-        if (distance < pickRadius && projection < minDistance) {
-            minDistance = projection;
-            closestSatelliteId = satellite.id;
-        }
-    }
-    if(selectedSatelliteId != closestSatelliteId && selectedSatelliteId != -1){
-        satellites[selectedSatelliteId].isSelected = false;
+void EarthWidget::selectSatellite(int id)
+{
+    const int previousSlot = satellites.slotOf(selectedSatelliteId);
+    if(selectedSatelliteId != id && previousSlot != -1){
+        satellites.setSelected(previousSlot, false);
+        queueSatelliteUpdate(previousSlot);
     }
-    selectedSatelliteId = closestSatelliteId;
-    if(selectedSatelliteId != -1){
-        satellites[selectedSatelliteId].isSelected = true;
+    selectedSatelliteId = id;
+    const int selectedSlot = satellites.slotOf(selectedSatelliteId);
+    if(selectedSlot != -1){
+        satellites.setSelected(selectedSlot, true);
+        queueSatelliteUpdate(selectedSlot);
     }
+    trajectoriesDirty = true;
+    if (sessionRecorder)
+        sessionRecorder->select(id);
 
-    update();  // Убедитесь, что это вызывается
-    return closestSatelliteId;
+    invalidateScene();
 }
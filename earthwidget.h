@@ -3,14 +3,24 @@
 #define EARTHWIDGET_H
 
 #include <QOpenGLWidget>
-#include <QMap>
+#include <QOpenGLShaderProgram>
+#include <QOpenGLVertexArrayObject>
+#include <QHash>
 #include "camera.h"
-#include "earth_renderer.h"
-#include "satellite_renderer.h"
-#include "trajectory_renderer.h"
+#include "simulation_clock.h"
+#include "frame_scheduler.h"
+#include "scene_renderer.h"
+#include "render_thread.h"
 #include "fps_renderer.h"
-#include "satellite.h"
+#include "satellite_store.h"
 #include "satellite_info_renderer.h"
+#include "text_renderer.h"
+#include "label_placer.h"
+#include "frame_profiler.h"
+#include "profiler_overlay.h"
+
+class SessionRecorder;
+class SessionReplay;
 
 class EarthWidget : public QOpenGLWidget
 {
@@ -23,16 +33,64 @@ public:
     ~EarthWidget();
 
     void addSatellite(int id, const QVector3D& position, const QString& info);
+    // Пакетная вставка каталога: сцена получает спутники один раз за кадр, а не на каждый вызов.
+    // Описание таких спутников запрашивается у загрузчика при первом показе
+    void addSatellites(const QVector<int>& ids, const QVector<QVector3D>& positions);
+    void setSatelliteInfoLoader(SatelliteStore::InfoLoader loader);
+    void updateSatellitePositions(const QVector<int>& ids, const QVector<QVector3D>& positions);
+    // Орбиты для пропагации на GPU и процедурных дуг (SceneOptions::gpuPropagation, proceduralOrbits)
+    void setSatelliteOrbits(const QVector<int>& ids, const QVector<SatelliteOrbit>& orbits);
+    // Подсветка спутников из найденных сближений; заменяет предыдущий набор
+    void setConjunctionHighlights(const QVector<int>& ids);
+    void removeSatellite(int id);
     void updateSatellitePosition(int id, const QVector3D& newPosition,
                                  const QVector<QVector3D>& trajectory,
-                                 const QVector<QVector3D>& futureTrajectory,
-                                 float angle);
+                                 const QVector<QVector3D>& futureTrajectory);
     bool toggleEarthAnimation();
     bool isEarthAnimating() const { return isAnimating; }
     int getSelectedSatelliteId() const { return selectedSatelliteId; }
+    const SimulationClock& simulationClock() const { return clock; }
+    FrameScheduler* frameScheduler() const { return scheduler; }
+
+    void setTimeWarp(double warp);
+    void setSimulationPaused(bool paused);
+    bool toggleSimulationPause();
+
+    // Управление камерой и выбором; мышь вызывает то же самое
+    void rotateCamera(float deltaTheta, float deltaPhi);
+    void zoomCamera(float factor);
+    void selectSatellite(int id);
+
+    // Запись сессии: ввод и шаг часов каждого кадра (виджет не владеет журналом)
+    void setSessionRecorder(SessionRecorder* recorder);
+    // Воспроизведение: шаг часов берется из записи, кадры идут без остановки
+    void setSessionReplay(SessionReplay* replay);
+
+    // Подписи с номерами над всеми спутниками
+    void setSatelliteLabelsVisible(bool visible);
+    bool areSatelliteLabelsVisible() const { return satelliteLabelsVisible; }
+
+    // Профилировщик кадра и его таблица поверх сцены
+    void setProfilerVisible(bool visible);
+    bool isProfilerVisible() const { return profilerVisible; }
+
+    void setSceneOptions(const SceneOptions& options);
+    const SceneOptions& sceneOptions() const { return options; }
+
+    // Рендеринг сцены в отдельном потоке; включается до первого показа виджета
+    void setThreadedRendering(bool enabled);
+    bool isThreadedRendering() const { return threadedRendering; }
 
 signals:
     void satelliteSelected(int id);
+    // Испускается в начале каждого кадра до шага часов, в том числе на паузе;
+    // здесь применяются накопленные внешние изменения сцены
+    void frameStarted();
+    // Испускается в начале кадра после шага часов, до отрисовки
+    void simulationAdvanced(double simulationTime);
+    // При пропагации на GPU положения в хранилище не обновляются каждый кадр;
+    // сигнал приходит перед выбором мышью и подписями, где они нужны на CPU
+    void satellitePositionsRequested();
 
 protected:
     void initializeGL() override;
@@ -44,16 +102,32 @@ protected:
 
 private:
     void setupSurfaceFormat();
+    void advanceSimulation();
+    void invalidateScene();
+    void syncScene(const QMatrix4x4& viewMatrix);
+    void initCompositor();
+    void compositeFrame();
+    void drawOverlay(const QMatrix4x4& viewMatrix);
     int pickSatellite(const QPoint& mousePos);
+    void queueSatelliteUpdate(int slot);
 
     // Renderers
     Camera camera;
-    EarthRenderer* earthRenderer;
-    SatelliteRenderer* satelliteRenderer;
-    TrajectoryRenderer* trajectoryRenderer;
+    SceneRenderer* sceneRenderer;     // рендеринг в GUI-потоке
+    RenderThread* renderThread;       // либо в отдельном потоке
+    bool threadedRendering;
     FPSRenderer* fpsRenderer;
     SatelliteInfoRenderer* satelliteInfoRenderer;
+    TextRenderer* textRenderer;       // 2D-слой поверх сцены, в GUI-потоке
+    LabelPlacer labelPlacer;
+    bool satelliteLabelsVisible;
+    GpuProfiler* gpuProfiler;         // проходы GUI-контекста: композиция и 2D-слой
+    ProfilerOverlay profilerOverlay;
+    bool profilerVisible;
 
+    // Вывод кадра потока рендеринга на экран
+    QOpenGLShaderProgram compositeProgram;
+    QOpenGLVertexArrayObject compositeVao;
 
     // Matrices
     QMatrix4x4 projection;
@@ -65,12 +139,30 @@ private:
     bool isAnimating;
 
     // Satellite data
-    QMap<int, Satellite> satellites;
+    SatelliteStore satellites;
     int selectedSatelliteId;
+    QVector<int> conjunctionIds;
+
+    SceneOptions options;
+
+    // Изменения, еще не переданные в сцену
+    bool optionsDirty;
+    bool satellitesDirty;                     // нужна полная передача набора
+    SatelliteChangeSet pendingSatelliteChanges; // иначе — только изменения за кадр
+    QHash<int, int> pendingUpdateIndex;         // id -> индекс в pendingSatelliteChanges.updated
+    bool trajectoriesDirty;
+    bool sceneDirty;
+    float pendingDeltaTime;
 
     // Animation
-    QTimer* animationTimer;
-    float rotationAngle;
+    FrameScheduler* scheduler;
+    SimulationClock clock;
+    bool simulationStarted;
+
+    SessionRecorder* sessionRecorder;
+    SessionReplay* sessionReplay;
+
+    static constexpr float LABEL_FONT_SIZE = 12.0f; // px
 };
 
 #endif // EARTHWIDGET_H
@@ -0,0 +1,190 @@
+// eclipse_model.cpp
+#include "eclipse_model.h"
+#include "kepler_propagator.h"
+#include "solar_ephemeris.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+constexpr double TIME_TOLERANCE = 0.1; // с, точность входа и выхода
+
+// Видимые радиусы дисков и расстояние между центрами, рад
+struct Discs {
+    double sun = 0.0;
+    double earth = 0.0;
+    double separation = 0.0;
+};
+
+Discs discs(const QVector3D& position, const QVector3D& sun)
+{
+    const double rx = position.x(), ry = position.y(), rz = position.z();
+    const double dx = sun.x() - rx, dy = sun.y() - ry, dz = sun.z() - rz;
+    const double r = std::sqrt(rx * rx + ry * ry + rz * rz);
+    const double d = std::sqrt(dx * dx + dy * dy + dz * dz);
+
+    Discs result;
+    result.sun = std::asin(std::min(SolarEphemeris::SUN_RADIUS / d, 1.0));
+    result.earth = std::asin(std::min(EclipseModel::EARTH_RADIUS / r, 1.0));
+    const double cosine = -(rx * dx + ry * dy + rz * dz) / (r * d);
+    result.separation = std::acos(std::clamp(cosine, -1.0, 1.0));
+    return result;
+}
+
+// Отрицательны внутри полутени и полной тени соответственно; непрерывны
+// по времени, поэтому вход и выход ищутся как корни
+double penumbraMargin(const Discs& d) { return d.separation - (d.earth + d.sun); }
+double umbraMargin(const Discs& d) { return d.separation - (d.earth - d.sun); }
+
+struct Span {
+    double begin;
+    double end;
+};
+
+template<typename F>
+double bisect(const F& f, double t0, double t1)
+{
+    // f(t0) и f(t1) разного знака
+    const bool negativeAtStart = f(t0) < 0.0;
+    while (t1 - t0 > TIME_TOLERANCE) {
+        const double t = 0.5 * (t0 + t1);
+        if ((f(t) < 0.0) == negativeAtStart)
+            t0 = t;
+        else
+            t1 = t;
+    }
+    return 0.5 * (t0 + t1);
+}
+
+template<typename F>
+double goldenMinimum(const F& f, double a, double b)
+{
+    const double ratio = 0.5 * (std::sqrt(5.0) - 1.0);
+    double c = b - ratio * (b - a);
+    double d = a + ratio * (b - a);
+    double fc = f(c), fd = f(d);
+    while (b - a > TIME_TOLERANCE) {
+        if (fc < fd) {
+            b = d;
+            d = c;
+            fd = fc;
+            c = b - ratio * (b - a);
+            fc = f(c);
+        } else {
+            a = c;
+            c = d;
+            fc = fd;
+            d = a + ratio * (b - a);
+            fd = f(d);
+        }
+    }
+    return 0.5 * (a + b);
+}
+
+// Участки окна, где f < 0. Отсчеты с шагом step; касание тени между двумя
+// отсчетами находится по локальному минимуму выше нуля
+template<typename F>
+QVector<Span> negativeSpans(const F& f, double start, double end, double step)
+{
+    const int count = std::max(1, int(std::ceil((end - start) / step)));
+    step = (end - start) / count;
+
+    QVector<double> values(count + 1);
+    for (int k = 0; k <= count; ++k)
+        values[k] = f(start + k * step);
+    double maxDifference = 0.0;
+    for (int k = 0; k < count; ++k)
+        maxDifference = std::max(maxDifference, std::abs(values[k + 1] - values[k]));
+
+    QVector<Span> spans;
+    bool inside = values[0] < 0.0;
+    double entry = start;
+    for (int k = 0; k < count; ++k) {
+        const double t0 = start + k * step;
+        const double t1 = t0 + step;
+        if (!inside && k > 0 && values[k] >= 0.0 && values[k] < maxDifference &&
+            values[k] < values[k - 1] && values[k] <= values[k + 1]) {
+            const double t = goldenMinimum(f, t0 - step, t1);
+            if (f(t) < 0.0)
+                spans.append({bisect(f, t0 - step, t), bisect(f, t, t1)});
+        }
+        if (!inside && values[k + 1] < 0.0) {
+            entry = bisect(f, t0, t1);
+            inside = true;
+        } else if (inside && values[k + 1] >= 0.0) {
+            spans.append({entry, bisect(f, t0, t1)});
+            inside = false;
+        }
+    }
+    if (inside)
+        spans.append({entry, end});
+    return spans;
+}
+
+}
+
+float EclipseModel::illumination(const QVector3D& position, const QVector3D& sun)
+{
+    if (position.lengthSquared() <= float(EARTH_RADIUS * EARTH_RADIUS))
+        return 0.0f;
+
+    const Discs d = discs(position, sun);
+    if (penumbraMargin(d) >= 0.0)
+        return 1.0f;
+    if (umbraMargin(d) <= 0.0)
+        return 0.0f;
+
+    // Полутень: площадь пересечения дисков радиусов a (Солнце) и b (Земля)
+    // с центрами на расстоянии c
+    const double a = d.sun, b = d.earth, c = d.separation;
+    const double x = (c * c + a * a - b * b) / (2.0 * c);
+    const double y = std::sqrt(std::max(a * a - x * x, 0.0));
+    const double overlap = a * a * std::acos(std::clamp(x / a, -1.0, 1.0)) +
+                           b * b * std::acos(std::clamp((c - x) / b, -1.0, 1.0)) - c * y;
+    return float(std::clamp(1.0 - overlap / (M_PI * a * a), 0.0, 1.0));
+}
+
+void EclipseModel::illuminate(const QVector4D* instances, int count, const QVector3D& sun, float* out)
+{
+    const QVector3D sunDirection = sun.normalized();
+    for (int i = 0; i < count; ++i) {
+        const QVector3D position = instances[i].toVector3D();
+        out[i] = QVector3D::dotProduct(position, sunDirection) >= 0.0f ? 1.0f : illumination(position, sun);
+    }
+}
+
+QVector<EclipseInterval> EclipseModel::intervals(const OrbitalElements& elements, double startTime, double duration)
+{
+    QVector<EclipseInterval> result;
+    if (elements.meanMotion <= 0.0 || duration <= 0.0)
+        return result;
+
+    auto margins = [&elements](double t) {
+        return discs(KeplerPropagator::position(elements, t), SolarEphemeris::position(t));
+    };
+    auto penumbra = [&margins](double t) { return penumbraMargin(margins(t)); };
+    auto umbra = [&margins](double t) { return umbraMargin(margins(t)); };
+
+    const double endTime = startTime + duration;
+    const double step = std::min(MAX_STEP, elements.period() / STEPS_PER_PERIOD);
+    const QVector<Span> shadows = negativeSpans(penumbra, startTime, endTime, step);
+    if (shadows.isEmpty())
+        return result;
+    const QVector<Span> umbras = negativeSpans(umbra, startTime, endTime, step);
+
+    // Полная тень всегда внутри полутени
+    for (const Span& shadow : shadows) {
+        EclipseInterval interval;
+        interval.entry = shadow.begin;
+        interval.exit = shadow.end;
+        for (const Span& span : umbras) {
+            if (span.begin >= shadow.begin - TIME_TOLERANCE && span.end <= shadow.end + TIME_TOLERANCE) {
+                interval.umbraEntry = span.begin;
+                interval.umbraExit = span.end;
+                break;
+            }
+        }
+        result.append(interval);
+    }
+    return result;
+}
@@ -0,0 +1,43 @@
+// eclipse_model.h
+#ifndef ECLIPSE_MODEL_H
+#define ECLIPSE_MODEL_H
+
+#include <QVector>
+#include <QVector3D>
+#include <QVector4D>
+#include "orbital_elements.h"
+
+// Прохождение тени Земли. Интервал, идущий на границе окна, обрезается ею
+struct EclipseInterval {
+    double entry = 0.0;       // вход в полутень, секунды Unix
+    double exit = 0.0;        // выход из полутени
+    double umbraEntry = 0.0;  // полная тень; без нее равны нулю
+    double umbraExit = 0.0;
+
+    bool hasUmbra() const { return umbraExit > umbraEntry; }
+};
+
+// Коническая модель тени: доля видимого диска Солнца, не закрытая диском
+// Земли (1 — освещен, 0 — полная тень, между ними полутень). Земля —
+// шар радиуса сцены, Солнце — SolarEphemeris.
+class EclipseModel {
+public:
+    // Освещенность точки в системе сцены при положении Солнца sun
+    static float illumination(const QVector3D& position, const QVector3D& sun);
+
+    // Освещенность count экземпляров (xyz — положение) за один проход.
+    // Спутник перед плоскостью терминатора не может быть в тени, поэтому
+    // геометрия дисков считается только для объектов за ней
+    static void illuminate(const QVector4D* instances, int count, const QVector3D& sun, float* out);
+
+    // Интервалы тени на окне [startTime, startTime + duration] по элементам
+    static QVector<EclipseInterval> intervals(const OrbitalElements& elements, double startTime, double duration);
+
+    static constexpr double EARTH_RADIUS = 6371000.0; // м, как у сетки Земли
+
+private:
+    static constexpr double MAX_STEP = 60.0;         // с, шаг отсчетов
+    static constexpr int STEPS_PER_PERIOD = 180;
+};
+
+#endif // ECLIPSE_MODEL_H
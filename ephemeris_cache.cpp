@@ -0,0 +1,377 @@
+// ephemeris_cache.cpp
+#include "ephemeris_cache.h"
+#include "kepler_propagator.h"
+#include "satellite_catalog.h"
+#include <QDateTime>
+#include <QDir>
+#include <QSaveFile>
+#include <QtConcurrent/QtConcurrent>
+#include <QDebug>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+constexpr char MAGIC[4] = {'E', 'P', 'H', 'C'};
+
+// FNV-1a: в отличие от qHashBits не зависит от процессора и версии Qt,
+// поэтому годится для имен файлов между запусками
+quint64 fnv1a(const void* data, size_t size, quint64 hash)
+{
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+}
+
+qsizetype EphemerisCache::Chunk::sizeBytes() const
+{
+    return file ? file->size() : storage.size();
+}
+
+EphemerisCache::EphemerisCache(double sampleStep)
+    : step(sampleStep)
+{
+    static_assert(sizeof(Header) == 48, "Ephemeris chunk header must stay packed");
+}
+
+EphemerisCache::~EphemerisCache() = default;
+
+void EphemerisCache::setDirectory(const QString& path)
+{
+    directory = path;
+    if (!directory.isEmpty() && !QDir().mkpath(directory)) {
+        qWarning() << "Ephemeris cache: cannot create" << directory;
+        directory.clear();
+    }
+}
+
+void EphemerisCache::clear()
+{
+    // Незавершенные сборки досчитаются в пуле, но их результат не нужен
+    chunks.clear();
+    pending.clear();
+    cacheStats.memoryBytes = 0;
+    cacheStats.chunksPending = 0;
+}
+
+void EphemerisCache::waitForBuilds()
+{
+    for (PendingBuild& build : pending)
+        build.storage.waitForFinished();
+    pollBuilds();
+}
+
+void EphemerisCache::interpolate(const SatelliteCatalog& catalog, double unixTime, QVector<QVector3D>& positions)
+{
+    const int count = catalog.size();
+    positions.resize(count);
+    if (count == 0)
+        return;
+
+    pollBuilds();
+
+    if (unixTime != lastTime)
+        direction = unixTime > lastTime ? 1 : -1;
+    lastTime = unixTime;
+
+    const double chunkPosition = unixTime / chunkDuration();
+    const qint64 index = qint64(std::floor(chunkPosition));
+    const double phase = chunkPosition - index;
+    currentIndex = index;
+    requestChunk(catalog, index);
+    if (direction > 0 ? phase >= PREFETCH_PHASE : phase <= 1.0 - PREFETCH_PHASE)
+        requestChunk(catalog, index + direction);
+
+    Chunk* chunk = useChunk(index);
+    if (!chunk) {
+        // Кусок еще строится: кадр считается без кэша, но и без ожидания
+        KeplerPropagator::propagate(catalog.elements(), unixTime, positions);
+        cacheStats.propagated += count;
+        return;
+    }
+
+    // Базис Эрмита на отрезке между соседними узлами; скорости умножаются на шаг
+    const double local = (unixTime - chunk->header->startTime) / step;
+    const int sample = std::clamp(int(local), 0, CHUNK_SAMPLES - 2);
+    const float s = float(local - sample);
+    const float s2 = s * s, s3 = s2 * s;
+    const float h00 = 2.0f * s3 - 3.0f * s2 + 1.0f;
+    const float h10 = float(step) * (s3 - 2.0f * s2 + s);
+    const float h01 = -2.0f * s3 + 3.0f * s2;
+    const float h11 = float(step) * (s3 - s2);
+
+    const QVector<OrbitalElements>& elements = catalog.elements();
+    const QVector<int>& ids = catalog.ids();
+    const QVector<quint64>& modified = catalog.modifiedRevisions();
+    const int chunkCount = chunk->header->satelliteCount;
+    const int stride = CHUNK_SAMPLES * STATE_FLOATS;
+    qint64 propagated = 0;
+    for (int i = 0; i < count; ++i) {
+        // Обычно порядок каталога не менялся с построения куска; поиск по id
+        // нужен только записям, переставленным удалением
+        const int slot = i < chunkCount && chunk->ids[i] == ids[i] ? i : chunk->slotOf(ids[i]);
+        if (slot < 0 || modified[i] > chunk->builtRevision) {
+            positions[i] = KeplerPropagator::position(elements[i], unixTime);
+            ++propagated;
+            continue;
+        }
+        const float* a = chunk->states + qsizetype(slot) * stride + sample * STATE_FLOATS;
+        const float* b = a + STATE_FLOATS;
+        positions[i] = QVector3D(h00 * a[0] + h10 * a[3] + h01 * b[0] + h11 * b[3],
+                                 h00 * a[1] + h10 * a[4] + h01 * b[1] + h11 * b[4],
+                                 h00 * a[2] + h10 * a[5] + h01 * b[2] + h11 * b[5]);
+    }
+    cacheStats.propagated += propagated;
+    cacheStats.interpolated += count - propagated;
+
+    // Слишком много записей изменилось после построения — кусок строится заново,
+    // а до готовности они пропагируются напрямую
+    if (propagated > count * REBUILD_STALE_FRACTION && !pending.contains(index))
+        startBuild(catalog, index);
+}
+
+int EphemerisCache::Chunk::slotOf(int id)
+{
+    if (slotById.isEmpty()) {
+        const int count = header->satelliteCount;
+        slotById.reserve(count);
+        for (int j = 0; j < count; ++j)
+            slotById.insert(ids[j], j);
+    }
+    return slotById.value(id, -1);
+}
+
+EphemerisCache::Chunk* EphemerisCache::useChunk(qint64 index)
+{
+    auto it = std::find_if(chunks.begin(), chunks.end(),
+                           [index](const std::unique_ptr<Chunk>& chunk) { return chunk->index == index; });
+    if (it == chunks.end())
+        return nullptr;
+    chunks.splice(chunks.begin(), chunks, it);
+    return chunks.front().get();
+}
+
+void EphemerisCache::requestChunk(const SatelliteCatalog& catalog, qint64 index)
+{
+    if (pending.contains(index))
+        return;
+    for (const auto& chunk : chunks) {
+        if (chunk->index == index)
+            return;
+    }
+
+    // Файл только отображается в память, чтение идет по мере обращения
+    if (!directory.isEmpty()) {
+        if (std::unique_ptr<Chunk> chunk = loadChunk(index, catalogKey(catalog), catalog.revision())) {
+            adoptChunk(std::move(chunk));
+            return;
+        }
+    }
+    startBuild(catalog, index);
+}
+
+void EphemerisCache::startBuild(const SatelliteCatalog& catalog, qint64 index)
+{
+    Header header;
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = FORMAT_VERSION;
+    header.catalogKey = catalogKey(catalog);
+    header.chunkIndex = index;
+    header.startTime = index * chunkDuration();
+    header.step = step;
+    header.sampleCount = CHUNK_SAMPLES;
+    header.satelliteCount = catalog.size();
+
+    // Снимок каталога: контейнеры разделяются без копирования, а изменения
+    // из потока отделят копию каталога, не трогая снимок
+    const QVector<OrbitalElements> elements = catalog.elements();
+    const QVector<int> ids = catalog.ids();
+    const QString path = directory.isEmpty() ? QString() : chunkPath(index, header.catalogKey);
+    const QString chunkDirectory = directory;
+    const qint64 budget = diskBudget;
+
+    PendingBuild build;
+    build.revision = catalog.revision();
+    build.storage = QtConcurrent::run([header, elements, ids, path, chunkDirectory, budget]() {
+        QByteArray storage = buildStorage(header, elements, ids);
+        if (!path.isEmpty()) {
+            saveChunk(path, storage);
+            pruneDirectory(chunkDirectory, budget);
+        }
+        return storage;
+    });
+    pending.insert(index, build);
+    cacheStats.chunksPending = pending.size();
+}
+
+void EphemerisCache::pollBuilds()
+{
+    for (auto it = pending.begin(); it != pending.end();) {
+        if (!it->storage.isFinished()) {
+            ++it;
+            continue;
+        }
+        auto chunk = std::make_unique<Chunk>();
+        chunk->index = it.key();
+        chunk->builtRevision = it->revision;
+        chunk->storage = it->storage.result();
+        it = pending.erase(it);
+        if (!attachLayout(*chunk, chunk->storage.constData(), chunk->storage.size()))
+            continue;
+        ++cacheStats.chunksBuilt;
+        adoptChunk(std::move(chunk));
+    }
+    cacheStats.chunksPending = pending.size();
+}
+
+void EphemerisCache::adoptChunk(std::unique_ptr<Chunk> chunk)
+{
+    auto it = std::find_if(chunks.begin(), chunks.end(),
+                           [&chunk](const std::unique_ptr<Chunk>& item) { return item->index == chunk->index; });
+    if (it != chunks.end()) {
+        // Перестроенный кусок заменяет старый на его месте в очереди
+        if ((*it)->builtRevision < chunk->builtRevision)
+            *it = std::move(chunk);
+    } else {
+        // Сразу за текущим: заказанный заранее кусок не должен вытесниться первым
+        chunks.insert(chunks.empty() ? chunks.end() : std::next(chunks.begin()), std::move(chunk));
+    }
+    evict();
+}
+
+QByteArray EphemerisCache::buildStorage(const Header& header, const QVector<OrbitalElements>& elements,
+                                        const QVector<int>& ids)
+{
+    const int count = header.satelliteCount;
+    const qsizetype idsBytes = qsizetype(count) * qsizetype(sizeof(qint32));
+    const qsizetype statesBytes = qsizetype(count) * CHUNK_SAMPLES * STATE_FLOATS * qsizetype(sizeof(float));
+
+    QByteArray storage;
+    storage.resize(qsizetype(sizeof(Header)) + idsBytes + statesBytes);
+    char* data = storage.data();
+    std::memcpy(data, &header, sizeof(Header));
+    std::memcpy(data + sizeof(Header), ids.constData(), size_t(idsBytes));
+    float* states = reinterpret_cast<float*>(data + sizeof(Header) + idsBytes);
+
+    // Сборка уже идет в пуле потоков и не задерживает кадр, поэтому спутники
+    // считаются подряд, без вложенного распараллеливания
+    for (int i = 0; i < count; ++i) {
+        float* out = states + qsizetype(i) * CHUNK_SAMPLES * STATE_FLOATS;
+        for (int sample = 0; sample < CHUNK_SAMPLES; ++sample, out += STATE_FLOATS) {
+            QVector3D position, velocity;
+            KeplerPropagator::state(elements[i], header.startTime + sample * header.step, position, velocity);
+            out[0] = position.x();
+            out[1] = position.y();
+            out[2] = position.z();
+            out[3] = velocity.x();
+            out[4] = velocity.y();
+            out[5] = velocity.z();
+        }
+    }
+    return storage;
+}
+
+std::unique_ptr<EphemerisCache::Chunk> EphemerisCache::loadChunk(qint64 index, quint64 fileKey, quint64 revision)
+{
+    auto file = std::make_unique<QFile>(chunkPath(index, fileKey));
+    if (!file->exists() || !file->open(QIODevice::ReadOnly))
+        return nullptr;
+
+    const uchar* data = file->map(0, file->size());
+    auto chunk = std::make_unique<Chunk>();
+    chunk->index = index;
+    chunk->builtRevision = revision;
+    if (!data || !attachLayout(*chunk, reinterpret_cast<const char*>(data), file->size()) ||
+        chunk->header->catalogKey != fileKey || chunk->header->chunkIndex != index ||
+        chunk->header->step != step) {
+        qWarning() << "Ephemeris cache: ignoring invalid chunk" << file->fileName();
+        return nullptr;
+    }
+
+    // Время изменения — момент последнего использования для pruneDirectory
+    file->setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+    chunk->file = std::move(file);
+    ++cacheStats.chunksLoaded;
+    return chunk;
+}
+
+void EphemerisCache::saveChunk(const QString& path, const QByteArray& storage)
+{
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly) || file.write(storage) != storage.size() || !file.commit())
+        qWarning() << "Ephemeris cache: failed to write" << file.fileName() << file.errorString();
+}
+
+void EphemerisCache::pruneDirectory(const QString& directory, qint64 budget)
+{
+    // Куски прежних версий каталога (в том числе после изменений из потока)
+    // больше не подойдут; удаляются самые давно использованные сверх предела
+    // Самый новый файл, только что записанный, остается в любом случае
+    const QFileInfoList files = QDir(directory).entryInfoList({"ephemeris_*.bin"}, QDir::Files, QDir::Time);
+    qint64 total = 0;
+    for (int i = 0; i < files.size(); ++i) {
+        total += files[i].size();
+        if (i > 0 && total > budget)
+            QFile::remove(files[i].filePath());
+    }
+}
+
+bool EphemerisCache::attachLayout(Chunk& chunk, const char* data, qsizetype size)
+{
+    if (size < qsizetype(sizeof(Header)))
+        return false;
+    const Header* header = reinterpret_cast<const Header*>(data);
+    if (std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0 || header->version != FORMAT_VERSION ||
+        header->sampleCount != CHUNK_SAMPLES || header->satelliteCount < 0)
+        return false;
+
+    const qsizetype count = header->satelliteCount;
+    const qsizetype expected = qsizetype(sizeof(Header)) + count * qsizetype(sizeof(qint32)) +
+                               count * CHUNK_SAMPLES * STATE_FLOATS * qsizetype(sizeof(float));
+    if (size < expected)
+        return false;
+
+    chunk.header = header;
+    chunk.ids = reinterpret_cast<const qint32*>(data + sizeof(Header));
+    chunk.states = reinterpret_cast<const float*>(data + sizeof(Header) + count * sizeof(qint32));
+    return true;
+}
+
+void EphemerisCache::evict()
+{
+    qsizetype total = 0;
+    for (const auto& chunk : chunks)
+        total += chunk->sizeBytes();
+    // Текущий и следующий по ходу времени куски остаются, даже если превышают
+    // предел: иначе заказанный кусок вытеснялся бы и заказывался снова
+    for (auto it = chunks.end(); total > memoryBudget && it != chunks.begin();) {
+        --it;
+        const qint64 index = (*it)->index;
+        if (index == currentIndex || index == currentIndex + direction)
+            continue;
+        total -= (*it)->sizeBytes();
+        it = chunks.erase(it);
+    }
+    cacheStats.memoryBytes = total;
+}
+
+quint64 EphemerisCache::catalogKey(const SatelliteCatalog& catalog) const
+{
+    // Ключ содержимого каталог ведет сам; здесь добавляется сетка узлов
+    const int samples = CHUNK_SAMPLES;
+    quint64 hash = fnv1a(&step, sizeof(step), catalog.contentKey());
+    return fnv1a(&samples, sizeof(samples), hash);
+}
+
+QString EphemerisCache::chunkPath(qint64 index, quint64 fileKey) const
+{
+    return QDir(directory).filePath(QString("ephemeris_%1_%2.bin")
+                                        .arg(fileKey, 16, 16, QChar('0'))
+                                        .arg(index));
+}
@@ -0,0 +1,142 @@
+// ephemeris_cache.h
+#ifndef EPHEMERIS_CACHE_H
+#define EPHEMERIS_CACHE_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QFuture>
+#include <QHash>
+#include <QString>
+#include <QVector>
+#include <QVector3D>
+#include <list>
+#include <memory>
+#include "orbital_elements.h"
+
+class SatelliteCatalog;
+
+// Кэш эфемерид каталога для воспроизведения и перемотки времени.
+//
+// Время разбито на куски по CHUNK_SAMPLES - 1 шагов; кусок хранит положение
+// и скорость каждого спутника в каждом узле (float, система сцены), так что
+// положение между узлами дает кубическая интерполяция Эрмита без пропагации.
+// При шаге 60 с ошибка на низкой орбите около метра — на уровне точности float.
+//
+// Кусок — непрерывный блок: заголовок, id спутников, затем состояния
+// [спутник][узел][x y z vx vy vz]. В этом же виде он пишется на диск и
+// отображается в память при следующем запуске (QFile::map), без разбора.
+// Имя файла включает ключ содержимого каталога (SatelliteCatalog::contentKey),
+// поэтому другой каталог не подхватит чужие файлы. Файлы сверх diskBudget
+// удаляются, начиная со старых.
+//
+// Куски строятся в пуле потоков по снимку каталога и не задерживают кадр:
+// следующий по ходу времени кусок заказывается заранее, с PREFETCH_PHASE
+// текущего, а пока нужного куска нет, положения пропагируются напрямую.
+// Записи каталога, измененные после построения куска, тоже пропагируются
+// напрямую; когда их доля превышает REBUILD_STALE_FRACTION, кусок
+// перестраивается в фоне.
+class EphemerisCache {
+public:
+    struct Stats {
+        qint64 interpolated = 0;  // положений из куска
+        qint64 propagated = 0;    // положений мимо кэша (новые или измененные записи)
+        int chunksBuilt = 0;
+        int chunksLoaded = 0;     // отображено с диска
+        int chunksPending = 0;    // строятся в пуле потоков
+        qsizetype memoryBytes = 0;
+    };
+
+    explicit EphemerisCache(double sampleStep = DEFAULT_SAMPLE_STEP);
+    ~EphemerisCache();
+
+    // Каталог для файлов кусков; пустая строка — только память
+    void setDirectory(const QString& directory);
+    // Предел памяти под куски в памяти; старые вытесняются
+    void setMemoryBudget(qsizetype bytes) { memoryBudget = bytes; }
+    // Предел файлов кусков на диске
+    void setDiskBudget(qint64 bytes) { diskBudget = bytes; }
+    void clear();
+    // Дождаться кусков, которые строятся (бенчмарки)
+    void waitForBuilds();
+
+    // Положения всего каталога на момент unixTime в порядке catalog.ids()
+    void interpolate(const SatelliteCatalog& catalog, double unixTime, QVector<QVector3D>& positions);
+
+    double sampleStep() const { return step; }
+    double chunkDuration() const { return step * (CHUNK_SAMPLES - 1); }
+    const Stats& stats() const { return cacheStats; }
+
+    static constexpr double DEFAULT_SAMPLE_STEP = 60.0; // с
+    static constexpr int CHUNK_SAMPLES = 11;            // 10 шагов на кусок
+
+private:
+    struct Header {
+        char magic[4];
+        quint32 version;
+        quint64 catalogKey;
+        qint64 chunkIndex;
+        double startTime;
+        double step;
+        qint32 sampleCount;
+        qint32 satelliteCount;
+    };
+
+    struct Chunk {
+        qint64 index = 0;
+        quint64 builtRevision = 0;     // ревизия каталога, на которой сняты состояния
+        QByteArray storage;            // построенный кусок
+        std::unique_ptr<QFile> file;   // или отображенный файл
+        const Header* header = nullptr;
+        const qint32* ids = nullptr;
+        const float* states = nullptr;
+
+        // Слот по id, если порядок каталога разошелся с куском (после удалений);
+        // строится один раз: состав куска не меняется
+        QHash<int, int> slotById;
+
+        int slotOf(int id);
+        qsizetype sizeBytes() const;
+    };
+
+    struct PendingBuild {
+        quint64 revision = 0;          // ревизия каталога в снимке
+        QFuture<QByteArray> storage;
+    };
+
+    Chunk* useChunk(qint64 index);
+    void requestChunk(const SatelliteCatalog& catalog, qint64 index);
+    void startBuild(const SatelliteCatalog& catalog, qint64 index);
+    void pollBuilds();
+    void adoptChunk(std::unique_ptr<Chunk> chunk);
+    std::unique_ptr<Chunk> loadChunk(qint64 index, quint64 fileKey, quint64 revision);
+    void evict();
+    quint64 catalogKey(const SatelliteCatalog& catalog) const;
+    QString chunkPath(qint64 index, quint64 fileKey) const;
+    static QByteArray buildStorage(const Header& header, const QVector<OrbitalElements>& elements,
+                                   const QVector<int>& ids);
+    static void saveChunk(const QString& path, const QByteArray& storage);
+    static void pruneDirectory(const QString& directory, qint64 budget);
+    static bool attachLayout(Chunk& chunk, const char* data, qsizetype size);
+
+    static constexpr quint32 FORMAT_VERSION = 1;
+    static constexpr int STATE_FLOATS = 6;
+    static constexpr double REBUILD_STALE_FRACTION = 0.25;
+    static constexpr double PREFETCH_PHASE = 0.5;       // доля куска, после которой заказывается следующий
+    static constexpr qsizetype DEFAULT_MEMORY_BUDGET = qsizetype(256) * 1024 * 1024;
+    static constexpr qint64 DEFAULT_DISK_BUDGET = qint64(2048) * 1024 * 1024;
+
+    double step;
+    QString directory;
+    qsizetype memoryBudget = DEFAULT_MEMORY_BUDGET;
+    qint64 diskBudget = DEFAULT_DISK_BUDGET;
+    std::list<std::unique_ptr<Chunk>> chunks; // в начале — последний использованный
+    QHash<qint64, PendingBuild> pending;      // индекс куска -> сборка в пуле
+
+    double lastTime = 0.0;
+    qint64 currentIndex = 0;                  // кусок последнего interpolate
+    int direction = 1;                        // +1 — время идет вперед, -1 — перемотка назад
+
+    Stats cacheStats;
+};
+
+#endif // EPHEMERIS_CACHE_H
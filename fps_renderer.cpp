@@ -4,6 +4,7 @@ FPSRenderer::FPSRenderer()
     : frameCount(0)
     , currentFps(0.0f)
     , updateInterval(1000.0f)
+    , fpsText("FPS: 0.0")
 {
     timer.start();
 }
@@ -15,27 +16,19 @@ void FPSRenderer::update()
     float elapsed = timer.elapsed();
     if (elapsed >= updateInterval) {
         currentFps = frameCount * (1000.0f / elapsed);
+        fpsText = QString("FPS: %1").arg(QString::number(currentFps, 'f', 1));
         frameCount = 0;
         timer.restart();
     }
 }
 
-void FPSRenderer::render(QPainter& painter, const QSize& viewportSize)
+void FPSRenderer::render(TextRenderer& text)
 {
-    painter.setRenderHint(QPainter::Antialiasing);
-
-    QFont font = painter.font();
-    font.setPointSize(12);
-    font.setBold(true);
-    painter.setFont(font);
-
-    QString fpsText = QString("FPS: %1").arg(QString::number(currentFps, 'f', 1));
-    QFontMetrics fm(font);
-    QRect textRect = fm.boundingRect(fpsText);
+    const float fontSize = 16.0f;
+    QSizeF textSize = text.measure(fpsText, fontSize);
+    QRectF textRect(QPointF(10, 10), textSize);
     textRect.adjust(-5, -5, 5, 5);
-    textRect.moveTopLeft(QPoint(10, 10));
 
-    painter.setPen(Qt::green);
-    painter.fillRect(textRect, QColor(0, 0, 0, 128));
-    painter.drawText(textRect, Qt::AlignCenter, fpsText);
+    text.addRect(textRect, QColor(0, 0, 0, 128));
+    text.addText(fpsText, textRect.topLeft() + QPointF(5, 5), fontSize, Qt::green);
 }
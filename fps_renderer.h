@@ -2,19 +2,21 @@
 #define FPS_RENDERER_H
 
 #include <QElapsedTimer>
-#include <QPainter>
+#include <QString>
+#include "text_renderer.h"
 
 class FPSRenderer {
 public:
     FPSRenderer();
     void update();
-    void render(QPainter& painter, const QSize& viewportSize);
+    void render(TextRenderer& text);
 
 private:
     QElapsedTimer timer;
     int frameCount;
     float currentFps;
     const float updateInterval;
+    QString fpsText; // пересобирается раз в updateInterval
 };
 
 #endif // FPS_RENDERER_H
@@ -0,0 +1,261 @@
+// frame_profiler.cpp
+#include "frame_profiler.h"
+#include <QOpenGLTimerQuery>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QThread>
+#include <QCoreApplication>
+#include <QDebug>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+// Дорожка GPU в трассе: время начала — момент постановки запроса на CPU
+constexpr quintptr GPU_THREAD = 0;
+
+double percentile(const QVector<float>& sorted, double fraction)
+{
+    if (sorted.isEmpty())
+        return 0.0;
+    int index = int(std::ceil(fraction * sorted.size())) - 1;
+    return sorted[std::clamp(index, 0, int(sorted.size()) - 1)];
+}
+
+}
+
+FrameProfiler& FrameProfiler::instance()
+{
+    static FrameProfiler profiler;
+    return profiler;
+}
+
+FrameProfiler::FrameProfiler()
+    : enabledFlag(false)
+    , nextEvent(0)
+{
+    clock.start();
+}
+
+void FrameProfiler::setEnabled(bool enabled)
+{
+    enabledFlag.store(enabled, std::memory_order_relaxed);
+}
+
+void FrameProfiler::reset()
+{
+    QMutexLocker locker(&mutex);
+    series.clear();
+    events.clear();
+    nextEvent = 0;
+}
+
+FrameProfiler::Series& FrameProfiler::seriesFor(const char* name, bool gpu)
+{
+    for (Series& s : series) {
+        if (s.gpu == gpu && (s.name == name || std::strcmp(s.name, name) == 0))
+            return s;
+    }
+    Series s;
+    s.name = name;
+    s.gpu = gpu;
+    s.durationsMs.resize(HISTORY);
+    series.append(s);
+    return series.last();
+}
+
+void FrameProfiler::addSample(const char* name, qint64 startNs, qint64 durationNs, bool gpu)
+{
+    const quintptr thread = gpu ? GPU_THREAD : reinterpret_cast<quintptr>(QThread::currentThreadId());
+
+    QMutexLocker locker(&mutex);
+
+    Series& s = seriesFor(name, gpu);
+    s.durationsMs[s.next] = float(durationNs / 1.0e6);
+    s.next = (s.next + 1) % HISTORY;
+    s.count = std::min(s.count + 1, int(HISTORY));
+
+    const Event event{name, startNs, durationNs, thread, gpu};
+    if (events.size() < MAX_TRACE_EVENTS) {
+        events.append(event);
+    } else {
+        events[nextEvent] = event;
+        nextEvent = (nextEvent + 1) % MAX_TRACE_EVENTS;
+    }
+
+    if (!gpu && !threadNames.contains(thread)) {
+        QString threadName = QThread::currentThread()->objectName();
+        if (threadName.isEmpty())
+            threadName = QThread::currentThread() == QCoreApplication::instance()->thread() ? "GUI" : "Worker";
+        threadNames.insert(thread, threadName);
+    }
+}
+
+QVector<FrameProfiler::Stats> FrameProfiler::statistics() const
+{
+    QVector<Series> snapshot;
+    {
+        QMutexLocker locker(&mutex);
+        snapshot = series;
+    }
+
+    QVector<Stats> result;
+    result.reserve(snapshot.size());
+    for (const Series& s : snapshot) {
+        QVector<float> sorted = s.durationsMs.mid(0, s.count);
+        std::sort(sorted.begin(), sorted.end());
+
+        Stats stats;
+        stats.name = QString::fromLatin1(s.name);
+        stats.gpu = s.gpu;
+        stats.count = s.count;
+        stats.p50Ms = percentile(sorted, 0.50);
+        stats.p99Ms = percentile(sorted, 0.99);
+        stats.maxMs = sorted.isEmpty() ? 0.0 : sorted.last();
+
+        stats.histogram.fill(0, HISTOGRAM_BINS);
+        if (stats.maxMs > 0.0) {
+            for (float value : sorted) {
+                int bin = int(value / stats.maxMs * HISTOGRAM_BINS);
+                stats.histogram[std::min(bin, HISTOGRAM_BINS - 1)]++;
+            }
+        }
+        result.append(stats);
+    }
+    return result;
+}
+
+bool FrameProfiler::exportChromeTrace(const QString& path) const
+{
+    QVector<Event> snapshot;
+    QHash<quintptr, QString> names;
+    {
+        QMutexLocker locker(&mutex);
+        // Кольцевой буфер в хронологическом порядке
+        snapshot = events.mid(nextEvent) + events.mid(0, nextEvent);
+        names = threadNames;
+    }
+
+    QJsonArray traceEvents;
+
+    // Метаданные: имена дорожек
+    names.insert(GPU_THREAD, "GPU");
+    for (auto it = names.constBegin(); it != names.constEnd(); ++it) {
+        traceEvents.append(QJsonObject{
+            {"name", "thread_name"}, {"ph", "M"}, {"pid", 1},
+            {"tid", QString::number(it.key())},
+            {"args", QJsonObject{{"name", it.value()}}}
+        });
+    }
+
+    for (const Event& event : snapshot) {
+        traceEvents.append(QJsonObject{
+            {"name", QString::fromLatin1(event.name)},
+            {"cat", event.gpu ? "gpu" : "cpu"},
+            {"ph", "X"},
+            {"pid", 1},
+            {"tid", QString::number(event.thread)},
+            {"ts", event.startNs / 1000.0},
+            {"dur", event.durationNs / 1000.0}
+        });
+    }
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qDebug() << "Failed to open trace file" << path;
+        return false;
+    }
+    file.write(QJsonDocument(QJsonObject{{"traceEvents", traceEvents},
+                                         {"displayTimeUnit", "ms"}}).toJson(QJsonDocument::Compact));
+    return file.commit();
+}
+
+GpuProfiler::GpuProfiler()
+    : supported(false)
+{
+}
+
+GpuProfiler::~GpuProfiler() = default;
+
+void GpuProfiler::initialize()
+{
+    // Пробный запрос: GL_TIME_ELAPSED есть не у всех драйверов
+    auto probe = std::make_unique<QOpenGLTimerQuery>();
+    supported = probe->create();
+    if (!supported) {
+        qDebug() << "GL timer queries are not supported, GPU profiling disabled";
+        return;
+    }
+    freeQueries.append(probe.get());
+    pool.push_back(std::move(probe));
+}
+
+void GpuProfiler::begin(const char* name)
+{
+    if (!supported || active.query)
+        return;
+
+    if (freeQueries.isEmpty()) {
+        if (int(pool.size()) >= MAX_QUERIES)
+            return; // GPU отстал сильнее, чем на MAX_QUERIES замеров — пропускаем
+        auto query = std::make_unique<QOpenGLTimerQuery>();
+        if (!query->create())
+            return;
+        freeQueries.append(query.get());
+        pool.push_back(std::move(query));
+    }
+
+    active.query = freeQueries.takeLast();
+    active.name = name;
+    active.startNs = FrameProfiler::instance().now();
+    active.query->begin();
+}
+
+void GpuProfiler::end()
+{
+    if (!active.query)
+        return;
+    active.query->end();
+    pending.enqueue(active);
+    active = Pending();
+}
+
+void GpuProfiler::collect()
+{
+    // Запросы завершаются по порядку: первый неготовый означает, что и остальные не готовы
+    while (!pending.isEmpty() && pending.head().query->isResultAvailable()) {
+        Pending done = pending.dequeue();
+        GLuint64 elapsedNs = done.query->waitForResult();
+        freeQueries.append(done.query);
+
+        FrameProfiler& profiler = FrameProfiler::instance();
+        if (profiler.isEnabled())
+            profiler.addSample(done.name, done.startNs, qint64(elapsedNs), true);
+    }
+}
+
+ProfileScope::ProfileScope(const char* scopeName, GpuProfiler* gpuProfiler)
+    : name(scopeName)
+    , gpu(gpuProfiler)
+    , start(0)
+    , active(FrameProfiler::instance().isEnabled())
+{
+    if (!active)
+        return;
+    start = FrameProfiler::instance().now();
+    if (gpu)
+        gpu->begin(name);
+}
+
+ProfileScope::~ProfileScope()
+{
+    if (!active)
+        return;
+    if (gpu)
+        gpu->end();
+    FrameProfiler& profiler = FrameProfiler::instance();
+    profiler.addSample(name, start, profiler.now() - start, false);
+}
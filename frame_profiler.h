@@ -0,0 +1,126 @@
+// frame_profiler.h
+#ifndef FRAME_PROFILER_H
+#define FRAME_PROFILER_H
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMutex>
+#include <QQueue>
+#include <QString>
+#include <QVector>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+class QOpenGLTimerQuery;
+
+// Профилировщик кадра: длительности проходов на CPU и GPU, история
+// за последние кадры, перцентили и экспорт в формат Chrome trace.
+// Замеры приходят из GUI-потока и из потока рендеринга.
+class FrameProfiler {
+public:
+    struct Stats {
+        QString name;
+        bool gpu = false;
+        int count = 0;
+        double p50Ms = 0.0;
+        double p99Ms = 0.0;
+        double maxMs = 0.0;
+        QVector<int> histogram; // HISTOGRAM_BINS корзин от 0 до maxMs
+    };
+
+    static constexpr int HISTORY = 600;            // замеров на проход
+    static constexpr int HISTOGRAM_BINS = 16;
+    static constexpr int MAX_TRACE_EVENTS = 20000;
+
+    static FrameProfiler& instance();
+
+    void setEnabled(bool enabled);
+    bool isEnabled() const { return enabledFlag.load(std::memory_order_relaxed); }
+
+    qint64 now() const { return clock.nsecsElapsed(); }
+    // name — строковый литерал, хранится без копирования
+    void addSample(const char* name, qint64 startNs, qint64 durationNs, bool gpu);
+    void reset();
+
+    QVector<Stats> statistics() const;
+    bool exportChromeTrace(const QString& path) const;
+
+private:
+    FrameProfiler();
+
+    struct Series {
+        const char* name;
+        bool gpu;
+        QVector<float> durationsMs; // кольцевой буфер
+        int next = 0;
+        int count = 0;
+    };
+
+    struct Event {
+        const char* name;
+        qint64 startNs;
+        qint64 durationNs;
+        quintptr thread;
+        bool gpu;
+    };
+
+    Series& seriesFor(const char* name, bool gpu);
+
+    std::atomic<bool> enabledFlag;
+    QElapsedTimer clock;
+
+    mutable QMutex mutex;
+    QVector<Series> series;
+    QVector<Event> events; // кольцевой буфер для трассы
+    int nextEvent;
+    QHash<quintptr, QString> threadNames;
+};
+
+// GL_TIME_ELAPSED запросы в текущем контексте. Результаты забираются
+// в collect() через несколько кадров, когда готовы, без ожидания GPU.
+// Запросы не вкладываются: внутренний begin при активном запросе игнорируется.
+class GpuProfiler {
+public:
+    GpuProfiler();
+    ~GpuProfiler();
+
+    // Требует активного OpenGL контекста
+    void initialize();
+    void begin(const char* name);
+    void end();
+    void collect();
+
+private:
+    struct Pending {
+        QOpenGLTimerQuery* query = nullptr;
+        const char* name = nullptr;
+        qint64 startNs = 0;
+    };
+
+    static constexpr int MAX_QUERIES = 64;
+
+    std::vector<std::unique_ptr<QOpenGLTimerQuery>> pool;
+    QVector<QOpenGLTimerQuery*> freeQueries;
+    QQueue<Pending> pending;
+    Pending active;
+    bool supported;
+};
+
+// Замер области видимости на CPU и, если передан gpu, на GPU
+class ProfileScope {
+public:
+    explicit ProfileScope(const char* name, GpuProfiler* gpu = nullptr);
+    ~ProfileScope();
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    const char* name;
+    GpuProfiler* gpu;
+    qint64 start;
+    bool active;
+};
+
+#endif // FRAME_PROFILER_H
@@ -0,0 +1,90 @@
+// frame_scheduler.cpp
+#include "frame_scheduler.h"
+#include <QOpenGLWidget>
+
+FrameScheduler::FrameScheduler(QOpenGLWidget* targetWidget)
+    : QObject(targetWidget)
+    , widget(targetWidget)
+    , lastFrameNs(0)
+    , mode(PacingMode::Timer)
+    , targetFps(0)
+    , dirty(true)
+    , pending(false)
+    , inFrame(false)
+    , animating(false)
+{
+    clock.start();
+
+    frameTimer.setSingleShot(true);
+    frameTimer.setTimerType(Qt::PreciseTimer);
+    connect(&frameTimer, &QTimer::timeout, widget, [this]() { widget->update(); });
+    connect(widget, &QOpenGLWidget::frameSwapped, this, &FrameScheduler::onFrameSwapped);
+}
+
+void FrameScheduler::invalidate()
+{
+    dirty = true;
+    // Изменения во время отрисовки учитываются в endFrame/frameSwapped
+    if (!inFrame)
+        schedule();
+}
+
+void FrameScheduler::setAnimating(bool isAnimating)
+{
+    if (animating == isAnimating)
+        return;
+    animating = isAnimating;
+    if (animating && !inFrame)
+        schedule();
+}
+
+void FrameScheduler::setTargetFrameRate(int fps)
+{
+    targetFps = qMax(0, fps);
+}
+
+void FrameScheduler::setPacingMode(PacingMode newMode)
+{
+    mode = newMode;
+}
+
+void FrameScheduler::beginFrame()
+{
+    inFrame = true;
+    pending = false;
+    dirty = false;
+    frameTimer.stop();
+    lastFrameNs = clock.nsecsElapsed();
+}
+
+void FrameScheduler::endFrame()
+{
+    inFrame = false;
+    if (mode == PacingMode::Timer && (dirty || animating))
+        schedule();
+}
+
+void FrameScheduler::onFrameSwapped()
+{
+    if (mode == PacingMode::FrameSwapped && (dirty || animating))
+        schedule();
+}
+
+void FrameScheduler::schedule()
+{
+    if (pending)
+        return;
+    pending = true;
+
+    qint64 delayMs = 0;
+    if (targetFps > 0) {
+        qint64 frameIntervalNs = 1000000000LL / targetFps;
+        qint64 sinceLastFrameNs = clock.nsecsElapsed() - lastFrameNs;
+        delayMs = qMax<qint64>(0, (frameIntervalNs - sinceLastFrameNs) / 1000000);
+    }
+
+    if (delayMs > 0)
+        frameTimer.start(int(delayMs));
+    else
+        widget->update();
+}
@@ -0,0 +1,59 @@
+// frame_scheduler.h
+#ifndef FRAME_SCHEDULER_H
+#define FRAME_SCHEDULER_H
+
+#include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
+
+class QOpenGLWidget;
+
+// Планировщик кадров: объединяет запросы на перерисовку и рисует только
+// когда изменилась симуляция или камера. Без изменений виджет простаивает.
+class FrameScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum class PacingMode {
+        Timer,        // Следующий кадр планируется таймером (с учетом ограничения FPS)
+        FrameSwapped  // Следующий кадр запрашивается по QOpenGLWidget::frameSwapped (V-Sync)
+    };
+
+    explicit FrameScheduler(QOpenGLWidget* widget);
+
+    // Помечает сцену измененной; несколько вызовов за кадр дают одну перерисовку
+    void invalidate();
+
+    // Непрерывная анимация (идет время симуляции)
+    void setAnimating(bool animating);
+    bool isAnimating() const { return animating; }
+
+    // 0 — без ограничения
+    void setTargetFrameRate(int fps);
+    int targetFrameRate() const { return targetFps; }
+
+    void setPacingMode(PacingMode mode);
+    PacingMode pacingMode() const { return mode; }
+
+    // Вызываются из paintGL
+    void beginFrame();
+    void endFrame();
+
+private:
+    void schedule();
+    void onFrameSwapped();
+
+    QOpenGLWidget* widget;
+    QTimer frameTimer;
+    QElapsedTimer clock;
+    qint64 lastFrameNs;
+    PacingMode mode;
+    int targetFps;
+    bool dirty;
+    bool pending;
+    bool inFrame;
+    bool animating;
+};
+
+#endif // FRAME_SCHEDULER_H
@@ -0,0 +1,245 @@
+// glyph_atlas.cpp
+#include "glyph_atlas.h"
+#include <QFontMetricsF>
+#include <QPainter>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+constexpr int ATLAS_WIDTH = 512;
+constexpr float INF = 1e20f;
+
+// Одномерное точное преобразование расстояний (Felzenszwalb, Huttenlocher)
+void distanceTransform1D(const float* f, int n, float* d, int* v, float* z)
+{
+    int k = 0;
+    v[0] = 0;
+    z[0] = -INF;
+    z[1] = INF;
+    for (int q = 1; q < n; ++q) {
+        float s = ((f[q] + q * q) - (f[v[k]] + v[k] * v[k])) / (2.0f * q - 2.0f * v[k]);
+        while (s <= z[k]) {
+            --k;
+            s = ((f[q] + q * q) - (f[v[k]] + v[k] * v[k])) / (2.0f * q - 2.0f * v[k]);
+        }
+        ++k;
+        v[k] = q;
+        z[k] = s;
+        z[k + 1] = INF;
+    }
+
+    k = 0;
+    for (int q = 0; q < n; ++q) {
+        while (z[k + 1] < q)
+            ++k;
+        d[q] = (q - v[k]) * (q - v[k]) + f[v[k]];
+    }
+}
+
+}
+
+GlyphAtlas::GlyphAtlas(const QFont& baseFont)
+    : font(baseFont)
+    , ascent(0.0f)
+    , lineSpacing(0.0f)
+{
+    font.setPixelSize(BASE_PIXEL_SIZE);
+}
+
+QVector<uint> GlyphAtlas::characterSet()
+{
+    QVector<uint> codes;
+    for (uint c = 0x20; c <= 0x7E; ++c)    // ASCII
+        codes.append(c);
+    for (uint c = 0xA0; c <= 0xFF; ++c)    // Latin-1, в т.ч. знак градуса
+        codes.append(c);
+    for (uint c = 0x410; c <= 0x44F; ++c)  // кириллица
+        codes.append(c);
+    codes.append(0x401);
+    codes.append(0x451);
+    return codes;
+}
+
+void GlyphAtlas::distanceTransform(QVector<float>& grid, int width, int height)
+{
+    const int n = std::max(width, height);
+    QVector<float> f(n), d(n), z(n + 1);
+    QVector<int> v(n);
+
+    for (int x = 0; x < width; ++x) {
+        for (int y = 0; y < height; ++y)
+            f[y] = grid[y * width + x];
+        distanceTransform1D(f.constData(), height, d.data(), v.data(), z.data());
+        for (int y = 0; y < height; ++y)
+            grid[y * width + x] = d[y];
+    }
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x)
+            f[x] = grid[y * width + x];
+        distanceTransform1D(f.constData(), width, d.data(), v.data(), z.data());
+        for (int x = 0; x < width; ++x)
+            grid[y * width + x] = d[x];
+    }
+}
+
+void GlyphAtlas::build()
+{
+    QFontMetricsF metrics(font);
+    ascent = metrics.ascent();
+    lineSpacing = metrics.lineSpacing();
+
+    struct Pending {
+        uint code;
+        QImage sdf;
+        QPoint position;
+    };
+    QVector<Pending> pending;
+    glyphs.clear();
+
+    for (uint code : characterSet()) {
+        const char32_t character = code;
+        const QString text = QString::fromUcs4(&character, 1);
+
+        Glyph glyph;
+        glyph.advance = metrics.horizontalAdvance(text);
+
+        const QRectF bounds = metrics.tightBoundingRect(text);
+        if (bounds.isEmpty()) {
+            glyphs.insert(code, glyph); // пробелы: только продвижение
+            continue;
+        }
+
+        const int margin = SPREAD + 1;
+        const int width = int(std::ceil(bounds.width())) + margin * 2;
+        const int height = int(std::ceil(bounds.height())) + margin * 2;
+        glyph.plane = QRectF(bounds.left() - margin, bounds.top() - margin, width, height);
+
+        QImage mask(width, height, QImage::Format_ARGB32_Premultiplied);
+        mask.fill(Qt::transparent);
+        QPainter painter(&mask);
+        painter.setFont(font);
+        painter.setPen(Qt::white);
+        painter.drawText(QPointF(margin - bounds.left(), margin - bounds.top()), text);
+        painter.end();
+
+        // Квадраты расстояний до ближайшего пикселя внутри и снаружи контура
+        QVector<float> toInside(width * height);
+        QVector<float> toOutside(width * height);
+        for (int y = 0; y < height; ++y) {
+            const QRgb* line = reinterpret_cast<const QRgb*>(mask.constScanLine(y));
+            for (int x = 0; x < width; ++x) {
+                const bool inside = qAlpha(line[x]) > 127;
+                toInside[y * width + x] = inside ? 0.0f : INF;
+                toOutside[y * width + x] = inside ? INF : 0.0f;
+            }
+        }
+        distanceTransform(toInside, width, height);
+        distanceTransform(toOutside, width, height);
+
+        // 0.5 — контур, больше — внутри глифа
+        QImage sdf(width, height, QImage::Format_Grayscale8);
+        for (int y = 0; y < height; ++y) {
+            uchar* line = sdf.scanLine(y);
+            for (int x = 0; x < width; ++x) {
+                const int i = y * width + x;
+                const float distance = toOutside[i] > 0.0f
+                    ? 0.5f - std::sqrt(toOutside[i])
+                    : std::sqrt(toInside[i]) - 0.5f;
+                const float value = 0.5f - distance / (2.0f * SPREAD);
+                line[x] = uchar(std::clamp(value, 0.0f, 1.0f) * 255.0f + 0.5f);
+            }
+        }
+
+        glyphs.insert(code, glyph);
+        pending.append({code, sdf, QPoint()});
+    }
+
+    // Упаковка полками: сначала высокие глифы
+    std::sort(pending.begin(), pending.end(), [](const Pending& a, const Pending& b) {
+        return a.sdf.height() > b.sdf.height();
+    });
+    int x = 0, y = 0, shelfHeight = 0;
+    for (Pending& item : pending) {
+        if (x + item.sdf.width() > ATLAS_WIDTH) {
+            x = 0;
+            y += shelfHeight + 1;
+            shelfHeight = 0;
+        }
+        item.position = QPoint(x, y);
+        x += item.sdf.width() + 1;
+        shelfHeight = std::max(shelfHeight, item.sdf.height());
+    }
+
+    int atlasHeight = 1;
+    while (atlasHeight < y + shelfHeight)
+        atlasHeight *= 2;
+
+    atlas = QImage(ATLAS_WIDTH, atlasHeight, QImage::Format_Grayscale8);
+    atlas.fill(0);
+    for (const Pending& item : pending) {
+        for (int row = 0; row < item.sdf.height(); ++row) {
+            std::copy_n(item.sdf.constScanLine(row), item.sdf.width(),
+                        atlas.scanLine(item.position.y() + row) + item.position.x());
+        }
+        Glyph& glyph = glyphs[item.code];
+        glyph.uv = QRectF(float(item.position.x()) / ATLAS_WIDTH,
+                          float(item.position.y()) / atlasHeight,
+                          float(item.sdf.width()) / ATLAS_WIDTH,
+                          float(item.sdf.height()) / atlasHeight);
+    }
+
+    fallback = glyphs.value('?');
+}
+
+const GlyphAtlas::Glyph& GlyphAtlas::glyph(uint codePoint) const
+{
+    auto it = glyphs.constFind(codePoint);
+    return it != glyphs.constEnd() ? *it : fallback;
+}
+
+QVector<GlyphAtlas::Quad> GlyphAtlas::layout(const QString& text, float pixelSize) const
+{
+    QVector<Quad> quads;
+    quads.reserve(text.size());
+
+    const float scale = pixelSize / BASE_PIXEL_SIZE;
+    float x = 0.0f;
+    float baseline = ascent * scale;
+    for (uint code : text.toUcs4()) {
+        if (code == '\n') {
+            x = 0.0f;
+            baseline += lineSpacing * scale;
+            continue;
+        }
+
+        const Glyph& g = glyph(code);
+        if (!g.plane.isEmpty()) {
+            quads.append({QRectF(x + g.plane.left() * scale, baseline + g.plane.top() * scale,
+                                 g.plane.width() * scale, g.plane.height() * scale),
+                          g.uv});
+        }
+        x += g.advance * scale;
+    }
+    return quads;
+}
+
+QSizeF GlyphAtlas::measure(const QString& text, float pixelSize) const
+{
+    const float scale = pixelSize / BASE_PIXEL_SIZE;
+    float width = 0.0f;
+    float x = 0.0f;
+    int lines = 1;
+    for (uint code : text.toUcs4()) {
+        if (code == '\n') {
+            width = std::max(width, x);
+            x = 0.0f;
+            ++lines;
+            continue;
+        }
+        x += glyph(code).advance * scale;
+    }
+    width = std::max(width, x);
+    return QSizeF(width, lines * lineSpacing * scale);
+}
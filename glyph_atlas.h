@@ -0,0 +1,57 @@
+// glyph_atlas.h
+#ifndef GLYPH_ATLAS_H
+#define GLYPH_ATLAS_H
+
+#include <QFont>
+#include <QHash>
+#include <QImage>
+#include <QRectF>
+#include <QSizeF>
+#include <QString>
+#include <QVector>
+
+// Атлас глифов в виде поля расстояний (SDF). Строится один раз на CPU;
+// одна текстура подходит для любого размера шрифта, края остаются четкими.
+class GlyphAtlas {
+public:
+    struct Glyph {
+        QRectF uv;        // область в атласе, нормализованная
+        QRectF plane;     // прямоугольник квада относительно начала на базовой линии, px базового размера
+        float advance = 0.0f;
+    };
+
+    // Квад глифа после раскладки, координаты в пикселях относительно левого верхнего угла текста
+    struct Quad {
+        QRectF rect;
+        QRectF uv;
+    };
+
+    static constexpr int BASE_PIXEL_SIZE = 32; // размер, в котором растеризуются глифы
+    static constexpr int SPREAD = 4;           // радиус поля расстояний, px
+
+    explicit GlyphAtlas(const QFont& font = QFont("Arial"));
+
+    void build();
+    bool isBuilt() const { return !atlas.isNull(); }
+
+    const QImage& image() const { return atlas; } // Format_Grayscale8
+    const Glyph& glyph(uint codePoint) const;
+
+    // Раскладка многострочного текста; '\n' переносит строку
+    QVector<Quad> layout(const QString& text, float pixelSize) const;
+    QSizeF measure(const QString& text, float pixelSize) const;
+    float lineHeight(float pixelSize) const { return lineSpacing * pixelSize / BASE_PIXEL_SIZE; }
+
+private:
+    static QVector<uint> characterSet();
+    static void distanceTransform(QVector<float>& grid, int width, int height);
+
+    QFont font;
+    QImage atlas;
+    QHash<uint, Glyph> glyphs;
+    Glyph fallback;
+    float ascent;
+    float lineSpacing;
+};
+
+#endif // GLYPH_ATLAS_H
@@ -0,0 +1,134 @@
+// gpu_memory_budget.cpp
+#include "gpu_memory_budget.h"
+#include <QDebug>
+#include <algorithm>
+
+qint64 GpuMemoryBudget::LayerUsage::bytes() const
+{
+    qint64 total = 0;
+    for (qint64 mip : bytesPerMip)
+        total += mip;
+    return total;
+}
+
+GpuMemoryBudget::GpuMemoryBudget()
+    : limitBytes(0)
+    , usedBytes(0)
+    , reclaiming(false)
+{
+}
+
+int GpuMemoryBudget::registerLayer(const QString& name, Priority priority, Reclaim reclaim)
+{
+    Layer layer;
+    layer.usage.name = name;
+    layer.usage.priority = priority;
+    layer.reclaim = std::move(reclaim);
+    layer.registered = true;
+    layerList.append(layer);
+    return layerList.size() - 1;
+}
+
+void GpuMemoryBudget::unregisterLayer(int layer)
+{
+    if (layer < 0 || layer >= layerList.size() || !layerList[layer].registered)
+        return;
+    setUsage(layer, {});
+    layerList[layer].registered = false;
+    layerList[layer].reclaim = Reclaim();
+}
+
+void GpuMemoryBudget::setUsage(int layer, const QVector<qint64>& bytesPerMip)
+{
+    if (layer < 0 || layer >= layerList.size() || !layerList[layer].registered)
+        return;
+    LayerUsage& usage = layerList[layer].usage;
+    usedBytes -= usage.bytes();
+    usage.bytesPerMip = bytesPerMip;
+    usedBytes += usage.bytes();
+}
+
+bool GpuMemoryBudget::request(int layer, qint64 bytes, ReclaimScope scope)
+{
+    if (limitBytes <= 0)
+        return true;
+    if (layer < 0 || layer >= layerList.size() || !layerList[layer].registered)
+        return usedBytes + bytes <= limitBytes;
+
+    const qint64 excess = usedBytes + bytes - limitBytes;
+    if (excess > 0 && scope != ReclaimScope::None && !reclaiming)
+        reclaim(excess, scope, layerList[layer].usage.priority, layer);
+    return usedBytes + bytes <= limitBytes;
+}
+
+void GpuMemoryBudget::enforce()
+{
+    if (limitBytes <= 0 || usedBytes <= limitBytes || reclaiming)
+        return;
+
+    reclaim(usedBytes - limitBytes, ReclaimScope::All, Priority::High, -1);
+    if (usedBytes > limitBytes) {
+        qWarning() << "GPU memory budget exceeded:" << usedBytes / (1024 * 1024) << "MB used of"
+                   << limitBytes / (1024 * 1024) << "MB";
+    }
+}
+
+QVector<GpuMemoryBudget::LayerUsage> GpuMemoryBudget::layers() const
+{
+    QVector<LayerUsage> result;
+    for (const Layer& layer : layerList) {
+        if (layer.registered)
+            result.append(layer.usage);
+    }
+    return result;
+}
+
+QVector<qint64> GpuMemoryBudget::textureBytes(int width, int height, int bytesPerTexel, bool mipmapped)
+{
+    QVector<qint64> mips;
+    if (width <= 0 || height <= 0)
+        return mips;
+
+    while (true) {
+        mips.append(qint64(width) * height * bytesPerTexel);
+        if (!mipmapped || (width == 1 && height == 1))
+            break;
+        width = std::max(1, width / 2);
+        height = std::max(1, height / 2);
+    }
+    return mips;
+}
+
+void GpuMemoryBudget::reclaim(qint64 bytes, ReclaimScope scope, Priority priority, int requester)
+{
+    // Сначала низший приоритет, внутри него — самые крупные слои. Кэши
+    // отдают только слои ниже запросившего: иначе слои одного приоритета
+    // выгружали бы тайлы друг друга каждый кадр
+    QVector<int> order;
+    for (int i = 0; i < layerList.size(); ++i) {
+        const Layer& layer = layerList[i];
+        if (i == requester || !layer.registered || !layer.reclaim)
+            continue;
+        if (scope == ReclaimScope::Caches ? layer.usage.priority < priority : layer.usage.priority <= priority)
+            order.append(i);
+    }
+    std::sort(order.begin(), order.end(), [this](int a, int b) {
+        const LayerUsage& first = layerList[a].usage;
+        const LayerUsage& second = layerList[b].usage;
+        if (first.priority != second.priority)
+            return first.priority < second.priority;
+        return first.bytes() > second.bytes();
+    });
+
+    reclaiming = true;
+    for (int index : order) {
+        if (bytes <= 0)
+            break;
+        const qint64 before = usedBytes;
+        // Копия: слой может сняться с учета изнутри функции
+        const Reclaim reclaimLayer = layerList[index].reclaim;
+        reclaimLayer(bytes, scope);
+        bytes -= before - usedBytes;
+    }
+    reclaiming = false;
+}
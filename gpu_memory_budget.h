@@ -0,0 +1,85 @@
+// gpu_memory_budget.h
+#ifndef GPU_MEMORY_BUDGET_H
+#define GPU_MEMORY_BUDGET_H
+
+#include <QString>
+#include <QVector>
+#include <functional>
+
+// Общий бюджет видеопамяти под текстуры слоев сцены. Слои регистрируются
+// с приоритетом и сообщают занятые байты по уровням mip; перед выделением
+// слой запрашивает место. Когда лимит превышен, память освобождают другие
+// слои, начиная с низшего приоритета, в пределах области запроса: кэши
+// (тайлы) выгружаются у слоев ниже запросившего, разрешение (атласы)
+// уменьшается у слоев не выше его. Запросивший слой себя не сжимает.
+// Слои без функции освобождения только учитываются.
+//
+// Работает в потоке OpenGL контекста сцены; функции освобождения
+// вызываются при активном контексте.
+class GpuMemoryBudget {
+public:
+    enum class Priority {
+        Low,    // вспомогательные карты: уменьшаются первыми
+        Normal,
+        High    // основной цвет, облака, таблицы атмосферы
+    };
+
+    // Чем запрос может освободить место у других слоев
+    enum class ReclaimScope {
+        None,   // только свободное место
+        Caches, // выгрузка кэшей слоев с приоритетом ниже
+        All     // и уменьшение разрешения слоев с приоритетом не выше
+    };
+
+    // Освобождает у слоя до bytes байт в пределах scope и сообщает новый
+    // расход через setUsage
+    using Reclaim = std::function<void(qint64 bytes, ReclaimScope scope)>;
+
+    struct LayerUsage {
+        QString name;
+        Priority priority = Priority::Normal;
+        QVector<qint64> bytesPerMip; // индекс — уровень mip
+        qint64 bytes() const;
+    };
+
+    GpuMemoryBudget();
+
+    // Лимит в байтах; 0 — без ограничения
+    void setLimit(qint64 bytes) { limitBytes = bytes; }
+    qint64 limit() const { return limitBytes; }
+    qint64 used() const { return usedBytes; }
+
+    int registerLayer(const QString& name, Priority priority, Reclaim reclaim = Reclaim());
+    void unregisterLayer(int layer);
+    void setUsage(int layer, const QVector<qint64>& bytesPerMip);
+
+    // Место под bytes новых байт слоя layer, при нехватке — за счет других
+    // слоев в пределах scope. false — не помещается и после освобождения
+    bool request(int layer, qint64 bytes, ReclaimScope scope = ReclaimScope::All);
+    // Возвращает расход в лимит после его уменьшения или роста слоев
+    // без запросов; вызывается раз в кадр
+    void enforce();
+
+    // Зарегистрированные слои (снятые с учета не входят)
+    QVector<LayerUsage> layers() const;
+
+    // Байты текстуры по уровням mip; без mipmapped — только уровень 0
+    static QVector<qint64> textureBytes(int width, int height, int bytesPerTexel, bool mipmapped);
+
+private:
+    struct Layer {
+        LayerUsage usage;
+        Reclaim reclaim;
+        bool registered = false;
+    };
+
+    // requester — запросивший слой, он не сжимается; -1 — никто
+    void reclaim(qint64 bytes, ReclaimScope scope, Priority priority, int requester);
+
+    QVector<Layer> layerList; // индекс — номер слоя
+    qint64 limitBytes;
+    qint64 usedBytes;
+    bool reclaiming;          // освобождение не вкладывается
+};
+
+#endif // GPU_MEMORY_BUDGET_H
@@ -0,0 +1,124 @@
+// gpu_propagator.cpp
+#include "gpu_propagator.h"
+#include "eclipse_model.h"
+#include "solar_ephemeris.h"
+#include <QDebug>
+#include <cmath>
+
+GpuPropagator::GpuPropagator()
+    : recordBuffer(QOpenGLBuffer::VertexBuffer)
+    , recordCapacity(0)
+    , valid(false)
+{
+}
+
+GpuPropagator::~GpuPropagator()
+{
+    if (vao.isCreated())
+        vao.destroy();
+    if (recordBuffer.isCreated())
+        recordBuffer.destroy();
+}
+
+bool GpuPropagator::initialize()
+{
+    initializeOpenGLFunctions();
+
+    if (!program.addShaderFromSourceFile(QOpenGLShader::Vertex, ":/shaders/kepler_propagate_vertex.glsl")) {
+        qDebug() << "Failed to compile Kepler propagation shader";
+        return false;
+    }
+
+    // Выход transform feedback задается до компоновки; положения и
+    // освещенность идут в разные буферы
+    const char* varyings[] = {"instance", "illumination"};
+    glTransformFeedbackVaryings(program.programId(), 2, varyings, GL_SEPARATE_ATTRIBS);
+    if (!program.link()) {
+        qDebug() << "Failed to link Kepler propagation program";
+        return false;
+    }
+
+    vao.create();
+    vao.bind();
+    recordBuffer.create();
+    recordBuffer.setUsagePattern(QOpenGLBuffer::DynamicDraw);
+    recordBuffer.bind();
+    for (int attribute = 0; attribute < 3; ++attribute) {
+        glEnableVertexAttribArray(attribute);
+        glVertexAttribPointer(attribute, 4, GL_FLOAT, GL_FALSE, sizeof(Record),
+                              reinterpret_cast<void*>(attribute * sizeof(QVector4D)));
+    }
+    vao.release();
+
+    valid = true;
+    return true;
+}
+
+GpuPropagator::Record GpuPropagator::makeRecord(const SatelliteOrbit& orbit, const QVector4D& instance,
+                                                double referenceTime)
+{
+    Record record;
+    if (!orbit.isValid()) {
+        record.axisP = instance;
+        return record;
+    }
+
+    // Аномалия на опорный момент считается в double; шейдеру остается
+    // прибавить n·dt за время не больше REBASE_INTERVAL
+    double M = std::fmod(orbit.meanAnomaly + orbit.meanMotion * (referenceTime - orbit.epoch), 2.0 * M_PI);
+    if (M < 0.0)
+        M += 2.0 * M_PI;
+
+    record.motion = QVector4D(float(orbit.meanMotion), float(M), orbit.eccentricity, 1.0f);
+    record.axisP = QVector4D(orbit.axisP, instance.w());
+    record.axisQ = QVector4D(orbit.axisQ, 0.0f);
+    return record;
+}
+
+bool GpuPropagator::reserve(int capacity)
+{
+    if (!valid || capacity <= recordCapacity)
+        return false;
+    recordBuffer.bind();
+    recordBuffer.allocate(capacity * int(sizeof(Record)));
+    recordBuffer.release();
+    recordCapacity = capacity;
+    return true;
+}
+
+void GpuPropagator::writeRecords(int first, const Record* records, int count)
+{
+    if (!valid || count <= 0 || first + count > recordCapacity)
+        return;
+    recordBuffer.bind();
+    recordBuffer.write(first * int(sizeof(Record)), records, count * int(sizeof(Record)));
+    recordBuffer.release();
+}
+
+void GpuPropagator::propagate(GLuint targetBuffer, GLuint illuminationBuffer, int count, float timeSinceReference,
+                              const QVector3D& sunPosition)
+{
+    if (!valid || count <= 0 || count > recordCapacity)
+        return;
+
+    program.bind();
+    program.setUniformValue("timeSinceReference", timeSinceReference);
+    program.setUniformValue("sunPosition", sunPosition);
+    program.setUniformValue("earthRadius", float(EclipseModel::EARTH_RADIUS));
+    program.setUniformValue("sunRadius", float(SolarEphemeris::SUN_RADIUS));
+    vao.bind();
+
+    // Только вершинный этап: растеризация не нужна
+    glEnable(GL_RASTERIZER_DISCARD);
+    glBindBufferRange(GL_TRANSFORM_FEEDBACK_BUFFER, 0, targetBuffer, 0, GLsizeiptr(count) * sizeof(QVector4D));
+    glBindBufferRange(GL_TRANSFORM_FEEDBACK_BUFFER, 1, illuminationBuffer, 0, GLsizeiptr(count) * sizeof(float));
+    glBeginTransformFeedback(GL_POINTS);
+    glDrawArrays(GL_POINTS, 0, count);
+    glEndTransformFeedback();
+    glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 1, 0);
+    glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0);
+    glDisable(GL_RASTERIZER_DISCARD);
+
+    vao.release();
+    program.release();
+}
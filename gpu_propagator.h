@@ -0,0 +1,63 @@
+// gpu_propagator.h
+#ifndef GPU_PROPAGATOR_H
+#define GPU_PROPAGATOR_H
+
+#include <QOpenGLExtraFunctions>
+#include <QOpenGLShaderProgram>
+#include <QOpenGLVertexArrayObject>
+#include <QOpenGLBuffer>
+#include <QVector>
+#include <QVector3D>
+#include <QVector4D>
+#include "satellite_orbit.h"
+
+// Пропагация Кеплера в вершинном шейдере с записью через transform feedback
+// (OpenGL 3.3, работает и на Mesa llvmpipe). Записи орбит лежат в буфере по
+// слотам; проход пишет vec4 положения и флагов в целевой буфер и освещенность
+// Солнцем в буфер float на слот, так что CPU не трогает положения объектов
+// каждый кадр.
+//
+// GLSL 3.30 считает во float, поэтому аномалия хранится на опорный момент,
+// а шейдер получает только время от него. Опорный момент выбирает владелец
+// и переписывает записи при его сдвиге (см. REBASE_INTERVAL).
+class GpuPropagator : protected QOpenGLExtraFunctions
+{
+public:
+    // Запись слота: 48 Б, три атрибута шейдера kepler_propagate_vertex.glsl
+    struct Record {
+        QVector4D motion; // n, M на опорный момент, e, 1 — орбита / 0 — неподвижная точка
+        QVector4D axisP;  // a·P или положение точки; w — флаги SatelliteStore::Flag
+        QVector4D axisQ;  // b·Q
+    };
+
+    GpuPropagator();
+    ~GpuPropagator();
+
+    // Требует активного контекста; false — transform feedback недоступен
+    bool initialize();
+    bool isValid() const { return valid; }
+
+    // Запись для орбиты на опорный момент; без орбиты — неподвижная точка instance
+    static Record makeRecord(const SatelliteOrbit& orbit, const QVector4D& instance, double referenceTime);
+
+    // Емкость буфера записей; true — буфер перевыделен и записи нужно записать заново
+    bool reserve(int capacity);
+    void writeRecords(int first, const Record* records, int count);
+
+    // Положения count слотов в targetBuffer (vec4 на слот) и их освещенность
+    // при положении Солнца sunPosition в illuminationBuffer (float на слот)
+    void propagate(GLuint targetBuffer, GLuint illuminationBuffer, int count, float timeSinceReference,
+                   const QVector3D& sunPosition);
+
+    // Сдвиг опорного момента: на час пропагации ошибка float — единицы метров
+    static constexpr double REBASE_INTERVAL = 3600.0; // с
+
+private:
+    QOpenGLShaderProgram program;
+    QOpenGLVertexArrayObject vao;
+    QOpenGLBuffer recordBuffer;
+    int recordCapacity;
+    bool valid;
+};
+
+#endif // GPU_PROPAGATOR_H
@@ -0,0 +1,161 @@
+// kepler_propagator.cpp
+#include "kepler_propagator.h"
+#include <algorithm>
+#include <cmath>
+
+double KeplerPropagator::solveKepler(double meanAnomaly, double eccentricity)
+{
+    double M = std::fmod(meanAnomaly, 2.0 * M_PI);
+    if (M < 0.0)
+        M += 2.0 * M_PI;
+
+    // Для больших эксцентриситетов начальное приближение pi сходится надежнее
+    double E = eccentricity < 0.8 ? M : M_PI;
+    for (int i = 0; i < MAX_ITERATIONS; ++i) {
+        double delta = (E - eccentricity * std::sin(E) - M) / (1.0 - eccentricity * std::cos(E));
+        E -= delta;
+        if (std::abs(delta) < TOLERANCE)
+            break;
+    }
+    return E;
+}
+
+QVector3D KeplerPropagator::position(const OrbitalElements& elements, double unixTime)
+{
+    const double e = elements.eccentricity;
+    const double a = elements.semiMajorAxis();
+    const double M = elements.meanAnomaly + elements.meanMotion * (unixTime - elements.epoch);
+    const double E = solveKepler(M, e);
+
+    // Положение в перифокальной системе
+    const double xOrbit = a * (std::cos(E) - e);
+    const double yOrbit = a * std::sqrt(1.0 - e * e) * std::sin(E);
+
+    const double cosW = std::cos(elements.argPerigee), sinW = std::sin(elements.argPerigee);
+    const double cosO = std::cos(elements.raan), sinO = std::sin(elements.raan);
+    const double cosI = std::cos(elements.inclination), sinI = std::sin(elements.inclination);
+
+    const double x = (cosO * cosW - sinO * sinW * cosI) * xOrbit + (-cosO * sinW - sinO * cosW * cosI) * yOrbit;
+    const double y = (sinO * cosW + cosO * sinW * cosI) * xOrbit + (-sinO * sinW + cosO * cosW * cosI) * yOrbit;
+    const double z = (sinW * sinI) * xOrbit + (cosW * sinI) * yOrbit;
+
+    // ECI -> сцена: ось Z ECI становится осью Y сцены
+    return QVector3D(float(x), float(z), float(-y));
+}
+
+bool KeplerPropagator::elementsFromState(const double position[3], const double velocity[3],
+                                         OrbitalElements& elements)
+{
+    const double mu = OrbitalElements::EARTH_MU;
+    const double rx = position[0], ry = position[1], rz = position[2];
+    const double vx = velocity[0], vy = velocity[1], vz = velocity[2];
+    const double r = std::sqrt(rx * rx + ry * ry + rz * rz);
+    const double v2 = vx * vx + vy * vy + vz * vz;
+    if (r <= 0.0)
+        return false;
+
+    // Удельная энергия; a > 0 только у эллиптических орбит
+    const double energy = v2 / 2.0 - mu / r;
+    if (energy >= 0.0)
+        return false;
+    const double a = -mu / (2.0 * energy);
+
+    // Момент импульса h = r x v и линия узлов n = z x h
+    const double hx = ry * vz - rz * vy;
+    const double hy = rz * vx - rx * vz;
+    const double hz = rx * vy - ry * vx;
+    const double h = std::sqrt(hx * hx + hy * hy + hz * hz);
+    if (h <= 0.0)
+        return false;
+    const double nx = -hy, ny = hx;
+    const double n = std::sqrt(nx * nx + ny * ny);
+
+    // Вектор эксцентриситета
+    const double rv = rx * vx + ry * vy + rz * vz;
+    const double ex = ((v2 - mu / r) * rx - rv * vx) / mu;
+    const double ey = ((v2 - mu / r) * ry - rv * vy) / mu;
+    const double ez = ((v2 - mu / r) * rz - rv * vz) / mu;
+    const double e = std::sqrt(ex * ex + ey * ey + ez * ez);
+
+    const double inclination = std::acos(std::clamp(hz / h, -1.0, 1.0));
+    const bool equatorial = n < CIRCULAR_EPSILON * h;
+    const bool circular = e < CIRCULAR_EPSILON;
+
+    // Углы через atan2 со знаком из направления движения; для вырожденных
+    // орбит неопределенный угол полагается нулевым, а фаза переносится в аномалию
+    const double raan = equatorial ? 0.0 : std::atan2(ny, nx);
+    double argPerigee = 0.0;
+    double trueAnomaly = 0.0;
+    if (!circular) {
+        // w = atan2((n x e) . h / |h|, n . e)
+        const double perigee = equatorial
+            ? std::atan2(ey, ex)
+            : std::atan2((ny * ez * hx - nx * ez * hy + (nx * ey - ny * ex) * hz) / h, nx * ex + ny * ey);
+        argPerigee = equatorial && hz < 0.0 ? -perigee : perigee;
+        // e cos v = h^2 / (mu r) - 1, e sin v = h (r . v) / (mu r)
+        trueAnomaly = std::atan2(h * rv, h * h - mu * r);
+    } else if (!equatorial) {
+        // Аргумент широты: (n x r) . h / |h| упрощается до rz |h|
+        trueAnomaly = std::atan2(rz * h, rx * nx + ry * ny);
+    } else {
+        // Истинная долгота
+        trueAnomaly = hz < 0.0 ? -std::atan2(ry, rx) : std::atan2(ry, rx);
+    }
+
+    const double E = 2.0 * std::atan2(std::sqrt(1.0 - e) * std::sin(trueAnomaly / 2.0),
+                                      std::sqrt(1.0 + e) * std::cos(trueAnomaly / 2.0));
+    const double M = E - e * std::sin(E);
+
+    const auto wrap = [](double angle) {
+        angle = std::fmod(angle, 2.0 * M_PI);
+        return angle < 0.0 ? angle + 2.0 * M_PI : angle;
+    };
+    elements.inclination = inclination;
+    elements.raan = wrap(raan);
+    elements.eccentricity = e;
+    elements.argPerigee = wrap(argPerigee);
+    elements.meanAnomaly = wrap(M);
+    elements.meanMotion = std::sqrt(mu / (a * a * a));
+    return true;
+}
+
+void KeplerPropagator::state(const OrbitalElements& elements, double unixTime,
+                             QVector3D& position, QVector3D& velocity)
+{
+    const double e = elements.eccentricity;
+    const double a = elements.semiMajorAxis();
+    const double n = elements.meanMotion;
+    const double M = elements.meanAnomaly + n * (unixTime - elements.epoch);
+    const double E = solveKepler(M, e);
+    const double cosE = std::cos(E), sinE = std::sin(E);
+    const double b = a * std::sqrt(1.0 - e * e);
+
+    // Перифокальная система; dE/dt = n / (1 - e cos E)
+    const double xOrbit = a * (cosE - e);
+    const double yOrbit = b * sinE;
+    const double dE = n / (1.0 - e * cosE);
+    const double vxOrbit = -a * sinE * dE;
+    const double vyOrbit = b * cosE * dE;
+
+    const double cosW = std::cos(elements.argPerigee), sinW = std::sin(elements.argPerigee);
+    const double cosO = std::cos(elements.raan), sinO = std::sin(elements.raan);
+    const double cosI = std::cos(elements.inclination), sinI = std::sin(elements.inclination);
+
+    // Орты P и Q перифокальной системы в ECI
+    const double px = cosO * cosW - sinO * sinW * cosI, py = sinO * cosW + cosO * sinW * cosI, pz = sinW * sinI;
+    const double qx = -cosO * sinW - sinO * cosW * cosI, qy = -sinO * sinW + cosO * cosW * cosI, qz = cosW * sinI;
+
+    // ECI -> сцена: (x, z, -y)
+    position = QVector3D(float(px * xOrbit + qx * yOrbit), float(pz * xOrbit + qz * yOrbit),
+                         float(-(py * xOrbit + qy * yOrbit)));
+    velocity = QVector3D(float(px * vxOrbit + qx * vyOrbit), float(pz * vxOrbit + qz * vyOrbit),
+                         float(-(py * vxOrbit + qy * vyOrbit)));
+}
+
+void KeplerPropagator::propagate(const QVector<OrbitalElements>& catalog, double unixTime,
+                                 QVector<QVector3D>& positions)
+{
+    positions.resize(catalog.size());
+    for (int i = 0; i < catalog.size(); ++i)
+        positions[i] = position(catalog[i], unixTime);
+}
@@ -0,0 +1,35 @@
+// kepler_propagator.h
+#ifndef KEPLER_PROPAGATOR_H
+#define KEPLER_PROPAGATOR_H
+
+#include <QVector>
+#include <QVector3D>
+#include "orbital_elements.h"
+
+// Невозмущенное движение по кеплеровой орбите. Положение возвращается
+// в системе сцены: ECI, где ось Y направлена на северный полюс, в метрах.
+class KeplerPropagator {
+public:
+    static QVector3D position(const OrbitalElements& elements, double unixTime);
+    // Положение и скорость (м/с) в системе сцены
+    static void state(const OrbitalElements& elements, double unixTime, QVector3D& position, QVector3D& velocity);
+
+    // Положения всего каталога на один момент; positions изменяется до размера catalog
+    static void propagate(const QVector<OrbitalElements>& catalog, double unixTime,
+                          QVector<QVector3D>& positions);
+
+    // Элементы из вектора состояния в ECI (ось Z на северный полюс), м и м/с.
+    // Эпоха и имя не меняются; для незамкнутых орбит возвращает false
+    static bool elementsFromState(const double position[3], const double velocity[3],
+                                  OrbitalElements& elements);
+
+    // Эксцентрическая аномалия из средней (уравнение Кеплера, метод Ньютона)
+    static double solveKepler(double meanAnomaly, double eccentricity);
+
+private:
+    static constexpr int MAX_ITERATIONS = 10;
+    static constexpr double TOLERANCE = 1e-10;
+    static constexpr double CIRCULAR_EPSILON = 1e-9; // порог для круговых и экваториальных орбит
+};
+
+#endif // KEPLER_PROPAGATOR_H
@@ -0,0 +1,166 @@
+// label_placer.cpp
+#include "label_placer.h"
+#include <algorithm>
+
+namespace {
+
+// Варианты положения подписи относительно точки спутника:
+// справа сверху, справа снизу, слева сверху, слева снизу
+constexpr float LABEL_GAP = 6.0f;
+
+}
+
+LabelPlacer::LabelPlacer(float radius)
+    : earthRadius(radius)
+    , lastSelectedId(-1)
+    , valid(false)
+    , satellitesMoved(false)
+    , gridColumns(0)
+    , gridRows(0)
+    , candidates(0)
+{
+}
+
+const QVector<LabelPlacer::Placement>& LabelPlacer::place(const SatelliteStore& satellites,
+                                                          const QMatrix4x4& viewProjection,
+                                                          const QVector3D& cameraPos,
+                                                          const QSize& viewport, int selectedId,
+                                                          const QRectF& reservedRect,
+                                                          const LabelSize& labelSize)
+{
+    const bool cameraChanged = viewProjection != lastViewProjection || viewport != lastViewport;
+    const bool refreshDue = satellitesMoved &&
+        (!sinceRefresh.isValid() || sinceRefresh.elapsed() >= REFRESH_INTERVAL_MS);
+    if (valid && !cameraChanged && !refreshDue && selectedId == lastSelectedId)
+        return result;
+
+    lastViewProjection = viewProjection;
+    lastViewport = viewport;
+    lastSelectedId = selectedId;
+    valid = true;
+    satellitesMoved = false;
+    sinceRefresh.start();
+
+    pruneLabels(satellites);
+    project(satellites, viewProjection, cameraPos, viewport);
+
+    gridColumns = viewport.width() / CELL_SIZE + 1;
+    gridRows = viewport.height() / CELL_SIZE + 1;
+    grid.fill(0, gridColumns * gridRows);
+    result.clear();
+
+    // Выбранный спутник занимает место первым
+    auto selected = std::find_if(projected.begin(), projected.end(),
+                                 [selectedId](const Projected& p) { return p.id == selectedId; });
+    if (selected != projected.end() && !reservedRect.isEmpty())
+        tryOccupy(reservedRect.translated(selected->screen));
+
+    // Ближе к камере — важнее
+    std::sort(projected.begin(), projected.end(), [](const Projected& a, const Projected& b) {
+        return a.distance < b.distance;
+    });
+
+    const QRectF screen(QPointF(0, 0), QSizeF(viewport));
+    for (const Projected& candidate : projected) {
+        if (candidate.id == selectedId)
+            continue;
+
+        auto text = labelTexts.find(candidate.id);
+        if (text == labelTexts.end()) {
+            text = labelTexts.insert(candidate.id, QString::number(candidate.id));
+            labelSizes.insert(candidate.id, labelSize(*text));
+        }
+        const QSizeF size = labelSizes.value(candidate.id);
+
+        const QPointF offsets[] = {
+            QPointF(LABEL_GAP, -LABEL_GAP - size.height()),
+            QPointF(LABEL_GAP, LABEL_GAP),
+            QPointF(-LABEL_GAP - size.width(), -LABEL_GAP - size.height()),
+            QPointF(-LABEL_GAP - size.width(), LABEL_GAP),
+        };
+        for (const QPointF& offset : offsets) {
+            QRectF rect(candidate.screen + offset, size);
+            if (!screen.contains(rect))
+                continue;
+            if (tryOccupy(rect)) {
+                result.append({candidate.id, offset, *text});
+                break;
+            }
+        }
+    }
+
+    return result;
+}
+
+void LabelPlacer::project(const SatelliteStore& satellites, const QMatrix4x4& viewProjection,
+                          const QVector3D& cameraPos, const QSize& viewport)
+{
+    projected.clear();
+    projected.reserve(satellites.size());
+    candidates = satellites.size();
+
+    // Элементы матрицы по столбцам, без временных QVector4D на каждый спутник
+    const float* m = viewProjection.constData();
+    const float halfWidth = viewport.width() * 0.5f;
+    const float halfHeight = viewport.height() * 0.5f;
+    const float radiusSquared = earthRadius * earthRadius;
+
+    const QVector<QVector3D>& positions = satellites.positions();
+    for (int slot = 0; slot < positions.size(); ++slot) {
+        const QVector3D& p = positions[slot];
+
+        const float w = m[3] * p.x() + m[7] * p.y() + m[11] * p.z() + m[15];
+        if (w <= 0.0f)
+            continue; // за камерой
+        const float x = (m[0] * p.x() + m[4] * p.y() + m[8] * p.z() + m[12]) / w;
+        const float y = (m[1] * p.x() + m[5] * p.y() + m[9] * p.z() + m[13]) / w;
+        if (x < -1.0f || x > 1.0f || y < -1.0f || y > 1.0f)
+            continue; // за пределами экрана
+
+        // Закрыт Землей: отрезок камера—спутник проходит через сферу
+        const QVector3D d = p - cameraPos;
+        const float lengthSquared = d.lengthSquared();
+        const float t = std::clamp(-QVector3D::dotProduct(cameraPos, d) / lengthSquared, 0.0f, 1.0f);
+        if (t < 1.0f && (cameraPos + d * t).lengthSquared() < radiusSquared)
+            continue;
+
+        projected.append({satellites.id(slot),
+                          QPointF((x + 1.0f) * halfWidth, (1.0f - y) * halfHeight),
+                          lengthSquared});
+    }
+}
+
+void LabelPlacer::pruneLabels(const SatelliteStore& satellites)
+{
+    // Кэш растет вместе с ушедшими из каталога объектами; проход по нему
+    // выполняется, только когда он вдвое больше каталога, — в среднем O(1)
+    if (labelTexts.size() <= std::max(MIN_PRUNE_SIZE, 2 * satellites.size()))
+        return;
+
+    for (auto it = labelTexts.begin(); it != labelTexts.end();) {
+        if (satellites.contains(it.key())) {
+            ++it;
+        } else {
+            labelSizes.remove(it.key());
+            it = labelTexts.erase(it);
+        }
+    }
+}
+
+bool LabelPlacer::tryOccupy(const QRectF& rect)
+{
+    const int left = std::max(0, int(rect.left()) / CELL_SIZE);
+    const int top = std::max(0, int(rect.top()) / CELL_SIZE);
+    const int right = std::min(gridColumns - 1, int(rect.right()) / CELL_SIZE);
+    const int bottom = std::min(gridRows - 1, int(rect.bottom()) / CELL_SIZE);
+
+    for (int row = top; row <= bottom; ++row) {
+        for (int column = left; column <= right; ++column) {
+            if (grid[row * gridColumns + column])
+                return false;
+        }
+    }
+    for (int row = top; row <= bottom; ++row)
+        std::fill_n(grid.begin() + row * gridColumns + left, right - left + 1, quint8(1));
+    return true;
+}
@@ -0,0 +1,84 @@
+// label_placer.h
+#ifndef LABEL_PLACER_H
+#define LABEL_PLACER_H
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMatrix4x4>
+#include <QPointF>
+#include <QRectF>
+#include <QSize>
+#include <QVector>
+#include <functional>
+#include "satellite_store.h"
+
+// Размещение подписей спутников без наложений.
+// Все кандидаты проецируются одним проходом, невидимые (за экраном, за камерой
+// или за Землей) отбрасываются, остальные занимают ячейки экранной сетки
+// в порядке приоритета. Пока камера неподвижна, результат переиспользуется.
+class LabelPlacer
+{
+public:
+    struct Placement {
+        int id;
+        QPointF offset; // левый верхний угол подписи относительно проекции спутника
+        QString text;
+    };
+
+    using LabelSize = std::function<QSizeF(const QString& text)>;
+
+    explicit LabelPlacer(float earthRadius);
+
+    // reservedRect — область вокруг выбранного спутника (плашка информации),
+    // занимается первой и не перекрывается другими подписями
+    const QVector<Placement>& place(const SatelliteStore& satellites,
+                                    const QMatrix4x4& viewProjection, const QVector3D& cameraPos,
+                                    const QSize& viewport, int selectedId, const QRectF& reservedRect,
+                                    const LabelSize& labelSize);
+
+    // Спутники сдвинулись: размещение обновится не чаще REFRESH_INTERVAL_MS
+    void markSatellitesMoved() { satellitesMoved = true; }
+    void invalidate() { valid = false; }
+
+    const QVector<Placement>& placements() const { return result; }
+    int candidateCount() const { return candidates; }
+
+private:
+    struct Projected {
+        int id;
+        QPointF screen;
+        float distance; // до камеры, меньше — выше приоритет
+    };
+
+    void project(const SatelliteStore& satellites, const QMatrix4x4& viewProjection,
+                 const QVector3D& cameraPos, const QSize& viewport);
+    bool tryOccupy(const QRectF& rect);
+    void pruneLabels(const SatelliteStore& satellites);
+
+    static constexpr int CELL_SIZE = 16;           // px
+    static constexpr int REFRESH_INTERVAL_MS = 200;
+    static constexpr int MIN_PRUNE_SIZE = 1024;    // меньший кэш подписей не чистится
+
+    float earthRadius;
+
+    // Состояние, при котором рассчитано размещение
+    QMatrix4x4 lastViewProjection;
+    QSize lastViewport;
+    int lastSelectedId;
+    bool valid;
+    bool satellitesMoved;
+    QElapsedTimer sinceRefresh;
+
+    // Буферы переиспользуются между пересчетами
+    QVector<Projected> projected;
+    QVector<quint8> grid;
+    int gridColumns;
+    int gridRows;
+    QHash<int, QString> labelTexts;
+    QHash<int, QSizeF> labelSizes;
+
+    QVector<Placement> result;
+    int candidates;
+};
+
+#endif // LABEL_PLACER_H
@@ -1,14 +1,161 @@
 #include <QApplication>
 #include <QMainWindow>
-#include <QTimer>
+#include <QCommandLineParser>
 #include <QDateTime>
+#include <algorithm>
 #include <cmath>
+#include <limits>
+#include <memory>
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QPushButton>
 #include <QWidget>
 #include <QLabel>
+#include <QFileDialog>
+#include <QListWidget>
+#include <QtMath>
 #include "earthwidget.h"
+#include "satellite_data.h"
+#include "catalog_loader.h"
+#include "catalog_feed.h"
+#include "satellite_catalog.h"
+#include "ephemeris_cache.h"
+#include "conjunction_screener.h"
+#include "pass_predictor.h"
+#include "eclipse_model.h"
+#include "solar_ephemeris.h"
+#include "session_log.h"
+#include "session_replay.h"
+
+namespace {
+
+// Предстоящие сближения спутника для информационной панели
+QString conjunctionSummary(const ConjunctionScreener* screener, int id, double unixTime)
+{
+    constexpr int MAX_LISTED = 5;
+    if (!screener || screener->lastResult().objects == 0)
+        return QString();
+
+    QString list;
+    int total = 0;
+    for (const Conjunction& conjunction : screener->lastResult().conjunctions) {
+        if ((conjunction.firstId != id && conjunction.secondId != id) || conjunction.time < unixTime)
+            continue;
+        if (++total > MAX_LISTED)
+            continue;
+        list += QString("\n%1  NORAD %2\n  miss %3 km, %4 km/s")
+                    .arg(QDateTime::fromMSecsSinceEpoch(qint64(conjunction.time * 1000.0), Qt::UTC)
+                             .toString("MM-dd HH:mm:ss"))
+                    .arg(conjunction.firstId == id ? conjunction.secondId : conjunction.firstId)
+                    .arg(conjunction.missDistance / 1000.0, 0, 'f', 2)
+                    .arg(conjunction.relativeSpeed / 1000.0, 0, 'f', 1);
+    }
+    if (total == 0)
+        return QString("\n\nConjunctions: none");
+    if (total > MAX_LISTED)
+        list += QString("\n  ... and %1 more").arg(total - MAX_LISTED);
+    return QString("\n\nConjunctions (%1):").arg(total) + list;
+}
+
+// Список ближайших пролетов выбранного спутника над станциями. Строится
+// заново при смене спутника, новом расчете или после захода одного из
+// показанных пролетов, а не на каждый кадр
+struct PassListView {
+    QListWidget* list = nullptr;
+    int satelliteId = -1;
+    bool stale = true;
+    double validUntil = 0.0;
+};
+
+void updatePassList(PassListView& view, const PassPredictor& predictor, int id, double unixTime)
+{
+    constexpr int MAX_LISTED = 8;
+    if (!view.stale && id == view.satelliteId && unixTime < view.validUntil)
+        return;
+    view.stale = false;
+    view.satelliteId = id;
+    view.validUntil = std::numeric_limits<double>::max();
+    view.list->clear();
+    if (id == -1)
+        return;
+
+    const PassPredictionResult& result = predictor.lastResult();
+    if (!result.satellites.contains(id)) {
+        view.list->addItem(predictor.isRunning() ? "Predicting passes..." : "No pass prediction");
+        return;
+    }
+    int shown = 0;
+    for (const SatellitePass& pass : result.satellites.value(id).passes) {
+        if (pass.set < unixTime)
+            continue;
+        const QDateTime rise = QDateTime::fromMSecsSinceEpoch(qint64(pass.rise * 1000.0), Qt::UTC);
+        const QDateTime set = QDateTime::fromMSecsSinceEpoch(qint64(pass.set * 1000.0), Qt::UTC);
+        view.list->addItem(QString("%1%2\n  %3 - %4, max %5°, az %6° - %7°")
+                               .arg(pass.rise <= unixTime ? "> " : "")
+                               .arg(predictor.stations()[pass.station].name)
+                               .arg(rise.toString("MM-dd HH:mm:ss"))
+                               .arg(set.toString("HH:mm:ss"))
+                               .arg(qRadiansToDegrees(pass.maxElevation), 0, 'f', 1)
+                               .arg(qRadiansToDegrees(pass.riseAzimuth), 0, 'f', 0)
+                               .arg(qRadiansToDegrees(pass.setAzimuth), 0, 'f', 0));
+        view.validUntil = std::min(view.validUntil, pass.rise > unixTime ? pass.rise : pass.set);
+        if (++shown == MAX_LISTED)
+            break;
+    }
+    if (shown == 0)
+        view.list->addItem(QString("No passes until %1")
+                               .arg(QDateTime::fromMSecsSinceEpoch(qint64((result.startTime + result.duration) * 1000.0),
+                                                                   Qt::UTC).toString("MM-dd HH:mm")));
+}
+
+// Тень Земли для информационной панели. Интервалы на два витка вперед
+// считаются заново при смене спутника или его элементов и после сдвига
+// времени на виток, а не на каждый кадр
+struct EclipseView {
+    int satelliteId = -1;
+    double epoch = 0.0;
+    double startTime = 0.0;
+    QVector<EclipseInterval> intervals;
+};
+
+QString eclipseSummary(EclipseView& view, int id, const OrbitalElements& elements, const QVector3D& position,
+                       double unixTime)
+{
+    const double period = elements.period();
+    if (period <= 0.0)
+        return QString();
+    if (id != view.satelliteId || elements.epoch != view.epoch ||
+        unixTime < view.startTime || unixTime > view.startTime + period) {
+        view.satelliteId = id;
+        view.epoch = elements.epoch;
+        view.startTime = unixTime;
+        view.intervals = EclipseModel::intervals(elements, unixTime, 2.0 * period);
+    }
+
+    auto timeOfDay = [](double time) {
+        return QDateTime::fromMSecsSinceEpoch(qint64(time * 1000.0), Qt::UTC).toString("HH:mm:ss");
+    };
+    const float light = EclipseModel::illumination(position, SolarEphemeris::position(unixTime));
+    QString text = QString("\n\nShadow: %1").arg(light >= 1.0f ? QString("sunlit")
+                                                  : light <= 0.0f ? QString("umbra")
+                                                  : QString("penumbra, %1% of the Sun").arg(qRound(light * 100.0f)));
+    for (const EclipseInterval& interval : view.intervals) {
+        if (interval.exit < unixTime)
+            continue;
+        if (interval.entry <= unixTime) {
+            text += QString(", exit %1").arg(timeOfDay(interval.exit));
+            continue;
+        }
+        text += QString("\nNext eclipse: %1 - %2 (%3 min%4)")
+                    .arg(timeOfDay(interval.entry), timeOfDay(interval.exit))
+                    .arg((interval.exit - interval.entry) / 60.0, 0, 'f', 1)
+                    .arg(interval.hasUmbra() ? "" : ", penumbra only");
+        break;
+    }
+    return text;
+}
+
+}
 
 int main(int argc, char *argv[])
 {
@@ -23,6 +170,61 @@ int main(int argc, char *argv[])
     QSurfaceFormat::setDefaultFormat(format);
 
     QApplication a(argc, argv);
+
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    QCommandLineOption maxFpsOption("max-fps", "Limit the frame rate (0 = unlimited).", "fps", "0");
+    QCommandLineOption framePacedOption("frame-paced", "Schedule frames from frameSwapped instead of a timer.");
+    QCommandLineOption renderThreadOption("render-thread", "Render the scene on a dedicated thread.");
+    QCommandLineOption scatteringOption("atmosphere-scattering", "Use precomputed Rayleigh/Mie atmospheric scattering.");
+    QCommandLineOption profileOption("profile", "Show the frame profiler from startup.");
+    QCommandLineOption cloudFramesOption("cloud-frames", "Directory with time-series cloud images (sorted by name).", "dir");
+    QCommandLineOption cloudIntervalOption("cloud-interval", "Simulation hours between cloud frames.", "hours", "1");
+    QCommandLineOption satelliteModeOption("satellite-mode", "Satellite drawing: auto, mesh or impostor.", "mode", "auto");
+    QCommandLineOption gpuPropagationOption("gpu-propagation", "Propagate catalog orbits on the GPU via transform feedback.");
+    QCommandLineOption proceduralOrbitsOption("procedural-orbits", "Draw the selected orbit from its elements in the vertex shader.");
+    QCommandLineOption catalogOption("catalog", "Load satellites from a TLE or OMM (XML, JSON, CSV) catalog.", "file");
+    QCommandLineOption feedOption("feed", "Accept live catalog updates on a local socket.", "name");
+    QCommandLineOption ephemerisCacheOption("ephemeris-cache", "Keep interpolated catalog ephemerides on disk.", "dir");
+    parser.addOption(maxFpsOption);
+    parser.addOption(framePacedOption);
+    parser.addOption(renderThreadOption);
+    parser.addOption(scatteringOption);
+    parser.addOption(profileOption);
+    parser.addOption(cloudFramesOption);
+    parser.addOption(cloudIntervalOption);
+    parser.addOption(satelliteModeOption);
+    parser.addOption(gpuPropagationOption);
+    parser.addOption(proceduralOrbitsOption);
+    parser.addOption(catalogOption);
+    parser.addOption(feedOption);
+    parser.addOption(ephemerisCacheOption);
+    QCommandLineOption conjunctionsOption("screen-conjunctions", "Screen the catalog for close approaches over the next 24 hours.");
+    QCommandLineOption conjunctionThresholdOption("conjunction-threshold", "Miss distance for conjunction screening.", "km", "5");
+    parser.addOption(conjunctionsOption);
+    parser.addOption(conjunctionThresholdOption);
+    QCommandLineOption stationOption("station", "Ground station for pass prediction: name,lat,lon[,alt_m] in degrees (repeatable).", "station");
+    QCommandLineOption minElevationOption("min-elevation", "Elevation mask for pass prediction.", "degrees", "10");
+    parser.addOption(stationOption);
+    parser.addOption(minElevationOption);
+    QCommandLineOption coverageOption("coverage", "Accumulate a sensor coverage heatmap with the given half-angle.", "degrees");
+    parser.addOption(coverageOption);
+    QCommandLineOption trailsOption("trails", "Draw fading trails of the given number of samples behind every satellite.", "samples");
+    QCommandLineOption trailStepOption("trail-step", "Simulation steps between trail samples.", "steps", "10");
+    parser.addOption(trailsOption);
+    parser.addOption(trailStepOption);
+    QCommandLineOption vramBudgetOption("vram-budget", "Video memory budget for texture layers; lower-priority layers are reduced to fit.", "MB");
+    parser.addOption(vramBudgetOption);
+    QCommandLineOption tileStreamingOption("tile-streaming", "Stream full-resolution Earth color tiles ahead of the camera.");
+    parser.addOption(tileStreamingOption);
+    QCommandLineOption recordOption("record", "Record camera, selection, clock and catalog events to a session log.", "file");
+    QCommandLineOption replayOption("replay", "Replay a recorded session log.", "file");
+    QCommandLineOption replaySpeedOption("replay-speed", "Replay pacing: realtime or max (one recorded frame per frame).", "mode", "realtime");
+    parser.addOption(recordOption);
+    parser.addOption(replayOption);
+    parser.addOption(replaySpeedOption);
+    parser.process(a);
+
     QMainWindow mainWindow;
 
     // Создаем центральный виджет и layout
@@ -36,6 +238,48 @@ int main(int argc, char *argv[])
     // Создаем EarthWidget
     EarthWidget* earthWidget = new EarthWidget(centralWidget);
     mainLayout->addWidget(earthWidget, 4); // Соотношение 4:1
+    earthWidget->frameScheduler()->setTargetFrameRate(parser.value(maxFpsOption).toInt());
+    if (parser.isSet(framePacedOption)) {
+        earthWidget->frameScheduler()->setPacingMode(FrameScheduler::PacingMode::FrameSwapped);
+    }
+    earthWidget->setThreadedRendering(parser.isSet(renderThreadOption));
+
+    SceneOptions sceneOptions;
+    sceneOptions.atmosphereScattering = parser.isSet(scatteringOption);
+    if (parser.value(satelliteModeOption) == "mesh")
+        sceneOptions.satelliteDrawMode = SatelliteDrawMode::Mesh;
+    else if (parser.value(satelliteModeOption) == "impostor")
+        sceneOptions.satelliteDrawMode = SatelliteDrawMode::Impostor;
+    sceneOptions.gpuPropagation = parser.isSet(gpuPropagationOption);
+    sceneOptions.proceduralOrbits = parser.isSet(proceduralOrbitsOption);
+    if (parser.isSet(coverageOption))
+        sceneOptions.coverageHalfAngle = qBound(0.0f, parser.value(coverageOption).toFloat(), 89.0f);
+    if (parser.isSet(trailsOption))
+        sceneOptions.trailLength = qBound(0, parser.value(trailsOption).toInt(), 1024);
+    sceneOptions.trailSampleSteps = std::max(1, parser.value(trailStepOption).toInt());
+    if (parser.isSet(vramBudgetOption))
+        sceneOptions.gpuMemoryBudget = std::max(0, parser.value(vramBudgetOption).toInt());
+    sceneOptions.tileStreaming = parser.isSet(tileStreamingOption);
+    if (parser.isSet(cloudFramesOption)) {
+        sceneOptions.cloudFrames = CloudLayer::framesFromDirectory(
+            parser.value(cloudFramesOption), parser.value(cloudIntervalOption).toDouble() * 3600.0);
+    }
+    earthWidget->setSceneOptions(sceneOptions);
+    earthWidget->setProfilerVisible(parser.isSet(profileOption));
+
+    // Воспроизведение записанной сессии: каталог и ввод приходят из журнала
+    SessionReplay* sessionReplay = nullptr;
+    if (parser.isSet(replayOption)) {
+        sessionReplay = new SessionReplay(earthWidget);
+        if (!sessionReplay->open(parser.value(replayOption)))
+            return 1;
+        sessionReplay->setPacing(parser.value(replaySpeedOption) == "max"
+                                     ? SessionReplay::Pacing::AsFastAsPossible
+                                     : SessionReplay::Pacing::RealTime);
+        earthWidget->setSessionReplay(sessionReplay);
+        if (parser.isSet(catalogOption) || parser.isSet(feedOption))
+            qWarning() << "--catalog and --feed are ignored during replay";
+    }
 
     // Создаем панель информации
     QWidget* infoPanel = new QWidget(centralWidget);
@@ -45,6 +289,12 @@ int main(int argc, char *argv[])
     satelliteInfo->setWordWrap(true);
     infoPanelLayout->addWidget(infoLabel);
     infoPanelLayout->addWidget(satelliteInfo);
+    // Пролеты над станциями; список виден, только если станции заданы
+    auto passView = std::make_shared<PassListView>();
+    auto eclipseView = std::make_shared<EclipseView>();
+    passView->list = new QListWidget(infoPanel);
+    passView->list->setVisible(false);
+    infoPanelLayout->addWidget(passView->list);
     infoPanelLayout->addStretch();
     mainLayout->addWidget(infoPanel, 1); // Соотношение 4:1
 
@@ -67,6 +317,70 @@ int main(int argc, char *argv[])
         bool isAnimating = earthWidget->toggleEarthAnimation();
         earthRotationButton->setText(isAnimating ? "Stop Earth Rotation" : "Start Earth Rotation");
     });
+
+    // Подписи всех спутников
+    QPushButton* labelsButton = new QPushButton("Show Labels", centralWidget);
+    buttonLayout->addWidget(labelsButton);
+    QObject::connect(labelsButton, &QPushButton::clicked, [earthWidget, labelsButton]() {
+        bool visible = !earthWidget->areSatelliteLabelsVisible();
+        earthWidget->setSatelliteLabelsVisible(visible);
+        labelsButton->setText(visible ? "Hide Labels" : "Show Labels");
+    });
+
+    // Профилировщик кадра
+    QPushButton* profilerButton = new QPushButton(
+        earthWidget->isProfilerVisible() ? "Hide Profiler" : "Show Profiler", centralWidget);
+    QPushButton* traceButton = new QPushButton("Export Trace", centralWidget);
+    buttonLayout->addWidget(profilerButton);
+    buttonLayout->addWidget(traceButton);
+    QObject::connect(profilerButton, &QPushButton::clicked, [earthWidget, profilerButton]() {
+        bool visible = !earthWidget->isProfilerVisible();
+        earthWidget->setProfilerVisible(visible);
+        profilerButton->setText(visible ? "Hide Profiler" : "Show Profiler");
+    });
+    QObject::connect(traceButton, &QPushButton::clicked, [&mainWindow]() {
+        QString path = QFileDialog::getSaveFileName(&mainWindow, "Export Chrome Trace",
+                                                    "earth3d_trace.json", "Trace (*.json)");
+        if (!path.isEmpty())
+            FrameProfiler::instance().exportChromeTrace(path);
+    });
+
+    // Переключение режима атмосферы
+    QPushButton* atmosphereButton = new QPushButton(
+        earthWidget->sceneOptions().atmosphereScattering ? "Classic Atmosphere" : "Atmosphere Scattering", centralWidget);
+    buttonLayout->addWidget(atmosphereButton);
+    QObject::connect(atmosphereButton, &QPushButton::clicked, [earthWidget, atmosphereButton]() {
+        SceneOptions options = earthWidget->sceneOptions();
+        options.atmosphereScattering = !options.atmosphereScattering;
+        earthWidget->setSceneOptions(options);
+        atmosphereButton->setText(options.atmosphereScattering ? "Classic Atmosphere" : "Atmosphere Scattering");
+    });
+
+    // Управление часами симуляции: пауза, ускорение и перемотка назад
+    static const QVector<double> timeWarpSteps = {-1000.0, -100.0, -10.0, -1.0, 1.0, 10.0, 100.0, 1000.0};
+    auto timeWarpIndex = std::make_shared<int>(timeWarpSteps.indexOf(1.0));
+
+    QPushButton* slowerButton = new QPushButton("<<", centralWidget);
+    QPushButton* pauseButton = new QPushButton("Pause", centralWidget);
+    QPushButton* fasterButton = new QPushButton(">>", centralWidget);
+    QLabel* timeWarpLabel = new QLabel("x1", centralWidget);
+    buttonLayout->addWidget(slowerButton);
+    buttonLayout->addWidget(pauseButton);
+    buttonLayout->addWidget(fasterButton);
+    buttonLayout->addWidget(timeWarpLabel);
+
+    auto applyTimeWarp = [earthWidget, timeWarpLabel, timeWarpIndex](int step) {
+        *timeWarpIndex = qBound(0, *timeWarpIndex + step, int(timeWarpSteps.size()) - 1);
+        double warp = timeWarpSteps[*timeWarpIndex];
+        earthWidget->setTimeWarp(warp);
+        timeWarpLabel->setText(QString("x%1").arg(warp));
+    };
+    QObject::connect(slowerButton, &QPushButton::clicked, [applyTimeWarp]() { applyTimeWarp(-1); });
+    QObject::connect(fasterButton, &QPushButton::clicked, [applyTimeWarp]() { applyTimeWarp(1); });
+    QObject::connect(pauseButton, &QPushButton::clicked, [earthWidget, pauseButton]() {
+        bool isPaused = earthWidget->toggleSimulationPause();
+        pauseButton->setText(isPaused ? "Resume" : "Pause");
+    });
     // QObject::connect(axisToggleButton, &QPushButton::clicked, [earthWidget, axisToggleButton]() {
     //     bool isVisible = earthWidget->toggleAxisVisibility();
     //     axisToggleButton->setText(isVisible ? "Hide Axes" : "Show Axes");
@@ -76,64 +390,177 @@ int main(int argc, char *argv[])
     const float EARTH_RADIUS = 6371000.0f; // Радиус Земли в метрах
     const float ORBIT_RADIUS = EARTH_RADIUS * 1.5f;
 
-    struct SatelliteData {
-        float angle;
-        float speed;
-        int id;
-        QVector3D position;
-
-        // Функция расчета траекторий для дуги в 30 градусов
-        void calculateTrajectories(float orbitRadius, QVector<QVector3D>& trajectory, QVector<QVector3D>& futureTrajectory) {
-            trajectory.clear();
-
-            // Расчет траектории: 30 градусов назад и вперед от текущей позиции
-            const int arcPoints = 30; // количество точек для дуги в 30 градусов
-            const float arcRange = 30.0f; // диапазон в градусах
-
-            // Рассчитываем точки для текущей дуги траектории
-            for (int i = -arcPoints; i <= arcPoints; ++i) {
-                float arcAngle = qDegreesToRadians(angle + (i * arcRange / arcPoints));
-                trajectory.append(QVector3D(
-                    orbitRadius * cos(arcAngle),
-                    0.0f,
-                    orbitRadius * sin(arcAngle)
-                    ));
-            }
+    QVector<SatelliteData> satelliteData;
 
-            // Расчет будущей траектории (следующие 30 градусов)
-            futureTrajectory.clear();
-            const int futurePoints = 30;
-            const float predictionTime = 5.0f; // время прогноза в секундах
-            float timeStep = predictionTime / futurePoints;
-
-            for (int i = 0; i <= futurePoints; ++i) {
-                float futureTime = timeStep * i;
-                float futureAngle = qDegreesToRadians(angle + speed * futureTime);
-                futureTrajectory.append(QVector3D(
-                    orbitRadius * cos(futureAngle),
-                    0.0f,
-                    orbitRadius * sin(futureAngle)
-                    ));
-            }
-        }
+    // Демонстрационные спутники, если каталог не задан
+    const bool demoSatellites = sessionReplay ? sessionReplay->header().demoSatellites
+                                              : !parser.isSet(catalogOption) && !parser.isSet(feedOption);
+    if (demoSatellites) {
+        satelliteData.append({0.0f, 1.0f, 1});
+        satelliteData.append({72.0f, 2.0f, 2});
+        satelliteData.append({144.0f, 3.0f, 3});
+        satelliteData.append({216.0f, 4.0f, 4});
+        satelliteData.append({288.0f, 5.0f, 5});
+    }
+
+    // Запись сессии начинается с текущего состояния часов
+    std::shared_ptr<SessionRecorder> sessionRecorder;
+    if (parser.isSet(recordOption)) {
+        SessionHeader header;
+        header.epoch = earthWidget->simulationClock().epoch();
+        header.simulationTime = earthWidget->simulationClock().simulationTime();
+        header.timeWarp = earthWidget->simulationClock().timeWarp();
+        header.paused = earthWidget->simulationClock().isPaused();
+        header.demoSatellites = demoSatellites;
+        sessionRecorder = std::make_shared<SessionRecorder>();
+        if (sessionRecorder->open(parser.value(recordOption), header))
+            earthWidget->setSessionRecorder(sessionRecorder.get());
+        else
+            sessionRecorder.reset();
+    }
+
+    // Каталог из файла и потока изменений: элементы и положения на текущий кадр
+    auto catalog = std::make_shared<SatelliteCatalog>();
+    // Положения на кадр интерполируются по кэшу эфемерид, а не пропагируются заново
+    auto ephemeris = std::make_shared<EphemerisCache>();
+    if (parser.isSet(ephemerisCacheOption))
+        ephemeris->setDirectory(parser.value(ephemerisCacheOption));
+    auto unixTime = [earthWidget](double simulationTime) {
+        return earthWidget->simulationClock().epoch().toMSecsSinceEpoch() / 1000.0 + simulationTime;
+    };
+    // При пропагации на GPU сцена получает орбиты, а CPU считает только нужные положения
+    const bool gpuPropagation = sceneOptions.gpuPropagation;
+    const bool sceneOrbits = gpuPropagation || sceneOptions.proceduralOrbits;
+    auto setOrbits = [earthWidget, catalog, sceneOrbits](const QVector<int>& ids) {
+        if (!sceneOrbits)
+            return;
+        QVector<SatelliteOrbit> orbits;
+        orbits.reserve(ids.size());
+        for (int id : ids)
+            orbits.append(SatelliteOrbit::fromElements(catalog->elements()[catalog->indexOf(id)]));
+        earthWidget->setSatelliteOrbits(ids, orbits);
     };
 
-    QVector<SatelliteData> satelliteData;
+    // Поиск сближений в фоне: участники подсвечиваются, выбранному спутнику
+    // показывается список его сближений. Окно поиска сдвигается, когда
+    // симуляция проходит его половину, и после изменений каталога
+    ConjunctionScreener* screener = nullptr;
+    auto screenConjunctions = [earthWidget, catalog, unixTime, &screener]() {
+        if (screener && !catalog->isEmpty())
+            screener->start(catalog->elements(), unixTime(earthWidget->simulationClock().simulationTime()));
+    };
+    if (parser.isSet(conjunctionsOption)) {
+        screener = new ConjunctionScreener(&mainWindow);
+        ConjunctionScreener::Settings settings;
+        settings.threshold = parser.value(conjunctionThresholdOption).toDouble() * 1000.0;
+        screener->setSettings(settings);
+        QObject::connect(screener, &ConjunctionScreener::finished, [earthWidget](const ConjunctionScreeningResult& result) {
+            QVector<int> ids;
+            ids.reserve(result.conjunctions.size() * 2);
+            for (const Conjunction& conjunction : result.conjunctions)
+                ids << conjunction.firstId << conjunction.secondId;
+            std::sort(ids.begin(), ids.end());
+            ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+            earthWidget->setConjunctionHighlights(ids);
+            if (earthWidget->getSelectedSatelliteId() != -1)
+                emit earthWidget->satelliteSelected(earthWidget->getSelectedSatelliteId());
+        });
+    }
 
-    satelliteData.append({0.0f, 1.0f, 1});
-    satelliteData.append({72.0f, 2.0f, 2});
-    satelliteData.append({144.0f, 3.0f, 3});
-    satelliteData.append({216.0f, 4.0f, 4});
-    satelliteData.append({288.0f, 5.0f, 5});
+    // Пролеты над наземными станциями, пересчет в фоне по тем же поводам, что
+    // и поиск сближений; из кэша берутся спутники с неизменными элементами
+    PassPredictor* passPredictor = nullptr;
+    auto predictPasses = [earthWidget, catalog, unixTime, &passPredictor]() {
+        if (!passPredictor || catalog->isEmpty())
+            return;
+        // Пока окно не сдвигается, кэш пролетов остается в силе
+        const PassPredictionResult& last = passPredictor->lastResult();
+        const double now = unixTime(earthWidget->simulationClock().simulationTime());
+        const bool keepWindow = !last.satellites.isEmpty() && now >= last.startTime &&
+                                now <= last.startTime + last.duration / 2.0;
+        passPredictor->start(catalog->elements(), keepWindow ? last.startTime : now);
+    };
+    QVector<GroundStation> stations;
+    for (const QString& text : parser.values(stationOption)) {
+        GroundStation station;
+        if (GroundStation::parse(text, station))
+            stations.append(station);
+        else
+            qWarning() << "Invalid ground station:" << text;
+    }
+    if (!stations.isEmpty()) {
+        passPredictor = new PassPredictor(&mainWindow);
+        PassPredictor::Settings settings;
+        settings.minElevation = qDegreesToRadians(parser.value(minElevationOption).toDouble());
+        passPredictor->setSettings(settings);
+        passPredictor->setStations(stations);
+        passView->list->setVisible(true);
+        auto refresh = [earthWidget, passPredictor, passView, unixTime]() {
+            updatePassList(*passView, *passPredictor, earthWidget->getSelectedSatelliteId(),
+                           unixTime(earthWidget->simulationClock().simulationTime()));
+        };
+        QObject::connect(passPredictor, &PassPredictor::finished, [passView, refresh]() {
+            passView->stale = true;
+            refresh();
+        });
+        QObject::connect(earthWidget, &EarthWidget::satelliteSelected, refresh);
+    }
+
+    QObject::connect(earthWidget, &EarthWidget::satellitePositionsRequested, [earthWidget, catalog, ephemeris, unixTime]() {
+        if (catalog->isEmpty())
+            return;
+        catalog->propagate(unixTime(earthWidget->simulationClock().simulationTime()), *ephemeris);
+        earthWidget->updateSatellitePositions(catalog->ids(), catalog->positions());
+    });
+
+    // Описание спутника каталога строится только при первом показе плашки
+    earthWidget->setSatelliteInfoLoader([catalog](int id) {
+        const int index = catalog->indexOf(id);
+        if (index == -1)
+            return QString();
+        const OrbitalElements& elements = catalog->elements()[index];
+        return elements.name.isEmpty() ? QString("NORAD %1").arg(elements.catalogNumber) : elements.name;
+    });
 
     // Обновление информации о выбранном спутнике
     QObject::connect(earthWidget, &EarthWidget::satelliteSelected,
-                     [satelliteInfo, &satelliteData, ORBIT_RADIUS](int id) {
+                     [satelliteInfo, &satelliteData, earthWidget, ORBIT_RADIUS, catalog, &screener, eclipseView](int id) {
                          if (id == -1) {
                              satelliteInfo->setText("No satellite selected");
                              return;
                          }
 
+                         const int catalogIndex = catalog->indexOf(id);
+                         if (catalogIndex != -1) {
+                             const OrbitalElements& elements = catalog->elements()[catalogIndex];
+                             const QVector3D& position = catalog->positions()[catalogIndex];
+                             const double now = earthWidget->simulationClock().currentDateTime().toMSecsSinceEpoch() / 1000.0;
+                             satelliteInfo->setText(QString(
+                                                        "%1\n"
+                                                        "NORAD ID: %2\n"
+                                                        "International designator: %3\n"
+                                                        "Epoch: %4\n"
+                                                        "Inclination: %5°\n"
+                                                        "Eccentricity: %6\n"
+                                                        "Period: %7 min\n"
+                                                        "Altitude: %8 km\n"
+                                                        "Time: %9"
+                                                        )
+                                                        .arg(elements.name)
+                                                        .arg(elements.catalogNumber)
+                                                        .arg(elements.internationalDesignator)
+                                                        .arg(QDateTime::fromMSecsSinceEpoch(qint64(elements.epoch * 1000.0), Qt::UTC)
+                                                                 .toString("yyyy-MM-dd HH:mm:ss"))
+                                                        .arg(qRadiansToDegrees(elements.inclination), 0, 'f', 4)
+                                                        .arg(elements.eccentricity, 0, 'f', 7)
+                                                        .arg(elements.period() / 60.0, 0, 'f', 2)
+                                                        .arg((position.length() - EarthWidget::EARTH_RADIUS) / 1000.0, 0, 'f', 1)
+                                                        .arg(earthWidget->simulationClock().currentDateTime().toString("yyyy-MM-dd HH:mm:ss"))
+                                                    + eclipseSummary(*eclipseView, id, elements, position, now)
+                                                    + conjunctionSummary(screener, id, now));
+                             return;
+                         }
+
                          for (const auto& sat : satelliteData) {
                              if (sat.id == id) {
                                  QString info = QString(
@@ -154,7 +581,7 @@ int main(int argc, char *argv[])
                                                     .arg(sat.position.y(), 0, 'f', 2)
                                                     .arg(sat.position.z(), 0, 'f', 2)
                                                     .arg(ORBIT_RADIUS / 1000.0, 0, 'f', 2)
-                                                    .arg(QDateTime::currentDateTimeUtc().toString("yyyy-MM-dd HH:mm:ss"));
+                                                    .arg(earthWidget->simulationClock().currentDateTime().toString("yyyy-MM-dd HH:mm:ss"));
 
                                  satelliteInfo->setText(info);
                                  break;
@@ -162,22 +589,10 @@ int main(int argc, char *argv[])
                          }
                      });
 
-    // Таймер для обновления позиций спутников
-    QTimer* timer = new QTimer(&mainWindow);
-    // В таймере обновления позиций:
-    QObject::connect(timer, &QTimer::timeout, [=, &satelliteData]() mutable {
+    // Пропагация выполняется по шагу часов симуляции в начале каждого кадра
+    QObject::connect(earthWidget, &EarthWidget::simulationAdvanced, [=, &satelliteData](double simulationTime) mutable {
         for(auto& sat : satelliteData) {
-            sat.angle += sat.speed * (16.0f / 1000.0f);
-            if(sat.angle >= 360.0f) {
-                sat.angle -= 360.0f;
-            }
-
-            float radians = qDegreesToRadians(sat.angle);
-            sat.position = QVector3D(
-                ORBIT_RADIUS * cos(radians),
-                0.0f,
-                ORBIT_RADIUS * sin(radians)
-                );
+            sat.propagate(simulationTime, ORBIT_RADIUS);
 
             // Обновляем траектории
             QVector<QVector3D> trajectory, futureTrajectory;
@@ -187,24 +602,142 @@ int main(int argc, char *argv[])
                 sat.id,
                 sat.position,
                 trajectory,
-                futureTrajectory,
-                sat.angle
+                futureTrajectory
                 );
 
             if (earthWidget->getSelectedSatelliteId() == sat.id) {
                 emit earthWidget->satelliteSelected(sat.id);
             }
         }
+
+        if (screener && !screener->isRunning() && !catalog->isEmpty()) {
+            const ConjunctionScreeningResult& last = screener->lastResult();
+            const double now = unixTime(simulationTime);
+            if (last.objects > 0 && (now < last.startTime || now > last.startTime + last.duration / 2.0))
+                screenConjunctions();
+        }
+        if (passPredictor && !passPredictor->isRunning() && !catalog->isEmpty()) {
+            const PassPredictionResult& last = passPredictor->lastResult();
+            const double now = unixTime(simulationTime);
+            if (!last.satellites.isEmpty() && (now < last.startTime || now > last.startTime + last.duration / 2.0))
+                predictPasses();
+        }
+
+        if (!catalog->isEmpty() && gpuPropagation) {
+            // Остальные положения пишет шейдер; выбранный нужен плашке
+            const int selectedId = earthWidget->getSelectedSatelliteId();
+            const int index = catalog->indexOf(selectedId);
+            if (index != -1) {
+                catalog->updatePosition(index, unixTime(simulationTime));
+                earthWidget->updateSatellitePositions({selectedId}, {catalog->positions()[index]});
+                emit earthWidget->satelliteSelected(selectedId);
+            }
+        } else if (!catalog->isEmpty()) {
+            catalog->propagate(unixTime(simulationTime), *ephemeris);
+            earthWidget->updateSatellitePositions(catalog->ids(), catalog->positions());
+            if (catalog->contains(earthWidget->getSelectedSatelliteId())) {
+                emit earthWidget->satelliteSelected(earthWidget->getSelectedSatelliteId());
+            }
+        }
+    });
+
+    // Каталог разбирается в фоне и добавляется в сцену одним пакетом
+    CatalogLoader* catalogLoader = new CatalogLoader(&mainWindow);
+    QObject::connect(catalogLoader, &CatalogLoader::loaded,
+                     [earthWidget, catalog, unixTime, sessionRecorder, setOrbits, screenConjunctions,
+                      predictPasses](const CatalogLoadResult& result) {
+        if (!result.ok()) {
+            qWarning() << "Failed to load catalog:" << result.error;
+            return;
+        }
+        qDebug() << "Loaded" << result.elements.size() << "objects from" << result.path
+                 << "in" << result.elapsedMs << "ms," << qRound64(result.objectsPerSecond()) << "objects/s,"
+                 << result.rejected << "rejected";
+
+        // Один проход пропагации на весь пакет, на момент часов симуляции
+        catalog->upsert(result.elements, unixTime(earthWidget->simulationClock().simulationTime()));
+        if (sessionRecorder) {
+            for (const OrbitalElements& elements : result.elements)
+                sessionRecorder->catalogUpdate({CatalogUpdate::Type::Upsert, elements});
+        }
+        earthWidget->addSatellites(catalog->ids(), catalog->positions());
+        setOrbits(catalog->ids());
+        screenConjunctions();
+        predictPasses();
     });
+    if (parser.isSet(catalogOption) && !sessionReplay) {
+        catalogLoader->load(parser.value(catalogOption));
+    }
+
+    // Пакет изменений каталога из потока или из записанной сессии
+    auto applyCatalogUpdates = [earthWidget, catalog, unixTime, sessionRecorder, setOrbits, screenConjunctions,
+                                predictPasses](const QVector<CatalogUpdate>& updates) {
+        // На паузе пропагации нет: без этого новые объекты считались бы на момент 0 (1970 год)
+        catalog->setTime(unixTime(earthWidget->simulationClock().simulationTime()));
+        QVector<int> changedIds;
+        QVector<QVector3D> changedPositions;
+        for (const CatalogUpdate& update : updates) {
+            if (sessionRecorder)
+                sessionRecorder->catalogUpdate(update);
+
+            const int id = update.elements.catalogNumber;
+            if (update.type == CatalogUpdate::Type::Remove) {
+                if (catalog->remove(id))
+                    earthWidget->removeSatellite(id);
+                continue;
+            }
+
+            // Положение новых элементов нужно и на паузе, когда пропагации нет
+            catalog->upsert(update.elements);
+            changedIds.append(id);
+            changedPositions.append(catalog->positions()[catalog->indexOf(id)]);
+        }
+        // Новые спутники добавляются, у существующих обновляется положение
+        if (!changedIds.isEmpty()) {
+            earthWidget->addSatellites(changedIds, changedPositions);
+            setOrbits(changedIds);
+        }
+        if (!updates.isEmpty()) {
+            screenConjunctions();
+            predictPasses();
+        }
+    };
+
+    // Поток изменений: записи копятся в сервере и применяются пакетом в начале
+    // кадра, поэтому сцена получает не больше одного набора изменений за кадр
+    if (parser.isSet(feedOption) && !sessionReplay) {
+        CatalogFeedServer* feedServer = new CatalogFeedServer(&mainWindow);
+        feedServer->listen(parser.value(feedOption));
+        QObject::connect(feedServer, &CatalogFeedServer::updatesAvailable,
+                         earthWidget->frameScheduler(), &FrameScheduler::invalidate);
+        QObject::connect(earthWidget, &EarthWidget::frameStarted, [feedServer, applyCatalogUpdates]() {
+            if (feedServer->hasPendingUpdates())
+                applyCatalogUpdates(feedServer->takePendingUpdates());
+        });
+    }
+
+    // Воспроизведение: события записанного кадра применяются перед его шагом часов
+    if (sessionReplay) {
+        QObject::connect(sessionReplay, &SessionReplay::cameraRotated, earthWidget, &EarthWidget::rotateCamera);
+        QObject::connect(sessionReplay, &SessionReplay::cameraZoomed, earthWidget, &EarthWidget::zoomCamera);
+        QObject::connect(sessionReplay, &SessionReplay::satelliteSelected, earthWidget, &EarthWidget::selectSatellite);
+        QObject::connect(sessionReplay, &SessionReplay::catalogUpdates, applyCatalogUpdates);
+        QObject::connect(sessionReplay, &SessionReplay::timeWarpChanged,
+                         [earthWidget, timeWarpLabel, timeWarpIndex](double warp) {
+            earthWidget->setTimeWarp(warp);
+            if (timeWarpSteps.contains(warp))
+                *timeWarpIndex = timeWarpSteps.indexOf(warp);
+            timeWarpLabel->setText(QString("x%1").arg(warp));
+        });
+        QObject::connect(sessionReplay, &SessionReplay::pausedChanged, [earthWidget, pauseButton](bool paused) {
+            earthWidget->setSimulationPaused(paused);
+            pauseButton->setText(paused ? "Resume" : "Pause");
+        });
+    }
 
     // При инициализации спутников:
     for(auto& sat : satelliteData) {
-        float radians = qDegreesToRadians(sat.angle);
-        sat.position = QVector3D(
-            ORBIT_RADIUS * cos(radians),
-            0.0f,
-            ORBIT_RADIUS * sin(radians)
-            );
+        sat.propagate(earthWidget->simulationClock().simulationTime(), ORBIT_RADIUS);
 
         QVector<QVector3D> trajectory, futureTrajectory;
         sat.calculateTrajectories(ORBIT_RADIUS, trajectory, futureTrajectory);
@@ -216,9 +749,6 @@ int main(int argc, char *argv[])
             );
     }
 
-    // Запускаем таймер
-    timer->start(16);
-
     mainWindow.resize(1024, 768);
     mainWindow.show();
 
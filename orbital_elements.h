@@ -0,0 +1,29 @@
+// orbital_elements.h
+#ifndef ORBITAL_ELEMENTS_H
+#define ORBITAL_ELEMENTS_H
+
+#include <QString>
+#include <cmath>
+
+// Средние элементы орбиты из TLE/OMM. Углы в радианах,
+// эпоха — секунды Unix (UTC), среднее движение — рад/с
+struct OrbitalElements {
+    int catalogNumber = -1;   // NORAD ID
+    QString name;
+    QString internationalDesignator;
+    double epoch = 0.0;
+    double inclination = 0.0;
+    double raan = 0.0;        // долгота восходящего узла
+    double eccentricity = 0.0;
+    double argPerigee = 0.0;
+    double meanAnomaly = 0.0;
+    double meanMotion = 0.0;
+    double bstar = 0.0;
+
+    static constexpr double EARTH_MU = 3.986004418e14; // м^3/с^2
+
+    double period() const { return meanMotion > 0.0 ? 2.0 * M_PI / meanMotion : 0.0; }
+    double semiMajorAxis() const { return std::cbrt(EARTH_MU / (meanMotion * meanMotion)); }
+};
+
+#endif // ORBITAL_ELEMENTS_H
@@ -0,0 +1,388 @@
+// pass_predictor.cpp
+#include "pass_predictor.h"
+#include "kepler_propagator.h"
+#include "solar_ephemeris.h"
+#include <QElapsedTimer>
+#include <QStringList>
+#include <QtConcurrent/QtConcurrent>
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace {
+
+constexpr double WGS84_A = 6378137.0;
+constexpr double WGS84_F = 1.0 / 298.257223563;
+constexpr int MAX_ITERATIONS = 40;
+constexpr double TIME_TOLERANCE = 0.1; // с, точность восхода, захода и кульминации
+constexpr double GOLDEN_RATIO = 0.6180339887498949;
+
+struct Vector {
+    double x, y, z;
+
+    double dot(const Vector& o) const { return x * o.x + y * o.y + z * o.z; }
+};
+
+// Станция в земной системе (ECEF): положение и оси горизонта
+struct StationFrame {
+    Vector position;
+    Vector up, east, north;
+};
+
+StationFrame makeFrame(const GroundStation& station)
+{
+    const double sinLat = std::sin(station.latitude), cosLat = std::cos(station.latitude);
+    const double sinLon = std::sin(station.longitude), cosLon = std::cos(station.longitude);
+    const double e2 = WGS84_F * (2.0 - WGS84_F);
+    const double n = WGS84_A / std::sqrt(1.0 - e2 * sinLat * sinLat);
+
+    StationFrame frame;
+    frame.position = {(n + station.altitude) * cosLat * cosLon, (n + station.altitude) * cosLat * sinLon,
+                      (n * (1.0 - e2) + station.altitude) * sinLat};
+    frame.up = {cosLat * cosLon, cosLat * sinLon, sinLat};
+    frame.east = {-sinLon, cosLon, 0.0};
+    frame.north = {-sinLat * cosLon, -sinLat * sinLon, cosLat};
+    return frame;
+}
+
+// Положение в ECI (ось Z на полюс); KeplerPropagator отдает систему сцены
+Vector satelliteEci(const OrbitalElements& elements, double unixTime)
+{
+    const QVector3D p = KeplerPropagator::position(elements, unixTime);
+    return {p.x(), -p.z(), p.y()};
+}
+
+// Отсчеты окна и поворот Земли в каждом из них; общие для всех спутников
+struct Sampling {
+    double startTime = 0.0;
+    double endTime = 0.0;
+    double step = 0.0;
+    int samples = 0;
+    QVector<double> cosTheta, sinTheta;
+
+    double time(int k) const { return std::min(startTime + k * step, endTime); }
+};
+
+Sampling makeSampling(double startTime, const PassPredictor::Settings& settings)
+{
+    Sampling sampling;
+    if (settings.coarseStep <= 0.0 || settings.duration < 0.0)
+        return sampling;
+    sampling.startTime = startTime;
+    sampling.endTime = startTime + settings.duration;
+    sampling.step = settings.coarseStep;
+    sampling.samples = int(std::ceil(settings.duration / settings.coarseStep)) + 1;
+    sampling.cosTheta.resize(sampling.samples);
+    sampling.sinTheta.resize(sampling.samples);
+    for (int k = 0; k < sampling.samples; ++k) {
+        const double theta = SolarEphemeris::siderealAngle(sampling.time(k));
+        sampling.cosTheta[k] = std::cos(theta);
+        sampling.sinTheta[k] = std::sin(theta);
+    }
+    return sampling;
+}
+
+// Направление на спутник в осях горизонта станции (вверх, восток, север)
+Vector topocentric(const StationFrame& station, const Vector& satellite, double cosTheta, double sinTheta)
+{
+    const Vector range = {cosTheta * satellite.x + sinTheta * satellite.y - station.position.x,
+                          -sinTheta * satellite.x + cosTheta * satellite.y - station.position.y,
+                          satellite.z - station.position.z};
+    return {range.dot(station.up), range.dot(station.east), range.dot(station.north)};
+}
+
+// Синус угла места: монотонен по углу, но обходится без asin
+double sinElevation(const Vector& direction)
+{
+    return direction.x / std::sqrt(direction.dot(direction));
+}
+
+double azimuth(const Vector& direction)
+{
+    const double angle = std::atan2(direction.y, direction.z);
+    return angle < 0.0 ? angle + 2.0 * M_PI : angle;
+}
+
+// Пролеты одного спутника: отсчеты с грубым шагом, затем уточнение.
+// Внутри ищутся корни и максимумы синуса угла места над синусом маски
+QVector<SatellitePass> predictPasses(const OrbitalElements& elements, const QVector<StationFrame>& stations,
+                                     const Sampling& sampling, double minElevation, QVector<Vector>& positions)
+{
+    QVector<SatellitePass> passes;
+    const int samples = sampling.samples;
+    if (elements.meanMotion <= 0.0 || stations.isEmpty() || samples == 0)
+        return passes;
+
+    positions.resize(samples);
+    for (int k = 0; k < samples; ++k)
+        positions[k] = satelliteEci(elements, sampling.time(k));
+
+    const double sinMask = std::sin(minElevation);
+    QVector<double> heights(samples);
+    for (int station = 0; station < stations.size(); ++station) {
+        const StationFrame& frame = stations[station];
+        auto direction = [&](double t) {
+            const double theta = SolarEphemeris::siderealAngle(t);
+            return topocentric(frame, satelliteEci(elements, t), std::cos(theta), std::sin(theta));
+        };
+        // Положительна, пока спутник выше маски
+        auto height = [&](double t) { return sinElevation(direction(t)) - sinMask; };
+        // Корень между отсчетами разного знака (деление пополам)
+        auto crossing = [&](double a, double b, bool rising) {
+            for (int i = 0; i < MAX_ITERATIONS && b - a > TIME_TOLERANCE; ++i) {
+                const double middle = (a + b) / 2.0;
+                if ((height(middle) >= 0.0) == rising)
+                    b = middle;
+                else
+                    a = middle;
+            }
+            return (a + b) / 2.0;
+        };
+        // Максимум на отрезке, где высота одногорбая (золотое сечение)
+        auto maximum = [&](double a, double b, double& peak) {
+            double x1 = b - GOLDEN_RATIO * (b - a), x2 = a + GOLDEN_RATIO * (b - a);
+            double f1 = height(x1), f2 = height(x2);
+            for (int i = 0; i < MAX_ITERATIONS && b - a > TIME_TOLERANCE; ++i) {
+                if (f1 < f2) {
+                    a = x1;
+                    x1 = x2;
+                    f1 = f2;
+                    x2 = a + GOLDEN_RATIO * (b - a);
+                    f2 = height(x2);
+                } else {
+                    b = x2;
+                    x2 = x1;
+                    f2 = f1;
+                    x1 = b - GOLDEN_RATIO * (b - a);
+                    f1 = height(x1);
+                }
+            }
+            const double t = (a + b) / 2.0;
+            peak = height(t);
+            return t;
+        };
+
+        for (int k = 0; k < samples; ++k) {
+            heights[k] = sinElevation(topocentric(frame, positions[k], sampling.cosTheta[k], sampling.sinTheta[k])) -
+                         sinMask;
+        }
+
+        SatellitePass pass;
+        pass.satelliteId = elements.catalogNumber;
+        pass.station = station;
+        double peak = 0.0;
+        auto beginPass = [&](double rise) {
+            pass.rise = rise;
+            pass.culmination = rise;
+            peak = height(rise);
+        };
+        auto endPass = [&](double set) {
+            pass.set = set;
+            pass.maxElevation = std::asin(std::clamp(peak + sinMask, -1.0, 1.0));
+            pass.riseAzimuth = azimuth(direction(pass.rise));
+            pass.setAzimuth = azimuth(direction(set));
+            passes.append(pass);
+        };
+
+        bool visible = heights[0] >= 0.0;
+        // Максимум на отрезке [a, b]: кульминация текущего пролета
+        // или целый пролет между отсчетами под горизонтом
+        auto checkPeak = [&](double a, double b) {
+            double top = 0.0;
+            const double topTime = maximum(a, b, top);
+            if (visible && top > peak) {
+                peak = top;
+                pass.culmination = topTime;
+            } else if (!visible && top >= 0.0) {
+                beginPass(crossing(a, topTime, true));
+                peak = top;
+                pass.culmination = topTime;
+                endPass(crossing(topTime, b, false));
+            }
+        };
+
+        if (visible)
+            beginPass(sampling.startTime);
+        // У краев окна максимум может лежать между крайними отсчетами
+        if (samples >= 2 && heights[0] >= heights[1])
+            checkPeak(sampling.startTime, sampling.time(1));
+        for (int k = 1; k < samples; ++k) {
+            const double t = sampling.time(k);
+
+            // Локальный максимум отсчетов в k-1. Под горизонтом он уточняется, только
+            // если вершина может подняться выше маски: для параболы превышение
+            // над отсчетом не больше четверти большей из разностей соседних
+            // отсчетов, здесь берется запас в восемь раз
+            if (k >= 2 && heights[k - 2] < heights[k - 1] && heights[k - 1] >= heights[k]) {
+                const double rise = std::max(heights[k - 1] - heights[k - 2], heights[k - 1] - heights[k]);
+                if (visible || heights[k - 1] + 2.0 * rise >= 0.0)
+                    checkPeak(sampling.time(k - 2), t);
+            }
+
+            if (!visible && heights[k] >= 0.0) {
+                visible = true;
+                beginPass(crossing(sampling.time(k - 1), t, true));
+            } else if (visible && heights[k] < 0.0) {
+                visible = false;
+                endPass(crossing(sampling.time(k - 1), t, false));
+                continue;
+            }
+            // Пролет, обрезанный окном, может не иметь максимума внутри
+            if (visible && heights[k] > peak) {
+                peak = heights[k];
+                pass.culmination = t;
+            }
+        }
+        if (samples >= 2 && heights[samples - 1] > heights[samples - 2])
+            checkPeak(sampling.time(samples - 2), sampling.endTime);
+        if (visible)
+            endPass(sampling.endTime);
+    }
+
+    std::sort(passes.begin(), passes.end(),
+              [](const SatellitePass& a, const SatellitePass& b) { return a.rise < b.rise; });
+    return passes;
+}
+
+bool sameOrbit(const OrbitalElements& a, const OrbitalElements& b)
+{
+    return a.epoch == b.epoch && a.meanAnomaly == b.meanAnomaly && a.meanMotion == b.meanMotion &&
+           a.eccentricity == b.eccentricity && a.inclination == b.inclination && a.raan == b.raan &&
+           a.argPerigee == b.argPerigee;
+}
+
+}
+
+bool GroundStation::parse(const QString& text, GroundStation& station)
+{
+    const QStringList fields = text.split(',');
+    if (fields.size() < 3 || fields.size() > 4)
+        return false;
+    bool latitudeOk = false, longitudeOk = false, altitudeOk = true;
+    const double latitude = fields[1].trimmed().toDouble(&latitudeOk);
+    const double longitude = fields[2].trimmed().toDouble(&longitudeOk);
+    const double altitude = fields.size() == 4 ? fields[3].trimmed().toDouble(&altitudeOk) : 0.0;
+    if (!latitudeOk || !longitudeOk || !altitudeOk || std::abs(latitude) > 90.0)
+        return false;
+
+    station.name = fields[0].trimmed();
+    station.latitude = latitude * M_PI / 180.0;
+    station.longitude = longitude * M_PI / 180.0;
+    station.altitude = altitude;
+    return true;
+}
+
+PassPredictor::PassPredictor(QObject* parent)
+    : QObject(parent)
+{
+    connect(&watcher, &QFutureWatcher<PassPredictionResult>::finished, this, [this]() {
+        result = watcher.result();
+        resultConfiguration = runningConfiguration;
+        emit finished(result);
+        if (restartPending) {
+            restartPending = false;
+            start(std::exchange(pendingCatalog, {}), pendingStartTime);
+        }
+    });
+}
+
+PassPredictor::~PassPredictor()
+{
+    watcher.waitForFinished();
+}
+
+void PassPredictor::setStations(const QVector<GroundStation>& newStations)
+{
+    stationList = newStations;
+    ++configuration;
+}
+
+void PassPredictor::setSettings(const Settings& newSettings)
+{
+    settings = newSettings;
+    ++configuration;
+}
+
+void PassPredictor::start(const QVector<OrbitalElements>& catalog, double startTime)
+{
+    if (watcher.isRunning()) {
+        restartPending = true;
+        pendingCatalog = catalog;
+        pendingStartTime = startTime;
+        return;
+    }
+    runningConfiguration = configuration;
+    const PassPredictionResult cache = resultConfiguration == configuration ? result : PassPredictionResult();
+    const QVector<GroundStation> stations = stationList;
+    const Settings predictionSettings = settings;
+    watcher.setFuture(QtConcurrent::run([catalog, stations, startTime, predictionSettings, cache]() {
+        return predict(catalog, stations, startTime, predictionSettings, cache);
+    }));
+}
+
+QVector<SatellitePass> PassPredictor::predict(const OrbitalElements& elements, const QVector<GroundStation>& stations,
+                                              double startTime, const Settings& settings)
+{
+    QVector<StationFrame> frames;
+    for (const GroundStation& station : stations)
+        frames.append(makeFrame(station));
+    QVector<Vector> positions;
+    return predictPasses(elements, frames, makeSampling(startTime, settings), settings.minElevation, positions);
+}
+
+PassPredictionResult PassPredictor::predict(const QVector<OrbitalElements>& catalog,
+                                            const QVector<GroundStation>& stations, double startTime,
+                                            const Settings& settings, const PassPredictionResult& cache)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    PassPredictionResult prediction;
+    prediction.startTime = startTime;
+    prediction.duration = settings.duration;
+    prediction.satellites.reserve(catalog.size());
+
+    QVector<StationFrame> frames;
+    for (const GroundStation& station : stations)
+        frames.append(makeFrame(station));
+    const Sampling sampling = makeSampling(startTime, settings);
+
+    // Из кэша берутся спутники с прежними элементами, если окно то же
+    const bool sameWindow = cache.startTime == startTime && cache.duration == settings.duration;
+    QVector<int> pending;
+    for (int i = 0; i < catalog.size(); ++i) {
+        const OrbitalElements& elements = catalog[i];
+        if (elements.meanMotion <= 0.0)
+            continue;
+        if (sameWindow) {
+            auto cached = cache.satellites.constFind(elements.catalogNumber);
+            if (cached != cache.satellites.constEnd() && sameOrbit(cached->elements, elements)) {
+                prediction.satellites.insert(elements.catalogNumber, *cached);
+                ++prediction.reused;
+                continue;
+            }
+        }
+        pending.append(i);
+    }
+
+    QVector<QVector<SatellitePass>> computed(pending.size());
+    QVector<int> blocks;
+    for (int begin = 0; begin < pending.size(); begin += SATELLITES_PER_BLOCK)
+        blocks.append(begin);
+    QtConcurrent::blockingMap(blocks, [&](int begin) {
+        QVector<Vector> positions;
+        const int end = std::min(begin + SATELLITES_PER_BLOCK, int(pending.size()));
+        for (int i = begin; i < end; ++i)
+            computed[i] = predictPasses(catalog[pending[i]], frames, sampling, settings.minElevation, positions);
+    });
+
+    for (int i = 0; i < pending.size(); ++i) {
+        const OrbitalElements& elements = catalog[pending[i]];
+        prediction.satellites.insert(elements.catalogNumber, {elements, computed[i]});
+    }
+    prediction.computed = pending.size();
+    for (const PassPredictionResult::Entry& entry : prediction.satellites)
+        prediction.passCount += entry.passes.size();
+    prediction.elapsedMs = timer.nsecsElapsed() / 1.0e6;
+    return prediction;
+}
@@ -0,0 +1,117 @@
+// pass_predictor.h
+#ifndef PASS_PREDICTOR_H
+#define PASS_PREDICTOR_H
+
+#include <QHash>
+#include <QObject>
+#include <QFutureWatcher>
+#include <QString>
+#include <QVector>
+#include "orbital_elements.h"
+
+// Наземная станция: геодезические координаты на эллипсоиде WGS-84
+struct GroundStation {
+    QString name;
+    double latitude = 0.0;  // рад
+    double longitude = 0.0; // рад, восточная
+    double altitude = 0.0;  // м над эллипсоидом
+
+    // "имя,широта,долгота[,высота]" в градусах и метрах
+    static bool parse(const QString& text, GroundStation& station);
+};
+
+// Пролет спутника над станцией. Пролет, идущий на границе окна,
+// обрезается ею: восход или заход совпадает с началом или концом окна
+struct SatellitePass {
+    int satelliteId = -1;
+    int station = -1;           // индекс в списке станций
+    double rise = 0.0;          // секунды Unix
+    double culmination = 0.0;
+    double set = 0.0;
+    double maxElevation = 0.0;  // рад
+    double riseAzimuth = 0.0;   // рад, от севера по часовой
+    double setAzimuth = 0.0;
+};
+
+struct PassPredictionResult {
+    // Элементы, по которым посчитаны пролеты; по ним проверяется кэш
+    struct Entry {
+        OrbitalElements elements;
+        QVector<SatellitePass> passes; // по времени восхода
+    };
+
+    QHash<int, Entry> satellites;
+    double startTime = 0.0;
+    double duration = 0.0;
+    int computed = 0;  // спутников, посчитанных заново
+    int reused = 0;    // взятых из кэша
+    int passCount = 0;
+    double elapsedMs = 0.0;
+
+    QVector<SatellitePass> passes(int satelliteId) const { return satellites.value(satelliteId).passes; }
+};
+
+// Предсказание пролетов каталога над списком станций на интервале времени.
+//
+// Угол места считается с грубым шагом; восход и заход уточняются поиском
+// корня между соседними отсчетами, кульминация — золотым сечением вокруг
+// локального максимума отсчетов. Короткий пролет между двумя отсчетами
+// находится по такому же максимуму под горизонтом. Спутники считаются
+// параллельно; результат спутника переиспользуется, пока не изменились
+// его элементы, станции или окно.
+class PassPredictor : public QObject {
+    Q_OBJECT
+
+public:
+    struct Settings {
+        double duration = 86400.0;  // с
+        double coarseStep = 60.0;   // с
+        double minElevation = 0.0;  // рад, маска горизонта
+    };
+
+    explicit PassPredictor(QObject* parent = nullptr);
+    ~PassPredictor() override;
+
+    // Смена станций или настроек сбрасывает кэш
+    void setStations(const QVector<GroundStation>& newStations);
+    const QVector<GroundStation>& stations() const { return stationList; }
+    void setSettings(const Settings& newSettings);
+    const Settings& currentSettings() const { return settings; }
+
+    // Синхронный расчет в глобальном пуле потоков; записи cache с теми же
+    // элементами и окном не пересчитываются
+    static PassPredictionResult predict(const QVector<OrbitalElements>& catalog, const QVector<GroundStation>& stations,
+                                        double startTime, const Settings& settings,
+                                        const PassPredictionResult& cache = PassPredictionResult());
+    // Пролеты одного спутника над всеми станциями
+    static QVector<SatellitePass> predict(const OrbitalElements& elements, const QVector<GroundStation>& stations,
+                                          double startTime, const Settings& settings);
+
+    // Расчет в фоне; если предыдущий еще идет, запускается после него
+    // с последним переданным каталогом
+    void start(const QVector<OrbitalElements>& catalog, double startTime);
+    bool isRunning() const { return watcher.isRunning(); }
+    const PassPredictionResult& lastResult() const { return result; }
+
+signals:
+    void finished(const PassPredictionResult& result);
+
+private:
+    static constexpr int SATELLITES_PER_BLOCK = 64; // спутников на задачу пула
+
+    Settings settings;
+    QVector<GroundStation> stationList;
+    QFutureWatcher<PassPredictionResult> watcher;
+    PassPredictionResult result;
+
+    // Номер набора станций и настроек: кэш годится только для того же набора
+    quint64 configuration = 0;
+    quint64 runningConfiguration = 0;
+    quint64 resultConfiguration = 0;
+
+    bool restartPending = false;
+    QVector<OrbitalElements> pendingCatalog;
+    double pendingStartTime = 0.0;
+};
+
+#endif // PASS_PREDICTOR_H
@@ -0,0 +1,55 @@
+// profiler_overlay.cpp
+#include "profiler_overlay.h"
+#include <algorithm>
+
+ProfilerOverlay::ProfilerOverlay()
+{
+}
+
+void ProfilerOverlay::render(TextRenderer& text, const QPointF& origin)
+{
+    if (!sinceRefresh.isValid() || sinceRefresh.elapsed() >= REFRESH_INTERVAL_MS) {
+        sinceRefresh.start();
+        stats = FrameProfiler::instance().statistics();
+        std::sort(stats.begin(), stats.end(), [](const FrameProfiler::Stats& a, const FrameProfiler::Stats& b) {
+            return a.gpu != b.gpu ? !a.gpu : a.name < b.name;
+        });
+
+        rows.clear();
+        for (const FrameProfiler::Stats& s : stats) {
+            rows.append(QString("%1 %2  p50 %3  p99 %4 ms")
+                            .arg(s.gpu ? "GPU" : "CPU")
+                            .arg(s.name, -14)
+                            .arg(s.p50Ms, 6, 'f', 2)
+                            .arg(s.p99Ms, 6, 'f', 2));
+        }
+    }
+
+    if (rows.isEmpty())
+        return;
+
+    const float histogramWidth = FrameProfiler::HISTOGRAM_BINS * BAR_WIDTH;
+    float textWidth = 0.0f;
+    for (const QString& row : rows)
+        textWidth = std::max(textWidth, float(text.measure(row, FONT_SIZE).width()));
+
+    QRectF background(origin, QSizeF(textWidth + histogramWidth + 20.0f, rows.size() * ROW_HEIGHT + 8.0f));
+    text.addRect(background, QColor(0, 0, 0, 160));
+
+    for (int i = 0; i < rows.size(); ++i) {
+        QPointF rowOrigin = origin + QPointF(5.0f, 4.0f + i * ROW_HEIGHT);
+        text.addText(rows[i], rowOrigin, FONT_SIZE, stats[i].gpu ? QColor(255, 200, 80) : QColor(120, 220, 255));
+
+        // Гистограмма от 0 до максимума прохода
+        const QVector<int>& bins = stats[i].histogram;
+        const int peak = std::max(1, *std::max_element(bins.begin(), bins.end()));
+        const float x0 = rowOrigin.x() + textWidth + 10.0f;
+        const float baseline = rowOrigin.y() + ROW_HEIGHT - 3.0f;
+        for (int bin = 0; bin < bins.size(); ++bin) {
+            float height = (ROW_HEIGHT - 4.0f) * bins[bin] / peak;
+            if (height > 0.0f)
+                text.addRect(QRectF(x0 + bin * BAR_WIDTH, baseline - height, BAR_WIDTH - 1.0f, height),
+                             QColor(200, 200, 200, 220));
+        }
+    }
+}
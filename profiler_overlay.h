@@ -0,0 +1,28 @@
+// profiler_overlay.h
+#ifndef PROFILER_OVERLAY_H
+#define PROFILER_OVERLAY_H
+
+#include <QElapsedTimer>
+#include <QPointF>
+#include <QVector>
+#include "frame_profiler.h"
+#include "text_renderer.h"
+
+// Таблица проходов кадра: p50/p99 и гистограмма длительностей
+class ProfilerOverlay {
+public:
+    ProfilerOverlay();
+    void render(TextRenderer& text, const QPointF& origin);
+
+private:
+    static constexpr int REFRESH_INTERVAL_MS = 250;
+    static constexpr float FONT_SIZE = 12.0f;
+    static constexpr float ROW_HEIGHT = 16.0f;
+    static constexpr float BAR_WIDTH = 3.0f;
+
+    QElapsedTimer sinceRefresh;
+    QVector<FrameProfiler::Stats> stats;
+    QVector<QString> rows; // подписи строк, пересобираются вместе со stats
+};
+
+#endif // PROFILER_OVERLAY_H
@@ -0,0 +1,112 @@
+// render_command_queue.h
+#ifndef RENDER_COMMAND_QUEUE_H
+#define RENDER_COMMAND_QUEUE_H
+
+#include <QMatrix4x4>
+#include <QSize>
+#include <QVector>
+#include <QVector3D>
+#include <array>
+#include <atomic>
+#include "satellite_change_set.h"
+#include "satellite_store.h"
+#include "scene_options.h"
+
+// Команда от GUI-потока потоку рендеринга
+struct RenderCommand {
+    enum class Type {
+        None,
+        Resize,           // size
+        SetCamera,        // projection, view, model
+        UpdateSatellites, // satellites
+        ApplySatelliteChanges, // satelliteChanges
+        SetTrajectories,  // trajectory, futureTrajectory, orbitLines, trajectoryVisible
+        Advance,          // deltaTime, unixTime
+        SetOptions        // options
+    };
+
+    Type type = Type::None;
+    QSize size;
+    QMatrix4x4 projection;
+    QMatrix4x4 view;
+    QMatrix4x4 model;
+    SatelliteStore satellites;
+    SatelliteChangeSet satelliteChanges;
+    QVector<QVector3D> trajectory;
+    QVector<QVector3D> futureTrajectory;
+    QVector<OrbitLine> orbitLines;
+    bool trajectoryVisible = false;
+    float deltaTime = 0.0f;
+    double unixTime = 0.0;
+    SceneOptions options;
+};
+
+// Очередь без блокировок для одного писателя и одного читателя.
+// Контейнеры Qt внутри команд разделяются неявно, поэтому копия набора
+// спутников в GUI-потоке не приводит к глубокому копированию.
+template <typename T, int Capacity>
+class SpscQueue {
+public:
+    bool push(T&& item) {
+        const int head = writeIndex.load(std::memory_order_relaxed);
+        const int next = (head + 1) % Capacity;
+        if (next == readIndex.load(std::memory_order_acquire))
+            return false; // очередь заполнена
+
+        items[head] = std::move(item);
+        writeIndex.store(next, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(T& item) {
+        const int tail = readIndex.load(std::memory_order_relaxed);
+        if (tail == writeIndex.load(std::memory_order_acquire))
+            return false;
+
+        item = std::move(items[tail]);
+        items[tail] = T(); // освобождаем разделяемые данные сразу
+        readIndex.store((tail + 1) % Capacity, std::memory_order_release);
+        return true;
+    }
+
+private:
+    std::array<T, Capacity> items;
+    alignas(64) std::atomic<int> writeIndex{0};
+    alignas(64) std::atomic<int> readIndex{0};
+};
+
+// Последнее значение для одного писателя и одного читателя без блокировок:
+// тройной буфер с атомарным обменом индекса, как у кадров RenderThread.
+// Писатель не ждет читателя, промежуточные значения заменяются новыми.
+template <typename T>
+class LatestValue {
+public:
+    void store(T&& value) {
+        items[backIndex] = std::move(value);
+        backIndex = readyIndex.exchange(backIndex | FRESH_BIT, std::memory_order_acq_rel) & INDEX_MASK;
+    }
+
+    // false — нового значения с прошлого вызова не было
+    bool take(T& value) {
+        if (!(readyIndex.load(std::memory_order_acquire) & FRESH_BIT))
+            return false;
+        frontIndex = readyIndex.exchange(frontIndex, std::memory_order_acq_rel) & INDEX_MASK;
+        value = std::move(items[frontIndex]);
+        items[frontIndex] = T(); // освобождаем разделяемые данные сразу
+        return true;
+    }
+
+private:
+    static constexpr int FRESH_BIT = 0x4;
+    static constexpr int INDEX_MASK = 0x3;
+
+    std::array<T, 3> items;
+    int backIndex = 0;                    // пишет писатель
+    alignas(64) std::atomic<int> readyIndex{1};
+    alignas(64) int frontIndex = 2;       // пишет читатель
+};
+
+using RenderCommandQueue = SpscQueue<RenderCommand, 256>;
+using LatestRenderCommand = LatestValue<RenderCommand>;
+
+#endif // RENDER_COMMAND_QUEUE_H
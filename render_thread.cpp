@@ -0,0 +1,265 @@
+// render_thread.cpp
+#include "render_thread.h"
+#include "scene_renderer.h"
+#include <QOpenGLContext>
+#include <QOffscreenSurface>
+#include <QCoreApplication>
+#include <QOpenGLFramebufferObject>
+#include <QDebug>
+
+RenderThread::RenderThread(QOpenGLContext* shareContext, float radius, const SceneOptions& options,
+                           QObject* parent)
+    : QThread(parent)
+    , context(new QOpenGLContext())
+    , surface(new QOffscreenSurface())
+    , earthRadius(radius)
+    , initialOptions(options)
+    , backIndex(0)
+    , readyIndex(1)
+    , frontIndex(2)
+{
+    setObjectName("RenderThread");
+
+    // QOffscreenSurface должен создаваться в GUI-потоке
+    surface->setFormat(shareContext->format());
+    surface->create();
+
+    context->setFormat(shareContext->format());
+    context->setShareContext(shareContext);
+    if (!context->create())
+        qDebug() << "Failed to create render thread OpenGL context";
+    context->moveToThread(this);
+}
+
+RenderThread::~RenderThread()
+{
+    stop();
+    delete context;
+    delete surface;
+}
+
+LatestRenderCommand* RenderThread::latestSlot(RenderCommand::Type type)
+{
+    switch (type) {
+    case RenderCommand::Type::Resize:
+        return &latestResize;
+    case RenderCommand::Type::SetCamera:
+        return &latestCamera;
+    case RenderCommand::Type::SetTrajectories:
+        return &latestTrajectories;
+    case RenderCommand::Type::SetOptions:
+        return &latestOptions;
+    default:
+        return nullptr;
+    }
+}
+
+bool RenderThread::post(RenderCommand&& command)
+{
+    // Снимок состояния: важен только последний, в очередь он не попадает
+    if (LatestRenderCommand* latest = latestSlot(command.type)) {
+        latest->store(std::move(command));
+        return true;
+    }
+
+    if (!isRunning())
+        return false;
+    if (!commands.push(std::move(command))) {
+        // Очередь заполнена: поток рендеринга будится, GUI не ждет
+        frameRequests.release();
+        return false;
+    }
+    return true;
+}
+
+void RenderThread::requestFrame()
+{
+    frameRequests.release();
+}
+
+void RenderThread::stop()
+{
+    if (!isRunning())
+        return;
+
+    // Флаг, а не команда: остановка не зависит от места в очереди
+    quitRequested.store(true);
+    frameRequests.release();
+    wait();
+}
+
+RenderThread::Frame RenderThread::acquireFrame()
+{
+    if (readyIndex.load() & FRESH_BIT)
+        frontIndex = readyIndex.exchange(frontIndex) & INDEX_MASK;
+
+    Frame frame;
+    Slot& slot = frameSlots[frontIndex];
+    frame.texture = slot.texture.load();
+    frame.fence = slot.fence;
+    if (slot.fbo)
+        frame.size = slot.fbo->size();
+    return frame;
+}
+
+GLsync RenderThread::releaseFrame(GLsync compositeFence)
+{
+    Slot& slot = frameSlots[frontIndex];
+    GLsync previous = slot.readFence;
+    slot.readFence = compositeFence;
+    return previous;
+}
+
+void RenderThread::run()
+{
+    if (!context->makeCurrent(surface)) {
+        qDebug() << "Failed to make render thread context current";
+        return;
+    }
+    initializeOpenGLFunctions();
+
+    scene = std::make_unique<SceneRenderer>(earthRadius);
+    scene->initialize(initialOptions);
+
+    for (;;) {
+        frameRequests.acquire();
+        // Несколько запросов, накопившихся за время кадра, дают один кадр
+        frameRequests.tryAcquire(frameRequests.available());
+
+        if (!processCommands())
+            break;
+        renderFrame();
+    }
+
+    releaseResources();
+    context->doneCurrent();
+    // Контекст удаляется в деструкторе, в GUI-потоке
+    context->moveToThread(QCoreApplication::instance()->thread());
+}
+
+bool RenderThread::processCommands()
+{
+    if (quitRequested.load())
+        return false;
+
+    // Снимки без нового значения остаются Type::None и пропускаются
+    RenderCommand resize;
+    RenderCommand camera;
+    RenderCommand trajectories;
+    RenderCommand options;
+    latestResize.take(resize);
+    latestCamera.take(camera);
+    latestTrajectories.take(trajectories);
+    latestOptions.take(options);
+
+    // Настройки — до изменений набора, как в однопоточном EarthWidget::paintGL
+    applyCommand(resize);
+    applyCommand(options);
+
+    RenderCommand command;
+    while (commands.pop(command))
+        applyCommand(command);
+
+    applyCommand(trajectories);
+    applyCommand(camera);
+    return true;
+}
+
+void RenderThread::applyCommand(const RenderCommand& command)
+{
+    switch (command.type) {
+    case RenderCommand::Type::Resize:
+        frameSize = command.size;
+        break;
+    case RenderCommand::Type::SetCamera:
+        projection = command.projection;
+        view = command.view;
+        model = command.model;
+        break;
+    case RenderCommand::Type::UpdateSatellites:
+        scene->setSatellites(command.satellites);
+        break;
+    case RenderCommand::Type::ApplySatelliteChanges:
+        scene->applySatelliteChanges(command.satelliteChanges);
+        break;
+    case RenderCommand::Type::SetTrajectories:
+        scene->setTrajectories(command.trajectory, command.futureTrajectory);
+        scene->setOrbitLines(command.orbitLines);
+        scene->setTrajectoryVisible(command.trajectoryVisible);
+        break;
+    case RenderCommand::Type::Advance:
+        scene->update(command.deltaTime);
+        scene->setUnixTime(command.unixTime);
+        break;
+    case RenderCommand::Type::SetOptions:
+        scene->setOptions(command.options);
+        break;
+    case RenderCommand::Type::None:
+        break;
+    }
+}
+
+void RenderThread::ensureSlot(Slot& slot)
+{
+    if (slot.fbo && slot.fbo->size() == frameSize)
+        return;
+
+    // Слот принадлежит потоку рендеринга, GUI его сейчас не читает
+    slot.fbo = std::make_unique<QOpenGLFramebufferObject>(frameSize);
+    slot.texture.store(slot.fbo->texture());
+}
+
+void RenderThread::renderFrame()
+{
+    if (frameSize.isEmpty())
+        return;
+
+    ProfileScope scope("render thread frame");
+
+    if (!multisampleFbo || multisampleFbo->size() != frameSize) {
+        QOpenGLFramebufferObjectFormat format;
+        format.setAttachment(QOpenGLFramebufferObject::CombinedDepthStencil);
+        format.setSamples(context->format().samples());
+        multisampleFbo = std::make_unique<QOpenGLFramebufferObject>(frameSize, format);
+    }
+
+    Slot& slot = frameSlots[backIndex];
+    // Дожидаемся, пока GUI-поток закончит читать текстуру слота
+    if (slot.readFence) {
+        glWaitSync(slot.readFence, 0, GL_TIMEOUT_IGNORED);
+        glDeleteSync(slot.readFence);
+        slot.readFence = nullptr;
+    }
+    ensureSlot(slot);
+
+    multisampleFbo->bind();
+    glViewport(0, 0, frameSize.width(), frameSize.height());
+    scene->render(projection, view, model);
+    multisampleFbo->release();
+
+    QOpenGLFramebufferObject::blitFramebuffer(slot.fbo.get(), multisampleFbo.get());
+
+    if (slot.fence)
+        glDeleteSync(slot.fence);
+    slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    glFlush();
+
+    backIndex = readyIndex.exchange(backIndex | FRESH_BIT) & INDEX_MASK;
+    emit frameReady();
+}
+
+void RenderThread::releaseResources()
+{
+    scene.reset();
+    multisampleFbo.reset();
+    for (Slot& slot : frameSlots) {
+        if (slot.fence)
+            glDeleteSync(slot.fence);
+        if (slot.readFence)
+            glDeleteSync(slot.readFence);
+        slot.fence = nullptr;
+        slot.readFence = nullptr;
+        slot.texture.store(0);
+        slot.fbo.reset();
+    }
+}
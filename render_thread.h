@@ -0,0 +1,109 @@
+// render_thread.h
+#ifndef RENDER_THREAD_H
+#define RENDER_THREAD_H
+
+#include <QThread>
+#include <QSemaphore>
+#include <QOpenGLExtraFunctions>
+#include <atomic>
+#include <memory>
+#include "render_command_queue.h"
+#include "scene_options.h"
+
+class QOpenGLContext;
+class QOffscreenSurface;
+class QOpenGLFramebufferObject;
+class SceneRenderer;
+
+// Поток рендеринга сцены. Рисует в FBO в собственном контексте, разделяемом
+// с контекстом виджета; виджет только выводит готовую текстуру на экран.
+// Состояние приходит через очередь команд без блокировок; команды-снимки
+// (камера, траектории, настройки) не ставятся в очередь, а заменяют
+// предыдущий снимок — поток рендеринга применяет последний.
+class RenderThread : public QThread, protected QOpenGLExtraFunctions
+{
+    Q_OBJECT
+
+public:
+    struct Frame {
+        GLuint texture = 0;
+        GLsync fence = nullptr;
+        QSize size;
+    };
+
+    // Создается в GUI-потоке при активном контексте shareContext; options —
+    // начальные опции сцены, с ними она инициализируется
+    RenderThread(QOpenGLContext* shareContext, float earthRadius, const SceneOptions& options,
+                 QObject* parent = nullptr);
+    ~RenderThread() override;
+
+    // Вызываются из GUI-потока и никогда его не блокируют. Снимки (камера,
+    // размер, траектории, настройки) заменяют предыдущие; изменения сцены
+    // идут через очередь. false — очередь заполнена или поток не работает:
+    // вызывающий копит изменения у себя и передает их следующим кадром
+    bool post(RenderCommand&& command);
+    void requestFrame();
+    void stop();
+
+    // Последний готовый кадр; texture == 0 если кадров еще не было
+    Frame acquireFrame();
+    // Fence после композиции кадра в GUI-контексте: слот не будет
+    // перезаписан, пока GPU его читает. Возвращает предыдущий fence
+    // слота, который вызывающий должен удалить в своем контексте.
+    GLsync releaseFrame(GLsync compositeFence);
+
+signals:
+    void frameReady();
+
+protected:
+    void run() override;
+
+private:
+    struct Slot {
+        std::unique_ptr<QOpenGLFramebufferObject> fbo;
+        GLsync fence = nullptr;     // рендер в слот завершен
+        GLsync readFence = nullptr; // композиция слота завершена
+        std::atomic<GLuint> texture{0};
+    };
+
+    bool processCommands();
+    void applyCommand(const RenderCommand& command);
+    LatestRenderCommand* latestSlot(RenderCommand::Type type);
+    void renderFrame();
+    void ensureSlot(Slot& slot);
+    void releaseResources();
+
+    static constexpr int SLOT_COUNT = 3;   // тройная буферизация
+    static constexpr int FRESH_BIT = 0x4;
+    static constexpr int INDEX_MASK = 0x3;
+
+    QOpenGLContext* context;
+    QOffscreenSurface* surface;
+    float earthRadius;
+    SceneOptions initialOptions;
+
+    RenderCommandQueue commands;
+    QSemaphore frameRequests;
+
+    // Последние снимки, обмен без блокировок
+    LatestRenderCommand latestResize;
+    LatestRenderCommand latestCamera;
+    LatestRenderCommand latestTrajectories;
+    LatestRenderCommand latestOptions;
+    std::atomic<bool> quitRequested{false};
+
+    // Состояние, принадлежащее потоку рендеринга
+    std::unique_ptr<SceneRenderer> scene;
+    std::unique_ptr<QOpenGLFramebufferObject> multisampleFbo;
+    QSize frameSize;
+    QMatrix4x4 projection;
+    QMatrix4x4 view;
+    QMatrix4x4 model;
+
+    Slot frameSlots[SLOT_COUNT];
+    int backIndex;               // пишет поток рендеринга
+    std::atomic<int> readyIndex; // обмен между потоками
+    int frontIndex;              // читает GUI-поток
+};
+
+#endif // RENDER_THREAD_H
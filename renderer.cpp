@@ -23,3 +23,8 @@ bool Renderer::init()
     initializeOpenGLFunctions();
     return true;
 }
+
+void Renderer::update(float deltaTime)
+{
+    Q_UNUSED(deltaTime);
+}
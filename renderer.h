@@ -16,6 +16,7 @@ public:
     virtual bool init();  // Новый метод для инициализации
     virtual void initialize() = 0;
     virtual void render(const QMatrix4x4& projection, const QMatrix4x4& view, const QMatrix4x4& model) = 0;
+    virtual void update(float deltaTime);  // Шаг часов симуляции в секундах
 
 protected:
     void initializeOpenGLFunctions();
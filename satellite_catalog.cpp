@@ -0,0 +1,129 @@
+// satellite_catalog.cpp
+#include "satellite_catalog.h"
+#include "kepler_propagator.h"
+#include "ephemeris_cache.h"
+
+namespace {
+
+// FNV-1a по числовым полям: не зависит от процессора и версии Qt,
+// поэтому ключ годится для имен файлов между запусками
+quint64 recordKey(const OrbitalElements& elements)
+{
+    const double values[] = {double(elements.catalogNumber), elements.epoch, elements.inclination,
+                             elements.raan, elements.eccentricity, elements.argPerigee,
+                             elements.meanAnomaly, elements.meanMotion};
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(values);
+    quint64 hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < sizeof(values); ++i) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+}
+
+void SatelliteCatalog::setElements(const QVector<OrbitalElements>& elements)
+{
+    clear();
+    upsert(elements, lastUnixTime);
+}
+
+bool SatelliteCatalog::upsert(const OrbitalElements& elements)
+{
+    bool added = false;
+    const int index = store(elements, added);
+    catalogPositions[index] = KeplerPropagator::position(elements, lastUnixTime);
+    return added;
+}
+
+void SatelliteCatalog::upsert(const QVector<OrbitalElements>& elements, double unixTime)
+{
+    const int capacity = catalogElements.size() + elements.size();
+    catalogElements.reserve(capacity);
+    catalogIds.reserve(capacity);
+    catalogPositions.reserve(capacity);
+    catalogModified.reserve(capacity);
+    indexById.reserve(capacity);
+
+    bool added = false;
+    for (const OrbitalElements& item : elements)
+        store(item, added);
+    propagate(unixTime);
+}
+
+int SatelliteCatalog::store(const OrbitalElements& elements, bool& added)
+{
+    ++catalogRevision;
+    auto it = indexById.constFind(elements.catalogNumber);
+    catalogKey ^= recordKey(elements);
+    if (it != indexById.constEnd()) {
+        catalogKey ^= recordKey(catalogElements[*it]);
+        catalogElements[*it] = elements;
+        catalogModified[*it] = catalogRevision;
+        added = false;
+        return *it;
+    }
+
+    const int index = catalogElements.size();
+    indexById.insert(elements.catalogNumber, index);
+    catalogElements.append(elements);
+    catalogIds.append(elements.catalogNumber);
+    catalogPositions.append(QVector3D());
+    catalogModified.append(catalogRevision);
+    added = true;
+    return index;
+}
+
+bool SatelliteCatalog::remove(int id)
+{
+    auto it = indexById.find(id);
+    if (it == indexById.end())
+        return false;
+
+    ++catalogRevision;
+    const int index = *it;
+    const int last = catalogElements.size() - 1;
+    catalogKey ^= recordKey(catalogElements[index]);
+    indexById.erase(it);
+    if (index != last) {
+        catalogElements[index] = std::move(catalogElements[last]);
+        catalogIds[index] = catalogIds[last];
+        catalogPositions[index] = catalogPositions[last];
+        catalogModified[index] = catalogModified[last];
+        indexById[catalogIds[index]] = index;
+    }
+    catalogElements.removeLast();
+    catalogIds.removeLast();
+    catalogPositions.removeLast();
+    catalogModified.removeLast();
+    return true;
+}
+
+void SatelliteCatalog::clear()
+{
+    catalogElements.clear();
+    catalogIds.clear();
+    catalogPositions.clear();
+    catalogModified.clear();
+    indexById.clear();
+    ++catalogRevision;
+    catalogKey = 0;
+}
+
+void SatelliteCatalog::propagate(double unixTime)
+{
+    lastUnixTime = unixTime;
+    KeplerPropagator::propagate(catalogElements, unixTime, catalogPositions);
+}
+
+void SatelliteCatalog::updatePosition(int index, double unixTime)
+{
+    catalogPositions[index] = KeplerPropagator::position(catalogElements[index], unixTime);
+}
+
+void SatelliteCatalog::propagate(double unixTime, EphemerisCache& cache)
+{
+    lastUnixTime = unixTime;
+    cache.interpolate(*this, unixTime, catalogPositions);
+}
@@ -0,0 +1,66 @@
+// satellite_catalog.h
+#ifndef SATELLITE_CATALOG_H
+#define SATELLITE_CATALOG_H
+
+#include <QHash>
+#include <QVector>
+#include <QVector3D>
+#include "orbital_elements.h"
+
+class EphemerisCache;
+
+// Орбитальные элементы каталога и положения на последний момент пропагации.
+// Массивы плотные и идут в одном порядке: удаление переносит последнюю
+// запись на место удаленной, поэтому индекс объекта может меняться.
+class SatelliteCatalog {
+public:
+    void setElements(const QVector<OrbitalElements>& elements);
+    // true, если объект новый; положение нового объекта считается сразу
+    bool upsert(const OrbitalElements& elements);
+    // Пакет записей (загрузка каталога): место резервируется заранее,
+    // положения всего каталога считаются один раз на момент unixTime
+    void upsert(const QVector<OrbitalElements>& elements, double unixTime);
+    bool remove(int id);
+    void clear();
+
+    // Момент, на который upsert считает положения; propagate сдвигает его сам.
+    // Без пропагации (пауза) задается по часам симуляции
+    void setTime(double unixTime) { lastUnixTime = unixTime; }
+    void propagate(double unixTime);
+    // То же через кэш эфемерид: интерполяция вместо пропагации
+    void propagate(double unixTime, EphemerisCache& cache);
+    // Положение одного объекта, например выбранного, когда остальные считает GPU
+    void updatePosition(int index, double unixTime);
+
+    int indexOf(int id) const { return indexById.value(id, -1); }
+    bool contains(int id) const { return indexById.contains(id); }
+    bool isEmpty() const { return catalogElements.isEmpty(); }
+    int size() const { return catalogElements.size(); }
+
+    const QVector<OrbitalElements>& elements() const { return catalogElements; }
+    const QVector<int>& ids() const { return catalogIds; }
+    const QVector<QVector3D>& positions() const { return catalogPositions; }
+
+    // Счетчик изменений каталога и номер изменения, на котором каждая запись
+    // получила текущие элементы; по ним кэш эфемерид находит устаревшие данные
+    quint64 revision() const { return catalogRevision; }
+    const QVector<quint64>& modifiedRevisions() const { return catalogModified; }
+    // Хеш содержимого, не зависящий от порядка записей и от запуска;
+    // обновляется за O(1) на изменение, а не пересчетом всего каталога
+    quint64 contentKey() const { return catalogKey; }
+
+private:
+    // Записывает элементы без пропагации; индекс записи
+    int store(const OrbitalElements& elements, bool& added);
+
+    QVector<OrbitalElements> catalogElements;
+    QVector<int> catalogIds;
+    QVector<QVector3D> catalogPositions;
+    QVector<quint64> catalogModified;
+    QHash<int, int> indexById;
+    double lastUnixTime = 0.0;
+    quint64 catalogRevision = 0;
+    quint64 catalogKey = 0;     // XOR хешей записей
+};
+
+#endif // SATELLITE_CATALOG_H
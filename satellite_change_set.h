@@ -0,0 +1,35 @@
+// satellite_change_set.h
+#ifndef SATELLITE_CHANGE_SET_H
+#define SATELLITE_CHANGE_SET_H
+
+#include <QVector>
+#include <QVector3D>
+#include "satellite_orbit.h"
+
+// Изменения спутников, накопленные за кадр. Рендерер применяет их к своим
+// буферам по месту, не перестраивая набор целиком.
+struct SatelliteChangeSet {
+    struct Update {
+        int id;
+        QVector3D position;
+        quint8 flags; // SatelliteStore::Flag
+    };
+
+    struct OrbitUpdate {
+        int id;
+        SatelliteOrbit orbit;
+    };
+
+    QVector<int> removed;      // применяются первыми
+    QVector<Update> updated;   // добавленные и измененные; при повторе id действует последнее
+    QVector<OrbitUpdate> orbits; // применяются после updated
+
+    bool isEmpty() const { return updated.isEmpty() && removed.isEmpty() && orbits.isEmpty(); }
+    void clear() {
+        updated.clear();
+        removed.clear();
+        orbits.clear();
+    }
+};
+
+#endif // SATELLITE_CHANGE_SET_H
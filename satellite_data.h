@@ -0,0 +1,70 @@
+// satellite_data.h
+#ifndef SATELLITE_DATA_H
+#define SATELLITE_DATA_H
+
+#include <QVector>
+#include <QVector3D>
+#include <QtMath>
+#include <cmath>
+
+// Демонстрационный спутник на круговой экваториальной орбите
+struct SatelliteData {
+    float initialAngle; // угол в момент эпохи часов
+    float speed;
+    int id;
+    float angle;
+    QVector3D position;
+
+    // Положение вычисляется от абсолютного времени симуляции,
+    // поэтому не зависит от частоты кадров и корректно работает при перемотке
+    void propagate(double simulationTime, float orbitRadius) {
+        angle = std::fmod(initialAngle + speed * simulationTime, 360.0);
+        if (angle < 0.0f) {
+            angle += 360.0f;
+        }
+
+        float radians = qDegreesToRadians(angle);
+        position = QVector3D(
+            orbitRadius * cos(radians),
+            0.0f,
+            orbitRadius * sin(radians)
+            );
+    }
+
+    // Функция расчета траекторий для дуги в 30 градусов
+    void calculateTrajectories(float orbitRadius, QVector<QVector3D>& trajectory, QVector<QVector3D>& futureTrajectory) {
+        trajectory.clear();
+
+        // Расчет траектории: 30 градусов назад и вперед от текущей позиции
+        const int arcPoints = 30; // количество точек для дуги в 30 градусов
+        const float arcRange = 30.0f; // диапазон в градусах
+
+        // Рассчитываем точки для текущей дуги траектории
+        for (int i = -arcPoints; i <= arcPoints; ++i) {
+            float arcAngle = qDegreesToRadians(angle + (i * arcRange / arcPoints));
+            trajectory.append(QVector3D(
+                orbitRadius * cos(arcAngle),
+                0.0f,
+                orbitRadius * sin(arcAngle)
+                ));
+        }
+
+        // Расчет будущей траектории (следующие 30 градусов)
+        futureTrajectory.clear();
+        const int futurePoints = 30;
+        const float predictionTime = 5.0f; // время прогноза в секундах
+        float timeStep = predictionTime / futurePoints;
+
+        for (int i = 0; i <= futurePoints; ++i) {
+            float futureTime = timeStep * i;
+            float futureAngle = qDegreesToRadians(angle + speed * futureTime);
+            futureTrajectory.append(QVector3D(
+                orbitRadius * cos(futureAngle),
+                0.0f,
+                orbitRadius * sin(futureAngle)
+                ));
+        }
+    }
+};
+
+#endif // SATELLITE_DATA_H
@@ -1,9 +1,8 @@
 #ifndef SATELLITE_INFO_RENDERER_H
 #define SATELLITE_INFO_RENDERER_H
 
-#include <QPainter>
 #include <QMatrix4x4>
-#include "satellite.h"
+#include "text_renderer.h"
 
 class SatelliteInfoRenderer
 {
@@ -11,12 +10,23 @@ public:
     SatelliteInfoRenderer();
     ~SatelliteInfoRenderer();
 
-    void render(QPainter* painter, const QMatrix4x4& projection, const QMatrix4x4& view,
-                const QMatrix4x4& model, const Satellite& satellite, const QSize& viewportSize);
+    // Добавляет плашку с информацией в пакет текста; проекция выполняется на GPU
+    void render(TextRenderer& text, int id, const QVector3D& position, const QString& info);
+    // Прямоугольник плашки относительно проекции спутника, в пикселях
+    QRectF boxRect(const TextRenderer& text, int id, const QString& info);
 
 private:
-    QPoint worldToScreen(const QVector3D& worldPos, const QMatrix4x4& mvp, const QSize& viewportSize);
-    void drawInfoBox(QPainter* painter, const QPoint& pos, const QString& info);
+    void updateCache(const TextRenderer& text, int id, const QString& info);
+
+    static constexpr float FONT_SIZE = 13.0f; // px, как прежний Arial 10pt
+    static constexpr float PADDING = 4.0f;
+    static constexpr float OFFSET_X = 5.0f;   // отступ вправо от точки спутника
+
+    // Текст плашки меняется только вместе со спутником
+    int cachedId;
+    QString cachedSource;
+    QString cachedInfo;
+    QSizeF cachedSize;
 };
 
 #endif
@@ -0,0 +1,71 @@
+// satellite_orbit.h
+#ifndef SATELLITE_ORBIT_H
+#define SATELLITE_ORBIT_H
+
+#include <QVector3D>
+#include <QVector4D>
+#include <cmath>
+#include "orbital_elements.h"
+
+// Кеплерова орбита в виде для пропагации на GPU: положение на момент t —
+// (cos E - e)·axisP + sin E·axisQ, где E решает уравнение Кеплера для
+// M = meanAnomaly + meanMotion·(t - epoch). Оси уже повернуты в систему сцены.
+struct SatelliteOrbit {
+    double epoch = 0.0;        // секунды Unix
+    double meanAnomaly = 0.0;  // на эпоху, рад
+    double meanMotion = 0.0;   // рад/с; 0 — орбиты нет
+    float eccentricity = 0.0f;
+    QVector3D axisP;           // a·P, м
+    QVector3D axisQ;           // b·Q, м
+
+    bool isValid() const { return meanMotion > 0.0; }
+    double period() const { return isValid() ? 2.0 * M_PI / meanMotion : 0.0; }
+
+    bool operator==(const SatelliteOrbit& other) const {
+        return epoch == other.epoch && meanAnomaly == other.meanAnomaly && meanMotion == other.meanMotion &&
+               eccentricity == other.eccentricity && axisP == other.axisP && axisQ == other.axisQ;
+    }
+
+    static SatelliteOrbit fromElements(const OrbitalElements& elements) {
+        const double e = elements.eccentricity;
+        const double a = elements.semiMajorAxis();
+        const double b = a * std::sqrt(1.0 - e * e);
+
+        const double cosW = std::cos(elements.argPerigee), sinW = std::sin(elements.argPerigee);
+        const double cosO = std::cos(elements.raan), sinO = std::sin(elements.raan);
+        const double cosI = std::cos(elements.inclination), sinI = std::sin(elements.inclination);
+
+        // Перифокальные оси в ECI, затем ECI -> сцена: (x, z, -y)
+        const double px = cosO * cosW - sinO * sinW * cosI;
+        const double py = sinO * cosW + cosO * sinW * cosI;
+        const double pz = sinW * sinI;
+        const double qx = -cosO * sinW - sinO * cosW * cosI;
+        const double qy = -sinO * sinW + cosO * cosW * cosI;
+        const double qz = cosW * sinI;
+
+        SatelliteOrbit orbit;
+        orbit.epoch = elements.epoch;
+        orbit.meanAnomaly = elements.meanAnomaly;
+        orbit.meanMotion = elements.meanMotion;
+        orbit.eccentricity = float(e);
+        orbit.axisP = QVector3D(float(a * px), float(a * pz), float(-a * py));
+        orbit.axisQ = QVector3D(float(b * qx), float(b * qz), float(-b * qy));
+        return orbit;
+    }
+};
+
+// Дуга орбиты, которую вершинный шейдер траекторий строит по gl_VertexID:
+// на GPU уходит только запись в 64 Б, независимо от числа точек линии
+struct OrbitLine {
+    SatelliteOrbit orbit;
+    float windowStart = 0.0f;  // начало дуги относительно текущего момента, с
+    float windowLength = 0.0f; // с
+    QVector4D color;
+
+    bool operator==(const OrbitLine& other) const {
+        return orbit == other.orbit && windowStart == other.windowStart &&
+               windowLength == other.windowLength && color == other.color;
+    }
+};
+
+#endif // SATELLITE_ORBIT_H
@@ -0,0 +1,29 @@
+// satellite_picking.cpp
+#include "satellite_picking.h"
+#include <limits>
+
+int pickClosestSatellite(const SatelliteStore& satellites, const QMatrix4x4& model,
+                         const QVector3D& rayOrigin, const QVector3D& rayDirection, float pickRadius)
+{
+    float minDistance = std::numeric_limits<float>::max();
+    int closestSatelliteId = -1;
+
+    // Проход только по плотному массиву положений
+    const QVector<QVector3D>& positions = satellites.positions();
+    for (int slot = 0; slot < positions.size(); ++slot) {
+        QVector3D satPos = model * positions[slot];
+        QVector3D toSatellite = satPos - rayOrigin;
+        float projection = QVector3D::dotProduct(toSatellite, rayDirection);
+
+        if (projection < 0) continue;
+
+        QVector3D projectionPoint = rayOrigin + rayDirection * projection;
+        float distance = (satPos - projectionPoint).length();
+
+        if (distance < pickRadius && projection < minDistance) {
+            minDistance = projection;
+            closestSatelliteId = satellites.id(slot);
+        }
+    }
+    return closestSatelliteId;
+}
@@ -0,0 +1,14 @@
+// satellite_picking.h
+#ifndef SATELLITE_PICKING_H
+#define SATELLITE_PICKING_H
+
+#include <QMatrix4x4>
+#include <QVector3D>
+#include "satellite_store.h"
+
+// Ближайший к камере спутник, прошедший на расстоянии не больше pickRadius
+// от луча. rayDirection нормализован. Возвращает -1, если попаданий нет.
+int pickClosestSatellite(const SatelliteStore& satellites, const QMatrix4x4& model,
+                         const QVector3D& rayOrigin, const QVector3D& rayDirection, float pickRadius);
+
+#endif // SATELLITE_PICKING_H
@@ -1,10 +1,25 @@
 #include "satellite_renderer.h"
+#include "eclipse_model.h"
+#include "solar_ephemeris.h"
 #include <QtMath>
+#include <algorithm>
+#include <cmath>
 
 SatelliteRenderer::SatelliteRenderer()
     : Renderer()
     , indexBuffer(QOpenGLBuffer::IndexBuffer)
+    , instanceBuffer(QOpenGLBuffer::VertexBuffer)
+    , illuminationBuffer(QOpenGLBuffer::VertexBuffer)
+    , instanceCapacity(0)
+    , dirtyBegin(0)
+    , dirtyEnd(0)
     , vertexCount(0)
+    , drawMode(SatelliteDrawMode::Auto)
+    , lastVertexCount(0)
+    , gpuPropagation(false)
+    , propagatorInitialized(false)
+    , unixTime(0.0)
+    , referenceTime(0.0)
 {
     time = 0.0f;
 }
@@ -13,12 +28,20 @@ SatelliteRenderer::~SatelliteRenderer()
 {
     if (indexBuffer.isCreated())
         indexBuffer.destroy();
+    if (impostorVao.isCreated())
+        impostorVao.destroy();
+    if (instanceBuffer.isCreated())
+        instanceBuffer.destroy();
+    if (illuminationBuffer.isCreated())
+        illuminationBuffer.destroy();
 }
 
 void SatelliteRenderer::initialize()
 {
     initShaders();
     initGeometry();
+    if (!trails.initialize())
+        qWarning() << "Satellite trails are unavailable";
 }
 
 void SatelliteRenderer::initShaders()
@@ -31,6 +54,15 @@ void SatelliteRenderer::initShaders()
 
     if (!program.link())
         qDebug() << "Failed to link satellite shader program";
+
+    if (!impostorProgram.addShaderFromSourceFile(QOpenGLShader::Vertex, ":/shaders/sat_impostor_vertex.glsl"))
+        qDebug() << "Failed to compile satellite impostor vertex shader";
+
+    if (!impostorProgram.addShaderFromSourceFile(QOpenGLShader::Fragment, ":/shaders/sat_impostor_fragment.glsl"))
+        qDebug() << "Failed to compile satellite impostor fragment shader";
+
+    if (!impostorProgram.link())
+        qDebug() << "Failed to link satellite impostor shader program";
 }
 
 void SatelliteRenderer::initGeometry()
@@ -43,7 +75,36 @@ void SatelliteRenderer::initGeometry()
 
     createSphere(RINGS, SEGMENTS);
 
+    // Буфер экземпляров выделяется при первой загрузке
+    instanceBuffer.create();
+    instanceBuffer.setUsagePattern(QOpenGLBuffer::DynamicDraw);
+    instanceBuffer.bind();
+    glEnableVertexAttribArray(2); // instance
+    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(QVector4D), nullptr);
+    glVertexAttribDivisor(2, 1);
+
+    illuminationBuffer.create();
+    illuminationBuffer.setUsagePattern(QOpenGLBuffer::DynamicDraw);
+    illuminationBuffer.bind();
+    glEnableVertexAttribArray(3); // illumination
+    glVertexAttribPointer(3, 1, GL_FLOAT, GL_FALSE, sizeof(float), nullptr);
+    glVertexAttribDivisor(3, 1);
+
     vao.release();
+
+    // Для точек те же буферы читаются по вершине на спутник
+    impostorVao.create();
+    impostorVao.bind();
+    instanceBuffer.bind();
+    glEnableVertexAttribArray(0); // instance
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(QVector4D), nullptr);
+    illuminationBuffer.bind();
+    glEnableVertexAttribArray(1); // illumination
+    glVertexAttribPointer(1, 1, GL_FLOAT, GL_FALSE, sizeof(float), nullptr);
+    impostorVao.release();
+    // Набор мог прийти до инициализации
+    dirtyBegin = 0;
+    dirtyEnd = instances.size();
 }
 
 void SatelliteRenderer::createSphere(int rings, int segments)
@@ -99,51 +160,230 @@ void SatelliteRenderer::createSphere(int rings, int segments)
                           reinterpret_cast<void*>(3 * sizeof(GLfloat)));
 }
 
-void SatelliteRenderer::updateSatellites(const QMap<int, Satellite>& newSatellites)
+void SatelliteRenderer::updateSatellites(const SatelliteStore& satellites)
+{
+    // Слоты совпадают со слотами хранилища
+    const int count = satellites.size();
+    slotIds = satellites.ids();
+    slotById.clear();
+    slotById.reserve(count);
+    instances.resize(count);
+    orbits = satellites.orbits();
+    orbits.resize(count);
+    for (int slot = 0; slot < count; ++slot) {
+        slotById.insert(slotIds[slot], slot);
+        instances[slot] = QVector4D(satellites.position(slot), float(satellites.flags()[slot]));
+    }
+    trails.resetAll();
+
+    dirtyBegin = 0;
+    dirtyEnd = instances.size();
+}
+
+void SatelliteRenderer::applyChanges(const SatelliteChangeSet& changes)
+{
+    // Удаление: последний слот переезжает на место удаленного
+    for (int id : changes.removed) {
+        auto it = slotById.find(id);
+        if (it == slotById.end())
+            continue;
+        const int slot = *it;
+        const int last = instances.size() - 1;
+        slotById.erase(it);
+        if (slot != last) {
+            instances[slot] = instances[last];
+            orbits[slot] = orbits[last];
+            slotIds[slot] = slotIds[last];
+            slotById[slotIds[slot]] = slot;
+            markDirty(slot);
+            trails.resetSlot(slot);
+        }
+        instances.removeLast();
+        orbits.removeLast();
+        slotIds.removeLast();
+    }
+
+    for (const SatelliteChangeSet::Update& update : changes.updated) {
+        const QVector4D instance(update.position, float(update.flags));
+        auto it = slotById.constFind(update.id);
+        if (it != slotById.constEnd()) {
+            // Положение спутника с орбитой на GPU не используется — грузим только смену флагов
+            const bool flagsChanged = instances[*it].w() != instance.w();
+            instances[*it] = instance;
+            if (flagsChanged || !propagatesOnGpu() || !orbits[*it].isValid())
+                markDirty(*it);
+        } else {
+            slotById.insert(update.id, instances.size());
+            slotIds.append(update.id);
+            instances.append(instance);
+            orbits.append(SatelliteOrbit());
+            markDirty(instances.size() - 1);
+            trails.resetSlot(instances.size() - 1);
+        }
+    }
+
+    for (const SatelliteChangeSet::OrbitUpdate& update : changes.orbits) {
+        const int slot = slotById.value(update.id, -1);
+        if (slot == -1)
+            continue;
+        orbits[slot] = update.orbit;
+        markDirty(slot);
+    }
+}
+
+void SatelliteRenderer::setGpuPropagation(bool enabled)
+{
+    if (gpuPropagation == enabled)
+        return;
+    gpuPropagation = enabled;
+    // Буфер экземпляров заполняется заново из другого источника
+    dirtyBegin = 0;
+    dirtyEnd = instances.size();
+}
+
+void SatelliteRenderer::setTrails(int length, int sampleSteps)
 {
-    satellites = newSatellites;
+    trails.setLength(length);
+    trails.setSampleSteps(sampleSteps);
+}
+
+void SatelliteRenderer::markDirty(int slot)
+{
+    if (slot < 0)
+        return;
+    if (dirtyBegin >= dirtyEnd) {
+        dirtyBegin = slot;
+        dirtyEnd = slot + 1;
+    } else {
+        dirtyBegin = std::min(dirtyBegin, slot);
+        dirtyEnd = std::max(dirtyEnd, slot + 1);
+    }
+}
+
+void SatelliteRenderer::uploadInstances()
+{
+    dirtyEnd = std::min(dirtyEnd, int(instances.size()));
+    if (dirtyBegin >= dirtyEnd)
+        return;
+
+    const bool gpu = propagatesOnGpu();
+    instanceBuffer.bind();
+    if (instances.size() > instanceCapacity) {
+        // Рост с запасом, чтобы поток добавлений не перевыделял буфер каждый кадр
+        instanceCapacity = std::max({int(instances.size()), instanceCapacity * 2, MIN_INSTANCE_CAPACITY});
+        instanceBuffer.allocate(instanceCapacity * int(sizeof(QVector4D)));
+        instanceBuffer.write(0, instances.constData(), instances.size() * int(sizeof(QVector4D)));
+        illuminationBuffer.bind();
+        illuminationBuffer.allocate(instanceCapacity * int(sizeof(float)));
+    } else if (!gpu) {
+        instanceBuffer.write(dirtyBegin * int(sizeof(QVector4D)), instances.constData() + dirtyBegin,
+                             (dirtyEnd - dirtyBegin) * int(sizeof(QVector4D)));
+    }
+
+    if (gpu) {
+        // Буфер записей растет вместе с буфером экземпляров
+        if (propagator.reserve(instanceCapacity))
+            writeRecords(0, instances.size());
+        else
+            writeRecords(dirtyBegin, dirtyEnd);
+    }
+    dirtyBegin = dirtyEnd = 0;
+}
+
+void SatelliteRenderer::writeRecords(int begin, int end)
+{
+    QVector<GpuPropagator::Record> records(end - begin);
+    for (int slot = begin; slot < end; ++slot)
+        records[slot - begin] = GpuPropagator::makeRecord(orbits[slot], instances[slot], referenceTime);
+    propagator.writeRecords(begin, records.constData(), records.size());
+}
+
+void SatelliteRenderer::update(float deltaTime)
+{
+    time += deltaTime;
+    if (deltaTime != 0.0f)
+        trails.step();
 }
 
 void SatelliteRenderer::render(const QMatrix4x4& projection, const QMatrix4x4& view, const QMatrix4x4& model)
 {
-    program.bind();
-    vao.bind();
+    lastVertexCount = 0;
+    if (instances.isEmpty())
+        return;
+
+    if (gpuPropagation && !propagatorInitialized) {
+        propagatorInitialized = true;
+        if (!propagator.initialize())
+            qWarning() << "GPU propagation is unavailable, satellites keep CPU positions";
+    }
+    const bool gpu = propagatesOnGpu();
+    if (gpu && std::abs(unixTime - referenceTime) > GpuPropagator::REBASE_INTERVAL) {
+        // Новый опорный момент: аномалии всех записей пересчитываются в double
+        referenceTime = unixTime;
+        dirtyBegin = 0;
+        dirtyEnd = instances.size();
+    }
+    uploadInstances();
+
+    // Освещенность всех экземпляров на текущий момент
+    const QVector3D sun = SolarEphemeris::position(unixTime);
+    if (gpu) {
+        propagator.propagate(instanceBuffer.bufferId(), illuminationBuffer.bufferId(), instances.size(),
+                             float(unixTime - referenceTime), sun);
+    } else {
+        illumination.resize(instances.size());
+        EclipseModel::illuminate(instances.constData(), instances.size(), sun, illumination.data());
+        illuminationBuffer.bind();
+        illuminationBuffer.write(0, illumination.constData(), illumination.size() * int(sizeof(float)));
+    }
+
+    // Следы под спутниками: выборка из готового буфера экземпляров и один вызов на все
+    trails.append(instanceBuffer.bufferId(), instances.size(), instanceCapacity);
+    trails.render(projection * view, model, instances.size());
+
+    // Масштаб растет с расстоянием до камеры, поэтому радиус на экране у всех
+    // спутников одинаков и зависит только от проекции и высоты вьюпорта
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    const float pixelScale = projection(1, 1) * float(viewport[3]) * 0.5f;
+    const bool impostors = drawMode == SatelliteDrawMode::Impostor ||
+                           (drawMode == SatelliteDrawMode::Auto && SCREEN_SCALE * pixelScale < IMPOSTOR_MAX_RADIUS);
+
+    QOpenGLShaderProgram& active = impostors ? impostorProgram : program;
+    if (!active.bind())
+        return;
 
     // Включаем прозрачность и сглаживание
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
     glEnable(GL_MULTISAMPLE);
 
-    for (const auto& satellite : satellites) {
-        QMatrix4x4 satMatrix = model;
-        satMatrix.translate(satellite.position);
-
-        // Вычисляем расстояние до камеры для масштабирования
-        QVector3D satelliteWorldPos = model * satellite.position;
-        QVector3D cameraPos = view.inverted().column(3).toVector3D();
-        QVector3D toCameraVector = cameraPos - satelliteWorldPos;
-        float distanceToCamera = toCameraVector.length();
-
-        // Масштабируем размер спутника пропорционально расстоянию
-        float scale = distanceToCamera * 0.005f;
-        satMatrix.scale(scale);
-
-        // Устанавливаем униформы
-        program.setUniformValue("mvp", projection * view * satMatrix);
-        program.setUniformValue("model", satMatrix);
-        program.setUniformValue("normalMatrix", satMatrix.normalMatrix());
-        program.setUniformValue("viewPos", cameraPos);
-        program.setUniformValue("isSelected", satellite.isSelected);
-        time += 0.016f; // Примерно 60 FPS
-        program.setUniformValue("time", time);
-
-        // Рендерим спутник
-        glDrawElements(GL_TRIANGLES, vertexCount, GL_UNSIGNED_INT, nullptr);
+    // Размер каждого спутника масштабируется по расстоянию до камеры в шейдере
+    active.setUniformValue("viewProjection", projection * view);
+    active.setUniformValue("model", model);
+    active.setUniformValue("cameraPosition", view.inverted().column(3).toVector3D());
+    active.setUniformValue("screenScale", SCREEN_SCALE);
+    active.setUniformValue("sunDirection", model.mapVector(sun).normalized());
+
+    if (impostors) {
+        active.setUniformValue("pixelScale", pixelScale);
+        active.setUniformValue("viewToWorld", view.inverted().normalMatrix());
+        impostorVao.bind();
+        glEnable(GL_PROGRAM_POINT_SIZE);
+        glDrawArrays(GL_POINTS, 0, instances.size());
+        glDisable(GL_PROGRAM_POINT_SIZE);
+        impostorVao.release();
+        lastVertexCount = instances.size();
+    } else {
+        active.setUniformValue("time", time);
+        vao.bind();
+        glDrawElementsInstanced(GL_TRIANGLES, vertexCount, GL_UNSIGNED_INT, nullptr, instances.size());
+        vao.release();
+        lastVertexCount = qint64(vertexCount) * instances.size();
     }
 
     // Восстанавливаем состояние OpenGL
     glDisable(GL_BLEND);
 
-    vao.release();
-    program.release();
+    active.release();
 }
@@ -2,9 +2,33 @@
 #define SATELLITE_RENDERER_H
 
 #include "renderer.h"
-#include "satellite.h"
-#include <QMap>
+#include "gpu_propagator.h"
+#include "satellite_trails.h"
+#include "satellite_change_set.h"
+#include "satellite_store.h"
+#include "scene_options.h"
+#include <QHash>
 
+// Все спутники рисуются одним instanced-вызовом. Экземпляры лежат плотным
+// массивом с отображением id -> слот; изменения за кадр обновляют только
+// затронутый диапазон буфера.
+//
+// Спутник на экране всегда одного размера (несколько пикселей), и сфера из
+// 512 треугольников в нем неразличима. Пока радиус меньше IMPOSTOR_MAX_RADIUS,
+// каждый спутник рисуется одной точкой GL_POINTS, а сферу затеняет фрагментный
+// шейдер; меш остается для крупных экранов.
+//
+// С пропагацией на GPU положения спутников с орбитой каждый кадр пишет в буфер
+// экземпляров GpuPropagator; положения от CPU для них не загружаются, и
+// буфер обновляется только при изменении набора, орбит или выбора.
+//
+// Освещенность Солнцем (EclipseModel) лежит в отдельном буфере float на слот
+// и читается шейдерами как атрибут экземпляра: каждый кадр ее считает CPU
+// по положениям экземпляров или, при пропагации на GPU, тот же проход
+// transform feedback.
+//
+// Следы за спутниками (SatelliteTrails) копируют столбцы истории из того же
+// буфера экземпляров; слоты следов совпадают со слотами экземпляров.
 class SatelliteRenderer : public Renderer
 {
 public:
@@ -13,20 +37,61 @@ public:
 
     void initialize() override;
     void render(const QMatrix4x4& projection, const QMatrix4x4& view, const QMatrix4x4& model) override;
-    void updateSatellites(const QMap<int, Satellite>& satellites);
+    void update(float deltaTime) override;
+    // Полная замена набора
+    void updateSatellites(const SatelliteStore& satellites);
+    void applyChanges(const SatelliteChangeSet& changes);
+
+    int satelliteCount() const { return instances.size(); }
+    // Буфер экземпляров после отрисовки кадра: положения на текущий момент
+    GLuint instanceBufferId() const { return instanceBuffer.bufferId(); }
+
+    void setDrawMode(SatelliteDrawMode mode) { drawMode = mode; }
+    void setGpuPropagation(bool enabled);
+    // Выборок в следе (0 — без следов) и шагов симуляции между выборками
+    void setTrails(int length, int sampleSteps);
+    // Момент, на который пропагируются орбиты (секунды Unix)
+    void setUnixTime(double time) { unixTime = time; }
+    qint64 verticesPerFrame() const { return lastVertexCount; }
 
 private:
     void initShaders();
     void initGeometry();
     void createSphere(int rings, int segments);
+    void markDirty(int slot);
+    void uploadInstances();
+    bool propagatesOnGpu() const { return gpuPropagation && propagator.isValid(); }
+    void writeRecords(int begin, int end);
 
+    QOpenGLShaderProgram impostorProgram;
+    QOpenGLVertexArrayObject impostorVao;  // буфер экземпляров как вершины точек
     QOpenGLBuffer indexBuffer;
-    QMap<int, Satellite> satellites;
+    QOpenGLBuffer instanceBuffer;
+    QOpenGLBuffer illuminationBuffer; // float на слот, та же емкость
+    QVector<QVector4D> instances;     // xyz — положение, w — флаги SatelliteStore::Flag
+    QVector<float> illumination;      // освещенность для пропагации на CPU
+    QVector<int> slotIds;             // id спутника в каждом слоте
+    QVector<SatelliteOrbit> orbits;   // по слотам; без орбиты — положение из instances
+    QHash<int, int> slotById;
+    int instanceCapacity;             // экземпляров в выделенном буфере
+    int dirtyBegin;                   // диапазон слотов для загрузки
+    int dirtyEnd;
     int vertexCount;
-    float time; // Добавьте эту переменную
+    SatelliteDrawMode drawMode;
+    qint64 lastVertexCount;
+    GpuPropagator propagator;
+    SatelliteTrails trails;
+    bool gpuPropagation;
+    bool propagatorInitialized;
+    double unixTime;
+    double referenceTime;             // опорный момент записей орбит
+    float time; // Время анимации, продвигается часами симуляции
 
     static constexpr int RINGS = 16;     // Меньше детализация для спутников
     static constexpr int SEGMENTS = 16;   // Меньше детализация для спутников
+    static constexpr float SCREEN_SCALE = 0.005f; // размер относительно расстояния до камеры
+    static constexpr int MIN_INSTANCE_CAPACITY = 256;
+    static constexpr float IMPOSTOR_MAX_RADIUS = 8.0f; // px, выше — меш
 };
 
 #endif // SATELLITE_RENDERER_H
@@ -0,0 +1,144 @@
+// satellite_store.cpp
+#include "satellite_store.h"
+
+int SatelliteStore::insert(int id, const QVector3D& position)
+{
+    auto it = slotById.constFind(id);
+    if (it != slotById.constEnd()) {
+        slotPositions[*it] = position;
+        return *it;
+    }
+
+    const int slot = slotIds.size();
+    slotById.insert(id, slot);
+    slotIds.append(id);
+    slotPositions.append(position);
+    slotFlags.append(0);
+    if (!slotOrbits.isEmpty())
+        slotOrbits.append(SatelliteOrbit());
+    return slot;
+}
+
+bool SatelliteStore::remove(int id)
+{
+    auto it = slotById.find(id);
+    if (it == slotById.end())
+        return false;
+
+    const int slot = *it;
+    const int last = slotIds.size() - 1;
+    slotById.erase(it);
+    if (slot != last) {
+        slotIds[slot] = slotIds[last];
+        slotPositions[slot] = slotPositions[last];
+        slotFlags[slot] = slotFlags[last];
+        if (!slotOrbits.isEmpty())
+            slotOrbits[slot] = slotOrbits[last];
+        slotById[slotIds[slot]] = slot;
+    }
+    slotIds.removeLast();
+    slotPositions.removeLast();
+    slotFlags.removeLast();
+    if (!slotOrbits.isEmpty())
+        slotOrbits.removeLast();
+    cold.remove(id);
+    return true;
+}
+
+void SatelliteStore::clear()
+{
+    slotIds.clear();
+    slotPositions.clear();
+    slotFlags.clear();
+    slotOrbits.clear();
+    slotById.clear();
+    cold.clear();
+}
+
+void SatelliteStore::reserve(int count)
+{
+    slotIds.reserve(count);
+    slotPositions.reserve(count);
+    slotFlags.reserve(count);
+    slotById.reserve(count);
+}
+
+void SatelliteStore::setSelected(int slot, bool selected)
+{
+    if (selected)
+        slotFlags[slot] |= Selected;
+    else
+        slotFlags[slot] &= quint8(~Selected);
+}
+
+void SatelliteStore::setConjunction(int slot, bool conjunction)
+{
+    if (conjunction)
+        slotFlags[slot] |= Conjunction;
+    else
+        slotFlags[slot] &= quint8(~Conjunction);
+}
+
+void SatelliteStore::setOrbit(int slot, const SatelliteOrbit& orbit)
+{
+    // Массив орбит появляется только при первой заданной орбите
+    if (slotOrbits.isEmpty())
+        slotOrbits.resize(slotIds.size());
+    slotOrbits[slot] = orbit;
+}
+
+void SatelliteStore::setInfo(int id, const QString& info)
+{
+    ColdRecord& record = cold[id];
+    record.info = info;
+    record.infoLoaded = true;
+}
+
+QString SatelliteStore::info(int id) const
+{
+    if (!slotById.contains(id))
+        return QString();
+
+    ColdRecord& record = cold[id];
+    if (!record.infoLoaded) {
+        if (infoLoader)
+            record.info = infoLoader(id);
+        record.infoLoaded = true;
+    }
+    return record.info;
+}
+
+void SatelliteStore::setTrajectories(int id, const QVector<QVector3D>& trajectory,
+                                     const QVector<QVector3D>& futureTrajectory)
+{
+    ColdRecord& record = cold[id];
+    record.trajectory = trajectory;
+    record.futureTrajectory = futureTrajectory;
+}
+
+const SatelliteStore::ColdRecord* SatelliteStore::coldRecord(int id) const
+{
+    auto it = cold.constFind(id);
+    return it != cold.constEnd() ? &*it : nullptr;
+}
+
+qsizetype SatelliteStore::hotBytes() const
+{
+    // Qt 6 QHash: корзин вдвое больше capacity(), байт смещения на корзину
+    // и узел ключ+значение на запись
+    const qsizetype hashBytes = slotById.capacity() * 2 + slotById.size() * qsizetype(sizeof(int) * 2);
+    return slotIds.capacity() * qsizetype(sizeof(int)) +
+           slotPositions.capacity() * qsizetype(sizeof(QVector3D)) +
+           slotFlags.capacity() * qsizetype(sizeof(quint8)) +
+           slotOrbits.capacity() * qsizetype(sizeof(SatelliteOrbit)) + hashBytes;
+}
+
+qsizetype SatelliteStore::coldBytes() const
+{
+    qsizetype bytes = cold.capacity() * 2 + cold.size() * qsizetype(sizeof(int) + sizeof(ColdRecord));
+    for (const ColdRecord& record : cold) {
+        bytes += record.info.capacity() * qsizetype(sizeof(QChar));
+        bytes += (record.trajectory.capacity() + record.futureTrajectory.capacity()) * qsizetype(sizeof(QVector3D));
+    }
+    return bytes;
+}
@@ -0,0 +1,99 @@
+// satellite_store.h
+#ifndef SATELLITE_STORE_H
+#define SATELLITE_STORE_H
+
+#include <QHash>
+#include <QString>
+#include <QVector>
+#include <QVector3D>
+#include <functional>
+#include "satellite_orbit.h"
+
+// Спутники сцены с разделением на горячие и холодные данные.
+//
+// Горячие данные — то, что читается каждый кадр (рендеринг, выбор, подписи):
+// id, положение и флаги в плотных массивах по слотам плюс хеш id -> слот.
+// Удаление переносит последний слот на место удаленного, поэтому слот
+// спутника может меняться; постоянный ключ — id.
+//
+// Холодные данные — описание для плашки и траектории — нужны единицам
+// спутников и лежат в отдельной таблице по id. Описание подгружается
+// при первом обращении через InfoLoader (например, из каталога).
+//
+// Память на спутник (64 бит, Qt 6), горячая часть:
+//   id 4 Б + положение 12 Б + флаги 1 Б                        = 17 Б
+//   QHash<int, int>: узел 8 Б с запасом роста, 1 Б смещения
+//   на корзину при заполнении не выше 1/2                      ~ 16 Б
+//   итого около 35 Б (плюс 56 Б на орбиту, если включена пропагация
+//   на GPU); холодная запись появляется только у спутников
+//   с описанием или траекторией (~90 Б + строка).
+// Прежняя запись в QMap<int, Satellite> занимала больше 200 Б: узел
+// std::map в 160 Б (запись 104 Б с QString и двумя QVector) плюс строка
+// описания в куче. Замер на 100k объектов — BM_SatelliteMemory в earth3d_microbench.
+class SatelliteStore {
+public:
+    enum Flag : quint8 {
+        Selected = 1 << 0,
+        Conjunction = 1 << 1 // участвует в найденном сближении
+    };
+
+    struct ColdRecord {
+        QString info;
+        bool infoLoaded = false;
+        QVector<QVector3D> trajectory;       // текущая траектория
+        QVector<QVector3D> futureTrajectory; // будущая траектория
+    };
+
+    using InfoLoader = std::function<QString(int id)>;
+
+    // Слот спутника; для существующего id только обновляется положение
+    int insert(int id, const QVector3D& position);
+    bool remove(int id);
+    void clear();
+    void reserve(int count);
+
+    int size() const { return slotIds.size(); }
+    bool isEmpty() const { return slotIds.isEmpty(); }
+    int slotOf(int id) const { return slotById.value(id, -1); }
+    bool contains(int id) const { return slotById.contains(id); }
+
+    // Горячие массивы, индексируются слотом
+    const QVector<int>& ids() const { return slotIds; }
+    const QVector<QVector3D>& positions() const { return slotPositions; }
+    const QVector<quint8>& flags() const { return slotFlags; }
+    // Орбиты для пропагации на GPU; пусто, пока ни одна не задана
+    const QVector<SatelliteOrbit>& orbits() const { return slotOrbits; }
+
+    int id(int slot) const { return slotIds[slot]; }
+    const QVector3D& position(int slot) const { return slotPositions[slot]; }
+    void setPosition(int slot, const QVector3D& position) { slotPositions[slot] = position; }
+    bool isSelected(int slot) const { return slotFlags[slot] & Selected; }
+    void setSelected(int slot, bool selected);
+    bool hasConjunction(int slot) const { return slotFlags[slot] & Conjunction; }
+    void setConjunction(int slot, bool conjunction);
+    void setOrbit(int slot, const SatelliteOrbit& orbit);
+
+    // Холодная таблица
+    void setInfoLoader(InfoLoader loader) { infoLoader = std::move(loader); }
+    void setInfo(int id, const QString& info);
+    QString info(int id) const;
+    void setTrajectories(int id, const QVector<QVector3D>& trajectory,
+                         const QVector<QVector3D>& futureTrajectory);
+    const ColdRecord* coldRecord(int id) const;
+
+    // Оценка занятой памяти по емкости массивов и числу записей
+    qsizetype hotBytes() const;
+    qsizetype coldBytes() const;
+
+private:
+    QVector<int> slotIds;
+    QVector<QVector3D> slotPositions;
+    QVector<quint8> slotFlags;
+    QVector<SatelliteOrbit> slotOrbits; // размер 0 или size()
+    QHash<int, int> slotById;
+
+    mutable QHash<int, ColdRecord> cold; // заполняется лениво в info()
+    InfoLoader infoLoader;
+};
+
+#endif // SATELLITE_STORE_H
@@ -0,0 +1,197 @@
+// satellite_trails.cpp
+#include "satellite_trails.h"
+#include <QDebug>
+#include <QVector4D>
+
+SatelliteTrails::SatelliteTrails()
+    : historyBuffer(0)
+    , historyTexture(0)
+    , bornBuffer(0)
+    , bornTexture(0)
+    , bornDirtyBegin(0)
+    , bornDirtyEnd(0)
+    , slotCapacity(0)
+    , length(0)
+    , sampleSteps(1)
+    , stepsSinceSample(0)
+    , sampleCount(0)
+    , valid(false)
+{
+}
+
+SatelliteTrails::~SatelliteTrails()
+{
+    if (!valid)
+        return;
+
+    glDeleteTextures(1, &historyTexture);
+    glDeleteTextures(1, &bornTexture);
+    glDeleteBuffers(1, &historyBuffer);
+    glDeleteBuffers(1, &bornBuffer);
+    vao.destroy();
+}
+
+bool SatelliteTrails::initialize()
+{
+    initializeOpenGLFunctions();
+
+    if (!program.addShaderFromSourceFile(QOpenGLShader::Vertex, ":/shaders/trail_vertex.glsl") ||
+        !program.addShaderFromSourceFile(QOpenGLShader::Fragment, ":/shaders/trail_fragment.glsl") ||
+        !program.link()) {
+        qDebug() << "Failed to build trail shaders";
+        return false;
+    }
+
+    // Буферные текстуры ссылаются на буферы; хранилище выделяется в allocate,
+    // имена становятся объектами при первой привязке
+    glGenBuffers(1, &historyBuffer);
+    glGenBuffers(1, &bornBuffer);
+    glGenTextures(1, &historyTexture);
+    glGenTextures(1, &bornTexture);
+    glBindBuffer(GL_TEXTURE_BUFFER, historyBuffer);
+    glBindBuffer(GL_TEXTURE_BUFFER, bornBuffer);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    glBindTexture(GL_TEXTURE_BUFFER, historyTexture);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, historyBuffer);
+    glBindTexture(GL_TEXTURE_BUFFER, bornTexture);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_R32I, bornBuffer);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+
+    vao.create();
+    valid = true;
+    return true;
+}
+
+void SatelliteTrails::setLength(int samples)
+{
+    samples = std::max(samples, 0);
+    if (samples == length)
+        return;
+    length = samples;
+    // Кольцо другой длины выделяется при следующей выборке
+    slotCapacity = 0;
+}
+
+void SatelliteTrails::step()
+{
+    if (isEnabled())
+        ++stepsSinceSample;
+}
+
+void SatelliteTrails::resetSlot(int slot)
+{
+    // Слоты за пределами кольца получат отметку при его выделении
+    if (slot < 0 || slot >= born.size())
+        return;
+    born[slot] = sampleCount;
+    if (bornDirtyBegin >= bornDirtyEnd) {
+        bornDirtyBegin = slot;
+        bornDirtyEnd = slot + 1;
+    } else {
+        bornDirtyBegin = std::min(bornDirtyBegin, slot);
+        bornDirtyEnd = std::max(bornDirtyEnd, slot + 1);
+    }
+}
+
+void SatelliteTrails::resetAll()
+{
+    born.fill(sampleCount);
+    bornDirtyBegin = 0;
+    bornDirtyEnd = born.size();
+}
+
+void SatelliteTrails::allocate(int capacity)
+{
+    GLint maxTexels = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &maxTexels);
+    if (qint64(capacity) * length > maxTexels) {
+        length = std::max(int(maxTexels / capacity), 0);
+        qWarning() << "Trail history limited to" << length << "samples by GL_MAX_TEXTURE_BUFFER_SIZE";
+        if (length < 2)
+            return;
+    }
+
+    slotCapacity = capacity;
+    glBindBuffer(GL_TEXTURE_BUFFER, historyBuffer);
+    glBufferData(GL_TEXTURE_BUFFER, GLsizeiptr(capacity) * length * sizeof(QVector4D), nullptr, GL_DYNAMIC_COPY);
+    glBindBuffer(GL_TEXTURE_BUFFER, bornBuffer);
+    glBufferData(GL_TEXTURE_BUFFER, GLsizeiptr(capacity) * sizeof(qint32), nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+    // Прежняя история потеряна: следы начинаются со следующей выборки
+    born.resize(capacity);
+    resetAll();
+    stepsSinceSample = sampleSteps;
+}
+
+void SatelliteTrails::uploadBorn()
+{
+    if (bornDirtyBegin >= bornDirtyEnd)
+        return;
+    glBindBuffer(GL_TEXTURE_BUFFER, bornBuffer);
+    glBufferSubData(GL_TEXTURE_BUFFER, GLintptr(bornDirtyBegin) * sizeof(qint32),
+                    GLsizeiptr(bornDirtyEnd - bornDirtyBegin) * sizeof(qint32), born.constData() + bornDirtyBegin);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    bornDirtyBegin = bornDirtyEnd = 0;
+}
+
+void SatelliteTrails::append(GLuint instanceBuffer, int count, int capacity)
+{
+    if (!isEnabled() || count <= 0)
+        return;
+    if (capacity > slotCapacity) {
+        allocate(capacity);
+        if (!isEnabled())
+            return;
+    }
+    if (stepsSinceSample < sampleSteps)
+        return;
+    stepsSinceSample = 0;
+
+    // Новый столбец — копия буфера экземпляров на GPU: положения там уже
+    // на текущий момент, в том числе записанные пропагацией на GPU
+    const int column = sampleCount % length;
+    glBindBuffer(GL_COPY_READ_BUFFER, instanceBuffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, historyBuffer);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0,
+                        GLintptr(column) * slotCapacity * sizeof(QVector4D),
+                        GLsizeiptr(std::min(count, slotCapacity)) * sizeof(QVector4D));
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    ++sampleCount;
+}
+
+void SatelliteTrails::render(const QMatrix4x4& viewProjection, const QMatrix4x4& model, int count)
+{
+    count = std::min(count, slotCapacity);
+    if (!isEnabled() || count <= 0 || sampleCount == 0 || !program.bind())
+        return;
+    uploadBorn();
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_BUFFER, historyTexture);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_BUFFER, bornTexture);
+    program.setUniformValue("history", 0);
+    program.setUniformValue("born", 1);
+    program.setUniformValue("viewProjection", viewProjection);
+    program.setUniformValue("model", model);
+    program.setUniformValue("capacity", slotCapacity);
+    program.setUniformValue("historyLength", length);
+    program.setUniformValue("newest", sampleCount - 1);
+    program.setUniformValue("opacity", OPACITY);
+
+    // Прозрачные линии не пишут глубину, чтобы не закрывать друг друга
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glDepthMask(GL_FALSE);
+    vao.bind();
+    glDrawArraysInstanced(GL_LINE_STRIP, 0, length, count);
+    vao.release();
+    glDepthMask(GL_TRUE);
+
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+    program.release();
+}
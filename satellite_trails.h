@@ -0,0 +1,69 @@
+// satellite_trails.h
+#ifndef SATELLITE_TRAILS_H
+#define SATELLITE_TRAILS_H
+
+#include <QOpenGLExtraFunctions>
+#include <QOpenGLShaderProgram>
+#include <QOpenGLVertexArrayObject>
+#include <QMatrix4x4>
+#include <QVector>
+#include <algorithm>
+
+// Затухающие следы за всеми спутниками. История лежит в одном кольцевом
+// буфере на GPU: столбец — положения всех слотов на одну выборку, каждые
+// sampleSteps шагов симуляции новый столбец копируется из буфера
+// экземпляров SatelliteRenderer одним вызовом, без чтения на CPU. Все следы
+// рисуются одним instanced-вызовом, голова кольца передается uniform-ом,
+// поэтому память фиксирована, а ломаные на CPU не строятся.
+//
+// Номер первой выборки каждого слота хранится отдельно: когда слот получает
+// другой спутник, его прежняя история в следе не показывается.
+class SatelliteTrails : protected QOpenGLExtraFunctions
+{
+public:
+    SatelliteTrails();
+    ~SatelliteTrails();
+
+    // Требует активного OpenGL контекста
+    bool initialize();
+
+    // Выборок в следе; 0 выключает следы. Смена длины сбрасывает историю
+    void setLength(int samples);
+    void setSampleSteps(int steps) { sampleSteps = std::max(steps, 1); }
+    bool isEnabled() const { return valid && length > 1; }
+
+    // Шаг симуляции; выборка берется на ближайшем append после sampleSteps шагов
+    void step();
+    // Слот получил другой спутник
+    void resetSlot(int slot);
+    void resetAll();
+
+    // Копирует положения count слотов из instanceBuffer, если подошла выборка;
+    // capacity — емкость буфера экземпляров, по ней выделяется кольцо
+    void append(GLuint instanceBuffer, int count, int capacity);
+    void render(const QMatrix4x4& viewProjection, const QMatrix4x4& model, int count);
+
+private:
+    void allocate(int capacity);
+    void uploadBorn();
+
+    QOpenGLShaderProgram program;
+    QOpenGLVertexArrayObject vao;  // без атрибутов: данные из буферных текстур
+    GLuint historyBuffer;
+    GLuint historyTexture;
+    GLuint bornBuffer;
+    GLuint bornTexture;
+    QVector<qint32> born;          // по слотам, номер первой выборки
+    int bornDirtyBegin;
+    int bornDirtyEnd;
+    int slotCapacity;              // слотов в столбце выделенного кольца
+    int length;
+    int sampleSteps;
+    int stepsSinceSample;
+    qint32 sampleCount;            // выборок с начала истории; номер следующей
+    bool valid;
+
+    static constexpr float OPACITY = 0.6f;
+};
+
+#endif // SATELLITE_TRAILS_H
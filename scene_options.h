@@ -0,0 +1,42 @@
+// scene_options.h
+#ifndef SCENE_OPTIONS_H
+#define SCENE_OPTIONS_H
+
+#include <QString>
+#include <QVector>
+
+// Кадр облачности: изображение в равнопромежуточной проекции,
+// действующее с момента time (секунды времени симуляции)
+struct CloudFrame {
+    double time = 0.0;
+    QString path;
+
+    bool operator==(const CloudFrame& other) const {
+        return time == other.time && path == other.path;
+    }
+};
+
+// Отрисовка спутников: сфера-меш или точка-импостор с аналитически
+// затененной сферой; Auto выбирает импостор, пока спутник мельче порога на экране
+enum class SatelliteDrawMode {
+    Auto,
+    Mesh,
+    Impostor
+};
+
+// Настройки отрисовки сцены, передаваемые из виджета в SceneRenderer
+// (напрямую или через очередь команд потока рендеринга)
+struct SceneOptions {
+    bool atmosphereScattering = false; // физическое рассеяние вместо текстурной оболочки
+    QVector<CloudFrame> cloudFrames;   // пусто — статичная textures/earth_clouds.jpg
+    SatelliteDrawMode satelliteDrawMode = SatelliteDrawMode::Auto;
+    bool gpuPropagation = false;       // положения спутников с орбитой считает шейдер
+    bool proceduralOrbits = false;     // орбита выбранного спутника строится в шейдере траекторий
+    float coverageHalfAngle = 0.0f;    // полуугол сенсора, градусы; 0 — без тепловой карты покрытия
+    int trailLength = 0;               // выборок в следах спутников; 0 — без следов
+    int trailSampleSteps = 10;         // шагов симуляции между выборками следа
+    int gpuMemoryBudget = 0;           // МБ видеопамяти на текстуры слоев; 0 — без ограничения
+    bool tileStreaming = false;        // подгрузка тайлов цветовой карты Земли по камере
+};
+
+#endif // SCENE_OPTIONS_H
@@ -0,0 +1,137 @@
+// scene_renderer.cpp
+#include "scene_renderer.h"
+#include <QDebug>
+
+SceneRenderer::SceneRenderer(float earthRadius)
+    : earthRenderer(std::make_unique<EarthRenderer>(earthRadius))
+    , satelliteRenderer(std::make_unique<SatelliteRenderer>())
+    , trajectoryRenderer(std::make_unique<TrajectoryRenderer>())
+    , trajectoryVisible(false)
+    , coverageTime(0.0f)
+{
+    earthRenderer->setMemoryBudget(&memoryBudget);
+}
+
+SceneRenderer::~SceneRenderer() = default;
+
+bool SceneRenderer::initialize(const SceneOptions& options)
+{
+    initializeOpenGLFunctions();
+    // Лимит нужен до initialize слоев: атласы сразу создаются по бюджету
+    memoryBudget.setLimit(qint64(options.gpuMemoryBudget) * 1024 * 1024);
+
+    // Инициализируем базовые функции OpenGL для каждого рендерера
+    if (!earthRenderer->init() ||
+        !satelliteRenderer->init() ||
+        !trajectoryRenderer->init()) {
+        qDebug() << "Failed to initialize OpenGL functions for renderers";
+        return false;
+    }
+
+    // Теперь можно инициализировать рендереры
+    earthRenderer->initialize();
+    satelliteRenderer->initialize();
+    trajectoryRenderer->initialize();
+    gpuProfiler.initialize();
+    setOptions(options);
+
+    // Настройка параметров рендеринга
+    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+
+    // Включаем и настраиваем тест глубины
+    glEnable(GL_DEPTH_TEST);
+    glDepthFunc(GL_LESS);  // Добавлено: стандартная функция теста глубины
+    glDepthMask(GL_TRUE);  // Добавлено: разрешаем запись в буфер глубины
+
+    // Включаем отсечение задних граней
+    glEnable(GL_CULL_FACE);
+    glCullFace(GL_BACK);   // Добавлено: отсекаем задние грани
+    glFrontFace(GL_CCW);   // Добавлено: определяем порядок вершин для передней грани
+
+    glEnable(GL_MULTISAMPLE);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    return true;
+}
+
+void SceneRenderer::update(float deltaTime)
+{
+    ProfileScope scope("scene update");
+    earthRenderer->update(deltaTime);
+    satelliteRenderer->update(deltaTime);
+    trajectoryRenderer->update(deltaTime);
+    coverageTime += deltaTime;
+}
+
+void SceneRenderer::setUnixTime(double unixTime)
+{
+    earthRenderer->setUnixTime(unixTime);
+    satelliteRenderer->setUnixTime(unixTime);
+    trajectoryRenderer->setUnixTime(unixTime);
+}
+
+void SceneRenderer::render(const QMatrix4x4& projection, const QMatrix4x4& view, const QMatrix4x4& model)
+{
+    // Результаты запросов прошлых кадров, без ожидания GPU
+    gpuProfiler.collect();
+    // Лимит мог уменьшиться в setOptions: слои сжимаются при активном контексте
+    memoryBudget.enforce();
+
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    {
+        ProfileScope scope("earth", &gpuProfiler);
+        earthRenderer->render(projection, view, model);
+    }
+    {
+        ProfileScope scope("satellites", &gpuProfiler);
+        satelliteRenderer->render(projection, view, model);
+    }
+
+    if (trajectoryVisible) {
+        ProfileScope scope("trajectories", &gpuProfiler);
+        trajectoryRenderer->render(projection, view, model);
+    }
+
+    // Зоны обзора на положения этого кадра; шаг — время симуляции с прошлого
+    // накопления, поэтому на пропущенных кадрах покрытие не теряется
+    if (earthRenderer->coverageActive()) {
+        ProfileScope scope("coverage", &gpuProfiler);
+        earthRenderer->accumulateCoverage(satelliteRenderer->instanceBufferId(),
+                                          satelliteRenderer->satelliteCount(), coverageTime);
+    }
+    coverageTime = 0.0f;
+}
+
+void SceneRenderer::setSatellites(const SatelliteStore& satellites)
+{
+    satelliteRenderer->updateSatellites(satellites);
+}
+
+void SceneRenderer::applySatelliteChanges(const SatelliteChangeSet& changes)
+{
+    satelliteRenderer->applyChanges(changes);
+}
+
+void SceneRenderer::setTrajectories(const QVector<QVector3D>& trajectory,
+                                    const QVector<QVector3D>& futureTrajectory)
+{
+    trajectoryRenderer->setTrajectories(trajectory, futureTrajectory);
+}
+
+void SceneRenderer::setOrbitLines(const QVector<OrbitLine>& lines)
+{
+    trajectoryRenderer->setOrbitLines(lines);
+}
+
+void SceneRenderer::setOptions(const SceneOptions& options)
+{
+    earthRenderer->setAtmosphereScattering(options.atmosphereScattering);
+    earthRenderer->setCloudFrames(options.cloudFrames);
+    earthRenderer->setTileStreaming(options.tileStreaming);
+    satelliteRenderer->setDrawMode(options.satelliteDrawMode);
+    satelliteRenderer->setGpuPropagation(options.gpuPropagation);
+    satelliteRenderer->setTrails(options.trailLength, options.trailSampleSteps);
+    earthRenderer->setCoverageHalfAngle(options.coverageHalfAngle);
+    memoryBudget.setLimit(qint64(options.gpuMemoryBudget) * 1024 * 1024);
+}
@@ -0,0 +1,55 @@
+// scene_renderer.h
+#ifndef SCENE_RENDERER_H
+#define SCENE_RENDERER_H
+
+#include <QOpenGLExtraFunctions>
+#include <memory>
+#include "earth_renderer.h"
+#include "satellite_renderer.h"
+#include "trajectory_renderer.h"
+#include "satellite_store.h"
+#include "scene_options.h"
+#include "frame_profiler.h"
+#include "gpu_memory_budget.h"
+
+// 3D-сцена без привязки к виджету: может рисовать как в контексте
+// QOpenGLWidget, так и в FBO отдельного потока рендеринга
+class SceneRenderer : protected QOpenGLExtraFunctions
+{
+public:
+    explicit SceneRenderer(float earthRadius);
+    ~SceneRenderer();
+
+    // Требует активного OpenGL контекста. Опции, в том числе лимит
+    // видеопамяти, применяются до создания текстур слоев
+    bool initialize(const SceneOptions& options = SceneOptions());
+    void update(float deltaTime);
+    // Момент симуляции в секундах Unix для пропагации и дуг орбит на GPU
+    void setUnixTime(double unixTime);
+    void render(const QMatrix4x4& projection, const QMatrix4x4& view, const QMatrix4x4& model);
+
+    void setSatellites(const SatelliteStore& satellites);
+    void applySatelliteChanges(const SatelliteChangeSet& changes);
+    void setTrajectories(const QVector<QVector3D>& trajectory, const QVector<QVector3D>& futureTrajectory);
+    void setOrbitLines(const QVector<OrbitLine>& lines);
+    void setTrajectoryVisible(bool visible) { trajectoryVisible = visible; }
+    void setOptions(const SceneOptions& options);
+
+    // Вершин, обработанных при отрисовке спутников в последнем кадре
+    qint64 satelliteVerticesPerFrame() const { return satelliteRenderer->verticesPerFrame(); }
+    // Доля видимых тайлов Земли, не загруженных к последнему кадру
+    float missingTileFraction() const { return earthRenderer->missingTileFraction(); }
+    // Видеопамять текстурных слоев: лимит, расход и разбивка по слоям
+    const GpuMemoryBudget& gpuMemory() const { return memoryBudget; }
+
+private:
+    GpuMemoryBudget memoryBudget; // объявлен раньше слоев: они снимаются с учета в деструкторах
+    std::unique_ptr<EarthRenderer> earthRenderer;
+    std::unique_ptr<SatelliteRenderer> satelliteRenderer;
+    std::unique_ptr<TrajectoryRenderer> trajectoryRenderer;
+    bool trajectoryVisible;
+    float coverageTime; // секунды симуляции с последнего накопления покрытия
+    GpuProfiler gpuProfiler; // замеры проходов в контексте сцены
+};
+
+#endif // SCENE_RENDERER_H
@@ -0,0 +1,234 @@
+// session_log.cpp
+#include "session_log.h"
+#include <QDebug>
+
+namespace {
+
+constexpr quint32 LOG_MAGIC = 0x45334453; // "E3DS"
+constexpr quint32 LOG_VERSION = 1;
+constexpr QDataStream::Version STREAM_VERSION = QDataStream::Qt_6_0;
+
+void writeElements(QDataStream& stream, const OrbitalElements& elements)
+{
+    stream << qint32(elements.catalogNumber) << elements.name << elements.internationalDesignator
+           << elements.epoch << elements.inclination << elements.raan << elements.eccentricity
+           << elements.argPerigee << elements.meanAnomaly << elements.meanMotion << elements.bstar;
+}
+
+void readElements(QDataStream& stream, OrbitalElements& elements)
+{
+    qint32 catalogNumber = -1;
+    stream >> catalogNumber >> elements.name >> elements.internationalDesignator
+           >> elements.epoch >> elements.inclination >> elements.raan >> elements.eccentricity
+           >> elements.argPerigee >> elements.meanAnomaly >> elements.meanMotion >> elements.bstar;
+    elements.catalogNumber = catalogNumber;
+}
+
+}
+
+SessionRecorder::SessionRecorder() = default;
+
+SessionRecorder::~SessionRecorder()
+{
+    close();
+}
+
+bool SessionRecorder::open(const QString& path, const SessionHeader& header)
+{
+    close();
+    file.setFileName(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "Failed to open session log" << path << file.errorString();
+        return false;
+    }
+
+    stream.setDevice(&file);
+    stream.setVersion(STREAM_VERSION);
+    stream << LOG_MAGIC << LOG_VERSION << header.epoch.toMSecsSinceEpoch() << header.simulationTime
+           << header.timeWarp << header.paused << header.demoSatellites;
+    events = 0;
+    return true;
+}
+
+void SessionRecorder::close()
+{
+    if (!file.isOpen())
+        return;
+    stream.setDevice(nullptr);
+    file.close();
+    qDebug() << "Session log closed," << events << "events";
+}
+
+void SessionRecorder::frame(double realDelta, double simulationTime)
+{
+    SessionEvent event;
+    event.type = SessionEvent::Type::Frame;
+    event.realDelta = realDelta;
+    event.simulationTime = simulationTime;
+    write(event);
+}
+
+void SessionRecorder::cameraRotate(float deltaTheta, float deltaPhi)
+{
+    SessionEvent event;
+    event.type = SessionEvent::Type::CameraRotate;
+    event.deltaTheta = deltaTheta;
+    event.deltaPhi = deltaPhi;
+    write(event);
+}
+
+void SessionRecorder::cameraZoom(float factor)
+{
+    SessionEvent event;
+    event.type = SessionEvent::Type::CameraZoom;
+    event.zoomFactor = factor;
+    write(event);
+}
+
+void SessionRecorder::select(int id)
+{
+    SessionEvent event;
+    event.type = SessionEvent::Type::Select;
+    event.id = id;
+    write(event);
+}
+
+void SessionRecorder::timeWarp(double warp)
+{
+    SessionEvent event;
+    event.type = SessionEvent::Type::TimeWarp;
+    event.timeWarp = warp;
+    write(event);
+}
+
+void SessionRecorder::pause(bool paused)
+{
+    SessionEvent event;
+    event.type = SessionEvent::Type::Pause;
+    event.paused = paused;
+    write(event);
+}
+
+void SessionRecorder::catalogUpdate(const CatalogUpdate& update)
+{
+    SessionEvent event;
+    event.type = SessionEvent::Type::CatalogUpdate;
+    event.update = update;
+    write(event);
+}
+
+void SessionRecorder::write(const SessionEvent& event)
+{
+    if (!file.isOpen())
+        return;
+
+    stream << quint8(event.type);
+    switch (event.type) {
+    case SessionEvent::Type::Frame:
+        stream << event.realDelta << event.simulationTime;
+        break;
+    case SessionEvent::Type::CameraRotate:
+        stream << event.deltaTheta << event.deltaPhi;
+        break;
+    case SessionEvent::Type::CameraZoom:
+        stream << event.zoomFactor;
+        break;
+    case SessionEvent::Type::Select:
+        stream << qint32(event.id);
+        break;
+    case SessionEvent::Type::TimeWarp:
+        stream << event.timeWarp;
+        break;
+    case SessionEvent::Type::Pause:
+        stream << event.paused;
+        break;
+    case SessionEvent::Type::CatalogUpdate:
+        if (event.update.type == CatalogUpdate::Type::Remove) {
+            stream << quint8(0) << qint32(event.update.elements.catalogNumber);
+        } else {
+            stream << quint8(1);
+            writeElements(stream, event.update.elements);
+        }
+        break;
+    }
+    ++events;
+}
+
+bool SessionReader::open(const QString& path)
+{
+    file.setFileName(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        error = file.errorString();
+        return false;
+    }
+
+    stream.setDevice(&file);
+    stream.setVersion(STREAM_VERSION);
+    quint32 magic = 0, version = 0;
+    qint64 epochMs = 0;
+    stream >> magic >> version >> epochMs >> sessionHeader.simulationTime >> sessionHeader.timeWarp
+           >> sessionHeader.paused >> sessionHeader.demoSatellites;
+    if (stream.status() != QDataStream::Ok || magic != LOG_MAGIC || version != LOG_VERSION) {
+        error = "not a session log or unsupported version";
+        return false;
+    }
+    sessionHeader.epoch = QDateTime::fromMSecsSinceEpoch(epochMs, Qt::UTC);
+    return true;
+}
+
+bool SessionReader::next(SessionEvent& event)
+{
+    if (stream.atEnd())
+        return false;
+
+    quint8 type = 0;
+    stream >> type;
+    event = SessionEvent();
+    event.type = SessionEvent::Type(type);
+    switch (event.type) {
+    case SessionEvent::Type::Frame:
+        stream >> event.realDelta >> event.simulationTime;
+        break;
+    case SessionEvent::Type::CameraRotate:
+        stream >> event.deltaTheta >> event.deltaPhi;
+        break;
+    case SessionEvent::Type::CameraZoom:
+        stream >> event.zoomFactor;
+        break;
+    case SessionEvent::Type::Select: {
+        qint32 id = -1;
+        stream >> id;
+        event.id = id;
+        break;
+    }
+    case SessionEvent::Type::TimeWarp:
+        stream >> event.timeWarp;
+        break;
+    case SessionEvent::Type::Pause:
+        stream >> event.paused;
+        break;
+    case SessionEvent::Type::CatalogUpdate: {
+        quint8 upsert = 0;
+        stream >> upsert;
+        if (upsert) {
+            event.update.type = CatalogUpdate::Type::Upsert;
+            readElements(stream, event.update.elements);
+        } else {
+            qint32 id = -1;
+            stream >> id;
+            event.update.type = CatalogUpdate::Type::Remove;
+            event.update.elements.catalogNumber = id;
+        }
+        break;
+    }
+    default:
+        error = QString("unknown event type %1").arg(type);
+        return false;
+    }
+
+    if (stream.status() != QDataStream::Ok) {
+        error = "truncated event";
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,91 @@
+// session_log.h
+#ifndef SESSION_LOG_H
+#define SESSION_LOG_H
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QFile>
+#include <QString>
+#include "catalog_loader.h"
+
+// Состояние часов и сцены на момент начала записи
+struct SessionHeader {
+    QDateTime epoch;               // эпоха часов симуляции (UTC)
+    double simulationTime = 0.0;   // секунды от эпохи
+    double timeWarp = 1.0;
+    bool paused = false;
+    bool demoSatellites = false;   // демонстрационные спутники вместо каталога
+};
+
+// Событие записанной сессии. Кадр закрывает группу событий: все, что
+// записано до него, применяется перед шагом часов этого кадра
+struct SessionEvent {
+    enum class Type : quint8 {
+        Frame = 1,
+        CameraRotate,
+        CameraZoom,
+        Select,
+        TimeWarp,
+        Pause,
+        CatalogUpdate
+    };
+
+    Type type = Type::Frame;
+    double realDelta = 0.0;        // Frame: реальный шаг кадра, с
+    double simulationTime = 0.0;   // Frame: время симуляции после шага
+    float deltaTheta = 0.0f;       // CameraRotate
+    float deltaPhi = 0.0f;
+    float zoomFactor = 1.0f;       // CameraZoom
+    int id = -1;                   // Select
+    double timeWarp = 1.0;         // TimeWarp
+    bool paused = false;           // Pause
+    CatalogUpdate update;          // CatalogUpdate
+};
+
+// Запись сессии в компактный двоичный журнал (QDataStream). Пишется каждое
+// событие ввода, изменение каталога и граница кадра с шагом часов, так что
+// воспроизведение дает ту же последовательность состояний, что и исходный запуск.
+class SessionRecorder {
+public:
+    SessionRecorder();
+    ~SessionRecorder();
+
+    bool open(const QString& path, const SessionHeader& header);
+    void close();
+    bool isOpen() const { return file.isOpen(); }
+
+    void frame(double realDelta, double simulationTime);
+    void cameraRotate(float deltaTheta, float deltaPhi);
+    void cameraZoom(float factor);
+    void select(int id);
+    void timeWarp(double warp);
+    void pause(bool paused);
+    void catalogUpdate(const CatalogUpdate& update);
+
+    qint64 eventCount() const { return events; }
+
+private:
+    void write(const SessionEvent& event);
+
+    QFile file;
+    QDataStream stream;
+    qint64 events = 0;
+};
+
+// Последовательное чтение журнала. Обрезанная последняя запись (процесс
+// завершился во время записи) считается концом журнала.
+class SessionReader {
+public:
+    bool open(const QString& path);
+    const SessionHeader& header() const { return sessionHeader; }
+    bool next(SessionEvent& event);
+    QString errorString() const { return error; }
+
+private:
+    QFile file;
+    QDataStream stream;
+    SessionHeader sessionHeader;
+    QString error;
+};
+
+#endif // SESSION_LOG_H
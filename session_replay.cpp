@@ -0,0 +1,103 @@
+// session_replay.cpp
+#include "session_replay.h"
+#include <QDebug>
+
+SessionReplay::SessionReplay(QObject* parent)
+    : QObject(parent)
+{
+}
+
+bool SessionReplay::open(const QString& path)
+{
+    if (!reader.open(path)) {
+        qWarning() << "Failed to open session log" << path << reader.errorString();
+        return false;
+    }
+    replayTime = 0.0;
+    frames = 0;
+    frameReady = false;
+    finishedReplay = false;
+    return true;
+}
+
+bool SessionReplay::readFrame()
+{
+    frameEvents.clear();
+    SessionEvent event;
+    while (reader.next(event)) {
+        if (event.type == SessionEvent::Type::Frame) {
+            frameEvent = event;
+            return true;
+        }
+        frameEvents.append(event);
+    }
+    // События после последнего кадра не относятся ни к одному шагу часов
+    return false;
+}
+
+bool SessionReplay::advanceFrame(double& realDelta, double& simulationTime)
+{
+    if (finishedReplay)
+        return false;
+
+    if (!frameReady) {
+        frameReady = readFrame();
+        if (!frameReady) {
+            finishedReplay = true;
+            qDebug() << "Session replay finished after" << frames << "frames";
+            emit finished();
+            return false;
+        }
+    }
+
+    if (pacing == Pacing::RealTime) {
+        if (!wallClock.isValid())
+            wallClock.start();
+        if (wallClock.nsecsElapsed() / 1.0e9 < replayTime + frameEvent.realDelta)
+            return false;
+    }
+
+    for (const SessionEvent& event : frameEvents) {
+        if (event.type == SessionEvent::Type::CatalogUpdate) {
+            pendingCatalog.append(event.update);
+            continue;
+        }
+        // Выбор может ссылаться на только что добавленный объект
+        flushCatalogUpdates();
+        switch (event.type) {
+        case SessionEvent::Type::CameraRotate:
+            emit cameraRotated(event.deltaTheta, event.deltaPhi);
+            break;
+        case SessionEvent::Type::CameraZoom:
+            emit cameraZoomed(event.zoomFactor);
+            break;
+        case SessionEvent::Type::Select:
+            emit satelliteSelected(event.id);
+            break;
+        case SessionEvent::Type::TimeWarp:
+            emit timeWarpChanged(event.timeWarp);
+            break;
+        case SessionEvent::Type::Pause:
+            emit pausedChanged(event.paused);
+            break;
+        default:
+            break;
+        }
+    }
+    flushCatalogUpdates();
+
+    realDelta = frameEvent.realDelta;
+    simulationTime = frameEvent.simulationTime;
+    replayTime += frameEvent.realDelta;
+    frameReady = false;
+    ++frames;
+    return true;
+}
+
+void SessionReplay::flushCatalogUpdates()
+{
+    if (pendingCatalog.isEmpty())
+        return;
+    emit catalogUpdates(pendingCatalog);
+    pendingCatalog.clear();
+}
@@ -0,0 +1,66 @@
+// session_replay.h
+#ifndef SESSION_REPLAY_H
+#define SESSION_REPLAY_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QVector>
+#include "session_log.h"
+
+// Воспроизведение записанной сессии по кадрам. Каждый вызов advanceFrame()
+// выдает сигналами события одного записанного кадра в исходном порядке и
+// возвращает его шаг часов, поэтому состояние сцены повторяется кадр в кадр
+// независимо от скорости воспроизведения.
+class SessionReplay : public QObject {
+    Q_OBJECT
+
+public:
+    enum class Pacing {
+        RealTime,          // кадр не раньше его момента в записи
+        AsFastAsPossible   // по записанному кадру на каждый вызов
+    };
+
+    explicit SessionReplay(QObject* parent = nullptr);
+
+    bool open(const QString& path);
+    const SessionHeader& header() const { return reader.header(); }
+    QString errorString() const { return reader.errorString(); }
+
+    void setPacing(Pacing newPacing) { pacing = newPacing; }
+    Pacing currentPacing() const { return pacing; }
+
+    // Выдает события следующего кадра и его шаг часов. false — кадр еще не
+    // наступил (RealTime) или запись закончилась
+    bool advanceFrame(double& realDelta, double& simulationTime);
+    bool isFinished() const { return finishedReplay; }
+    qint64 framesReplayed() const { return frames; }
+
+signals:
+    void cameraRotated(float deltaTheta, float deltaPhi);
+    void cameraZoomed(float factor);
+    void satelliteSelected(int id);
+    void timeWarpChanged(double warp);
+    void pausedChanged(bool paused);
+    // Подряд идущие изменения каталога приходят одним пакетом, как из потока
+    void catalogUpdates(const QVector<CatalogUpdate>& updates);
+    void finished();
+
+private:
+    bool readFrame();
+    void flushCatalogUpdates();
+
+    SessionReader reader;
+    Pacing pacing = Pacing::RealTime;
+    QElapsedTimer wallClock;
+    double replayTime = 0.0;       // сумма реальных шагов выданных кадров
+
+    // События следующего кадра, прочитанные заранее для проверки его момента
+    QVector<SessionEvent> frameEvents;
+    SessionEvent frameEvent;
+    bool frameReady = false;
+    bool finishedReplay = false;
+    QVector<CatalogUpdate> pendingCatalog;
+    qint64 frames = 0;
+};
+
+#endif // SESSION_REPLAY_H
@@ -3,13 +3,46 @@
 in vec2 vTexCoord;
 in vec3 vNormal;
 in vec3 vFragPos;
+in vec3 vLocalPos;
 
 out vec4 fragColor;
 
-uniform sampler2D skyTexture;
-uniform vec3 lightPos;
+uniform vec3 sunDirection; // единичный, на Солнце в мировой системе
 uniform vec3 viewPos;
 
+const float PI = 3.14159265;
+
+// Слой облаков (CloudLayer), общий для Земли и атмосферы
+uniform sampler2D cloudPrevious;
+uniform sampler2D cloudNext;
+uniform float cloudBlend;
+uniform float cloudDrift;
+uniform bool cloudsAvailable;
+
+// Покрытие облаками в направлении dir (координаты модели Земли).
+// Градиенты берутся по непрерывной из двух параметризаций долготы,
+// чтобы на шве не выбирался самый грубый mip-уровень.
+float cloudCoverage(vec3 dir) {
+    if (!cloudsAvailable)
+        return 0.0;
+    dir = normalize(dir);
+    float u = 1.0 - atan(dir.z, dir.x) / (2.0 * PI) + cloudDrift;
+    float v = acos(clamp(dir.y, -1.0, 1.0)) / PI;
+    vec2 uv = vec2(u, v);
+
+    vec2 dx = dFdx(uv);
+    vec2 dy = dFdy(uv);
+    float uAlt = fract(u + 0.5);
+    float dxAlt = dFdx(uAlt);
+    float dyAlt = dFdy(uAlt);
+    if (abs(dxAlt) < abs(dx.x)) dx.x = dxAlt;
+    if (abs(dyAlt) < abs(dy.x)) dy.x = dyAlt;
+
+    float previous = textureGrad(cloudPrevious, uv, dx, dy).r;
+    float next = textureGrad(cloudNext, uv, dx, dy).r;
+    return mix(previous, next, cloudBlend);
+}
+
 void main() {
     vec3 viewDir = normalize(viewPos - vFragPos);
     float visibility = dot(normalize(vNormal), viewDir);
@@ -18,11 +51,10 @@ void main() {
         discard;
     }
 
-    // Используем текстурные координаты без модификации
-    vec4 clouds = texture(skyTexture, vTexCoord);
+    vec3 clouds = vec3(cloudCoverage(vLocalPos));
 
     vec3 atmosphereColor = vec3(0.7, 0.85, 1.0);
-    vec3 lightDir = normalize(lightPos - vFragPos);
+    vec3 lightDir = sunDirection; // Солнце бесконечно далеко: свет параллельный
     float dayFactor = max(dot(normalize(vNormal), lightDir), 0.0);
 
     float rim = 1.0 - visibility;
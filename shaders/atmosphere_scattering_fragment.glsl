@@ -0,0 +1,82 @@
+#version 330 core
+
+in vec3 vFragPos;
+
+out vec4 fragColor;
+
+// Таблицы из AtmosphereScatteringModel
+uniform sampler2D transmittanceLut;   // T(r, mu)
+uniform sampler3D scatteringLut;      // S(r, mu, muS): rgb — Рэлей, a — Ми
+
+uniform vec3 viewPos;
+uniform vec3 sunDirection;
+uniform float bottomRadius;
+uniform float topRadius;
+uniform vec3 rayleighScattering;
+uniform float miePhaseG;
+uniform float sunIntensity = 20.0;
+uniform float exposure = 1.0;
+
+const float PI = 3.14159265;
+const float MU_S_MIN = -0.2;
+const ivec2 TRANSMITTANCE_SIZE = ivec2(256, 64);
+const ivec3 SCATTERING_SIZE = ivec3(32, 128, 32); // muS, mu, r
+
+// Координата центра текселя для x в [0, 1] (индекс / (size - 1) на CPU)
+float texelCoord(float x, int size) {
+    return 0.5 / float(size) + x * (1.0 - 1.0 / float(size));
+}
+
+float radiusCoord(float r) {
+    return sqrt(clamp((r - bottomRadius) / (topRadius - bottomRadius), 0.0, 1.0));
+}
+
+float rayleighPhase(float nu) {
+    return 3.0 / (16.0 * PI) * (1.0 + nu * nu);
+}
+
+float miePhase(float nu) {
+    float g = miePhaseG;
+    float g2 = g * g;
+    return 3.0 / (8.0 * PI) * ((1.0 - g2) * (1.0 + nu * nu)) /
+           ((2.0 + g2) * pow(1.0 + g2 - 2.0 * g * nu, 1.5));
+}
+
+bool intersectsGround(float r, float mu) {
+    return mu < 0.0 && r * r * (mu * mu - 1.0) + bottomRadius * bottomRadius >= 0.0;
+}
+
+void main() {
+    // Камера снаружи атмосферы: фрагмент передней грани — точка входа луча
+    vec3 viewDir = normalize(vFragPos - viewPos);
+    vec3 up = normalize(vFragPos);
+    float r = topRadius;
+    float mu = dot(up, viewDir);
+    float muS = dot(up, sunDirection);
+    float nu = dot(viewDir, sunDirection);
+
+    vec3 uvw = vec3(
+        texelCoord(clamp((muS - MU_S_MIN) / (1.0 - MU_S_MIN), 0.0, 1.0), SCATTERING_SIZE.x),
+        texelCoord((mu + 1.0) * 0.5, SCATTERING_SIZE.y),
+        texelCoord(radiusCoord(r), SCATTERING_SIZE.z));
+    vec4 scattering = texture(scatteringLut, uvw);
+
+    // Восстановление Ми из красного канала (приближение Брюнетона)
+    vec3 rayleigh = scattering.rgb;
+    vec3 mie = scattering.rgb * (scattering.a / max(scattering.r, 1e-6)) *
+               (rayleighScattering.r / rayleighScattering);
+
+    vec3 radiance = sunIntensity * (rayleigh * rayleighPhase(nu) + mie * miePhase(nu));
+
+    // Поверхность Земли за атмосферой ослабляется пропусканием луча
+    vec3 transmittance = vec3(1.0);
+    if (intersectsGround(r, mu)) {
+        vec2 uv = vec2(texelCoord((mu + 1.0) * 0.5, TRANSMITTANCE_SIZE.x),
+                       texelCoord(radiusCoord(r), TRANSMITTANCE_SIZE.y));
+        transmittance = texture(transmittanceLut, uv).rgb;
+    }
+
+    vec3 color = 1.0 - exp(-exposure * radiance);
+    // Смешивание ONE, SRC_ALPHA: dst * T + рассеянный свет
+    fragColor = vec4(color, dot(transmittance, vec3(1.0 / 3.0)));
+}
@@ -0,0 +1,16 @@
+#version 330 core
+
+in vec3 position;
+
+out vec3 vFragPos;
+
+uniform mat4 projectionMatrix;
+uniform mat4 viewMatrix;
+uniform mat4 modelMatrix;
+uniform float shellScale; // Переводит сферу атмосферы к верхней границе модели рассеяния
+
+void main() {
+    vec4 worldPos = modelMatrix * vec4(position * shellScale, 1.0);
+    vFragPos = worldPos.xyz;
+    gl_Position = projectionMatrix * viewMatrix * worldPos;
+}
@@ -7,22 +7,21 @@ in vec3 normal;
 out vec2 vTexCoord;
 out vec3 vNormal;
 out vec3 vFragPos;
+out vec3 vLocalPos;
 
 uniform mat4 projectionMatrix;
 uniform mat4 viewMatrix;
 uniform mat4 modelMatrix;
-uniform mat4 cloudRotationMatrix; // Добавляем матрицу вращения для облаков
 
 void main() {
-    // Применяем матрицу вращения к позиции для анимации облаков
-    vec4 rotatedPosition = cloudRotationMatrix * vec4(position * 1.025, 1.0);
-    vec4 worldPos = modelMatrix * rotatedPosition;
+    // Движение облаков задается в текстурных координатах слоя облаков
+    vec4 worldPos = modelMatrix * vec4(position * 1.025, 1.0);
 
     vTexCoord = texCoord;
     vFragPos = worldPos.xyz;
+    vLocalPos = position;
 
-    // Применяем матрицу вращения к нормалям
-    mat3 normalMatrix = transpose(inverse(mat3(modelMatrix * cloudRotationMatrix)));
+    mat3 normalMatrix = transpose(inverse(mat3(modelMatrix)));
     vNormal = normalize(normalMatrix * normal);
 
     gl_Position = projectionMatrix * viewMatrix * worldPos;
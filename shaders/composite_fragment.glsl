@@ -0,0 +1,10 @@
+#version 330 core
+
+in vec2 vTexCoord;
+out vec4 fragColor;
+
+uniform sampler2D frameTexture;
+
+void main() {
+    fragColor = vec4(texture(frameTexture, vTexCoord).rgb, 1.0);
+}
@@ -0,0 +1,24 @@
+#version 330 core
+// Точный тест попадания в зону обзора по направлению из текселя;
+// прошедшие фрагменты складываются аддитивным смешиванием
+flat in vec3 subpoint;
+flat in float cosCoverage;
+
+uniform vec2 targetSize;
+uniform float weight; // секунды симуляции за шаг
+
+out float coverage;
+
+const float PI = 3.14159265359;
+const float TWO_PI = 6.28318530718;
+
+void main()
+{
+    vec2 uv = gl_FragCoord.xy / targetSize;
+    float theta = uv.x * TWO_PI;
+    float phi = uv.y * PI;
+    vec3 dir = vec3(sin(phi) * cos(theta), cos(phi), sin(phi) * sin(theta));
+    if (dot(dir, subpoint) < cosCoverage)
+        discard;
+    coverage = weight;
+}
@@ -0,0 +1,65 @@
+#version 330 core
+// Накопление покрытия: по два экземпляра на спутник (divisor = 2), каждый —
+// прямоугольник в UV вокруг зоны обзора. Второй экземпляр сдвинут на оборот
+// по долготе и закрывает часть зоны за швом u = 0/1
+layout(location = 0) in vec4 instance; // xyz — положение спутника в инерциальной системе сцены
+
+uniform mat3 inertialToFixed; // поворот в земную систему сетки на звездное время
+uniform float earthRadius;
+uniform float halfAngle;    // полуугол конуса сенсора, рад
+
+flat out vec3 subpoint;     // единичное направление на подспутниковую точку
+flat out float cosCoverage; // косинус центрального угла зоны обзора
+
+const float PI = 3.14159265359;
+const float TWO_PI = 6.28318530718;
+
+void main()
+{
+    // Экземпляр вне экрана, если зона пуста
+    gl_Position = vec4(2.0, 2.0, 0.0, 1.0);
+    subpoint = vec3(0.0, 1.0, 0.0);
+    cosCoverage = 2.0;
+
+    float r = length(instance.xyz);
+    if (r <= earthRadius)
+        return;
+
+    // Центральный угол: луч сенсора под углом halfAngle к надиру касается
+    // поверхности не дальше горизонта
+    float horizon = acos(earthRadius / r);
+    float s = r / earthRadius * sin(halfAngle);
+    float lambda = s >= 1.0 ? horizon : min(asin(s) - halfAngle, horizon);
+    if (lambda <= 0.0)
+        return;
+
+    vec3 n = inertialToFixed * (instance.xyz / r);
+    subpoint = n;
+    cosCoverage = cos(lambda);
+
+    // Тот же параметр, что у сетки Земли: u = θ/2π, v = φ/π
+    float u = atan(n.z, n.x) / TWO_PI;
+    u = u < 0.0 ? u + 1.0 : u;
+    float colatitude = acos(clamp(n.y, -1.0, 1.0));
+    float vMin = (colatitude - lambda) / PI;
+    float vMax = (colatitude + lambda) / PI;
+
+    bool copy = (gl_InstanceID & 1) == 1;
+    float uMin, uMax;
+    if (vMin <= 0.0 || vMax >= 1.0) {
+        // Зона накрывает полюс: вся полоса широт
+        if (copy)
+            return;
+        uMin = 0.0;
+        uMax = 1.0;
+    } else {
+        float halfWidth = asin(clamp(sin(lambda) / sin(colatitude), 0.0, 1.0)) / TWO_PI;
+        float shift = copy ? (u < 0.5 ? 1.0 : -1.0) : 0.0;
+        uMin = u - halfWidth + shift;
+        uMax = u + halfWidth + shift;
+    }
+
+    vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+    vec2 uv = mix(vec2(uMin, max(vMin, 0.0)), vec2(uMax, min(vMax, 1.0)), corner);
+    gl_Position = vec4(uv * 2.0 - 1.0, 0.0, 1.0);
+}
@@ -3,6 +3,7 @@
 in vec2 vTexCoord;
 in vec3 vNormal;
 in vec3 vFragPos;
+in vec3 vLocalPos;
 flat in vec2 vTileCoord;
 
 out vec4 fragColor;
@@ -14,14 +15,12 @@ uniform sampler2D normalMap;       // Карта нормалей
 
 // Новые текстуры
 uniform sampler2D nightLightMap;   // Карта ночных огней
-uniform sampler2D cloudMap;        // Карта облаков
 uniform sampler2D specularMap;     // Карта бликов
 uniform sampler2D temperatureMap;  // Карта температур
 uniform sampler2D snowMap;         // Карта снега/льда
 
-uniform vec3 lightPos;
+uniform vec3 sunDirection; // единичный, на Солнце в мировой системе
 uniform vec3 viewPos;
-uniform float time;               // Для анимации облаков
 
 // Параметры освещения
 uniform float ambientStrength = 0.3;
@@ -29,7 +28,93 @@ uniform float diffuseStrength = 0.7;
 uniform float specularStrength = 0.05;
 uniform float shininess = 16.0;
 uniform float heightScale = 0.15;
-uniform float cloudOpacity = 0.5;  // Прозрачность облаков
+uniform float cloudOpacity = 0.5;  // Прозрачность облаков (0 — облака рисует оболочка атмосферы)
+uniform float cloudShadow = 0.25;  // Затенение поверхности под облаками
+
+const float PI = 3.14159265;
+
+// Слой облаков (CloudLayer), общий для Земли и атмосферы
+uniform sampler2D cloudPrevious;
+uniform sampler2D cloudNext;
+uniform float cloudBlend;
+uniform float cloudDrift;
+uniform bool cloudsAvailable;
+
+// Накопленное покрытие зонами обзора (CoverageLayer)
+uniform sampler2D coverageMap;
+uniform float coverageScale;     // 1 / накопленное время
+uniform bool coverageAvailable;
+uniform float coverageOpacity = 0.6;
+uniform float coverageSaturation = 4.0; // среднее число спутников, дающее верх шкалы
+
+// Покрытие облаками в направлении dir (координаты модели Земли).
+// Градиенты берутся по непрерывной из двух параметризаций долготы,
+// чтобы на шве не выбирался самый грубый mip-уровень.
+float cloudCoverage(vec3 dir) {
+    if (!cloudsAvailable)
+        return 0.0;
+    dir = normalize(dir);
+    float u = 1.0 - atan(dir.z, dir.x) / (2.0 * PI) + cloudDrift;
+    float v = acos(clamp(dir.y, -1.0, 1.0)) / PI;
+    vec2 uv = vec2(u, v);
+
+    vec2 dx = dFdx(uv);
+    vec2 dy = dFdy(uv);
+    float uAlt = fract(u + 0.5);
+    float dxAlt = dFdx(uAlt);
+    float dyAlt = dFdy(uAlt);
+    if (abs(dxAlt) < abs(dx.x)) dx.x = dxAlt;
+    if (abs(dyAlt) < abs(dy.x)) dy.x = dyAlt;
+
+    float previous = textureGrad(cloudPrevious, uv, dx, dy).r;
+    float next = textureGrad(cloudNext, uv, dx, dy).r;
+    return mix(previous, next, cloudBlend);
+}
+
+// Среднее число спутников, в зоне обзора которых находится точка dir
+float coverageMean(vec3 dir) {
+    dir = normalize(dir);
+    float u = atan(dir.z, dir.x) / (2.0 * PI);
+    float v = acos(clamp(dir.y, -1.0, 1.0)) / PI;
+    // Текстура без mip-уровней, шов по u закрывает GL_REPEAT
+    return texture(coverageMap, vec2(u, v)).r * coverageScale;
+}
+
+// Тайлы цветовой карты полного разрешения (TileTextureManager): страничная
+// таблица по (segment, ring) дает слой массива или -1, если тайла нет
+uniform sampler2DArray tilePool;
+uniform sampler2D tilePageTable;
+uniform bool tilesAvailable;
+uniform int tileSegments;
+uniform int tileColumns;
+uniform vec2 tileCellSize;       // размер ячейки тайла в UV атласа
+
+// Дневной цвет: загруженный тайл, иначе ячейка атласа. Градиенты
+// считаются до ветвления — соседние пиксели могут попасть в разные тайлы
+vec4 dayColorSample() {
+    vec4 atlasColor = texture(earthTexture, vTexCoord);
+    vec2 cellCoord = vTexCoord / tileCellSize;
+    vec2 dx = dFdx(cellCoord);
+    vec2 dy = dFdy(cellCoord);
+    if (!tilesAvailable)
+        return atlasColor;
+
+    ivec2 tile = ivec2(vTileCoord + 0.5); // (ring, segment)
+    float layer = texelFetch(tilePageTable, ivec2(tile.y, tile.x), 0).r;
+    if (layer < 0.0)
+        return atlasColor;
+    int index = tile.x * tileSegments + tile.y;
+    vec2 cell = vec2(index % tileColumns, index / tileColumns);
+    vec2 local = clamp(cellCoord - cell, 0.0, 1.0);
+    return textureGrad(tilePool, vec3(local, layer), dx, dy);
+}
+
+// Шкала тепловой карты: синий — редко, красный — постоянно
+vec3 heatmap(float t) {
+    return clamp(vec3(1.5 - abs(4.0 * t - 3.0),
+                      1.5 - abs(4.0 * t - 2.0),
+                      1.5 - abs(4.0 * t - 1.0)), 0.0, 1.0);
+}
 
 void main() {
     vec3 viewDir = normalize(viewPos - vFragPos);
@@ -40,15 +125,14 @@ void main() {
     }
 
     // Базовый цвет земли
-    vec4 dayColor = texture(earthTexture, vTexCoord);
+    vec4 dayColor = dayColorSample();
     vec4 nightColor = texture(nightLightMap, vTexCoord);
 
     // Получаем высоту для текущего фрагмента
     float height = texture(heightMap, vTexCoord).r;
 
-    // Облака с анимацией
-    vec2 cloudUV = vTexCoord + vec2(time * 0.001, 0.0);
-    vec4 clouds = texture(cloudMap, cloudUV);
+    // Облака из общего слоя
+    float clouds = cloudCoverage(vLocalPos);
 
     // Спекулярная карта для разных типов поверхности
     float surfaceSpecular = texture(specularMap, vTexCoord).r;
@@ -58,7 +142,7 @@ void main() {
     float snow = texture(snowMap, vTexCoord).r;
 
     // Смешиваем дневной и ночной цвет в зависимости от освещения
-    vec3 lightDir = normalize(lightPos - vFragPos);
+    vec3 lightDir = sunDirection; // Солнце бесконечно далеко: свет параллельный
     float dayFactor = max(dot(normalize(vNormal), lightDir), 0.0);
     vec3 baseColor = mix(nightColor.rgb * 2.0, dayColor.rgb, dayFactor);
 
@@ -85,8 +169,17 @@ void main() {
     // Итоговый цвет
     vec3 color = ambient + diffuse + specular;
 
-    // Добавляем облака
-    color = mix(color, clouds.rgb, clouds.a * cloudOpacity * dayFactor);
+    // Тень и сами облака
+    color *= 1.0 - clouds * cloudShadow * dayFactor;
+    color = mix(color, vec3(1.0), clouds * cloudOpacity * dayFactor);
+
+    // Тепловая карта покрытия в логарифмической шкале; непокрытые точки
+    // остаются без изменений
+    if (coverageAvailable) {
+        float mean = coverageMean(vLocalPos);
+        float level = clamp(log(1.0 + mean) / log(1.0 + coverageSaturation), 0.0, 1.0);
+        color = mix(color, heatmap(level), coverageOpacity * smoothstep(0.0, 0.02, level));
+    }
 
     // Затемнение по краям
     color *= pow(visibility, 0.5);
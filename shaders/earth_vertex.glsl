@@ -8,6 +8,7 @@ in vec2 tileCoord;
 out vec2 vTexCoord;
 out vec3 vNormal;
 out vec3 vFragPos;
+out vec3 vLocalPos;
 flat out vec2 vTileCoord;
 
 uniform mat4 projectionMatrix;
@@ -19,6 +20,7 @@ uniform float heightScale = 0.15;
 void main() {
     vTexCoord = texCoord;
     vTileCoord = tileCoord;
+    vLocalPos = position;
 
     // Получаем высоту из тайловой карты высот
     float height = texture(heightMap, texCoord).r;
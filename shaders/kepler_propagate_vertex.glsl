@@ -0,0 +1,70 @@
+#version 330 core
+// Пропагация Кеплера для transform feedback: одна вершина — один спутник,
+// результат пишется прямо в буфер экземпляров SatelliteRenderer, освещенность
+// Солнцем — в его буфер освещенности (коническая модель EclipseModel)
+layout(location = 0) in vec4 motion; // n (рад/с), M на опорный момент, e, 1 — орбита / 0 — точка
+layout(location = 1) in vec4 axisP;  // a·P в системе сцены (или неподвижное положение), w — флаги
+layout(location = 2) in vec4 axisQ;  // b·Q
+
+uniform float timeSinceReference; // секунды от опорного момента, не больше часа
+uniform vec3 sunPosition;         // в системе сцены, м
+uniform float earthRadius;
+uniform float sunRadius;
+
+out vec4 instance;
+out float illumination;
+
+const float PI = 3.14159265359;
+const float TWO_PI = 6.28318530718;
+const int MAX_ITERATIONS = 10;
+
+// Доля диска Солнца, не закрытая диском Земли, как EclipseModel::illumination
+float sunlight(vec3 position)
+{
+    // Перед плоскостью терминатора тени нет
+    if (dot(position, sunPosition) >= 0.0)
+        return 1.0;
+    float r = length(position);
+    if (r <= earthRadius)
+        return 0.0;
+
+    vec3 toSun = sunPosition - position;
+    float d = length(toSun);
+    float a = asin(min(sunRadius / d, 1.0));
+    float b = asin(earthRadius / r);
+    float c = acos(clamp(dot(-position, toSun) / (r * d), -1.0, 1.0));
+    if (c >= a + b)
+        return 1.0;
+    if (c <= b - a)
+        return 0.0;
+
+    float x = (c * c + a * a - b * b) / (2.0 * c);
+    float y = sqrt(max(a * a - x * x, 0.0));
+    float overlap = a * a * acos(clamp(x / a, -1.0, 1.0)) + b * b * acos(clamp((c - x) / b, -1.0, 1.0)) - c * y;
+    return clamp(1.0 - overlap / (PI * a * a), 0.0, 1.0);
+}
+
+void main()
+{
+    gl_Position = vec4(0.0);
+    if (motion.w == 0.0) {
+        instance = axisP;
+        illumination = sunlight(axisP.xyz);
+        return;
+    }
+
+    float e = motion.z;
+    float M = mod(motion.y + motion.x * timeSinceReference, TWO_PI);
+
+    // Уравнение Кеплера методом Ньютона, как KeplerPropagator::solveKepler
+    float E = e < 0.8 ? M : 3.14159265359;
+    for (int i = 0; i < MAX_ITERATIONS; ++i) {
+        float delta = (E - e * sin(E) - M) / (1.0 - e * cos(E));
+        E -= delta;
+        if (abs(delta) < 1e-6)
+            break;
+    }
+
+    instance = vec4((cos(E) - e) * axisP.xyz + sin(E) * axisQ.xyz, axisP.w);
+    illumination = sunlight(instance.xyz);
+}
@@ -1,18 +1,26 @@
 #version 330 core
 in vec3 fragNormal;
 in vec3 fragPosition;
+flat in float flags;
+flat in float sunlit;
 
-uniform bool isSelected;
+uniform vec3 sunDirection;
 
 out vec4 FragColor;
 
 void main()
 {
-    // Базовый цвет спутника
-    vec3 baseColor = isSelected ? vec3(1.0, 0.5, 0.0) : vec3(0.7, 0.7, 0.7);
+    // Флаги: бит 0 — выбран, бит 1 — участвует в сближении
+    int bits = int(flags + 0.5);
+    bool isSelected = (bits & 1) != 0;
+    bool isConjunction = (bits & 2) != 0;
 
-    // Направление света (фиксированное)
-    vec3 lightDir = normalize(vec3(1.0, 1.0, 1.0));
+    // Базовый цвет спутника; выбор важнее подсветки сближения
+    vec3 baseColor = isSelected ? vec3(1.0, 0.5, 0.0)
+                   : isConjunction ? vec3(1.0, 0.15, 0.1) : vec3(0.7, 0.7, 0.7);
+
+    // Свет от Солнца
+    vec3 lightDir = sunDirection;
 
     // Вычисляем диффузное освещение
     float diff = max(dot(fragNormal, lightDir), 0.0);
@@ -26,12 +34,14 @@ void main()
     float spec = pow(max(dot(viewDir, reflectDir), 0.0), 32.0);
     float specStrength = 0.5;
 
-    // Финальный цвет
-    vec3 finalColor = baseColor * (ambient + diff) + vec3(1.0) * spec * specStrength;
+    // Финальный цвет; в тени Земли остается только рассеянный свет,
+    // и спутник темнеет с уходом в синий
+    vec3 finalColor = baseColor * (ambient + diff * sunlit) + vec3(1.0) * spec * specStrength * sunlit;
+    finalColor = mix(finalColor * vec3(0.45, 0.55, 1.0), finalColor, sunlit);
 
     // Добавляем alpha для сглаживания краёв
     float alpha = 1.0;
-    if (!isSelected) {
+    if (!isSelected && !isConjunction) {
         // Вычисляем alpha для краёв сферы
         float edgeSoftness = 1.0 - pow(1.0 - max(dot(fragNormal, viewDir), 0.0), 2.0);
         alpha = min(1.0, edgeSoftness + 0.5);
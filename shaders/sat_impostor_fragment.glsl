@@ -0,0 +1,47 @@
+#version 330 core
+flat in float flags;
+flat in float pointSize;
+flat in float sunlit;
+
+uniform mat3 viewToWorld; // поворот из системы камеры в мировую
+uniform vec3 sunDirection;
+
+out vec4 FragColor;
+
+void main()
+{
+    // Координата в спрайте -> видимая полусфера единичного радиуса
+    vec2 p = gl_PointCoord * 2.0 - 1.0;
+    p.y = -p.y;
+    float r = length(p);
+    if (r > 1.0)
+        discard;
+    vec3 fragNormal = normalize(viewToWorld * vec3(p, sqrt(max(1.0 - r * r, 0.0))));
+
+    // Освещение как в sat_fragment.glsl
+    int bits = int(flags + 0.5);
+    bool isSelected = (bits & 1) != 0;
+    bool isConjunction = (bits & 2) != 0;
+    vec3 baseColor = isSelected ? vec3(1.0, 0.5, 0.0)
+                   : isConjunction ? vec3(1.0, 0.15, 0.1) : vec3(0.7, 0.7, 0.7);
+    vec3 lightDir = sunDirection;
+    float diff = max(dot(fragNormal, lightDir), 0.0);
+    float ambient = 0.3;
+    vec3 viewDir = -fragNormal;
+    vec3 reflectDir = reflect(-lightDir, fragNormal);
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), 32.0);
+    float specStrength = 0.5;
+    vec3 finalColor = baseColor * (ambient + diff * sunlit) + vec3(1.0) * spec * specStrength * sunlit;
+    finalColor = mix(finalColor * vec3(0.45, 0.55, 1.0), finalColor, sunlit);
+
+    float alpha = 1.0;
+    if (!isSelected && !isConjunction) {
+        float edgeSoftness = 1.0 - pow(1.0 - max(dot(fragNormal, viewDir), 0.0), 2.0);
+        alpha = min(1.0, edgeSoftness + 0.5);
+    }
+
+    // MSAA не сглаживает discard — край сглаживается по пикселю вручную
+    alpha *= 1.0 - smoothstep(1.0 - 2.0 / pointSize, 1.0, r);
+
+    FragColor = vec4(finalColor, alpha);
+}
@@ -0,0 +1,27 @@
+#version 330 core
+layout(location = 0) in vec4 instance; // xyz — положение спутника, w — флаги SatelliteStore::Flag
+layout(location = 1) in float illumination; // доля диска Солнца, 0 — полная тень Земли
+
+uniform mat4 viewProjection;
+uniform mat4 model;
+uniform vec3 cameraPosition;
+uniform float screenScale;
+uniform float pixelScale; // пикселей на единицу y/w: projection[1][1] * высота / 2
+
+flat out float flags;
+flat out float sunlit;
+flat out float pointSize;
+
+void main()
+{
+    vec3 center = (model * vec4(instance.xyz, 1.0)).xyz;
+
+    // Тот же радиус, что у сферы-меша, но одна вершина вместо сотен
+    float radius = distance(cameraPosition, center) * screenScale;
+
+    gl_Position = viewProjection * vec4(center, 1.0);
+    pointSize = max(2.0 * radius * pixelScale / gl_Position.w, 1.0);
+    gl_PointSize = pointSize;
+    flags = instance.w;
+    sunlit = illumination;
+}
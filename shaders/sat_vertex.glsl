@@ -1,17 +1,29 @@
 #version 330 core
 layout(location = 0) in vec3 position;
-layout(location = 1) in vec2 texCoord;
-layout(location = 2) in vec3 normal;
+layout(location = 1) in vec3 normal;
+layout(location = 2) in vec4 instance; // xyz — положение спутника, w — флаги SatelliteStore::Flag
+layout(location = 3) in float illumination; // доля диска Солнца, 0 — полная тень Земли
 
-uniform mat4 mvp;
-uniform bool isSelected;
+uniform mat4 viewProjection;
+uniform mat4 model;
+uniform vec3 cameraPosition;
+uniform float screenScale;
 
 out vec3 fragNormal;
 out vec3 fragPosition;
+flat out float flags;
+flat out float sunlit;
 
 void main()
 {
+    vec3 center = (model * vec4(instance.xyz, 1.0)).xyz;
+
+    // Размер пропорционален расстоянию до камеры, спутник виден при любом масштабе
+    float scale = distance(cameraPosition, center) * screenScale;
+
     fragPosition = position;
     fragNormal = normalize(normal);
-    gl_Position = mvp * vec4(position, 1.0);
+    flags = instance.w;
+    sunlit = illumination;
+    gl_Position = viewProjection * vec4(center + position * scale, 1.0);
 }
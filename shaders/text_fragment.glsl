@@ -0,0 +1,20 @@
+#version 330 core
+
+in vec2 vTexCoord;
+in vec4 vColor;
+flat in float vSolid;
+
+out vec4 fragColor;
+
+uniform sampler2D glyphAtlas; // поле расстояний, 0.5 — контур глифа
+
+void main() {
+    float distance = texture(glyphAtlas, vTexCoord).r;
+    float width = max(fwidth(distance), 1e-4) * 0.75;
+    float alpha = mix(smoothstep(0.5 - width, 0.5 + width, distance), 1.0, vSolid);
+
+    if (vColor.a * alpha <= 0.0) {
+        discard;
+    }
+    fragColor = vec4(vColor.rgb, vColor.a * alpha);
+}
@@ -0,0 +1,39 @@
+#version 330 core
+
+in vec4 anchor;   // xyz — точка сцены (w = 1) или пиксели экрана (w = 0)
+in vec4 rect;     // смещение и размер квада в пикселях
+in vec4 uvRect;   // область атласа, нулевая ширина — заливка
+in vec4 color;
+
+out vec2 vTexCoord;
+out vec4 vColor;
+flat out float vSolid;
+
+uniform mat4 mvpMatrix;
+uniform vec2 viewportSize;
+
+void main() {
+    // Углы квада для GL_TRIANGLE_STRIP
+    vec2 corner = vec2(float(gl_VertexID & 1), float(gl_VertexID >> 1));
+
+    vec2 origin = anchor.xy;
+    if (anchor.w > 0.5) {
+        vec4 clip = mvpMatrix * vec4(anchor.xyz, 1.0);
+        if (clip.w <= 0.0) {
+            // За камерой: выносим квад за пределы экрана
+            gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
+            return;
+        }
+        vec2 ndc = clip.xy / clip.w;
+        origin = vec2((ndc.x + 1.0) * 0.5 * viewportSize.x, (1.0 - ndc.y) * 0.5 * viewportSize.y);
+        origin = floor(origin + 0.5); // целые пиксели — четче текст
+    }
+
+    vec2 pixel = origin + rect.xy + corner * rect.zw;
+    gl_Position = vec4(pixel.x / viewportSize.x * 2.0 - 1.0,
+                       1.0 - pixel.y / viewportSize.y * 2.0, 0.0, 1.0);
+
+    vTexCoord = uvRect.xy + corner * uvRect.zw;
+    vColor = color;
+    vSolid = uvRect.z > 0.0 ? 0.0 : 1.0;
+}
@@ -0,0 +1,16 @@
+#version 330 core
+in float fade;
+flat in float flags;
+
+uniform float opacity;
+
+out vec4 FragColor;
+
+void main()
+{
+    // Цвета как у спутников: выбранный — оранжевый, в сближении — красный
+    int bits = int(flags + 0.5);
+    vec3 color = (bits & 1) != 0 ? vec3(1.0, 0.5, 0.0)
+               : (bits & 2) != 0 ? vec3(1.0, 0.15, 0.1) : vec3(0.6, 0.75, 0.9);
+    FragColor = vec4(color, opacity * fade * fade);
+}
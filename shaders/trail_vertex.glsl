@@ -0,0 +1,35 @@
+#version 330 core
+// Следы спутников из кольцевого буфера: экземпляр — спутник, вершина —
+// выборка истории, 0 — самая новая. Столбец кольца хранит слоты подряд
+uniform samplerBuffer history;  // vec4 на (столбец, слот): xyz — положение, w — флаги
+uniform isamplerBuffer born;    // номер первой выборки, принадлежащей слоту
+uniform mat4 viewProjection;
+uniform mat4 model;
+uniform int capacity;           // слотов в столбце
+uniform int historyLength;      // столбцов в кольце
+uniform int newest;             // номер самой новой выборки
+
+out float fade;
+flat out float flags;
+
+void main()
+{
+    int slot = gl_InstanceID;
+    int available = newest - texelFetch(born, slot).r; // старший доступный возраст
+    if (available < 0) {
+        // Выборок у нового владельца слота еще нет
+        gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
+        fade = 0.0;
+        flags = 0.0;
+        return;
+    }
+
+    // Выборки старше владельца слота стягиваются в его первую точку
+    int age = min(gl_VertexID, available);
+    int column = (newest - age) % historyLength;
+    vec4 position = texelFetch(history, column * capacity + slot);
+
+    gl_Position = viewProjection * model * vec4(position.xyz, 1.0);
+    fade = 1.0 - float(gl_VertexID) / float(historyLength - 1);
+    flags = texelFetch(history, (newest % historyLength) * capacity + slot).w;
+}
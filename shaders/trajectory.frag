@@ -1,11 +1,12 @@
 #version 330 core
 in float vLineCoord;
+in vec4 vColor;
 out vec4 FragColor;
 
-uniform vec4 color;
 uniform float time;
 
 void main() {
+    vec4 color = vColor;
     float pattern;
     float dash = 1.0;
 
@@ -1,10 +1,44 @@
 #version 330 core
 layout(location = 0) in vec3 aPos;
+// Процедурная дуга орбиты: запись на экземпляр, точки считаются по gl_VertexID
+layout(location = 1) in vec4 orbitAxisP;  // a·P, w — эксцентриситет
+layout(location = 2) in vec4 orbitAxisQ;  // b·Q, w — среднее движение, рад/с
+layout(location = 3) in vec4 orbitWindow; // M на опорный момент, начало и длина окна, с
+layout(location = 4) in vec4 orbitColor;
 
 uniform mat4 mvp;
+uniform vec4 color;
+uniform bool procedural;
+uniform int orbitVertices;
+uniform float timeSinceReference;
 out float vLineCoord;
+out vec4 vColor;
+
+const float TWO_PI = 6.28318530718;
+
+vec3 orbitPosition(float t)
+{
+    float e = orbitAxisP.w;
+    float M = mod(orbitWindow.x + orbitAxisQ.w * t, TWO_PI);
+    float E = e < 0.8 ? M : 3.14159265359;
+    for (int i = 0; i < 10; ++i) {
+        float delta = (E - e * sin(E) - M) / (1.0 - e * cos(E));
+        E -= delta;
+        if (abs(delta) < 1e-5)
+            break;
+    }
+    return (cos(E) - e) * orbitAxisP.xyz + sin(E) * orbitAxisQ.xyz;
+}
 
 void main() {
-    gl_Position = mvp * vec4(aPos, 1.0);
+    vec3 position = aPos;
+    vColor = color;
+    if (procedural) {
+        float t = timeSinceReference + orbitWindow.y +
+                  orbitWindow.z * float(gl_VertexID) / float(orbitVertices - 1);
+        position = orbitPosition(t);
+        vColor = orbitColor;
+    }
+    gl_Position = mvp * vec4(position, 1.0);
     vLineCoord = float(gl_VertexID) * 0.1; // Масштабируем координату для пунктира
 }
@@ -0,0 +1,70 @@
+// simulation_clock.cpp
+#include "simulation_clock.h"
+#include <QtGlobal>
+
+SimulationClock::SimulationClock()
+    : lastTickNs(0)
+    , epochUtc(QDateTime::currentDateTimeUtc())
+    , simTime(0.0)
+    , simDelta(0.0)
+    , realDelta(0.0)
+    , warp(1.0)
+    , paused(false)
+{
+    timer.start();
+}
+
+void SimulationClock::tick()
+{
+    qint64 now = timer.nsecsElapsed();
+    realDelta = qMin((now - lastTickNs) / 1.0e9, MAX_REAL_STEP);
+    lastTickNs = now;
+
+    // Перемотка назад — это просто отрицательный множитель
+    simDelta = paused ? 0.0 : realDelta * warp;
+    simTime += simDelta;
+}
+
+void SimulationClock::tick(double realSeconds, double simulationSeconds)
+{
+    lastTickNs = timer.nsecsElapsed();
+    realDelta = realSeconds;
+    simDelta = simulationSeconds - simTime;
+    simTime = simulationSeconds;
+}
+
+void SimulationClock::setTimeWarp(double newWarp)
+{
+    warp = newWarp;
+}
+
+void SimulationClock::setPaused(bool isPaused)
+{
+    // После паузы кадры могли не рисоваться долго — начинаем отсчет заново
+    if (paused && !isPaused)
+        lastTickNs = timer.nsecsElapsed();
+    paused = isPaused;
+}
+
+bool SimulationClock::togglePause()
+{
+    setPaused(!paused);
+    return paused;
+}
+
+void SimulationClock::reset(double simulationSeconds)
+{
+    simTime = simulationSeconds;
+    simDelta = 0.0;
+    lastTickNs = timer.nsecsElapsed();
+}
+
+void SimulationClock::setEpoch(const QDateTime& newEpoch)
+{
+    epochUtc = newEpoch.toUTC();
+}
+
+QDateTime SimulationClock::currentDateTime() const
+{
+    return epochUtc.addMSecs(qint64(simTime * 1000.0));
+}
@@ -0,0 +1,50 @@
+// simulation_clock.h
+#ifndef SIMULATION_CLOCK_H
+#define SIMULATION_CLOCK_H
+
+#include <QElapsedTimer>
+#include <QDateTime>
+
+// Единые часы симуляции: реальное прошедшее время, ускорение/перемотка и пауза.
+// Все рендереры и пропагатор получают время отсюда, а не из фиксированного шага 16 мс.
+class SimulationClock {
+public:
+    SimulationClock();
+
+    // Вызывается один раз за кадр, продвигает время симуляции
+    void tick();
+    // Шаг, заданный извне (воспроизведение записанной сессии): часы
+    // переходят к записанному времени симуляции
+    void tick(double realSeconds, double simulationSeconds);
+
+    void setTimeWarp(double warp);
+    double timeWarp() const { return warp; }
+
+    void setPaused(bool paused);
+    bool isPaused() const { return paused; }
+    bool togglePause();
+
+    // Сбрасывает время симуляции к началу эпохи
+    void reset(double simulationSeconds = 0.0);
+    void setEpoch(const QDateTime& epochUtc);
+
+    double simulationTime() const { return simTime; }   // секунды от эпохи
+    float deltaTime() const { return float(simDelta); }  // шаг симуляции последнего тика (с учетом warp)
+    float realDeltaTime() const { return float(realDelta); }
+    QDateTime epoch() const { return epochUtc; }
+    QDateTime currentDateTime() const;
+
+private:
+    static constexpr double MAX_REAL_STEP = 0.25; // секунды, защита от скачков после зависаний
+
+    QElapsedTimer timer;
+    qint64 lastTickNs;
+    QDateTime epochUtc;
+    double simTime;
+    double simDelta;
+    double realDelta;
+    double warp;
+    bool paused;
+};
+
+#endif // SIMULATION_CLOCK_H
@@ -0,0 +1,33 @@
+// solar_ephemeris.cpp
+#include "solar_ephemeris.h"
+#include <cmath>
+
+QVector3D SolarEphemeris::position(double unixTime)
+{
+    constexpr double DEGREE = M_PI / 180.0;
+
+    // Дни от J2000.0; разница UTC и TT (около минуты) здесь несущественна
+    const double n = unixTime / 86400.0 + 2440587.5 - 2451545.0;
+    const double meanLongitude = (280.460 + 0.9856474 * n) * DEGREE;
+    const double meanAnomaly = (357.528 + 0.9856003 * n) * DEGREE;
+    const double eclipticLongitude = meanLongitude + (1.915 * std::sin(meanAnomaly) +
+                                                      0.020 * std::sin(2.0 * meanAnomaly)) * DEGREE;
+    const double obliquity = (23.439 - 0.0000004 * n) * DEGREE;
+    const double distance = (1.00014 - 0.01671 * std::cos(meanAnomaly) -
+                             0.00014 * std::cos(2.0 * meanAnomaly)) * ASTRONOMICAL_UNIT;
+
+    const double x = distance * std::cos(eclipticLongitude);
+    const double y = distance * std::cos(obliquity) * std::sin(eclipticLongitude);
+    const double z = distance * std::sin(obliquity) * std::sin(eclipticLongitude);
+
+    // ECI -> сцена, как в KeplerPropagator
+    return QVector3D(float(x), float(z), float(-y));
+}
+
+double SolarEphemeris::siderealAngle(double unixTime)
+{
+    // IAU 1982, линейная часть
+    const double daysSinceJ2000 = unixTime / 86400.0 - 10957.5;
+    const double degrees = std::fmod(280.46061837 + 360.98564736629 * daysSinceJ2000, 360.0);
+    return degrees * M_PI / 180.0;
+}
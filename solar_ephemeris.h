@@ -0,0 +1,21 @@
+// solar_ephemeris.h
+#ifndef SOLAR_EPHEMERIS_H
+#define SOLAR_EPHEMERIS_H
+
+#include <QVector3D>
+
+// Положение Солнца по упрощенной теории Astronomical Almanac: ошибка около
+// 0.01° в 1950–2050 годах, для теней и освещения этого достаточно
+class SolarEphemeris {
+public:
+    // Геоцентрическое положение в системе сцены (ECI, ось Y на полюс), м
+    static QVector3D position(double unixTime);
+    // Гринвичское среднее звездное время, рад: поворот Земли вокруг оси
+    // полюса относительно той же инерциальной системы
+    static double siderealAngle(double unixTime);
+
+    static constexpr double ASTRONOMICAL_UNIT = 1.495978707e11; // м
+    static constexpr double SUN_RADIUS = 6.957e8;               // м
+};
+
+#endif // SOLAR_EPHEMERIS_H
@@ -0,0 +1,150 @@
+// text_renderer.cpp
+#include "text_renderer.h"
+#include <QDebug>
+
+TextRenderer::TextRenderer()
+    : Renderer()
+{
+}
+
+TextRenderer::~TextRenderer() = default;
+
+void TextRenderer::initialize()
+{
+    // Атлас строится один раз на все время работы
+    atlas.build();
+
+    atlasTexture = std::make_unique<QOpenGLTexture>(QOpenGLTexture::Target2D);
+    atlasTexture->setSize(atlas.image().width(), atlas.image().height());
+    atlasTexture->setFormat(QOpenGLTexture::R8_UNorm);
+    atlasTexture->allocateStorage(QOpenGLTexture::Red, QOpenGLTexture::UInt8);
+    atlasTexture->setData(QOpenGLTexture::Red, QOpenGLTexture::UInt8, atlas.image().constBits());
+    atlasTexture->setMinificationFilter(QOpenGLTexture::Linear);
+    atlasTexture->setMagnificationFilter(QOpenGLTexture::Linear);
+    atlasTexture->setWrapMode(QOpenGLTexture::ClampToEdge);
+
+    if (!program.addShaderFromSourceFile(QOpenGLShader::Vertex, ":/shaders/text_vertex.glsl"))
+        qDebug() << "Failed to compile text vertex shader";
+    if (!program.addShaderFromSourceFile(QOpenGLShader::Fragment, ":/shaders/text_fragment.glsl"))
+        qDebug() << "Failed to compile text fragment shader";
+    program.bindAttributeLocation("anchor", 0);
+    program.bindAttributeLocation("rect", 1);
+    program.bindAttributeLocation("uvRect", 2);
+    program.bindAttributeLocation("color", 3);
+    if (!program.link())
+        qDebug() << "Failed to link text shader program";
+
+    vao.create();
+    vao.bind();
+
+    vbo.create();
+    vbo.setUsagePattern(QOpenGLBuffer::DynamicDraw);
+    vbo.bind();
+    for (int attribute = 0; attribute < 4; ++attribute) {
+        program.enableAttributeArray(attribute);
+        program.setAttributeBuffer(attribute, GL_FLOAT, attribute * sizeof(QVector4D), 4, sizeof(Instance));
+        glVertexAttribDivisor(attribute, 1);
+    }
+
+    vao.release();
+}
+
+void TextRenderer::begin(const QSize& viewportSize)
+{
+    viewport = viewportSize;
+    instances.clear(); // емкость сохраняется между кадрами
+}
+
+void TextRenderer::addText(const QString& text, const QPointF& position, float pixelSize, const QColor& color)
+{
+    appendText(QVector4D(position.x(), position.y(), 0.0f, 0.0f), QPointF(), text, pixelSize, color);
+}
+
+void TextRenderer::addRect(const QRectF& rect, const QColor& color)
+{
+    instances.append({QVector4D(0.0f, 0.0f, 0.0f, 0.0f),
+                      QVector4D(rect.x(), rect.y(), rect.width(), rect.height()),
+                      QVector4D(), toVector(color)});
+}
+
+void TextRenderer::addLabel(const QVector3D& anchor, const QPointF& offset, const QString& text,
+                            float pixelSize, const QColor& color)
+{
+    appendText(QVector4D(anchor, 1.0f), offset, text, pixelSize, color);
+}
+
+void TextRenderer::addLabelRect(const QVector3D& anchor, const QRectF& rect, const QColor& color)
+{
+    instances.append({QVector4D(anchor, 1.0f),
+                      QVector4D(rect.x(), rect.y(), rect.width(), rect.height()),
+                      QVector4D(), toVector(color)});
+}
+
+void TextRenderer::appendText(const QVector4D& anchor, const QPointF& offset, const QString& text,
+                              float pixelSize, const QColor& color)
+{
+    const float scale = pixelSize / GlyphAtlas::BASE_PIXEL_SIZE;
+    const QVector4D rgba = toVector(color);
+
+    for (const GlyphAtlas::Quad& quad : cachedLayout(text)) {
+        instances.append({anchor,
+                          QVector4D(offset.x() + quad.rect.x() * scale, offset.y() + quad.rect.y() * scale,
+                                    quad.rect.width() * scale, quad.rect.height() * scale),
+                          QVector4D(quad.uv.x(), quad.uv.y(), quad.uv.width(), quad.uv.height()),
+                          rgba});
+    }
+}
+
+const QVector<GlyphAtlas::Quad>& TextRenderer::cachedLayout(const QString& text)
+{
+    auto it = layoutCache.find(text);
+    if (it != layoutCache.end())
+        return *it;
+
+    if (layoutCache.size() >= MAX_CACHED_LAYOUTS)
+        layoutCache.clear();
+    return *layoutCache.insert(text, atlas.layout(text, GlyphAtlas::BASE_PIXEL_SIZE));
+}
+
+QVector4D TextRenderer::toVector(const QColor& color)
+{
+    return QVector4D(color.redF(), color.greenF(), color.blueF(), color.alphaF());
+}
+
+void TextRenderer::render(const QMatrix4x4& projection, const QMatrix4x4& view, const QMatrix4x4& model)
+{
+    if (instances.isEmpty() || viewport.isEmpty() || !program.bind())
+        return;
+
+    vao.bind();
+    vbo.bind();
+    vbo.allocate(instances.constData(), instances.size() * sizeof(Instance));
+
+    program.setUniformValue("mvpMatrix", projection * view * model);
+    program.setUniformValue("viewportSize", QVector2D(viewport.width(), viewport.height()));
+
+    glActiveTexture(GL_TEXTURE0);
+    atlasTexture->bind();
+    program.setUniformValue("glyphAtlas", 0);
+
+    // Сохраняем текущие состояния OpenGL
+    GLboolean depthTest, blend, cullFace;
+    glGetBooleanv(GL_DEPTH_TEST, &depthTest);
+    glGetBooleanv(GL_BLEND, &blend);
+    glGetBooleanv(GL_CULL_FACE, &cullFace);
+
+    glDisable(GL_DEPTH_TEST);
+    glDisable(GL_CULL_FACE);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, instances.size());
+
+    if (depthTest) glEnable(GL_DEPTH_TEST);
+    if (cullFace) glEnable(GL_CULL_FACE);
+    if (!blend) glDisable(GL_BLEND);
+
+    atlasTexture->release();
+    vao.release();
+    program.release();
+}
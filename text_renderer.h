@@ -0,0 +1,63 @@
+// text_renderer.h
+#ifndef TEXT_RENDERER_H
+#define TEXT_RENDERER_H
+
+#include "renderer.h"
+#include "glyph_atlas.h"
+#include <QOpenGLTexture>
+#include <QColor>
+#include <QHash>
+#include <QVector4D>
+#include <memory>
+
+// Текст поверх сцены без QPainter: глифы из SDF-атласа рисуются
+// инстансированными квадами за один draw call. Метки, привязанные
+// к точкам сцены, проецируются в вершинном шейдере.
+class TextRenderer : public Renderer
+{
+public:
+    TextRenderer();
+    ~TextRenderer() override;
+
+    void initialize() override;
+    // Рисует накопленный с begin() пакет
+    void render(const QMatrix4x4& projection, const QMatrix4x4& view, const QMatrix4x4& model) override;
+
+    void begin(const QSize& viewportSize);
+
+    // Экранные координаты в логических пикселях, от левого верхнего угла
+    void addText(const QString& text, const QPointF& position, float pixelSize, const QColor& color);
+    void addRect(const QRectF& rect, const QColor& color);
+
+    // Привязка к точке сцены; offset и rect — в пикселях от ее проекции
+    void addLabel(const QVector3D& anchor, const QPointF& offset, const QString& text,
+                  float pixelSize, const QColor& color);
+    void addLabelRect(const QVector3D& anchor, const QRectF& rect, const QColor& color);
+
+    QSizeF measure(const QString& text, float pixelSize) const { return atlas.measure(text, pixelSize); }
+    int instanceCount() const { return instances.size(); }
+
+private:
+    struct Instance {
+        QVector4D anchor; // xyz — точка сцены (w = 1) или пиксели экрана (w = 0)
+        QVector4D rect;   // x, y, ширина, высота в пикселях от якоря
+        QVector4D uv;     // область атласа; нулевая ширина — сплошная заливка
+        QVector4D color;
+    };
+
+    void appendText(const QVector4D& anchor, const QPointF& offset, const QString& text,
+                    float pixelSize, const QColor& color);
+    const QVector<GlyphAtlas::Quad>& cachedLayout(const QString& text);
+    static QVector4D toVector(const QColor& color);
+
+    static constexpr int MAX_CACHED_LAYOUTS = 8192;
+
+    GlyphAtlas atlas;
+    std::unique_ptr<QOpenGLTexture> atlasTexture;
+    QVector<Instance> instances;
+    // Раскладка строк в базовом размере атласа, масштабируется при добавлении
+    QHash<QString, QVector<GlyphAtlas::Quad>> layoutCache;
+    QSize viewport;
+};
+
+#endif // TEXT_RENDERER_H
@@ -1,29 +1,84 @@
 // tile_texture_manager.cpp
 #include "tile_texture_manager.h"
 #include <QImage>
+#include <QImageReader>
 #include <QtMath>
 #include <QDebug>
+#include <QFileInfo>
+#include <QSet>
+#include <QVector2D>
+#include <QtConcurrent/QtConcurrent>
 #include <qpainter.h>
+#include <algorithm>
+
+namespace {
+
+void setAtlasFiltering(QOpenGLTexture& texture)
+{
+    texture.setMinificationFilter(QOpenGLTexture::LinearMipMapLinear);
+    texture.setMagnificationFilter(QOpenGLTexture::Linear);
+    texture.setWrapMode(QOpenGLTexture::ClampToEdge);
+}
+
+QVector3D spherePoint(float phi, float theta)
+{
+    return QVector3D(std::sin(phi) * std::cos(theta), std::cos(phi), std::sin(phi) * std::sin(theta));
+}
+
+}
 
 TileTextureManager::TileTextureManager(const QString& path, int rings, int segments)
     : imagePath(path)
     , numRings(rings)
     , numSegments(segments)
-    , textureAtlas(nullptr)
+    , atlasLevel(0)
+    , loadBudget(0)
+    , uploadPause(0)
+    , lastVisible(0)
+    , lastMissing(0)
+    , lastPrefetched(0)
+    , memoryBudget(nullptr)
+    , budgetLayer(-1)
+    , decodeFailed(false)
+    , tilePool(0)
+    , pageTable(0)
+    , poolCapacity(0)
+    , pageTableDirty(false)
 {
     initializeOpenGLFunctions();
 }
 
 TileTextureManager::~TileTextureManager() {
+    releasePool();
+    if (pageTable)
+        glDeleteTextures(1, &pageTable);
+    if (memoryBudget)
+        memoryBudget->unregisterLayer(budgetLayer);
+}
+
+void TileTextureManager::setMemoryBudget(GpuMemoryBudget* budget, GpuMemoryBudget::Priority priority) {
+    if (memoryBudget)
+        memoryBudget->unregisterLayer(budgetLayer);
+    memoryBudget = budget;
+    budgetLayer = -1;
+    if (memoryBudget) {
+        budgetLayer = memoryBudget->registerLayer(QFileInfo(imagePath).completeBaseName(), priority,
+                                                  [this](qint64 bytes, GpuMemoryBudget::ReclaimScope scope) {
+                                                      reclaimMemory(bytes, scope);
+                                                  });
+    }
 }
 
 void TileTextureManager::initialize() {
+    // Исходник нужен только на время сборки атласа: тайлы потом вырезаются
+    // из файла в пуле потоков
     QImage sourceImage(imagePath);
     if (sourceImage.isNull()) {
         qWarning() << "Failed to load source image:" << imagePath;
         return;
     }
     sourceImage = sourceImage.mirrored(true, false);
+    sourceSize = sourceImage.size();
 
     // Если текстура слишком большая, разбиваем на более мелкие тайлы
     int maxTextureSize;
@@ -32,6 +87,8 @@ void TileTextureManager::initialize() {
     // Определяем размер тайла, чтобы не превысить ограничения OpenGL
     int tileWidth = std::min(sourceImage.width() / numSegments, maxTextureSize);
     int tileHeight = std::min(sourceImage.height() / numRings, maxTextureSize);
+    tileBytesPerMip = GpuMemoryBudget::textureBytes(sourceImage.width() / numSegments,
+                                                    sourceImage.height() / numRings, 4, true);
 
     // Создаем атлас с учетом максимального размера текстуры
     tilesPerRow = std::ceil(std::sqrt(numRings * numSegments));
@@ -39,56 +96,228 @@ void TileTextureManager::initialize() {
     // Убедимся, что размер атласа не превышает максимально допустимый
     int atlasWidth = std::min(tileWidth * tilesPerRow, maxTextureSize);
     int atlasHeight = std::min(tileHeight * tilesPerRow, maxTextureSize);
-
     atlasSize = QSize(atlasWidth, atlasHeight);
-    QImage atlasImage(atlasSize, QImage::Format_RGBA8888);
+
+    int currentTileWidth = atlasWidth / tilesPerRow;
+    int currentTileHeight = atlasHeight / tilesPerRow;
+    tileUVCoords.clear();
+    pageEntries.fill(-1.0f, numRings * numSegments);
+    for (int index = 0; index < numRings * numSegments; ++index) {
+        // Сохраняем UV-координаты
+        int atlasX = index % tilesPerRow * currentTileWidth;
+        int atlasY = index / tilesPerRow * currentTileHeight;
+        QRectF uvCoords(
+            float(atlasX) / atlasSize.width(),
+            float(atlasY) / atlasSize.height(),
+            float(currentTileWidth) / atlasSize.width(),
+            float(currentTileHeight) / atlasSize.height()
+            );
+        tileUVCoords.append(uvCoords);
+    }
+
+    // Атлас, не помещающийся в бюджет, сразу создается уменьшенным; лимит
+    // задается до initialize (SceneRenderer::initialize)
+    atlasLevel = 0;
+    if (memoryBudget) {
+        while (reducedAtlasSize(atlasLevel + 1).width() >= MIN_ATLAS_SIZE
+               && !memoryBudget->request(budgetLayer, atlasBytes(atlasLevel)))
+            ++atlasLevel;
+    }
+
+    uploadAtlas(composeAtlas(sourceImage, atlasSize, reducedAtlasSize(atlasLevel), numRings, numSegments,
+                             tilesPerRow));
+}
+
+QImage TileTextureManager::readAtlas(const QString& path, const QSize& size, const QSize& scaledSize, int rings,
+                                     int segments, int columns) {
+    QImage source(path);
+    if (source.isNull())
+        return source;
+    return composeAtlas(source.mirrored(true, false), size, scaledSize, rings, segments, columns);
+}
+
+QImage TileTextureManager::composeAtlas(const QImage& source, const QSize& size, const QSize& scaledSize,
+                                        int rings, int segments, int columns) {
+    QImage atlasImage(size, QImage::Format_RGBA8888);
     atlasImage.fill(Qt::transparent);
 
-    // Масштабируем тайлы если нужно
-    float scaleX = float(atlasWidth) / (tileWidth * tilesPerRow);
-    float scaleY = float(atlasHeight) / (tileHeight * tilesPerRow);
+    // Размеры тайла в атласе
+    int currentTileWidth = size.width() / columns;
+    int currentTileHeight = size.height() / columns;
 
-    for (int ring = 0; ring < numRings; ++ring) {
-        for (int segment = 0; segment < numSegments; ++segment) {
+    QPainter painter(&atlasImage);
+    painter.setRenderHint(QPainter::SmoothPixmapTransform);
+    for (int ring = 0; ring < rings; ++ring) {
+        for (int segment = 0; segment < segments; ++segment) {
             // Позиция в атласе
-            int atlasX = (ring * numSegments + segment) % tilesPerRow * (atlasWidth / tilesPerRow);
-            int atlasY = (ring * numSegments + segment) / tilesPerRow * (atlasHeight / tilesPerRow);
+            int atlasX = (ring * segments + segment) % columns * currentTileWidth;
+            int atlasY = (ring * segments + segment) / columns * currentTileHeight;
 
             // Позиция в исходной текстуре
-            int sourceX = segment * (sourceImage.width() / numSegments);
-            int sourceY = ring * (sourceImage.height() / numRings);
-
-            // Размеры тайла в атласе
-            int currentTileWidth = atlasWidth / tilesPerRow;
-            int currentTileHeight = atlasHeight / tilesPerRow;
+            int sourceX = segment * (source.width() / segments);
+            int sourceY = ring * (source.height() / rings);
 
             // Копируем и масштабируем тайл
             QRect sourceRect(sourceX, sourceY,
-                             sourceImage.width() / numSegments,
-                             sourceImage.height() / numRings);
+                             source.width() / segments,
+                             source.height() / rings);
             QRect targetRect(atlasX, atlasY, currentTileWidth, currentTileHeight);
-
-            QPainter painter(&atlasImage);
-            painter.setRenderHint(QPainter::SmoothPixmapTransform);
-            painter.drawImage(targetRect, sourceImage, sourceRect);
-
-            // Сохраняем UV-координаты
-            QRectF uvCoords(
-                float(atlasX) / atlasSize.width(),
-                float(atlasY) / atlasSize.height(),
-                float(currentTileWidth) / atlasSize.width(),
-                float(currentTileHeight) / atlasSize.height()
-                );
-            tileUVCoords.append(uvCoords);
+            painter.drawImage(targetRect, source, sourceRect);
         }
     }
+    painter.end();
+
+    // Масштабируется атлас целиком, чтобы UV тайлов остались прежними
+    if (scaledSize != size)
+        atlasImage = atlasImage.scaled(scaledSize, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+    return atlasImage;
+}
 
+QSize TileTextureManager::reducedAtlasSize(int level) const {
+    return QSize(std::max(1, atlasSize.width() >> level), std::max(1, atlasSize.height() >> level));
+}
+
+qint64 TileTextureManager::atlasBytes(int level) const {
+    const QSize size = reducedAtlasSize(level);
+    qint64 bytes = 0;
+    for (qint64 mip : GpuMemoryBudget::textureBytes(size.width(), size.height(), 4, true))
+        bytes += mip;
+    return bytes;
+}
+
+void TileTextureManager::uploadAtlas(const QImage& atlasImage) {
     // Создаем текстуру атласа с правильными параметрами
-    textureAtlas = new QOpenGLTexture(atlasImage);
-    textureAtlas->setMinificationFilter(QOpenGLTexture::LinearMipMapLinear);
-    textureAtlas->setMagnificationFilter(QOpenGLTexture::Linear);
-    textureAtlas->setWrapMode(QOpenGLTexture::ClampToEdge);
+    textureAtlas.reset();
+    textureAtlas = std::make_unique<QOpenGLTexture>(atlasImage);
+    setAtlasFiltering(*textureAtlas);
     textureAtlas->generateMipMaps();
+    reportUsage();
+}
+
+bool TileTextureManager::reduceAtlas() {
+    const QSize size = reducedAtlasSize(atlasLevel + 1);
+    if (!textureAtlas || size.width() < MIN_ATLAS_SIZE)
+        return false;
+
+    // Уровень mip 1 атласа — тот же атлас, уменьшенный вдвое: он копируется
+    // на GPU в новую текстуру, без исходника и пересборки на CPU
+    auto reduced = std::make_unique<QOpenGLTexture>(QOpenGLTexture::Target2D);
+    reduced->setFormat(QOpenGLTexture::RGBA8_UNorm);
+    reduced->setSize(size.width(), size.height());
+    reduced->setMipLevels(reduced->maximumMipLevels());
+    reduced->allocateStorage();
+
+    GLint readFramebuffer = 0;
+    GLint drawFramebuffer = 0;
+    glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &readFramebuffer);
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &drawFramebuffer);
+    GLuint framebuffers[2];
+    glGenFramebuffers(2, framebuffers);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffers[0]);
+    glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, textureAtlas->textureId(), 1);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, framebuffers[1]);
+    glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, reduced->textureId(), 0);
+    glBlitFramebuffer(0, 0, size.width(), size.height(), 0, 0, size.width(), size.height(),
+                      GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, readFramebuffer);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, drawFramebuffer);
+    glDeleteFramebuffers(2, framebuffers);
+
+    setAtlasFiltering(*reduced);
+    reduced->generateMipMaps();
+    textureAtlas = std::move(reduced);
+    ++atlasLevel;
+    reduceClock.restart();
+    // Собираемый больший атлас уже не нужен
+    restoring = QFuture<QImage>();
+    reportUsage();
+    return true;
+}
+
+void TileTextureManager::restoreAtlas() {
+    if (atlasLevel == 0 || !textureAtlas || !memoryBudget)
+        return;
+    const qint64 grownBytes = atlasBytes(atlasLevel - 1) - atlasBytes(atlasLevel);
+
+    if (restoring.isValid()) {
+        if (!restoring.isFinished())
+            return;
+        const QImage atlasImage = restoring.result();
+        restoring = QFuture<QImage>();
+        if (atlasImage.isNull()) {
+            qWarning() << "Failed to restore texture atlas from" << imagePath;
+            decodeFailed = true;
+            return;
+        }
+        // Только свободное место: рост не должен сжимать другие слои.
+        // Не поместился — собранный атлас выбрасывается, попытка позже
+        if (!memoryBudget->request(budgetLayer, grownBytes, GpuMemoryBudget::ReclaimScope::None)) {
+            reduceClock.restart();
+            return;
+        }
+        --atlasLevel;
+        uploadAtlas(atlasImage);
+        return;
+    }
+
+    // Запас под лимитом и пауза после уменьшения: иначе атлас, выросший
+    // вплотную к лимиту, сжимался бы снова при первом же запросе
+    if (decodeFailed || (reduceClock.isValid() && reduceClock.elapsed() < RESTORE_DELAY_MS))
+        return;
+    const qint64 limit = memoryBudget->limit();
+    if (limit > 0 && memoryBudget->used() + grownBytes > qint64(limit * RESTORE_FILL))
+        return;
+
+    const QString path = imagePath;
+    const QSize size = atlasSize;
+    const QSize scaledSize = reducedAtlasSize(atlasLevel - 1);
+    const int rings = numRings;
+    const int segments = numSegments;
+    const int columns = tilesPerRow;
+    restoring = QtConcurrent::run([path, size, scaledSize, rings, segments, columns]() {
+        return readAtlas(path, size, scaledSize, rings, segments, columns);
+    });
+}
+
+void TileTextureManager::reclaimMemory(qint64 bytes, GpuMemoryBudget::ReclaimScope scope) {
+    // Сначала тайлы: пул выделен одним куском и освобождается целиком.
+    // Выделить его снова можно не раньше UPLOAD_RETRY_CALLS вызовов, иначе
+    // пул и атлас другого слоя вытесняли бы друг друга каждый кадр
+    if (poolCapacity > 0) {
+        const qint64 before = memoryBudget ? memoryBudget->used() : 0;
+        releasePool();
+        uploadPause = UPLOAD_RETRY_CALLS;
+        if (memoryBudget)
+            bytes -= before - memoryBudget->used();
+    }
+
+    // Затем атлас, если запрос это допускает: уменьшение вдвое по сторонам
+    // освобождает три четверти
+    if (scope != GpuMemoryBudget::ReclaimScope::All)
+        return;
+    while (bytes > 0) {
+        const qint64 before = memoryBudget ? memoryBudget->used() : 0;
+        if (!reduceAtlas())
+            break;
+        if (memoryBudget)
+            bytes -= before - memoryBudget->used();
+    }
+}
+
+void TileTextureManager::reportUsage() {
+    if (!memoryBudget)
+        return;
+
+    QVector<qint64> bytesPerMip;
+    if (textureAtlas) {
+        const QSize size = reducedAtlasSize(atlasLevel);
+        bytesPerMip = GpuMemoryBudget::textureBytes(size.width(), size.height(), 4, true);
+    }
+    if (bytesPerMip.size() < tileBytesPerMip.size())
+        bytesPerMip.resize(tileBytesPerMip.size());
+    for (int mip = 0; mip < tileBytesPerMip.size(); ++mip)
+        bytesPerMip[mip] += poolCapacity * tileBytesPerMip[mip];
+    memoryBudget->setUsage(budgetLayer, bytesPerMip);
 }
 
 bool TileTextureManager::bindTileTexture(int ring, int segment) {
@@ -102,31 +331,206 @@ const QRectF& TileTextureManager::getTileUVCoords(int ring, int segment) {
     return tileUVCoords[index];
 }
 
-void TileTextureManager::loadTile(const TileCoords& coords) {
-    QRectF uvCoords, sphereCoords;
-    calculateTileCoordinates(coords, uvCoords, sphereCoords);
+bool TileTextureManager::allocatePool() {
+    qint64 tileBytes = 0;
+    for (qint64 mip : tileBytesPerMip)
+        tileBytes += mip;
+    GLint maxLayers = 0;
+    glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxLayers);
+
+    // Пул только в свободном месте или на месте тайлов слоев ниже; не
+    // помещается целиком — берется вдвое меньший
+    int capacity = std::min(POOL_TILES, int(maxLayers));
+    if (memoryBudget) {
+        while (capacity >= MIN_POOL_TILES
+               && !memoryBudget->request(budgetLayer, capacity * tileBytes, GpuMemoryBudget::ReclaimScope::Caches))
+            capacity /= 2;
+    }
+    if (capacity < MIN_POOL_TILES || tileBytesPerMip.isEmpty())
+        return false;
+
+    const int tileWidth = sourceSize.width() / numSegments;
+    const int tileHeight = sourceSize.height() / numRings;
+    glGenTextures(1, &tilePool);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, tilePool);
+    for (int level = 0; level < tileBytesPerMip.size(); ++level) {
+        glTexImage3D(GL_TEXTURE_2D_ARRAY, level, GL_RGBA8, std::max(1, tileWidth >> level),
+                     std::max(1, tileHeight >> level), capacity, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    }
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, tileBytesPerMip.size() - 1);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+    if (!pageTable) {
+        glGenTextures(1, &pageTable);
+        glBindTexture(GL_TEXTURE_2D, pageTable);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_R32F, numSegments, numRings, 0, GL_RED, GL_FLOAT, nullptr);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        pageTableDirty = true;
+    }
+
+    poolCapacity = capacity;
+    freeLayers.clear();
+    for (int layer = capacity - 1; layer >= 0; --layer)
+        freeLayers.append(layer);
+    reportUsage();
+    return true;
+}
+
+void TileTextureManager::releasePool() {
+    if (poolCapacity == 0)
+        return;
+    glDeleteTextures(1, &tilePool);
+    tilePool = 0;
+    poolCapacity = 0;
+    freeLayers.clear();
+    residentTiles.clear();
+    pageEntries.fill(-1.0f);
+    pageTableDirty = true;
+    reportUsage();
+}
+
+void TileTextureManager::releaseTiles() {
+    decodedTiles.clear();
+    releasePool();
+}
+
+void TileTextureManager::releaseLayer(const TileCoords& coords, int layer) {
+    freeLayers.append(layer);
+    pageEntries[coords.ring * numSegments + coords.segment] = -1.0f;
+    pageTableDirty = true;
+}
+
+void TileTextureManager::updatePageTable() {
+    if (!pageTableDirty || !pageTable)
+        return;
+    glBindTexture(GL_TEXTURE_2D, pageTable);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, numSegments, numRings, GL_RED, GL_FLOAT, pageEntries.constData());
+    glBindTexture(GL_TEXTURE_2D, 0);
+    pageTableDirty = false;
+}
+
+void TileTextureManager::bindTiles(QOpenGLShaderProgram& program, int poolUnit, int pageTableUnit) {
+    // Сэмплеры назначаются всегда: иначе sampler2DArray и атлас делили бы блок 0
+    program.setUniformValue("tilePool", poolUnit);
+    program.setUniformValue("tilePageTable", pageTableUnit);
+    const bool available = !residentTiles.isEmpty() && !tileUVCoords.isEmpty();
+    program.setUniformValue("tilesAvailable", available);
+    if (!available)
+        return;
+
+    updatePageTable();
+    glActiveTexture(GL_TEXTURE0 + poolUnit);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, tilePool);
+    glActiveTexture(GL_TEXTURE0 + pageTableUnit);
+    glBindTexture(GL_TEXTURE_2D, pageTable);
+    glActiveTexture(GL_TEXTURE0);
+    program.setUniformValue("tileSegments", numSegments);
+    program.setUniformValue("tileColumns", tilesPerRow);
+    program.setUniformValue("tileCellSize", QVector2D(tileUVCoords[0].width(), tileUVCoords[0].height()));
+}
+
+bool TileTextureManager::uploadTile(const TileCoords& coords, const QVector<QImage>& levels) {
+    if (poolCapacity == 0 && !allocatePool()) {
+        uploadPause = UPLOAD_RETRY_CALLS;
+        return false;
+    }
+    // Пул заполнен тайлами с заявками: остальные ждут, пока те не уйдут с экрана
+    if (freeLayers.isEmpty())
+        return false;
+
+    const int layer = freeLayers.takeLast();
+    glBindTexture(GL_TEXTURE_2D_ARRAY, tilePool);
+    for (int level = 0; level < std::min(int(levels.size()), int(tileBytesPerMip.size())); ++level) {
+        const QImage& image = levels[level];
+        glTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, 0, 0, layer, image.width(), image.height(), 1, GL_RGBA,
+                        GL_UNSIGNED_BYTE, image.constBits());
+    }
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
 
-    // Вычисляем размеры и позицию тайла в исходном изображении
-    int x = uvCoords.x() * sourceImage.width();
-    int y = uvCoords.y() * sourceImage.height();
-    int width = uvCoords.width() * sourceImage.width();
-    int height = uvCoords.height() * sourceImage.height();
+    residentTiles.insert(coords, layer);
+    pageEntries[coords.ring * numSegments + coords.segment] = float(layer);
+    pageTableDirty = true;
+    return true;
+}
+
+void TileTextureManager::startDecode(const QVector<TileCoords>& coords) {
+    const QString path = imagePath;
+    const QSize size = sourceSize;
+    const int rings = numRings;
+    const int segments = numSegments;
+    decoding = QtConcurrent::run([path, size, rings, segments, coords]() {
+        return decodeTiles(path, size, rings, segments, coords);
+    });
+}
 
-    // Вырезаем участок изображения для тайла
-    QImage tileImage = sourceImage.copy(x, y, width, height);
+void TileTextureManager::pollDecoded() {
+    if (!decoding.isValid() || !decoding.isFinished())
+        return;
+    const QVector<TileImage> tiles = decoding.result();
+    decoding = QFuture<QVector<TileImage>>();
+    if (tiles.isEmpty()) {
+        // Файл не читается: без этого пакет заказывался бы каждый кадр
+        decodeFailed = true;
+        return;
+    }
+    for (const TileImage& tile : tiles)
+        decodedTiles.insert(tile.coords, tile.levels);
+}
 
-    auto tile = new Tile();
-    tile->texture = std::make_unique<QOpenGLTexture>(tileImage.mirrored());
-    tile->texture->setMinificationFilter(QOpenGLTexture::LinearMipMapLinear);
-    tile->texture->setMagnificationFilter(QOpenGLTexture::Linear);
-    tile->texture->setWrapMode(QOpenGLTexture::ClampToEdge);
-    tile->uvCoords = uvCoords;
-    tile->sphereCoords = sphereCoords;
-    tile->isLoaded = true;
+void TileTextureManager::waitForTiles() {
+    if (decoding.isValid())
+        decoding.waitForFinished();
+    pollDecoded();
+}
 
-    // Размер в мегабайтах (приблизительно)
-    int tileSizeMB = (width * height * 4) / (1024 * 1024);
-    tileCache.insert(coords, tile, tileSizeMB);
+QVector<TileTextureManager::TileImage> TileTextureManager::decodeTiles(const QString& path, const QSize& sourceSize,
+                                                                      int rings, int segments,
+                                                                      const QVector<TileCoords>& coords) {
+    const int tileWidth = sourceSize.width() / segments;
+    const int tileHeight = sourceSize.height() / rings;
+
+    // Общая рамка пакета в координатах отраженного исходника; в файле она
+    // зеркальна по горизонтали. JPEG декодирует только рамку, остальные
+    // форматы — файл целиком, но в памяти остается только она
+    QRect bounds;
+    for (const TileCoords& tile : coords)
+        bounds |= QRect(tile.segment * tileWidth, tile.ring * tileHeight, tileWidth, tileHeight);
+    QImageReader reader(path);
+    reader.setClipRect(QRect(sourceSize.width() - bounds.right() - 1, bounds.y(), bounds.width(), bounds.height()));
+    QImage region = reader.read();
+
+    QVector<TileImage> tiles;
+    if (region.isNull()) {
+        qWarning() << "Failed to load tiles from" << path << reader.errorString();
+        return tiles;
+    }
+    region = region.mirrored(true, false);
+
+    // Строки тайла идут в том же порядке, что и в ячейке атласа, поэтому
+    // шейдер берет тайл и атлас по одним локальным UV. Уровни mip считаются
+    // здесь же: в видеопамяти перестраивать их пришлось бы для всего пула
+    const int levelCount = GpuMemoryBudget::textureBytes(tileWidth, tileHeight, 4, true).size();
+    tiles.reserve(coords.size());
+    for (const TileCoords& tile : coords) {
+        QImage level = region.copy(tile.segment * tileWidth - bounds.x(), tile.ring * tileHeight - bounds.y(),
+                                   tileWidth, tileHeight).convertToFormat(QImage::Format_RGBA8888);
+        TileImage image{tile, {}};
+        image.levels.reserve(levelCount);
+        image.levels.append(level);
+        for (int index = 1; index < levelCount; ++index) {
+            level = level.scaled(std::max(1, tileWidth >> index), std::max(1, tileHeight >> index),
+                                 Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+            image.levels.append(level);
+        }
+        tiles.append(image);
+    }
+    return tiles;
 }
 
 void TileTextureManager::calculateTileCoordinates(const TileCoords& coords, QRectF& uvCoords, QRectF& sphereCoords) const {
@@ -145,67 +549,153 @@ void TileTextureManager::calculateTileCoordinates(const TileCoords& coords, QRec
     sphereCoords = QRectF(phi1, theta1, phi2 - phi1, theta2 - theta1);
 }
 
-void TileTextureManager::updateVisibleTiles(const QMatrix4x4& viewProjection) {
-    QSet<TileCoords> visibleTiles;
+void TileTextureManager::updateVisibleTiles(const QMatrix4x4& viewProjection, const QVector3D& eye) {
+    requestTiles(collectRequests({PredictedView{viewProjection, eye, 0.0f}}));
+}
+
+QVector<TileRequest> TileTextureManager::collectRequests(const QVector<PredictedView>& views) const {
+    QVector<TileRequest> requests;
 
-    // Определяем видимые тайлы
     for (int ring = 0; ring < numRings; ++ring) {
         for (int segment = 0; segment < numSegments; ++segment) {
             TileCoords coords{ring, segment};
             QRectF uvCoords, sphereCoords;
             calculateTileCoordinates(coords, uvCoords, sphereCoords);
 
-            if (isTileVisible(sphereCoords, viewProjection)) {
-                visibleTiles.insert(coords);
-                // Предзагружаем тайл если его нет в кэше
-                if (!tileCache.contains(coords)) {
-                    loadTile(coords);
+            // Виды идут по возрастанию timeAhead: первый совпавший — самый ранний
+            for (const PredictedView& view : views) {
+                if (isTileVisible(sphereCoords, view.viewProjection, view.eye)) {
+                    requests.append(TileRequest{coords, view.timeAhead});
+                    break;
                 }
             }
         }
     }
 
-    // Удаляем невидимые тайлы из кэша
-    QList<TileCoords> cachedTiles = tileCache.keys();
-    for (const TileCoords& coords : cachedTiles) {
-        if (!visibleTiles.contains(coords)) {
-            tileCache.remove(coords);
-        }
-    }
+    std::stable_sort(requests.begin(), requests.end(), [](const TileRequest& a, const TileRequest& b) {
+        return a.timeToVisible < b.timeToVisible;
+    });
+    return requests;
 }
 
-bool TileTextureManager::isTileVisible(const QRectF& sphereCoords, const QMatrix4x4& viewProjection) const {
-    // Создаем 8 угловых точек для сферического сегмента
-    const float radius = 1.0f; // Единичная сфера
-    QVector<QVector3D> corners;
-
-    float phi1 = sphereCoords.x();
-    float phi2 = sphereCoords.x() + sphereCoords.height();
-    float theta1 = sphereCoords.y();
-    float theta2 = sphereCoords.y() + sphereCoords.width();
-
-    // Генерируем угловые точки
-    for (float phi : {phi1, phi2}) {
-        for (float theta : {theta1, theta2}) {
-            float x = radius * sin(phi) * cos(theta);
-            float y = radius * cos(phi);
-            float z = radius * sin(phi) * sin(theta);
-            corners.append(QVector3D(x, y, z));
+void TileTextureManager::requestTiles(const QVector<TileRequest>& requests) {
+    lastVisible = 0;
+    lastMissing = 0;
+    lastPrefetched = 0;
+    if (!hasSource())
+        return;
+    pollDecoded();
+
+    QSet<TileCoords> requestedTiles;
+    requestedTiles.reserve(requests.size());
+    for (const TileRequest& request : requests)
+        requestedTiles.insert(request.coords);
+
+    // Вырезанные тайлы, которые больше не ожидаются на экране, не загружаются
+    for (auto it = decodedTiles.begin(); it != decodedTiles.end();) {
+        if (requestedTiles.contains(it.key()))
+            ++it;
+        else
+            it = decodedTiles.erase(it);
+    }
+    // Слои пула с тайлами без заявок освобождаются до загрузки новых
+    for (auto it = residentTiles.begin(); it != residentTiles.end();) {
+        if (requestedTiles.contains(it.key())) {
+            ++it;
+        } else {
+            releaseLayer(it.key(), it.value());
+            it = residentTiles.erase(it);
         }
     }
 
-    // Проверяем, находится ли хотя бы одна точка в пределах пирамиды видимости
-    for (const QVector3D& corner : corners) {
-        QVector4D clipSpace = viewProjection * QVector4D(corner, 1.0f);
-        if (clipSpace.w() != 0) {
-            QVector3D ndc = QVector3D(clipSpace.x(), clipSpace.y(), clipSpace.z()) / clipSpace.w();
-            if (ndc.x() >= -1.0f && ndc.x() <= 1.0f &&
-                ndc.y() >= -1.0f && ndc.y() <= 1.0f &&
-                ndc.z() >= -1.0f && ndc.z() <= 1.0f) {
-                return true;
+    // Вырезается не больше, чем поместится в пул: остальное ждало бы в памяти
+    const int capacity = poolCapacity > 0 ? poolCapacity : POOL_TILES;
+    const int decodeRoom = std::min<int>(DECODE_BATCH, capacity - residentTiles.size() - decodedTiles.size());
+
+    int uploaded = 0;
+    // Бюджет видеопамяти отказал — загрузки ждут UPLOAD_RETRY_CALLS вызовов,
+    // а не повторяются каждый кадр, выгружая тайлы других слоев
+    bool outOfMemory = uploadPause > 0;
+    if (uploadPause > 0)
+        --uploadPause;
+    QVector<TileCoords> toDecode;
+    for (const TileRequest& request : requests) {
+        const bool visible = request.timeToVisible <= 0.0f;
+        lastVisible += visible;
+        if (residentTiles.contains(request.coords))
+            continue;
+
+        auto decoded = decodedTiles.find(request.coords);
+        if (decoded != decodedTiles.end()) {
+            if (!outOfMemory && (loadBudget <= 0 || uploaded < loadBudget)) {
+                if (uploadTile(request.coords, *decoded)) {
+                    decodedTiles.erase(decoded);
+                    ++uploaded;
+                    lastPrefetched += !visible;
+                    continue;
+                }
+                // Пул заполнен или бюджет отказал (uploadTile ставит паузу)
+                outOfMemory = true;
             }
+        } else if (!isLoading() && toDecode.size() < decodeRoom) {
+            // Следующий пакет — самые срочные из еще не вырезанных
+            toDecode.append(request.coords);
         }
+        lastMissing += visible; // останется в очереди до следующего кадра
+    }
+    if (!toDecode.isEmpty())
+        startDecode(toDecode);
+}
+
+bool TileTextureManager::isTileVisible(const QRectF& sphereCoords, const QMatrix4x4& viewProjection,
+                                       const QVector3D& eye) {
+    // Тайл лежит в шапке единичной сферы вокруг направления на его центр
+    // с угловым радиусом до самого дальнего угла: дальше углов точки
+    // широтно-долготного прямоугольника от центра не отходят. Обе проверки
+    // консервативны — тайл отбрасывается, только если шапка заведомо
+    // за горизонтом или целиком снаружи одной из плоскостей пирамиды
+    const float phi1 = sphereCoords.x();
+    const float phi2 = sphereCoords.x() + sphereCoords.width();
+    const float theta1 = sphereCoords.y();
+    const float theta2 = sphereCoords.y() + sphereCoords.height();
+    const QVector3D center = spherePoint(phi1 + 0.5f * sphereCoords.width(), theta1 + 0.5f * sphereCoords.height());
+
+    float cosRadius = 1.0f;
+    for (float phi : {phi1, phi2}) {
+        for (float theta : {theta1, theta2})
+            cosRadius = std::min(cosRadius, QVector3D::dotProduct(center, spherePoint(phi, theta)));
+    }
+    const float capRadius = std::acos(qBound(-1.0f, cosRadius, 1.0f));
+
+    // За горизонтом: из eye видна шапка вокруг eye/|eye| радиуса acos(1/|eye|);
+    // тайл виден, если шапки пересекаются
+    const float eyeDistance = eye.length();
+    if (eyeDistance > 1.0f) {
+        const float horizon = std::acos(1.0f / eyeDistance);
+        const float toEye = std::acos(qBound(-1.0f, QVector3D::dotProduct(center, eye) / eyeDistance, 1.0f));
+        if (toEye >= horizon + capRadius)
+            return false;
+    }
+
+    // Шапка меньше полусферы лежит в шаре с центром center * cos r и
+    // радиусом sin r; большая — в единичном шаре
+    QVector3D ballCenter;
+    float ballRadius = 1.0f;
+    if (cosRadius > 0.0f) {
+        ballCenter = center * cosRadius;
+        ballRadius = std::sin(capRadius);
     }
 
-    return false;
+    // Плоскости пирамиды из строк видовой проекции: w ± x, w ± y, w ± z
+    const QVector4D w = viewProjection.row(3);
+    for (int axis = 0; axis < 3; ++axis) {
+        for (float sign : {1.0f, -1.0f}) {
+            const QVector4D plane = w + sign * viewProjection.row(axis);
+            const float normalLength = plane.toVector3D().length();
+            if (normalLength > 0.0f
+                && QVector3D::dotProduct(plane.toVector3D(), ballCenter) + plane.w() < -ballRadius * normalLength)
+                return false;
+        }
+    }
+    return true;
 }
@@ -2,11 +2,18 @@
 #ifndef TILE_TEXTURE_MANAGER_H
 #define TILE_TEXTURE_MANAGER_H
 
-#include <QOpenGLFunctions>
+#include <QOpenGLExtraFunctions>
+#include <QOpenGLShaderProgram>
 #include <QOpenGLTexture>
 #include <QMatrix4x4>
-#include <QCache>
+#include <QElapsedTimer>
+#include <QFuture>
+#include <QHash>
+#include <QImage>
 #include <QString>
+#include <QVector>
+#include <memory>
+#include "gpu_memory_budget.h"
 
 struct TileCoords {
     int ring;
@@ -17,50 +24,155 @@ struct TileCoords {
     }
 };
 
-// For QCache
+// Для QHash/QSet тайлов
 inline uint qHash(const TileCoords& key) {
-    return qHash(QString("%1_%2").arg(key.ring).arg(key.segment));
+    // Заявки проверяются по пулу каждый кадр — без строк
+    return uint(qHash((quint64(quint32(key.ring)) << 32) | quint32(key.segment)));
 }
 
-class Tile {
-public:
-    Tile() : texture(nullptr), isLoaded(false) {}
-    ~Tile() { }
+// Заявка на тайл: timeToVisible — через сколько секунд тайл ожидается
+// на экране (0 — виден сейчас), по нему выбирается порядок загрузки
+struct TileRequest {
+    TileCoords coords;
+    float timeToVisible;
+};
 
-    std::unique_ptr<QOpenGLTexture> texture;
-    QRectF uvCoords;        // UV-координаты тайла в текстуре
-    QRectF sphereCoords;    // Сферические координаты тайла (phi1, theta1, phi2, theta2)
-    bool isLoaded;
+// Вид камеры через timeAhead секунд: видовая проекция единичной сферы
+// и положение камеры в ее координатах (для отсечения за горизонтом)
+struct PredictedView {
+    QMatrix4x4 viewProjection;
+    QVector3D eye;
+    float timeAhead;
 };
 
-class TileTextureManager : protected QOpenGLFunctions {
+// Атлас всех тайлов слоя и пул тайлов полного разрешения. Исходное
+// изображение нужно только для сборки атласа; тайлы вырезаются из файла
+// в пуле потоков пакетами, а в видеопамять загружаются не больше loadBudget
+// за кадр. Пул — массив текстур (слой на тайл) и страничная таблица
+// тайл -> слой: шейдер берет тайл из пула, если он загружен, иначе атлас.
+// С бюджетом видеопамяти (GpuMemoryBudget) пул выделяется в свободном
+// месте или за счет тайлов слоев ниже, атласы он не трогает. Под давлением
+// слой сначала освобождает пул, затем уменьшает атлас вдвое копированием
+// его уровня mip 1 на GPU. Когда место освободилось, атлас пересобирается
+// из файла в пуле потоков и возвращается к прежнему размеру по шагу за раз.
+// UV атласа при этом не меняются: масштабируется изображение целиком.
+class TileTextureManager : protected QOpenGLExtraFunctions {
 public:
     TileTextureManager(const QString& imagePath, int rings, int segments);
     ~TileTextureManager();
 
+    // До initialize: слой регистрируется в бюджете под именем файла
+    void setMemoryBudget(GpuMemoryBudget* budget, GpuMemoryBudget::Priority priority);
     void initialize();
+    // Пул тайлов и страничная таблица на заданных блоках текстур; uniform-ы
+    // tilePool, tilePageTable, tilesAvailable, tileSegments, tileColumns, tileCellSize
+    void bindTiles(QOpenGLShaderProgram& program, int poolUnit, int pageTableUnit);
+    // Освобождает пул целиком (потоковая подгрузка выключена)
+    void releaseTiles();
     bool bindTileTexture(int ring, int segment);
     const QRectF& getTileUVCoords(int ring, int segment);
-    void updateVisibleTiles(const QMatrix4x4& viewProjection);
+    const QVector<QRectF>& getAllTileUVCoords() const { return tileUVCoords; }
+    void updateVisibleTiles(const QMatrix4x4& viewProjection, const QVector3D& eye);
+    // eye — камера в координатах единичной сферы: тайлы за горизонтом не видны
+    static bool isTileVisible(const QRectF& sphereCoords, const QMatrix4x4& viewProjection, const QVector3D& eye);
+
+    // Заявки на тайлы, видимые хотя бы в одном из видов, по возрастанию
+    // timeToVisible: для каждого тайла берется самый ранний вид
+    QVector<TileRequest> collectRequests(const QVector<PredictedView>& views) const;
+    // Загружает в видеопамять вырезанные в фоне тайлы по порядку заявок, не
+    // больше бюджета за вызов, заказывает вырезку следующих и выгружает тайлы
+    // без заявок. requests отсортированы по timeToVisible
+    void requestTiles(const QVector<TileRequest>& requests);
+    // Загрузок в видеопамять за вызов requestTiles; 0 — без ограничения
+    void setLoadBudget(int tilesPerCall) { loadBudget = tilesPerCall; }
+    bool hasSource() const { return !sourceSize.isEmpty() && !decodeFailed; }
+    // Идет ли вырезка тайлов в пуле потоков; waitForTiles дожидается ее (бенчмарки)
+    bool isLoading() const { return decoding.isValid(); }
+    void waitForTiles();
+
+    // Итоги последнего вызова: видимых тайлов, из них не загруженных
+    // после него и загруженных заранее, до появления на экране
+    int visibleTileCount() const { return lastVisible; }
+    int missingTileCount() const { return lastMissing; }
+    int prefetchedTileCount() const { return lastPrefetched; }
+
+    // Уменьшений атласа вдвое под давлением бюджета
+    int atlasReduction() const { return atlasLevel; }
+    // Раз в кадр: уменьшенный атлас растет обратно, если место есть с запасом
+    void restoreAtlas();
 
 private:
-    void loadTile(const TileCoords& coords);
+    // Тайл с цепочкой уровней mip, RGBA8888, в ориентации ячейки атласа
+    struct TileImage {
+        TileCoords coords;
+        QVector<QImage> levels;
+    };
+
+    bool uploadTile(const TileCoords& coords, const QVector<QImage>& levels);
+    bool allocatePool();
+    void releasePool();
+    void releaseLayer(const TileCoords& coords, int layer);
+    void updatePageTable();
+    void startDecode(const QVector<TileCoords>& coords);
+    void pollDecoded();
+    static QVector<TileImage> decodeTiles(const QString& path, const QSize& sourceSize, int rings, int segments,
+                                          const QVector<TileCoords>& coords);
     void calculateTileCoordinates(const TileCoords& coords, QRectF& uvCoords, QRectF& sphereCoords) const;
-    bool isTileVisible(const QRectF& sphereCoords, const QMatrix4x4& viewProjection) const;
-    void cleanupUnusedTiles();
+    static QImage composeAtlas(const QImage& source, const QSize& size, const QSize& scaledSize, int rings,
+                               int segments, int columns);
+    static QImage readAtlas(const QString& path, const QSize& size, const QSize& scaledSize, int rings,
+                            int segments, int columns);
+    void uploadAtlas(const QImage& atlasImage);
+    bool reduceAtlas();
+    QSize reducedAtlasSize(int level) const;
+    qint64 atlasBytes(int level) const;
+    void reclaimMemory(qint64 bytes, GpuMemoryBudget::ReclaimScope scope);
+    void reportUsage();
 
     QString imagePath;
-    QImage sourceImage;
+    QSize sourceSize;                  // исходник отражен по горизонтали, как в атласе
     int numRings;
     int numSegments;
-    QOpenGLTexture* textureAtlas;
+    std::unique_ptr<QOpenGLTexture> textureAtlas;
     QVector<QRectF> tileUVCoords;     // Кэшируем UV-координаты для каждого тайла
-    QSize atlasSize;                   // Размер атласа текстур
+    QSize atlasSize;                   // Размер атласа текстур без уменьшения
+    int atlasLevel;                    // атлас загружен уменьшенным в 2^atlasLevel раз
     int tilesPerRow;                   // Количество тайлов в строке атласа
+    int loadBudget;
+    int uploadPause;                   // вызовов без загрузок после отказа бюджета
+    int lastVisible;
+    int lastMissing;
+    int lastPrefetched;
+
+    GpuMemoryBudget* memoryBudget;
+    int budgetLayer;
+    QVector<qint64> tileBytesPerMip;   // тайл со всеми уровнями mip
+
+    // Вырезка тайлов в пуле потоков: один пакет на слой за раз
+    QFuture<QVector<TileImage>> decoding;
+    QHash<TileCoords, QVector<QImage>> decodedTiles; // ждут загрузки в видеопамять
+    bool decodeFailed;
+
+    // Возврат атласа к большему размеру: сборка в пуле потоков
+    QFuture<QImage> restoring;
+    QElapsedTimer reduceClock;         // с последнего уменьшения атласа
+
+    // Пул выделяется целиком при первой загрузке; в таблице -1 — тайла нет
+    GLuint tilePool;
+    GLuint pageTable;
+    int poolCapacity;                  // слоев в пуле; 0 — не выделен
+    QVector<int> freeLayers;
+    QHash<TileCoords, int> residentTiles;
+    QVector<float> pageEntries;        // ring * segments + segment -> слой
+    bool pageTableDirty;
 
-    // Используем QCache для автоматического управления памятью
-    QCache<TileCoords, Tile> tileCache;
-    static constexpr int MAX_CACHE_SIZE = 512; // В мегабайтах
+    static constexpr int POOL_TILES = 1024;    // слоев пула, если хватает бюджета
+    static constexpr int MIN_POOL_TILES = 64;  // меньший пул не выделяется
+    static constexpr int MIN_ATLAS_SIZE = 256; // меньше атлас не уменьшается
+    static constexpr int DECODE_BATCH = 64;    // тайлов в пакете вырезки
+    static constexpr int UPLOAD_RETRY_CALLS = 30;     // пауза загрузок после отказа бюджета
+    static constexpr qint64 RESTORE_DELAY_MS = 10000; // от уменьшения атласа до роста
+    static constexpr double RESTORE_FILL = 0.9;       // доля лимита, занятая после роста
 };
 
 #endif // TILE_TEXTURE_MANAGER_H
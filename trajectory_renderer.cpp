@@ -1,5 +1,6 @@
 #include "trajectory_renderer.h"
 #include <QDateTime>
+#include <cmath>
 
 TrajectoryRenderer::TrajectoryRenderer()
     : currentVBO(QOpenGLBuffer::VertexBuffer),
@@ -7,6 +8,10 @@ TrajectoryRenderer::TrajectoryRenderer()
     currentVertexCount(0),
     predictedVertexCount(0),
     needsUpdate(false),
+    orbitBuffer(QOpenGLBuffer::VertexBuffer),
+    orbitLinesDirty(false),
+    unixTime(0.0),
+    referenceTime(0.0),
     time(0.0f)
 {
 }
@@ -17,6 +22,10 @@ TrajectoryRenderer::~TrajectoryRenderer()
         currentVBO.destroy();
     if (predictedVBO.isCreated())
         predictedVBO.destroy();
+    if (orbitVao.isCreated())
+        orbitVao.destroy();
+    if (orbitBuffer.isCreated())
+        orbitBuffer.destroy();
 }
 
 void TrajectoryRenderer::initialize()
@@ -31,6 +40,19 @@ void TrajectoryRenderer::initialize()
     predictedVBO.create();
 
     vao.release();
+
+    // Процедурные дуги: вершинных данных нет, запись дуги — атрибуты экземпляра
+    orbitVao.create();
+    orbitVao.bind();
+    orbitBuffer.create();
+    orbitBuffer.bind();
+    for (int attribute = 1; attribute <= 4; ++attribute) {
+        glEnableVertexAttribArray(attribute);
+        glVertexAttribPointer(attribute, 4, GL_FLOAT, GL_FALSE, sizeof(OrbitRecord),
+                              reinterpret_cast<void*>((attribute - 1) * sizeof(QVector4D)));
+        glVertexAttribDivisor(attribute, 1);
+    }
+    orbitVao.release();
 }
 
 void TrajectoryRenderer::initShaders()
@@ -56,9 +78,48 @@ void TrajectoryRenderer::setTrajectories(const QVector<QVector3D>& current,
     }
 }
 
+void TrajectoryRenderer::setOrbitLines(const QVector<OrbitLine>& lines)
+{
+    if (lines != orbitLines) {
+        orbitLines = lines;
+        orbitLinesDirty = true;
+    }
+}
+
+void TrajectoryRenderer::uploadOrbitLines()
+{
+    referenceTime = unixTime;
+
+    QVector<OrbitRecord> records(orbitLines.size());
+    for (int i = 0; i < orbitLines.size(); ++i) {
+        const OrbitLine& line = orbitLines[i];
+        const SatelliteOrbit& orbit = line.orbit;
+        // Аномалия на опорный момент в double, шейдер прибавляет n·dt
+        double M = std::fmod(orbit.meanAnomaly + orbit.meanMotion * (referenceTime - orbit.epoch), 2.0 * M_PI);
+        if (M < 0.0)
+            M += 2.0 * M_PI;
+        records[i].axisP = QVector4D(orbit.axisP, orbit.eccentricity);
+        records[i].axisQ = QVector4D(orbit.axisQ, float(orbit.meanMotion));
+        records[i].window = QVector4D(float(M), line.windowStart, line.windowLength, 0.0f);
+        records[i].color = line.color;
+    }
+
+    orbitBuffer.bind();
+    orbitBuffer.allocate(records.constData(), records.size() * int(sizeof(OrbitRecord)));
+    orbitBuffer.release();
+    orbitLinesDirty = false;
+}
+
+void TrajectoryRenderer::update(float deltaTime)
+{
+    // Фаза пунктира в [0, 1), при перемотке назад движется в обратную сторону
+    time = std::fmod(time + deltaTime * DASH_SPEED, 1.0f);
+    if (time < 0.0f) time += 1.0f;
+}
+
 void TrajectoryRenderer::render(const QMatrix4x4& projection, const QMatrix4x4& view, const QMatrix4x4& model)
 {
-    if (currentTrajectory.isEmpty() && predictedTrajectory.isEmpty())
+    if (currentTrajectory.isEmpty() && predictedTrajectory.isEmpty() && orbitLines.isEmpty())
         return;
 
     QMatrix4x4 mvp = projection * view * model;
@@ -76,10 +137,8 @@ void TrajectoryRenderer::render(const QMatrix4x4& projection, const QMatrix4x4&
     glGetIntegerv(GL_DEPTH_FUNC, &previousDepthFunc);
     glDepthFunc(GL_LEQUAL);
 
-    // Обновляем время для анимации
-    time += 0.01f;
-    if (time > 1.0f) time = 0.0f;
     program.setUniformValue("time", time);
+    program.setUniformValue("procedural", false);
 
     // Обновляем буферы только если необходимо
     if (needsUpdate) {
@@ -120,6 +179,17 @@ void TrajectoryRenderer::render(const QMatrix4x4& projection, const QMatrix4x4&
         glDrawArrays(GL_LINE_STRIP, 0, predictedVertexCount);
     }
 
+    // Процедурные дуги: по экземпляру на дугу, точки считает шейдер
+    if (!orbitLines.isEmpty()) {
+        if (orbitLinesDirty || std::abs(unixTime - referenceTime) > REBASE_INTERVAL)
+            uploadOrbitLines();
+        program.setUniformValue("procedural", true);
+        program.setUniformValue("orbitVertices", ORBIT_VERTICES);
+        program.setUniformValue("timeSinceReference", float(unixTime - referenceTime));
+        orbitVao.bind();
+        glDrawArraysInstanced(GL_LINE_STRIP, 0, ORBIT_VERTICES, orbitLines.size());
+    }
+
     // Восстановление состояния OpenGL
     glDepthFunc(previousDepthFunc);
     glDisable(GL_LINE_SMOOTH);
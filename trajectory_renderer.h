@@ -2,8 +2,13 @@
 #define TRAJECTORY_RENDERER_H
 
 #include "renderer.h"
+#include "satellite_orbit.h"
 #include <QVector3D>
 
+// Траектории выбранного спутника: ломаные, построенные на CPU, либо
+// процедурные дуги орбит (OrbitLine), которые вершинный шейдер вычисляет
+// по gl_VertexID. Для дуг буфер обновляется только при смене набора или
+// опорного момента, а ход времени передается uniform-переменной.
 class TrajectoryRenderer : public Renderer {
 public:
     TrajectoryRenderer();
@@ -11,11 +16,24 @@ public:
 
     void initialize() override;
     void render(const QMatrix4x4& projection, const QMatrix4x4& view, const QMatrix4x4& model) override;
+    void update(float deltaTime) override;
     void setTrajectories(const QVector<QVector3D>& currentTrajectory,
                          const QVector<QVector3D>& predictedTrajectory);
+    void setOrbitLines(const QVector<OrbitLine>& lines);
+    // Момент, от которого шейдер отсчитывает окна дуг (секунды Unix)
+    void setUnixTime(double time) { unixTime = time; }
 
 private:
     void initShaders();
+    void uploadOrbitLines();
+
+    // Запись дуги на GPU: атрибуты 1-4 шейдера trajectory.vert, по экземпляру на дугу
+    struct OrbitRecord {
+        QVector4D axisP;  // a·P, w — эксцентриситет
+        QVector4D axisQ;  // b·Q, w — среднее движение, рад/с
+        QVector4D window; // M на опорный момент, начало и длина окна, с
+        QVector4D color;
+    };
 
     QVector<QVector3D> currentTrajectory;
     QVector<QVector3D> predictedTrajectory;
@@ -25,7 +43,19 @@ private:
     int currentVertexCount;
     int predictedVertexCount;
     bool needsUpdate;
+
+    QVector<OrbitLine> orbitLines;
+    QOpenGLVertexArrayObject orbitVao;
+    QOpenGLBuffer orbitBuffer;
+    bool orbitLinesDirty;
+    double unixTime;
+    double referenceTime; // опорный момент записей дуг
     float time;  // Для анимации пунктирной линии
+
+    static constexpr float DASH_SPEED = 0.625f; // Циклов пунктира в секунду
+    static constexpr int ORBIT_VERTICES = 256;  // точек процедурной дуги
+    // Шейдер считает во float: время от опорного момента держим небольшим
+    static constexpr double REBASE_INTERVAL = 3600.0; // с
 };
 
 #endif // TRAJECTORY_RENDERER_H